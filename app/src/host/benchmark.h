@@ -0,0 +1,37 @@
+// SPDX-License-Identifier: MPL-2.0
+// Copyright © 2022 Skyline Team and Contributors (https://github.com/skyline-emu/)
+
+#pragma once
+
+#include <chrono>
+#include <string_view>
+#include <fmt/format.h>
+
+namespace skyline::host {
+    using Nanoseconds = std::chrono::duration<double, std::nano>;
+
+    /**
+     * @brief Runs the supplied function repeatedly and measures the average duration of a single run
+     * @param iterations The amount of times the function is run after a single untimed warm-up run
+     */
+    template<typename Function>
+    Nanoseconds Measure(size_t iterations, Function &&function) {
+        function();
+
+        auto start{std::chrono::steady_clock::now()};
+        for (size_t iteration{}; iteration < iterations; iteration++)
+            function();
+        return Nanoseconds{std::chrono::steady_clock::now() - start} / iterations;
+    }
+
+    /**
+     * @brief Prints the result of a benchmark in a format that can be easily compared across runs
+     * @param bytes The amount of bytes processed by a single run, the throughput is only printed if this is non-zero
+     */
+    inline void Report(std::string_view name, Nanoseconds duration, size_t bytes = 0) {
+        if (bytes)
+            fmt::print("{:<56} {:>12.1f} ns {:>10.2f} GiB/s\n", name, duration.count(), (static_cast<double>(bytes) / (1024 * 1024 * 1024)) / (duration.count() / 1'000'000'000));
+        else
+            fmt::print("{:<56} {:>12.1f} ns\n", name, duration.count());
+    }
+}
@@ -0,0 +1,23 @@
+// SPDX-License-Identifier: MPL-2.0
+// Copyright © 2022 Skyline Team and Contributors (https://github.com/skyline-emu/)
+
+#pragma once
+
+#include <cstdint>
+
+/**
+ * @brief A substitute for the libadrenotools BCeNabler header on non-Android hosts, no driver is ever patched
+ */
+enum adrenotools_bcn_type {
+    ADRENOTOOLS_BCN_INCOMPATIBLE,
+    ADRENOTOOLS_BCN_BLOB,
+    ADRENOTOOLS_BCN_PATCH,
+};
+
+inline adrenotools_bcn_type adrenotools_get_bcn_type(uint32_t driverMajorVersion, uint32_t driverMinorVersion, uint32_t vendorId) {
+    return ADRENOTOOLS_BCN_INCOMPATIBLE;
+}
+
+inline bool adrenotools_patch_bcn(void *vkGetPhysicalDeviceFormatPropertiesFn) {
+    return false;
+}
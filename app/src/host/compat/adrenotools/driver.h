@@ -0,0 +1,34 @@
+// SPDX-License-Identifier: MPL-2.0
+// Copyright © 2022 Skyline Team and Contributors (https://github.com/skyline-emu/)
+
+#pragma once
+
+#include <cstdint>
+
+/**
+ * @brief A substitute for the libadrenotools driver header on non-Android hosts, custom drivers and GPU mapping imports are never available
+ */
+#define ADRENOTOOLS_DRIVER_CUSTOM (1 << 0)
+#define ADRENOTOOLS_DRIVER_FILE_REDIRECT (1 << 1)
+#define ADRENOTOOLS_DRIVER_GPU_MAPPING_IMPORT (1 << 2)
+
+struct adrenotools_gpu_mapping {
+    void *host_ptr;
+    uint64_t gpu_addr;
+    uint64_t size;
+    uint64_t flags;
+};
+
+inline void *adrenotools_open_libvulkan(int dlopenMode, int featureFlags, const char *tmpLibDir, const char *hookLibDir, const char *customDriverDir, const char *customDriverName, const char *fileRedirectDir, adrenotools_gpu_mapping *nextGpuMapping) {
+    return nullptr;
+}
+
+inline bool adrenotools_import_user_mem(adrenotools_gpu_mapping *outMapping, void *hostPtr, uint64_t size) {
+    return false;
+}
+
+inline bool adrenotools_validate_gpu_mapping(adrenotools_gpu_mapping *mapping) {
+    return false;
+}
+
+inline void adrenotools_set_turbo(bool turbo) {}
@@ -0,0 +1,36 @@
+// SPDX-License-Identifier: MPL-2.0
+// Copyright © 2022 Skyline Team and Contributors (https://github.com/skyline-emu/)
+
+#pragma once
+
+#include <cstdarg>
+#include <cstdio>
+
+/**
+ * @brief A substitute for the NDK logging header on non-Android hosts, all messages are written to stderr
+ */
+enum android_LogPriority {
+    ANDROID_LOG_UNKNOWN = 0,
+    ANDROID_LOG_DEFAULT,
+    ANDROID_LOG_VERBOSE,
+    ANDROID_LOG_DEBUG,
+    ANDROID_LOG_INFO,
+    ANDROID_LOG_WARN,
+    ANDROID_LOG_ERROR,
+    ANDROID_LOG_FATAL,
+    ANDROID_LOG_SILENT,
+};
+
+inline int __android_log_write(int priority, const char *tag, const char *text) {
+    return std::fprintf(stderr, "%s: %s\n", tag, text);
+}
+
+inline int __android_log_print(int priority, const char *tag, const char *format, ...) {
+    std::va_list args;
+    va_start(args, format);
+    int written{std::fprintf(stderr, "%s: ", tag)};
+    written += std::vfprintf(stderr, format, args);
+    written += std::fprintf(stderr, "\n");
+    va_end(args);
+    return written;
+}
@@ -0,0 +1,15 @@
+// SPDX-License-Identifier: MPL-2.0
+// Copyright © 2022 Skyline Team and Contributors (https://github.com/skyline-emu/)
+
+#pragma once
+
+#define PROP_VALUE_MAX 92
+
+/**
+ * @brief A substitute for the Android system property getter on non-Android hosts, no properties are defined
+ * @return The length of the value, this is always 0
+ */
+inline int __system_property_get(const char *name, char *value) {
+    value[0] = '\0';
+    return 0;
+}
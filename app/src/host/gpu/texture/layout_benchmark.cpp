@@ -0,0 +1,68 @@
+// SPDX-License-Identifier: MPL-2.0
+// Copyright © 2022 Skyline Team and Contributors (https://github.com/skyline-emu/)
+
+#include <random>
+#include <benchmark.h>
+#include "layout_reference.h"
+
+/**
+ * @brief Measures the throughput of the block-linear copy functions on surfaces representative of guest textures, the per-byte reference implementation is measured alongside as a baseline
+ */
+namespace skyline::gpu::texture {
+    struct BenchmarkSurface {
+        std::string_view name;
+        Dimensions dimensions;
+        size_t formatBlockWidth, formatBlockHeight, formatBpb;
+        size_t gobBlockHeight, gobBlockDepth;
+    };
+
+    constexpr std::array<BenchmarkSurface, 7> Surfaces{{
+        {"1920x1080 R8G8B8A8", {1920, 1080, 1}, 1, 1, 4, 16, 1},
+        {"1280x720 R16G16B16A16", {1280, 720, 1}, 1, 1, 8, 16, 1},
+        {"1024x1024 BC7", {1024, 1024, 1}, 4, 4, 16, 16, 1},
+        {"2048x2048 ASTC 8x8", {2048, 2048, 1}, 8, 8, 16, 16, 1},
+        {"512x512 R32G32B32", {512, 512, 1}, 1, 1, 12, 16, 1},
+        {"333x177 R8G8B8A8", {333, 177, 1}, 1, 1, 4, 4, 1}, // Unaligned to GOBs in both dimensions, this exercises the sector-granular paths
+        {"128x128x32 R8G8B8A8", {128, 128, 32}, 1, 1, 4, 4, 8},
+    }};
+
+    void RunBenchmarks() {
+        std::mt19937 rng{0x534B59};
+
+        for (const auto &surface : Surfaces) {
+            reference::BlockLinearSurface reference{surface.dimensions, surface.formatBlockWidth, surface.formatBlockHeight, surface.formatBpb, surface.gobBlockHeight, surface.gobBlockDepth};
+            size_t linearSize{reference.widthBytes * reference.heightLines * reference.depth};
+            std::vector<u8> blockLinear(GetBlockLinearLayerSize(surface.dimensions, surface.formatBlockWidth, surface.formatBlockHeight, surface.formatBpb, surface.gobBlockHeight, surface.gobBlockDepth)), linear(linearSize);
+            std::generate(blockLinear.begin(), blockLinear.end(), [&] { return static_cast<u8>(rng()); });
+
+            size_t iterations{std::max<size_t>((256 * 1024 * 1024) / linearSize, 4)}; // Every copy is run for ~256MiB worth of data
+
+            host::Report(fmt::format("{} BlockLinearToLinear", surface.name), host::Measure(iterations, [&] {
+                CopyBlockLinearToLinear(surface.dimensions, surface.formatBlockWidth, surface.formatBlockHeight, surface.formatBpb, surface.gobBlockHeight, surface.gobBlockDepth, blockLinear.data(), linear.data());
+            }), linearSize);
+
+            host::Report(fmt::format("{} LinearToBlockLinear", surface.name), host::Measure(iterations, [&] {
+                CopyLinearToBlockLinear(surface.dimensions, surface.formatBlockWidth, surface.formatBlockHeight, surface.formatBpb, surface.gobBlockHeight, surface.gobBlockDepth, linear.data(), blockLinear.data());
+            }), linearSize);
+
+            // A subrect offset by a sector in both dimensions from the origin, as used by DMA copies of a part of a surface
+            if (surface.dimensions.depth == 1) {
+                u32 originX{static_cast<u32>(util::DivideCeil<size_t>(16, surface.formatBpb) * surface.formatBlockWidth)}, originY{static_cast<u32>(2 * surface.formatBlockHeight)};
+                Dimensions subrectDimensions{surface.dimensions.width - originX, surface.dimensions.height - originY, 1};
+                size_t subrectSize{util::DivideCeil<size_t>(subrectDimensions.width, surface.formatBlockWidth) * surface.formatBpb * util::DivideCeil<size_t>(subrectDimensions.height, surface.formatBlockHeight)};
+
+                host::Report(fmt::format("{} BlockLinearToPitchSubrect", surface.name), host::Measure(iterations, [&] {
+                    CopyBlockLinearToPitchSubrect(subrectDimensions, surface.dimensions, surface.formatBlockWidth, surface.formatBlockHeight, surface.formatBpb, 0, surface.gobBlockHeight, surface.gobBlockDepth, blockLinear.data(), linear.data(), originX, originY);
+                }), subrectSize);
+            }
+
+            host::Report(fmt::format("{} BlockLinearToLinear (Reference)", surface.name), host::Measure(std::max<size_t>(iterations / 64, 1), [&] {
+                reference::CopyBlockLinear<true>(reference, blockLinear.data(), linear.data());
+            }), linearSize);
+        }
+    }
+}
+
+int main() {
+    skyline::gpu::texture::RunBenchmarks();
+}
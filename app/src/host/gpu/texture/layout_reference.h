@@ -0,0 +1,69 @@
+// SPDX-License-Identifier: MPL-2.0
+// Copyright © 2022 Skyline Team and Contributors (https://github.com/skyline-emu/)
+
+#pragma once
+
+#include <gpu/texture/layout.h>
+
+namespace skyline::gpu::texture::reference {
+    constexpr size_t GobWidth{64}; //!< The width of a GOB in bytes
+    constexpr size_t GobHeight{8}; //!< The height of a GOB in lines
+    constexpr size_t GobSize{GobWidth * GobHeight}; //!< The size of a GOB in bytes
+
+    /**
+     * @brief The layout of a block-linear surface in terms of bytes and lines rather than format blocks
+     */
+    struct BlockLinearSurface {
+        size_t widthBytes; //!< The width of a line of the surface in bytes, excluding any padding
+        size_t heightLines; //!< The height of the surface in lines of format blocks
+        size_t depth;
+        size_t gobBlockHeight, gobBlockDepth;
+
+        BlockLinearSurface(Dimensions dimensions, size_t formatBlockWidth, size_t formatBlockHeight, size_t formatBpb, size_t gobBlockHeight, size_t gobBlockDepth)
+            : widthBytes{util::DivideCeil<size_t>(dimensions.width, formatBlockWidth) * formatBpb},
+              heightLines{util::DivideCeil<size_t>(dimensions.height, formatBlockHeight)},
+              depth{dimensions.depth},
+              gobBlockHeight{gobBlockHeight},
+              gobBlockDepth{gobBlockDepth} {}
+
+        /**
+         * @return The offset of the byte at the supplied coordinates in blocklinear memory
+         * @note This is computed for each byte directly from the GOB layout, it's intentionally not optimized so it can serve as a reference for the copy functions
+         */
+        size_t GetOffset(size_t x, size_t y, size_t z) const {
+            size_t robHeight{GobHeight * gobBlockHeight};
+            size_t blockSize{GobSize * gobBlockHeight * gobBlockDepth};
+            size_t robSize{blockSize * util::DivideCeil(widthBytes, GobWidth)};
+            size_t mobSize{robSize * util::DivideCeil(heightLines, robHeight)};
+
+            size_t gobOffset{((x % GobWidth) / 32) * 256 + ((y % GobHeight) / 2) * 64 + ((x % 32) / 16) * 32 + (y % 2) * 16 + (x % 16)};
+            return (z / gobBlockDepth) * mobSize + (y / robHeight) * robSize + (x / GobWidth) * blockSize + (z % gobBlockDepth) * (GobSize * gobBlockHeight) + ((y % robHeight) / GobHeight) * GobSize + gobOffset;
+        }
+    };
+
+    /**
+     * @brief Copies a region of a block-linear surface to or from a pitch-linear buffer one byte at a time
+     * @param pitch The stride of a line in the pitch-linear buffer, slices are tightly packed
+     */
+    template<bool BlockLinearToPitch>
+    void CopyBlockLinear(const BlockLinearSurface &surface, u8 *blockLinear, u8 *pitchLinear, size_t pitch,
+                         size_t originXBytes, size_t originY, size_t widthBytes, size_t heightLines) {
+        for (size_t z{}; z < surface.depth; z++) {
+            for (size_t y{}; y < heightLines; y++) {
+                u8 *line{pitchLinear + (z * heightLines + y) * pitch};
+                for (size_t x{}; x < widthBytes; x++) {
+                    u8 &swizzled{blockLinear[surface.GetOffset(originXBytes + x, originY + y, z)]};
+                    if constexpr (BlockLinearToPitch)
+                        line[x] = swizzled;
+                    else
+                        swizzled = line[x];
+                }
+            }
+        }
+    }
+
+    template<bool BlockLinearToPitch>
+    void CopyBlockLinear(const BlockLinearSurface &surface, u8 *blockLinear, u8 *pitchLinear, size_t pitch = 0) {
+        CopyBlockLinear<BlockLinearToPitch>(surface, blockLinear, pitchLinear, pitch ? pitch : surface.widthBytes, 0, 0, surface.widthBytes, surface.heightLines);
+    }
+}
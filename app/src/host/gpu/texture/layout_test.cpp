@@ -0,0 +1,241 @@
+// SPDX-License-Identifier: MPL-2.0
+// Copyright © 2022 Skyline Team and Contributors (https://github.com/skyline-emu/)
+
+#include <random>
+#include "layout_reference.h"
+
+/**
+ * @brief Checks the block-linear copy functions against a per-byte reference implementation
+ * @note The copy functions use whole-GOB copies for GOBs within the surface and sector runs elsewhere, surfaces are randomly generated to cover both paths with all format sizes, block dimensions, depths and mipmap chains
+ */
+namespace skyline::gpu::texture {
+    struct FormatInfo {
+        size_t blockWidth;
+        size_t blockHeight;
+        size_t bpb;
+    };
+
+    constexpr std::array<FormatInfo, 10> Formats{{
+        {1, 1, 1}, {1, 1, 2}, {1, 1, 4}, {1, 1, 6}, {1, 1, 8}, {1, 1, 12}, {1, 1, 16}, // Uncompressed formats including the NPOT R16G16B16 and R32G32B32 formats
+        {4, 4, 8}, {4, 4, 16}, {8, 8, 16}, // BCn and ASTC formats
+    }};
+
+    constexpr size_t IterationCount{400}; //!< The amount of random surfaces to check with every copy function
+    constexpr size_t GuardSize{reference::GobSize}; //!< The size of the region after a buffer which is checked to ensure it isn't written to
+    constexpr u8 GuardValue{0xA5};
+
+    /**
+     * @brief A randomly generated block-linear surface along with the parameters used to create it
+     */
+    struct Surface {
+        FormatInfo format;
+        Dimensions dimensions;
+        size_t gobBlockHeight, gobBlockDepth;
+
+        reference::BlockLinearSurface GetReference() const {
+            return {dimensions, format.blockWidth, format.blockHeight, format.bpb, gobBlockHeight, gobBlockDepth};
+        }
+
+        size_t GetBlockLinearSize() const {
+            return GetBlockLinearLayerSize(dimensions, format.blockWidth, format.blockHeight, format.bpb, gobBlockHeight, gobBlockDepth);
+        }
+    };
+
+    class LayoutTest {
+      private:
+        std::mt19937 rng{0x534B59}; //!< A fixed seed is used so that failures are reproducible
+        size_t checkCount{}, failureCount{};
+
+        size_t Random(size_t min, size_t max) {
+            return std::uniform_int_distribution<size_t>{min, max}(rng);
+        }
+
+        std::vector<u8> RandomBuffer(size_t size) {
+            std::vector<u8> buffer(size + GuardSize, GuardValue);
+            for (size_t i{}; i < size; i++)
+                buffer[i] = static_cast<u8>(rng());
+            return buffer;
+        }
+
+        Surface RandomSurface(bool allowDepth = true) {
+            const auto &format{Formats[Random(0, Formats.size() - 1)]};
+            bool is3D{allowDepth && Random(0, 3) == 0};
+            return Surface{
+                .format = format,
+                .dimensions = Dimensions{
+                    static_cast<u32>(Random(1, 160 / format.blockWidth) * format.blockWidth - Random(0, format.blockWidth - 1)),
+                    static_cast<u32>(Random(1, 160 / format.blockHeight) * format.blockHeight - Random(0, format.blockHeight - 1)),
+                    static_cast<u32>(is3D ? Random(2, 9) : 1),
+                },
+                .gobBlockHeight = size_t{1} << Random(0, 5),
+                .gobBlockDepth = is3D ? size_t{1} << Random(0, 3) : 1,
+            };
+        }
+
+        void Check(std::string_view name, const Surface &surface, span<u8> actual, span<u8> expected) {
+            checkCount++;
+            auto mismatch{std::mismatch(actual.begin(), actual.end(), expected.begin())};
+            if (mismatch.first == actual.end())
+                return;
+
+            if (failureCount++ < 16)
+                fmt::print(stderr, "{}: Mismatch at offset 0x{:X} of 0x{:X} (0x{:02X} != 0x{:02X}) with {}x{}x{} ({}x{} blocks, {} bpb) GOB block {}x{}\n",
+                           name, std::distance(actual.begin(), mismatch.first), actual.size(), *mismatch.first, *mismatch.second,
+                           surface.dimensions.width, surface.dimensions.height, surface.dimensions.depth,
+                           surface.format.blockWidth, surface.format.blockHeight, surface.format.bpb,
+                           surface.gobBlockHeight, surface.gobBlockDepth);
+        }
+
+        void CheckBlockLinearToLinear() {
+            auto surface{RandomSurface()};
+            auto reference{surface.GetReference()};
+            auto blockLinear{RandomBuffer(surface.GetBlockLinearSize())};
+
+            size_t linearSize{reference.widthBytes * reference.heightLines * reference.depth};
+            std::vector<u8> actual(linearSize + GuardSize, GuardValue), expected(actual);
+            CopyBlockLinearToLinear(surface.dimensions, surface.format.blockWidth, surface.format.blockHeight, surface.format.bpb, surface.gobBlockHeight, surface.gobBlockDepth, blockLinear.data(), actual.data());
+            reference::CopyBlockLinear<true>(reference, blockLinear.data(), expected.data());
+            Check("CopyBlockLinearToLinear", surface, actual, expected);
+        }
+
+        void CheckLinearToBlockLinear() {
+            auto surface{RandomSurface()};
+            auto reference{surface.GetReference()};
+            auto linear{RandomBuffer(reference.widthBytes * reference.heightLines * reference.depth)};
+
+            auto actual{RandomBuffer(surface.GetBlockLinearSize())}, expected{actual};
+            CopyLinearToBlockLinear(surface.dimensions, surface.format.blockWidth, surface.format.blockHeight, surface.format.bpb, surface.gobBlockHeight, surface.gobBlockDepth, linear.data(), actual.data());
+            reference::CopyBlockLinear<false>(reference, expected.data(), linear.data());
+            Check("CopyLinearToBlockLinear", surface, actual, expected);
+        }
+
+        void CheckPitch() {
+            auto surface{RandomSurface()};
+            auto reference{surface.GetReference()};
+            auto pitch{static_cast<u32>(reference.widthBytes + Random(0, 2) * Random(1, 64))};
+            size_t pitchSize{pitch * reference.heightLines * reference.depth};
+
+            auto blockLinear{RandomBuffer(surface.GetBlockLinearSize())};
+            std::vector<u8> actual(pitchSize + GuardSize, GuardValue), expected(actual);
+            CopyBlockLinearToPitch(surface.dimensions, surface.format.blockWidth, surface.format.blockHeight, surface.format.bpb, pitch, surface.gobBlockHeight, surface.gobBlockDepth, blockLinear.data(), actual.data());
+            reference::CopyBlockLinear<true>(reference, blockLinear.data(), expected.data(), pitch);
+            Check("CopyBlockLinearToPitch", surface, actual, expected);
+
+            auto pitchLinear{RandomBuffer(pitchSize)};
+            auto actualBlockLinear{RandomBuffer(surface.GetBlockLinearSize())}, expectedBlockLinear{actualBlockLinear};
+            CopyPitchToBlockLinear(surface.dimensions, surface.format.blockWidth, surface.format.blockHeight, surface.format.bpb, pitch, surface.gobBlockHeight, surface.gobBlockDepth, pitchLinear.data(), actualBlockLinear.data());
+            reference::CopyBlockLinear<false>(reference, expectedBlockLinear.data(), pitchLinear.data(), pitch);
+            Check("CopyPitchToBlockLinear", surface, actualBlockLinear, expectedBlockLinear);
+        }
+
+        void CheckSubrect() {
+            auto surface{RandomSurface()};
+            auto reference{surface.GetReference()};
+
+            // The subrect is positioned at a random block within the surface, it's copied to or from a pitch or linear buffer of its own size
+            size_t widthBlocks{util::DivideCeil<size_t>(surface.dimensions.width, surface.format.blockWidth)}, heightLines{reference.heightLines};
+            size_t originXBlocks{Random(0, widthBlocks - 1)}, originYLines{Random(0, heightLines - 1)};
+            Dimensions subrectDimensions{
+                static_cast<u32>(Random(1, widthBlocks - originXBlocks) * surface.format.blockWidth),
+                static_cast<u32>(Random(1, heightLines - originYLines) * surface.format.blockHeight),
+                surface.dimensions.depth,
+            };
+            u32 originX{static_cast<u32>(originXBlocks * surface.format.blockWidth)}, originY{static_cast<u32>(originYLines * surface.format.blockHeight)};
+
+            size_t subrectWidthBytes{(subrectDimensions.width / surface.format.blockWidth) * surface.format.bpb}, subrectHeightLines{subrectDimensions.height / surface.format.blockHeight};
+            auto pitch{static_cast<u32>(subrectWidthBytes + Random(0, 1) * Random(1, 64))};
+            size_t pitchSize{pitch * subrectHeightLines * surface.dimensions.depth};
+
+            auto blockLinear{RandomBuffer(surface.GetBlockLinearSize())};
+            std::vector<u8> actual(pitchSize + GuardSize, GuardValue), expected(actual);
+            CopyBlockLinearToPitchSubrect(subrectDimensions, surface.dimensions, surface.format.blockWidth, surface.format.blockHeight, surface.format.bpb, pitch, surface.gobBlockHeight, surface.gobBlockDepth, blockLinear.data(), actual.data(), originX, originY);
+            reference::CopyBlockLinear<true>(reference, blockLinear.data(), expected.data(), pitch, originXBlocks * surface.format.bpb, originYLines, subrectWidthBytes, subrectHeightLines);
+            Check("CopyBlockLinearToPitchSubrect", surface, actual, expected);
+
+            auto pitchLinear{RandomBuffer(pitchSize)};
+            auto actualBlockLinear{RandomBuffer(surface.GetBlockLinearSize())}, expectedBlockLinear{actualBlockLinear};
+            CopyPitchToBlockLinearSubrect(subrectDimensions, surface.dimensions, surface.format.blockWidth, surface.format.blockHeight, surface.format.bpb, pitch, surface.gobBlockHeight, surface.gobBlockDepth, pitchLinear.data(), actualBlockLinear.data(), originX, originY);
+            reference::CopyBlockLinear<false>(reference, expectedBlockLinear.data(), pitchLinear.data(), pitch, originXBlocks * surface.format.bpb, originYLines, subrectWidthBytes, subrectHeightLines);
+            Check("CopyPitchToBlockLinearSubrect", surface, actualBlockLinear, expectedBlockLinear);
+
+            auto linear{RandomBuffer(subrectWidthBytes * subrectHeightLines * surface.dimensions.depth)};
+            actualBlockLinear = RandomBuffer(surface.GetBlockLinearSize());
+            expectedBlockLinear = actualBlockLinear;
+            CopyLinearToBlockLinearSubrect(subrectDimensions, surface.dimensions, surface.format.blockWidth, surface.format.blockHeight, surface.format.bpb, surface.gobBlockHeight, surface.gobBlockDepth, linear.data(), actualBlockLinear.data(), originX, originY);
+            reference::CopyBlockLinear<false>(reference, expectedBlockLinear.data(), linear.data(), subrectWidthBytes, originXBlocks * surface.format.bpb, originYLines, subrectWidthBytes, subrectHeightLines);
+            Check("CopyLinearToBlockLinearSubrect", surface, actualBlockLinear, expectedBlockLinear);
+        }
+
+        void CheckRobs() {
+            auto surface{RandomSurface(false)};
+            auto reference{surface.GetReference()};
+            auto blockLinear{RandomBuffer(surface.GetBlockLinearSize())};
+
+            // The surface is deswizzled in randomly sized bands of ROBs, these must produce the same result as deswizzling it as a whole
+            size_t linearSize{reference.widthBytes * reference.heightLines};
+            std::vector<u8> actual(linearSize + GuardSize, GuardValue), expected(actual);
+            size_t robCount{GetBlockLinearRobCount(surface.dimensions, surface.format.blockHeight, surface.gobBlockHeight)};
+            for (size_t robOffset{}; robOffset < robCount;) {
+                size_t bandRobCount{Random(1, 3)};
+                CopyBlockLinearRobsToLinear(surface.dimensions, surface.format.blockWidth, surface.format.blockHeight, surface.format.bpb, surface.gobBlockHeight, surface.gobBlockDepth, blockLinear.data(), actual.data(), robOffset, bandRobCount);
+                robOffset += bandRobCount;
+            }
+            reference::CopyBlockLinear<true>(reference, blockLinear.data(), expected.data());
+            Check("CopyBlockLinearRobsToLinear", surface, actual, expected);
+        }
+
+        void CheckMipChain() {
+            auto surface{RandomSurface()};
+            size_t levelCount{Random(1, std::bit_width(std::max({surface.dimensions.width, surface.dimensions.height, surface.dimensions.depth})))};
+            auto levels{GetBlockLinearMipLayout(surface.dimensions,
+                                                surface.format.blockHeight, surface.format.blockWidth, surface.format.bpb,
+                                                0, 0, 0,
+                                                surface.gobBlockHeight, surface.gobBlockDepth,
+                                                levelCount)};
+
+            size_t blockLinearSize{}, linearSize{};
+            for (const auto &level : levels) {
+                blockLinearSize += level.blockLinearSize;
+                linearSize += level.linearSize;
+            }
+
+            checkCount++;
+            size_t layerSize{GetBlockLinearLayerSize(surface.dimensions, surface.format.blockHeight, surface.format.blockWidth, surface.format.bpb, surface.gobBlockHeight, surface.gobBlockDepth, levelCount, false)};
+            if (layerSize != blockLinearSize && failureCount++ < 16)
+                fmt::print(stderr, "GetBlockLinearMipLayout: Level sizes sum to 0x{:X} rather than the layer size of 0x{:X}\n", blockLinearSize, layerSize);
+
+            // Every level is deswizzled from its offset in the mip chain using the block dimensions determined for it
+            auto blockLinear{RandomBuffer(blockLinearSize + surface.GetBlockLinearSize())};
+            std::vector<u8> actual(linearSize + GuardSize, GuardValue), expected(actual);
+            size_t blockLinearOffset{}, linearOffset{};
+            for (const auto &level : levels) {
+                reference::BlockLinearSurface reference{level.dimensions, surface.format.blockWidth, surface.format.blockHeight, surface.format.bpb, level.blockHeight, level.blockDepth};
+                CopyBlockLinearToLinear(level.dimensions, surface.format.blockWidth, surface.format.blockHeight, surface.format.bpb, level.blockHeight, level.blockDepth, blockLinear.data() + blockLinearOffset, actual.data() + linearOffset);
+                reference::CopyBlockLinear<true>(reference, blockLinear.data() + blockLinearOffset, expected.data() + linearOffset);
+
+                blockLinearOffset += level.blockLinearSize;
+                linearOffset += level.linearSize;
+            }
+            Check("GetBlockLinearMipLayout", surface, actual, expected);
+        }
+
+      public:
+        int Run() {
+            for (size_t iteration{}; iteration < IterationCount; iteration++) {
+                CheckBlockLinearToLinear();
+                CheckLinearToBlockLinear();
+                CheckPitch();
+                CheckSubrect();
+                CheckRobs();
+                CheckMipChain();
+            }
+
+            fmt::print("{} of {} checks failed\n", failureCount, checkCount);
+            return failureCount ? EXIT_FAILURE : EXIT_SUCCESS;
+        }
+    };
+}
+
+int main() {
+    return skyline::gpu::texture::LayoutTest{}.Run();
+}
@@ -0,0 +1,37 @@
+// SPDX-License-Identifier: MPL-2.0
+// Copyright © 2022 Skyline Team and Contributors (https://github.com/skyline-emu/)
+
+#include <loader/loader.h>
+#include <kernel/types/KProcess.h>
+
+/**
+ * @brief Substitutes for the few definitions from the loader and kernel that the GPU references on its error paths, these can't be linked into headless host targets as their translation units depend on the entire HLE kernel
+ * @note Headless targets have no guest so there's no process to kill nor any guest executables to symbolicate stack traces with
+ */
+namespace skyline {
+    namespace loader {
+        std::string Loader::GetStackTrace(signal::StackFrame *frame) {
+            std::string trace;
+            if (!frame)
+                asm("MOV %0, FP" : "=r"(frame));
+            while (frame) {
+                trace += fmt::format("\n* 0x{:X}", reinterpret_cast<uintptr_t>(frame->lr));
+                frame = frame->next;
+            }
+            return trace;
+        }
+
+        std::string Loader::GetStackTrace(const std::vector<void *> &frames) {
+            std::string trace;
+            for (const auto &frame : frames)
+                trace += fmt::format("\n* 0x{:X}", reinterpret_cast<uintptr_t>(frame));
+            return trace;
+        }
+    }
+
+    namespace kernel::type {
+        void KProcess::Kill(bool join, bool all, bool disableCreation) {
+            throw exception("Cannot kill the guest process in a headless target as there's no guest");
+        }
+    }
+}
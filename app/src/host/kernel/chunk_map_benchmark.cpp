@@ -0,0 +1,237 @@
+// SPDX-License-Identifier: MPL-2.0
+// Copyright © 2022 Skyline Team and Contributors (https://github.com/skyline-emu/)
+
+#include <map>
+#include <random>
+#include <shared_mutex>
+#include <kernel/memory.h>
+#include <benchmark.h>
+
+/**
+ * @brief Measures the latency of mapping, unmapping and looking up chunks in the VMM with a 39-bit address space layout, comparing the flat chunk array against the std::map it replaced
+ * @note Reprotection of the host mapping isn't included as it's identical for both and dominated by the kernel
+ */
+namespace skyline::kernel {
+    /**
+     * @brief The chunk map prior to the flat chunk array, a std::map from the base address to the descriptor which is looked up while holding the VMM mutex in shared mode
+     */
+    struct TreeChunkMap {
+        std::map<u8 *, ChunkDescriptor> chunks;
+        std::shared_mutex mutex;
+
+        TreeChunkMap(span<u8> addressSpace) {
+            chunks = {
+                {addressSpace.data(), {.state = memory::states::Unmapped, .size = addressSpace.size()}},
+                {reinterpret_cast<u8 *>(UINT64_MAX), {.state = memory::states::Reserved}},
+            };
+        }
+
+        bool Map(const std::pair<u8 *, ChunkDescriptor> &newDesc) {
+            auto firstChunkBase{chunks.lower_bound(newDesc.first)};
+            if (newDesc.first <= firstChunkBase->first)
+                --firstChunkBase;
+
+            auto lastChunkBase{chunks.lower_bound(newDesc.first + newDesc.second.size)};
+            if ((newDesc.first + newDesc.second.size) < lastChunkBase->first)
+                --lastChunkBase;
+
+            ChunkDescriptor firstChunk{firstChunkBase->second};
+            ChunkDescriptor lastChunk{lastChunkBase->second};
+
+            bool needsReprotection{false};
+            bool isUnmapping{newDesc.second.state == memory::states::Unmapped};
+
+            if (firstChunkBase->first == lastChunkBase->first) {
+                if (firstChunk.IsCompatible(newDesc.second)) [[unlikely]]
+                    return false;
+
+                if ((firstChunk.state == memory::states::Unmapped) != isUnmapping)
+                    needsReprotection = true;
+
+                firstChunk.size = static_cast<size_t>(newDesc.first - firstChunkBase->first);
+                chunks[firstChunkBase->first] = firstChunk;
+
+                lastChunk.size = static_cast<size_t>((lastChunkBase->first + lastChunk.size) - (newDesc.first + newDesc.second.size));
+                chunks.insert({newDesc.first + newDesc.second.size, lastChunk});
+
+                chunks.insert(newDesc);
+            } else {
+                if ((firstChunkBase->first + firstChunk.size) != lastChunkBase->first) {
+                    auto tempChunkBase{std::next(firstChunkBase)};
+
+                    while (tempChunkBase->first != lastChunkBase->first) {
+                        auto tmp{tempChunkBase++};
+                        if ((tmp->second.state == memory::states::Unmapped) != isUnmapping)
+                            needsReprotection = true;
+                    }
+                    chunks.erase(std::next(firstChunkBase), lastChunkBase);
+                }
+
+                bool shouldInsert{true};
+
+                if (firstChunk.IsCompatible(newDesc.second)) {
+                    shouldInsert = false;
+
+                    firstChunk.size = static_cast<size_t>((newDesc.first + newDesc.second.size) - firstChunkBase->first);
+                    chunks[firstChunkBase->first] = firstChunk;
+                } else if ((firstChunkBase->first + firstChunk.size) != newDesc.first) {
+                    firstChunk.size = static_cast<size_t>(newDesc.first - firstChunkBase->first);
+
+                    chunks[firstChunkBase->first] = firstChunk;
+
+                    if ((firstChunk.state == memory::states::Unmapped) != isUnmapping)
+                        needsReprotection = true;
+                }
+
+                if (lastChunk.IsCompatible(newDesc.second)) {
+                    u8 *oldBase{lastChunkBase->first};
+                    chunks.erase(lastChunkBase);
+
+                    if (shouldInsert) {
+                        shouldInsert = false;
+
+                        lastChunk.size = static_cast<size_t>((lastChunk.size + oldBase) - (newDesc.first));
+
+                        chunks[newDesc.first] = lastChunk;
+                    } else {
+                        firstChunk.size = static_cast<size_t>((lastChunk.size + oldBase) - firstChunkBase->first);
+                        chunks[firstChunkBase->first] = firstChunk;
+                    }
+                } else if ((newDesc.first + newDesc.second.size) != lastChunkBase->first) {
+                    lastChunk.size = static_cast<size_t>((lastChunk.size + lastChunkBase->first) - (newDesc.first + newDesc.second.size));
+
+                    chunks.erase(lastChunkBase);
+                    chunks[newDesc.first + newDesc.second.size] = lastChunk;
+
+                    if ((lastChunk.state == memory::states::Unmapped) != isUnmapping)
+                        needsReprotection = true;
+                }
+
+                if (shouldInsert)
+                    chunks.insert(newDesc);
+            }
+
+            return needsReprotection;
+        }
+
+        ChunkEntry Find(u8 *addr) {
+            std::shared_lock lock{mutex};
+            auto chunkBase{chunks.lower_bound(addr)};
+            if (addr < chunkBase->first)
+                --chunkBase;
+            return {chunkBase->first, chunkBase->second};
+        }
+    };
+
+    /**
+     * @brief The regions of a 39-bit address space as laid out by MemoryManager::InitializeRegions
+     */
+    struct AddressSpaceLayout {
+        span<u8> addressSpace{static_cast<u8 *>(nullptr), 1ULL << 39};
+        span<u8> code{reinterpret_cast<u8 *>(0x800000000), 0x10000000};
+        span<u8> alias{code.end().base(), 0x1000000000};
+        span<u8> heap{alias.end().base(), 0x180000000};
+        span<u8> stack{heap.end().base(), 0x80000000};
+        span<u8> tlsIo{stack.end().base(), 0x1000000000};
+    };
+
+    constexpr size_t PageSize{0x1000};
+
+    /**
+     * @brief A sequence of mappings representative of a guest at runtime, these are generated upfront so both maps are given identical work
+     */
+    struct Workload {
+        std::vector<std::pair<u8 *, ChunkDescriptor>> setup; //!< The mappings of the code, heap and threads which exist prior to the churn
+        std::vector<std::pair<u8 *, ChunkDescriptor>> churn; //!< Pairs of mapping and unmapping a range as done for shared and transfer memory, thread stacks and TLS pages
+        std::vector<u8 *> queries; //!< Random addresses inside the mapped regions as looked up by the NCE and SVCs
+
+        Workload(const AddressSpaceLayout &layout, size_t threadCount, size_t churnCount) {
+            std::mt19937 rng{0x534B59};
+            auto random{[&](size_t min, size_t max) { return std::uniform_int_distribution<size_t>{min, max}(rng); }};
+
+            // The main executable and a few NROs with their text, rodata and data segments
+            u8 *codeAddress{layout.code.data()};
+            for (size_t module{}; module < 8; module++) {
+                setup.push_back({codeAddress, {.permission = {true, false, true}, .state = memory::states::Code, .size = random(0x10, 0x2000) * PageSize}});
+                codeAddress += setup.back().second.size;
+                setup.push_back({codeAddress, {.permission = {true, false, false}, .state = memory::states::Code, .size = random(0x10, 0x800) * PageSize}});
+                codeAddress += setup.back().second.size;
+                setup.push_back({codeAddress, {.permission = {true, true, false}, .state = memory::states::CodeMutable, .size = random(0x10, 0x800) * PageSize}});
+                codeAddress += setup.back().second.size;
+            }
+
+            setup.push_back({layout.heap.data(), {.permission = {true, true, false}, .state = memory::states::Heap, .size = 0x40000000}});
+
+            // Every thread has a stack and a TLS page, stacks are separated by guard pages
+            for (size_t thread{}; thread < threadCount; thread++) {
+                setup.push_back({layout.stack.data() + thread * 0x110000, {.isSrcMergeDisallowed = true, .permission = {true, true, false}, .state = memory::states::Stack, .size = 0x100000}});
+                setup.push_back({layout.tlsIo.data() + thread * 2 * PageSize, {.permission = {true, true, false}, .state = memory::states::ThreadLocal, .size = PageSize}});
+            }
+
+            for (size_t iteration{}; iteration < churnCount; iteration++) {
+                std::pair<u8 *, ChunkDescriptor> mapping;
+                switch (random(0, 3)) {
+                    case 0: // Shared memory mapped into the alias region
+                        mapping = {layout.alias.data() + random(0, 0x1000) * 0x200000, {.isSrcMergeDisallowed = true, .permission = {true, true, false}, .state = memory::states::SharedMemory, .size = random(1, 0x1000) * PageSize}};
+                        break;
+                    case 1: // Transfer memory borrowed from the heap
+                        mapping = {layout.heap.data() + random(0, 0x3FFF) * PageSize, {.isSrcMergeDisallowed = true, .permission = {true, true, false}, .state = memory::states::TransferMemory, .size = random(1, 0x100) * PageSize}};
+                        break;
+                    case 2: // A stack of a thread that's being created
+                        mapping = {layout.stack.data() + (threadCount + random(0, 0xFF)) * 0x110000, {.isSrcMergeDisallowed = true, .permission = {true, true, false}, .state = memory::states::Stack, .size = 0x100000}};
+                        break;
+                    default: // A TLS page of a thread that's being created
+                        mapping = {layout.tlsIo.data() + (threadCount + random(0, 0xFF)) * 2 * PageSize, {.permission = {true, true, false}, .state = memory::states::ThreadLocal, .size = PageSize}};
+                        break;
+                }
+                churn.push_back(mapping);
+
+                // Memory that was borrowed from the heap is returned to it rather than unmapped
+                bool isTransfer{mapping.second.state == memory::states::TransferMemory};
+                churn.push_back({mapping.first, {.permission = isTransfer ? memory::Permission{true, true, false} : memory::Permission{}, .state = isTransfer ? memory::states::Heap : memory::states::Unmapped, .size = mapping.second.size}});
+            }
+
+            queries.resize(1 << 16);
+            for (auto &query : queries) {
+                auto &mapping{setup[random(0, setup.size() - 1)]};
+                query = mapping.first + random(0, mapping.second.size - 1);
+            }
+        }
+    };
+
+    template<typename MapType>
+    void RunBenchmarks(std::string_view name, MapType &chunks, const Workload &workload, size_t threadCount) {
+        for (const auto &mapping : workload.setup)
+            chunks.Map(mapping);
+
+        size_t churnIndex{};
+        host::Report(fmt::format("{} threads Map+Unmap {}", threadCount, name), host::Measure(workload.churn.size() / 2 - 1, [&] {
+            chunks.Map(workload.churn[churnIndex++]);
+            chunks.Map(workload.churn[churnIndex++]);
+        }));
+
+        size_t queryIndex{}, checksum{};
+        host::Report(fmt::format("{} threads Query {}", threadCount, name), host::Measure(1'000'000, [&] {
+            checksum += chunks.Find(workload.queries[queryIndex++ % workload.queries.size()]).descriptor.size;
+        }));
+
+        if (!checksum)
+            throw exception("No chunks were found");
+    }
+}
+
+int main() {
+    using namespace skyline::kernel;
+
+    AddressSpaceLayout layout;
+    for (size_t threadCount : {16, 256}) {
+        Workload workload{layout, threadCount, 200'000};
+
+        TreeChunkMap treeChunks{layout.addressSpace};
+        RunBenchmarks("TreeMap", treeChunks, workload, threadCount);
+
+        ChunkMap chunks;
+        chunks.Reset(layout.addressSpace);
+        RunBenchmarks("ChunkMap", chunks, workload, threadCount);
+    }
+}
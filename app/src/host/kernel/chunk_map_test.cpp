@@ -0,0 +1,204 @@
+// SPDX-License-Identifier: MPL-2.0
+// Copyright © 2022 Skyline Team and Contributors (https://github.com/skyline-emu/)
+
+#include <random>
+#include <thread>
+#include <kernel/memory.h>
+
+/**
+ * @brief Checks the VMM chunk map against a per-page model of the address space and stresses lock-free lookups against a concurrent writer
+ * @note Chunks are mapped at random inside a window of a 39-bit address space, the window is large enough for the chunk array to outgrow its initial capacity so both the in-place and reallocating paths of the writer are covered
+ */
+namespace skyline::kernel {
+    constexpr size_t PageSize{0x1000};
+    constexpr size_t WindowPageCount{0x10000}; //!< The amount of pages in the window that chunks are mapped into
+    u8 *const WindowBase{reinterpret_cast<u8 *>(0x8000000)};
+    constexpr size_t AddressSpaceSize{1ULL << 39};
+    constexpr size_t MapCount{20'000}; //!< The amount of random mappings checked against the model
+    constexpr size_t ConcurrentMapCount{200'000}; //!< The amount of random mappings done by the writer while readers are looking up chunks
+    constexpr size_t ReaderCount{3};
+
+    class ChunkMapTest {
+      private:
+        std::mt19937 rng{0x534B59}; //!< A fixed seed is used so that failures are reproducible
+        size_t checkCount{}, failureCount{};
+
+        size_t Random(size_t min, size_t max) {
+            return std::uniform_int_distribution<size_t>{min, max}(rng);
+        }
+
+        /**
+         * @return A random chunk inside the window with the same attributes as those mapped by the MemoryManager
+         * @param excludedPages A range of pages in the window that the chunk must not overlap
+         */
+        std::pair<u8 *, ChunkDescriptor> RandomChunk(std::pair<size_t, size_t> excludedPages = {}) {
+            constexpr std::array<memory::MemoryState, 6> States{memory::states::Heap, memory::states::Stack, memory::states::CodeMutable, memory::states::SharedMemory, memory::states::Reserved, memory::states::Unmapped};
+
+            size_t pageCount{Random(0, 31) ? Random(1, 16) : Random(1, 0x1000)}; // Most mappings are small with the occasional mapping spanning a large amount of chunks
+            size_t page;
+            do {
+                page = Random(0, WindowPageCount - pageCount);
+            } while (page < excludedPages.second && page + pageCount > excludedPages.first);
+
+            auto state{States[Random(0, States.size() - 1)]};
+            ChunkDescriptor descriptor{
+                .isSrcMergeDisallowed = state == memory::states::Stack || state == memory::states::SharedMemory,
+                .permission = state == memory::states::Unmapped ? memory::Permission{} : memory::Permission{true, Random(0, 1) == 1, false},
+                .state = state,
+                .size = pageCount * PageSize,
+            };
+            descriptor.attributes.isBorrowed = state != memory::states::Unmapped && Random(0, 7) == 0;
+            return {WindowBase + page * PageSize, descriptor};
+        }
+
+        static bool IsEquivalent(const ChunkDescriptor &lhs, const ChunkDescriptor &rhs) {
+            return lhs.permission.raw == rhs.permission.raw && lhs.state.value == rhs.state.value && lhs.attributes.value == rhs.attributes.value;
+        }
+
+        void Fail(std::string_view message) {
+            if (failureCount++ < 16)
+                fmt::print(stderr, "{}\n", message);
+        }
+
+        /**
+         * @brief Checks that the chunks are sorted, contiguous, cover the entire address space and are followed by the placeholder chunk
+         */
+        void CheckStructure(const ChunkMap &chunks) {
+            checkCount++;
+            auto entries{chunks.GetChunks()};
+            if (entries.size() < 2 || entries.front().base != nullptr || entries.back().base != reinterpret_cast<u8 *>(UINT64_MAX))
+                return Fail(fmt::format("The chunks don't start at the base of the address space or aren't followed by the placeholder ({} chunks)", entries.size()));
+
+            for (size_t index{1}; index < entries.size() - 1; index++) {
+                const auto &previous{entries[index - 1]}, &chunk{entries[index]};
+                if (previous.End() != chunk.base || !chunk.descriptor.size)
+                    return Fail(fmt::format("Chunk {} at {} (0x{:X} bytes) doesn't follow the previous chunk ending at {}", index, fmt::ptr(chunk.base), chunk.descriptor.size, fmt::ptr(previous.End())));
+            }
+
+            if (entries[entries.size() - 2].End() != reinterpret_cast<u8 *>(AddressSpaceSize))
+                Fail(fmt::format("The chunks end at {} rather than the end of the address space", fmt::ptr(entries[entries.size() - 2].End())));
+        }
+
+        /**
+         * @brief Checks that the chunk containing each page in the supplied range of the window matches the model of that page
+         */
+        void CheckPages(const ChunkMap &chunks, const std::vector<ChunkDescriptor> &model, size_t firstPage, size_t lastPage) {
+            checkCount++;
+            for (size_t page{firstPage}; page < lastPage; page++) {
+                u8 *address{WindowBase + page * PageSize};
+                auto chunk{chunks.Find(address)};
+                if (chunk.base > address || chunk.End() <= address)
+                    return Fail(fmt::format("Find({}) returned a chunk at {} (0x{:X} bytes) which doesn't contain it", fmt::ptr(address), fmt::ptr(chunk.base), chunk.descriptor.size));
+                if (!IsEquivalent(chunk.descriptor, model[page]))
+                    return Fail(fmt::format("The chunk containing {} has the state 0x{:X} and permission {} rather than the state 0x{:X} and permission {}", fmt::ptr(address), chunk.descriptor.state.value, chunk.descriptor.permission, model[page].state.value, model[page].permission));
+            }
+        }
+
+        void CheckMapping() {
+            ChunkMap chunks;
+            chunks.Reset(span<u8>{static_cast<u8 *>(nullptr), AddressSpaceSize});
+            std::vector<ChunkDescriptor> model(WindowPageCount, ChunkDescriptor{.state = memory::states::Unmapped});
+
+            size_t maxChunkCount{};
+            for (size_t iteration{}; iteration < MapCount; iteration++) {
+                auto chunk{RandomChunk()};
+                size_t firstPage{static_cast<size_t>(chunk.first - WindowBase) / PageSize}, lastPage{firstPage + chunk.second.size / PageSize};
+
+                bool wasUnmapped{std::all_of(model.begin() + firstPage, model.begin() + lastPage, [](const ChunkDescriptor &page) { return page.state == memory::states::Unmapped; })};
+                bool wasMapped{std::none_of(model.begin() + firstPage, model.begin() + lastPage, [](const ChunkDescriptor &page) { return page.state == memory::states::Unmapped; })};
+                bool isUnmapping{chunk.second.state == memory::states::Unmapped};
+
+                bool needsReprotection{chunks.Map(chunk)};
+                std::fill(model.begin() + firstPage, model.begin() + lastPage, chunk.second);
+
+                checkCount++;
+                if (needsReprotection != (isUnmapping ? !wasUnmapped : !wasMapped))
+                    Fail(fmt::format("Mapping {} (0x{:X} bytes) returned {} for reprotection", fmt::ptr(chunk.first), chunk.second.size, needsReprotection));
+
+                // The pages around the mapping are checked as well as they are affected by splitting and merging
+                CheckPages(chunks, model, firstPage ? firstPage - 1 : 0, std::min(lastPage + 1, WindowPageCount));
+                if (iteration % 64 == 0) {
+                    CheckStructure(chunks);
+                    CheckPages(chunks, model, 0, WindowPageCount);
+                }
+                maxChunkCount = std::max(maxChunkCount, chunks.GetChunks().size());
+            }
+
+            CheckStructure(chunks);
+            CheckPages(chunks, model, 0, WindowPageCount);
+            fmt::print("Mapped {} chunks with up to {} chunks in the map\n", MapCount, maxChunkCount);
+        }
+
+        /**
+         * @brief Checks that lookups are never torn while the writer is modifying the chunk array in-place or reallocating it
+         * @note A range of pages that's never written to is mapped with a unique descriptor so readers can check the exact chunk they get, the rest of the window can only be checked for containing the address
+         */
+        void CheckConcurrentLookups() {
+            ChunkMap chunks;
+            chunks.Reset(span<u8>{static_cast<u8 *>(nullptr), AddressSpaceSize});
+
+            constexpr std::pair<size_t, size_t> AnchorPages{WindowPageCount / 2, WindowPageCount / 2 + 16};
+            std::pair<u8 *, ChunkDescriptor> anchor{WindowBase + AnchorPages.first * PageSize, ChunkDescriptor{
+                .isSrcMergeDisallowed = true,
+                .permission = {true, false, true},
+                .state = memory::states::Code,
+                .size = (AnchorPages.second - AnchorPages.first) * PageSize,
+            }};
+            chunks.Map(anchor);
+
+            std::atomic<bool> stop{};
+            std::atomic<size_t> lookupCount{}, tornCount{};
+            std::vector<std::thread> readers;
+            for (size_t reader{}; reader < ReaderCount; reader++) {
+                readers.emplace_back([&, seed = reader] {
+                    std::mt19937 readerRng{static_cast<u32>(seed)};
+                    size_t lookups{}, torn{};
+                    while (!stop.load(std::memory_order_relaxed)) {
+                        u8 *address{WindowBase + std::uniform_int_distribution<size_t>{0, WindowPageCount * PageSize - 1}(readerRng)};
+                        auto chunk{chunks.Find(address)};
+                        if (chunk.base > address || chunk.End() <= address)
+                            torn++;
+
+                        u8 *anchorAddress{anchor.first + std::uniform_int_distribution<size_t>{0, anchor.second.size - 1}(readerRng)};
+                        auto anchorChunk{chunks.Find(anchorAddress)};
+                        if (anchorChunk.base != anchor.first || anchorChunk.descriptor.size != anchor.second.size || !IsEquivalent(anchorChunk.descriptor, anchor.second))
+                            torn++;
+                        lookups += 2;
+                    }
+                    lookupCount += lookups;
+                    tornCount += torn;
+                });
+            }
+
+            for (size_t iteration{}; iteration < ConcurrentMapCount; iteration++) {
+                chunks.Map(RandomChunk(AnchorPages));
+                // The writer is periodically descheduled so readers can run on hosts with few cores
+                if (iteration % 1024 == 0)
+                    std::this_thread::yield();
+            }
+
+            stop = true;
+            for (auto &reader : readers)
+                reader.join();
+
+            checkCount++;
+            if (tornCount)
+                Fail(fmt::format("{} of {} concurrent lookups returned a torn chunk", tornCount.load(), lookupCount.load()));
+            CheckStructure(chunks);
+            fmt::print("Looked up {} chunks concurrently with {} mappings\n", lookupCount.load(), ConcurrentMapCount);
+        }
+
+      public:
+        int Run() {
+            CheckMapping();
+            CheckConcurrentLookups();
+
+            fmt::print("{} of {} checks failed\n", failureCount, checkCount);
+            return failureCount ? EXIT_FAILURE : EXIT_SUCCESS;
+        }
+    };
+}
+
+int main() {
+    return skyline::kernel::ChunkMapTest{}.Run();
+}
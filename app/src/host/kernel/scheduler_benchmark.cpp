@@ -0,0 +1,146 @@
+// SPDX-License-Identifier: MPL-2.0
+// Copyright © 2022 Skyline Team and Contributors (https://github.com/skyline-emu/)
+
+#include <algorithm>
+#include <list>
+#include <memory>
+#include <random>
+#include <common/spin_lock.h>
+#include <kernel/run_queue.h>
+#include <benchmark.h>
+
+/**
+ * @brief Measures the latency of scheduler queue operations with many runnable threads on a core, comparing the priority-bitmap run queue against the sorted list it replaced
+ * @note Every operation is performed while holding a SpinLock as the scheduler does, the signalling and waking of threads isn't included as it's identical for both queues
+ */
+namespace skyline::kernel {
+    /**
+     * @brief A stand-in for KThread with only the members that are accessed by the scheduler queues
+     */
+    struct BenchmarkThread {
+        std::atomic<i8> priority;
+        u64 averageTimeslice{};
+
+        BenchmarkThread *runQueuePrev{}, *runQueueNext{};
+        i8 runQueuePriority{-1};
+        u64 runQueueTimeslice{};
+    };
+
+    /**
+     * @brief The scheduler queue prior to the priority-bitmap run queue, a list sorted by priority which is searched linearly on every operation
+     */
+    struct SortedListQueue {
+        std::list<std::shared_ptr<BenchmarkThread>> queue;
+
+        static bool IsHigherPriority(const i8 priority, const std::shared_ptr<BenchmarkThread> &it) {
+            return priority < it->priority;
+        }
+
+        void Insert(const std::shared_ptr<BenchmarkThread> &thread) {
+            auto nextThread{std::upper_bound(queue.begin(), queue.end(), thread->priority.load(), IsHigherPriority)};
+            if (nextThread == queue.begin() && nextThread != queue.end()) {
+                queue.splice(std::upper_bound(queue.begin(), queue.end(), queue.front()->priority.load(), IsHigherPriority), queue, queue.begin());
+                queue.push_front(thread);
+            } else {
+                queue.insert(nextThread, thread);
+            }
+        }
+
+        void Rotate() {
+            queue.splice(std::upper_bound(queue.begin(), queue.end(), queue.front()->priority.load(), IsHigherPriority), queue, queue.begin());
+        }
+
+        void Remove(const std::shared_ptr<BenchmarkThread> &thread) {
+            queue.erase(std::find(queue.begin(), queue.end(), thread));
+        }
+    };
+
+    /**
+     * @brief Inserts a thread into a run queue in the same way as Scheduler::InsertThread
+     */
+    void Insert(RunQueue<BenchmarkThread> &queue, BenchmarkThread *thread) {
+        auto front{queue.front.load(std::memory_order_relaxed)};
+        if (!front || thread->priority < front->priority) {
+            if (front)
+                queue.PushBack(front);
+            queue.front.store(thread, std::memory_order_relaxed);
+        } else {
+            queue.PushBack(thread);
+        }
+    }
+
+    constexpr size_t IterationCount{1'000'000};
+
+    void RunBenchmarks(size_t threadCount, bool mixedPriorities) {
+        std::mt19937 rng{0x534B59};
+        std::vector<std::shared_ptr<BenchmarkThread>> threads(threadCount);
+        for (auto &thread : threads) {
+            thread = std::make_shared<BenchmarkThread>();
+            // Guest applications run most threads at a few priorities around the default of 44 with some higher priority threads for audio and GPU work
+            thread->priority = static_cast<i8>(mixedPriorities ? std::uniform_int_distribution<int>{28, 59}(rng) : 44);
+        }
+
+        std::vector<size_t> removals(IterationCount);
+        for (auto &index : removals)
+            index = std::uniform_int_distribution<size_t>{0, threadCount - 1}(rng);
+
+        auto name{[&](std::string_view operation, std::string_view queue) {
+            return fmt::format("{} threads ({} priority) {} {}", threadCount, mixedPriorities ? "mixed" : "same", operation, queue);
+        }};
+
+        SpinLock mutex;
+        {
+            SortedListQueue list;
+            for (const auto &thread : threads)
+                list.Insert(thread);
+
+            // A cooperative yield of the thread at the front of the queue, it's moved behind all threads with the same priority
+            host::Report(name("Rotate", "SortedList"), host::Measure(IterationCount, [&] {
+                std::scoped_lock lock{mutex};
+                list.Rotate();
+            }));
+
+            // A thread waiting on a synchronization object and then being woken up again, it's removed from and reinserted into the queue
+            size_t iteration{};
+            host::Report(name("Remove+Insert", "SortedList"), host::Measure(IterationCount, [&] {
+                auto &thread{threads[removals[iteration++ % IterationCount]]};
+                {
+                    std::scoped_lock lock{mutex};
+                    list.Remove(thread);
+                }
+                std::scoped_lock lock{mutex};
+                list.Insert(thread);
+            }));
+        }
+
+        {
+            RunQueue<BenchmarkThread> queue;
+            for (const auto &thread : threads)
+                Insert(queue, thread.get());
+
+            host::Report(name("Rotate", "RunQueue"), host::Measure(IterationCount, [&] {
+                std::scoped_lock lock{mutex};
+                queue.PushBack(queue.front.load(std::memory_order_relaxed));
+                queue.AdvanceFront();
+            }));
+
+            size_t iteration{};
+            host::Report(name("Remove+Insert", "RunQueue"), host::Measure(IterationCount, [&] {
+                auto thread{threads[removals[iteration++ % IterationCount]].get()};
+                {
+                    std::scoped_lock lock{mutex};
+                    queue.Erase(thread);
+                }
+                std::scoped_lock lock{mutex};
+                Insert(queue, thread);
+            }));
+        }
+    }
+}
+
+int main() {
+    for (size_t threadCount : {16, 128, 512}) {
+        skyline::kernel::RunBenchmarks(threadCount, false);
+        skyline::kernel::RunBenchmarks(threadCount, true);
+    }
+}
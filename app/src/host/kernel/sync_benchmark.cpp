@@ -0,0 +1,315 @@
+// SPDX-License-Identifier: MPL-2.0
+// Copyright © 2022 Skyline Team and Contributors (https://github.com/skyline-emu/)
+
+#include <algorithm>
+#include <numeric>
+#include <random>
+#include <semaphore>
+#include <kernel/types/KSyncObject.h>
+#include <benchmark.h>
+
+/**
+ * @brief Measures the latency of waiting on and signalling synchronization objects in the same way as svcWaitSynchronization, comparing the per-object waiter lists against the global lock and sorted waiter lists they replaced
+ * @note Threads block on a semaphore rather than being descheduled, the scheduler overhead of a wait is identical for both protocols and is measured separately by the scheduler benchmark
+ */
+namespace skyline::kernel {
+    /**
+     * @brief A stand-in for KThread with only the members that are accessed while waiting on synchronization objects
+     */
+    struct BenchmarkThread {
+        std::atomic<i8> priority{44};
+        std::mutex syncWaitMutex;
+        bool isCancellable{};
+        void *wakeObject{}; //!< The object which woke this thread, this is a type-erased pointer as both protocols share the thread
+        std::array<type::SyncWaiterNode<BenchmarkThread>, type::MaxSyncWaitObjects> syncWaiterNodes{};
+        std::binary_semaphore wakeup{0}; //!< Stands in for the thread being inserted into and removed from the scheduler queue
+    };
+
+    /**
+     * @brief A synchronization object with a per-object waiter list, this is signalled in the same way as KSyncObject
+     */
+    struct WaiterListObject : type::SyncWaiterList<BenchmarkThread> {
+        WaiterListObject() : SyncWaiterList{false} {}
+
+        void Signal() {
+            SyncWaiterList::Signal([this](BenchmarkThread *waiter) {
+                waiter->wakeObject = this;
+                waiter->wakeup.release();
+            });
+        }
+    };
+
+    /**
+     * @brief Waits on the supplied objects in the same way as svcWaitSynchronization
+     * @return The index of the object which was signalled
+     */
+    size_t Wait(BenchmarkThread &thread, span<WaiterListObject *> objects) {
+        for (size_t index{}; index < objects.size(); index++)
+            if (objects[index]->signalled.load())
+                return index;
+
+        auto removeWaiters{[&](size_t count) {
+            for (size_t index{}; index < count; index++)
+                objects[index]->RemoveWaiter(thread.syncWaiterNodes[index]);
+        }};
+
+        for (size_t index{}; index < objects.size(); index++) {
+            auto &node{thread.syncWaiterNodes[index]};
+            node.thread = &thread;
+            if (objects[index]->AddWaiter(node)) {
+                removeWaiters(index);
+                return index;
+            }
+        }
+
+        {
+            std::scoped_lock lock{thread.syncWaitMutex};
+            thread.isCancellable = true;
+            thread.wakeObject = nullptr;
+        }
+
+        for (auto object : objects) {
+            if (object->signalled.load()) {
+                std::scoped_lock lock{thread.syncWaitMutex};
+                if (thread.isCancellable) {
+                    thread.isCancellable = false;
+                    thread.wakeObject = object;
+                    thread.wakeup.release();
+                }
+                break;
+            }
+        }
+
+        thread.wakeup.acquire();
+
+        void *wakeObject;
+        {
+            std::scoped_lock lock{thread.syncWaitMutex};
+            thread.isCancellable = false;
+            wakeObject = thread.wakeObject;
+        }
+
+        removeWaiters(objects.size());
+        return static_cast<size_t>(std::distance(objects.begin(), std::find(objects.begin(), objects.end(), wakeObject)));
+    }
+
+    /**
+     * @brief A synchronization object as it was prior to the per-object waiter lists, all objects share a single global lock and have a list of waiters sorted by priority
+     */
+    struct GlobalLockObject {
+        inline static std::mutex syncObjectMutex;
+        std::list<BenchmarkThread *> syncObjectWaiters;
+        std::atomic<bool> signalled{};
+
+        static bool IsHigherPriority(const i8 priority, const BenchmarkThread *it) {
+            return priority < it->priority;
+        }
+
+        void Signal() {
+            std::scoped_lock lock{syncObjectMutex};
+            signalled = true;
+            for (auto &waiter : syncObjectWaiters) {
+                if (waiter->isCancellable) {
+                    waiter->isCancellable = false;
+                    waiter->wakeObject = this;
+                    waiter->wakeup.release();
+                }
+            }
+        }
+
+        bool ResetSignal() {
+            std::scoped_lock lock{syncObjectMutex};
+            if (signalled) [[likely]] {
+                signalled = false;
+                return true;
+            }
+            return false;
+        }
+    };
+
+    /**
+     * @brief Waits on the supplied objects in the same way as svcWaitSynchronization did prior to the per-object waiter lists
+     */
+    size_t Wait(BenchmarkThread &thread, span<GlobalLockObject *> objects) {
+        std::unique_lock lock{GlobalLockObject::syncObjectMutex};
+        for (size_t index{}; index < objects.size(); index++)
+            if (objects[index]->signalled)
+                return index;
+
+        auto priority{thread.priority.load()};
+        for (auto object : objects)
+            object->syncObjectWaiters.insert(std::upper_bound(object->syncObjectWaiters.begin(), object->syncObjectWaiters.end(), priority, GlobalLockObject::IsHigherPriority), &thread);
+
+        thread.isCancellable = true;
+        thread.wakeObject = nullptr;
+
+        lock.unlock();
+        thread.wakeup.acquire();
+        lock.lock();
+
+        thread.isCancellable = false;
+        size_t wakeIndex{};
+        for (size_t index{}; index < objects.size(); index++) {
+            auto object{objects[index]};
+            if (object == thread.wakeObject)
+                wakeIndex = index;
+            object->syncObjectWaiters.erase(std::find(object->syncObjectWaiters.begin(), object->syncObjectWaiters.end(), &thread));
+        }
+        return wakeIndex;
+    }
+
+    constexpr size_t PingPongIterations{100'000};
+
+    /**
+     * @brief Measures the round-trip latency of two threads signalling each other's event and waiting on their own, as is done by guest threads handing off work
+     * @param pairCount The amount of independent pairs of threads which are run concurrently, these only contend on the global lock of the old protocol
+     */
+    template<typename ObjectType>
+    void RunPingPong(std::string_view protocol, size_t pairCount) {
+        struct Pair {
+            BenchmarkThread ping, pong;
+            ObjectType pingEvent, pongEvent;
+        };
+        std::vector<std::unique_ptr<Pair>> pairs(pairCount);
+        for (auto &pair : pairs)
+            pair = std::make_unique<Pair>();
+
+        std::vector<std::thread> threads;
+        std::vector<host::Nanoseconds> durations(pairCount);
+        for (size_t index{}; index < pairCount; index++) {
+            auto &pair{*pairs[index]};
+            threads.emplace_back([&pair] {
+                ObjectType *event{&pair.pingEvent};
+                for (size_t iteration{}; iteration <= PingPongIterations; iteration++) {
+                    Wait(pair.pong, span<ObjectType *>{&event, 1});
+                    pair.pingEvent.ResetSignal();
+                    pair.pongEvent.Signal();
+                }
+            });
+            threads.emplace_back([&pair, &duration = durations[index]] {
+                ObjectType *event{&pair.pongEvent};
+                duration = host::Measure(PingPongIterations, [&] {
+                    pair.pingEvent.Signal();
+                    Wait(pair.ping, span<ObjectType *>{&event, 1});
+                    pair.pongEvent.ResetSignal();
+                });
+            });
+        }
+        for (auto &thread : threads)
+            thread.join();
+
+        host::Report(fmt::format("Event ping-pong ({} pairs) {}", pairCount, protocol), std::accumulate(durations.begin(), durations.end(), host::Nanoseconds{}) / pairCount);
+    }
+
+    constexpr size_t MultiWaitIterations{50'000};
+
+    /**
+     * @brief Measures the latency of a thread waiting on the maximum amount of objects at once being woken up by another thread signalling a random one of them, as is done by the service manager and guest event loops
+     */
+    template<typename ObjectType>
+    void RunMultiWait(std::string_view protocol) {
+        std::array<ObjectType, type::MaxSyncWaitObjects> objects;
+        std::array<ObjectType *, type::MaxSyncWaitObjects> objectPointers;
+        for (size_t index{}; index < objects.size(); index++)
+            objectPointers[index] = &objects[index];
+
+        std::mt19937 rng{0x534B59};
+        std::vector<size_t> signalIndices(MultiWaitIterations + 1);
+        for (auto &index : signalIndices)
+            index = std::uniform_int_distribution<size_t>{0, objects.size() - 1}(rng);
+
+        BenchmarkThread waiter, signaller;
+        ObjectType acknowledgement;
+        std::thread signallerThread{[&] {
+            ObjectType *event{&acknowledgement};
+            for (size_t iteration{}; iteration <= MultiWaitIterations; iteration++) {
+                objects[signalIndices[iteration]].Signal();
+                Wait(signaller, span<ObjectType *>{&event, 1});
+                acknowledgement.ResetSignal();
+            }
+        }};
+
+        size_t iteration{};
+        host::Report(fmt::format("Wait on {} objects {}", objects.size(), protocol), host::Measure(MultiWaitIterations, [&] {
+            auto index{Wait(waiter, span<ObjectType *>{objectPointers})};
+            if (index != signalIndices[iteration++])
+                throw exception("Woken up by object {} rather than the signalled object {}", index, signalIndices[iteration - 1]);
+            objects[index].ResetSignal();
+            acknowledgement.Signal();
+        }));
+        signallerThread.join();
+    }
+
+    constexpr size_t RegistrationIterations{200'000};
+
+    /**
+     * @brief Measures the cost of registering and unregistering a thread as a waiter on the maximum amount of objects without blocking, this isolates the bookkeeping of a wait from the latency of waking a thread
+     * @param backgroundWaiterCount The amount of other threads which are already waiting on every object
+     */
+    void RunRegistration(size_t backgroundWaiterCount) {
+        std::vector<std::unique_ptr<BenchmarkThread>> backgroundThreads(backgroundWaiterCount);
+        std::mt19937 rng{0x534B59};
+        for (auto &thread : backgroundThreads) {
+            thread = std::make_unique<BenchmarkThread>();
+            thread->priority = static_cast<i8>(std::uniform_int_distribution<int>{28, 59}(rng));
+        }
+        BenchmarkThread thread;
+
+        {
+            std::array<GlobalLockObject, type::MaxSyncWaitObjects> objects;
+            for (auto &object : objects)
+                for (const auto &backgroundThread : backgroundThreads)
+                    object.syncObjectWaiters.insert(std::upper_bound(object.syncObjectWaiters.begin(), object.syncObjectWaiters.end(), backgroundThread->priority.load(), GlobalLockObject::IsHigherPriority), backgroundThread.get());
+
+            host::Report(fmt::format("Register on {} objects ({} waiters) GlobalLock", objects.size(), backgroundWaiterCount), host::Measure(RegistrationIterations, [&] {
+                std::unique_lock lock{GlobalLockObject::syncObjectMutex};
+                for (auto &object : objects)
+                    object.syncObjectWaiters.insert(std::upper_bound(object.syncObjectWaiters.begin(), object.syncObjectWaiters.end(), thread.priority.load(), GlobalLockObject::IsHigherPriority), &thread);
+                lock.unlock();
+
+                lock.lock();
+                for (auto &object : objects)
+                    object.syncObjectWaiters.erase(std::find(object.syncObjectWaiters.begin(), object.syncObjectWaiters.end(), &thread));
+            }));
+        }
+
+        {
+            std::array<WaiterListObject, type::MaxSyncWaitObjects> objects;
+            for (size_t index{}; index < objects.size(); index++) {
+                for (const auto &backgroundThread : backgroundThreads) {
+                    auto &node{backgroundThread->syncWaiterNodes[index]};
+                    node.thread = backgroundThread.get();
+                    objects[index].AddWaiter(node);
+                }
+            }
+
+            host::Report(fmt::format("Register on {} objects ({} waiters) WaiterList", objects.size(), backgroundWaiterCount), host::Measure(RegistrationIterations, [&] {
+                for (size_t index{}; index < objects.size(); index++) {
+                    auto &node{thread.syncWaiterNodes[index]};
+                    node.thread = &thread;
+                    objects[index].AddWaiter(node);
+                }
+
+                for (size_t index{}; index < objects.size(); index++)
+                    objects[index].RemoveWaiter(thread.syncWaiterNodes[index]);
+            }));
+        }
+    }
+
+    void RunBenchmarks() {
+        for (size_t pairCount : {1, 4}) {
+            RunPingPong<GlobalLockObject>("GlobalLock", pairCount);
+            RunPingPong<WaiterListObject>("WaiterList", pairCount);
+        }
+
+        RunMultiWait<GlobalLockObject>("GlobalLock");
+        RunMultiWait<WaiterListObject>("WaiterList");
+
+        for (size_t backgroundWaiterCount : {0, 8})
+            RunRegistration(backgroundWaiterCount);
+    }
+}
+
+int main() {
+    skyline::kernel::RunBenchmarks();
+}
@@ -0,0 +1,129 @@
+// SPDX-License-Identifier: MPL-2.0
+// Copyright © 2022 Skyline Team and Contributors (https://github.com/skyline-emu/)
+
+#include <algorithm>
+#include <csignal>
+#include <fstream>
+#include <random>
+#include <thread>
+#include <sys/mman.h>
+#include <nce/userfaultfd.h>
+#include <benchmark.h>
+
+/**
+ * @brief Measures the throughput of write traps on guest memory with the userfaultfd write-protection backend of NCE against the mprotect backend
+ * @note Every iteration re-traps a random page and writes to it, as is done for a GPU resource that's written by the guest after being synchronized every frame, the trap callbacks themselves aren't included as they're identical for both backends
+ */
+namespace skyline::nce {
+    constexpr size_t PageSize{0x1000};
+    constexpr size_t RegionPageCount{0x4000}; //!< The size of the shared memory region that stands in for guest memory
+    constexpr size_t IterationCount{100'000};
+
+    /**
+     * @brief Resolves a write trap in the same way as the mprotect backend of NCE, by making the faulting page writable on the faulting thread
+     */
+    void MprotectSignalHandler(int, siginfo_t *info, void *) {
+        auto page{util::AlignDown(reinterpret_cast<u8 *>(info->si_addr), PageSize)};
+        mprotect(page, PageSize, PROT_READ | PROT_WRITE);
+    }
+
+    /**
+     * @return The amount of VMAs in the address space of the process, reprotecting individual pages with mprotect splits VMAs at their boundaries
+     */
+    size_t CountVmas() {
+        std::ifstream maps{"/proc/self/maps"};
+        return static_cast<size_t>(std::count(std::istreambuf_iterator<char>{maps}, std::istreambuf_iterator<char>{}, '\n'));
+    }
+
+    void ReportFaults(std::string_view name, host::Nanoseconds duration, size_t vmaCount) {
+        host::Report(name, duration);
+        fmt::print("{:<56} {:>12.0f} faults/s with {} VMAs\n", "", 1'000'000'000 / duration.count(), vmaCount);
+    }
+
+    void RunBenchmarks(span<u8> region, Userfaultfd *userfaultfd, size_t trappedPageCount) {
+        // Every other page is trapped so that the trapped pages can't be coalesced into a single VMA by the mprotect backend
+        std::vector<span<u8>> trappedPages(trappedPageCount);
+        for (size_t index{}; index < trappedPageCount; index++)
+            trappedPages[index] = region.subspan(index * 2 * PageSize, PageSize);
+
+        std::mt19937 rng{0x534B59};
+        std::vector<size_t> writes(IterationCount);
+        for (auto &index : writes)
+            index = std::uniform_int_distribution<size_t>{0, trappedPageCount - 1}(rng);
+
+        {
+            for (auto page : trappedPages)
+                mprotect(page.data(), page.size(), PROT_READ);
+            size_t vmaCount{CountVmas()};
+
+            size_t iteration{};
+            auto duration{host::Measure(IterationCount - 1, [&] {
+                auto page{trappedPages[writes[iteration++]]};
+                *reinterpret_cast<volatile u8 *>(page.data()) = static_cast<u8>(iteration);
+                mprotect(page.data(), page.size(), PROT_READ);
+            })};
+            ReportFaults(fmt::format("{} trapped pages Write+Retrap Mprotect", trappedPageCount), duration, vmaCount);
+
+            mprotect(region.data(), region.size(), PROT_READ | PROT_WRITE);
+        }
+
+        if (userfaultfd) {
+            // Pages are write-protected and made writable as NCE::ProtectPages does, the mprotect is a no-op as the protection of the pages doesn't change
+            auto protect{[&](span<u8> page) {
+                userfaultfd->WriteProtect(page, true);
+                mprotect(page.data(), page.size(), PROT_READ | PROT_WRITE);
+            }};
+
+            for (auto page : trappedPages)
+                protect(page);
+            size_t vmaCount{CountVmas()};
+
+            std::thread faultThread{[&] {
+                userfaultfd->Run([&](u8 *page) {
+                    userfaultfd->WriteProtect(span<u8>{page, PageSize}, false);
+                });
+            }};
+
+            size_t iteration{};
+            auto duration{host::Measure(IterationCount - 1, [&] {
+                auto page{trappedPages[writes[iteration++]]};
+                *reinterpret_cast<volatile u8 *>(page.data()) = static_cast<u8>(iteration);
+                protect(page);
+            })};
+            ReportFaults(fmt::format("{} trapped pages Write+Retrap Userfaultfd", trappedPageCount), duration, vmaCount);
+
+            userfaultfd->Exit();
+            faultThread.join();
+            userfaultfd->WriteProtect(region, false);
+        }
+    }
+}
+
+int main() {
+    using namespace skyline;
+    using namespace skyline::nce;
+
+    // Guest memory is shared memory, only shared memory write-protection is representative of the backend
+    auto mapping{mmap(nullptr, RegionPageCount * PageSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0)};
+    if (mapping == MAP_FAILED)
+        throw exception("Failed to map the guest memory region: {}", strerror(errno));
+    span<u8> region{reinterpret_cast<u8 *>(mapping), RegionPageCount * PageSize};
+    std::fill(region.begin(), region.end(), 0); // All pages are faulted in upfront so only write traps are measured
+
+    struct sigaction action{
+        .sa_flags = SA_SIGINFO,
+    };
+    action.sa_sigaction = MprotectSignalHandler;
+    sigaction(SIGSEGV, &action, nullptr);
+
+    Userfaultfd userfaultfd;
+    std::array<span<u8>, 1> regions{region};
+    bool hasUserfaultfd{userfaultfd.Initialize(regions)};
+    if (!hasUserfaultfd)
+        fmt::print("Userfaultfd write-protection is unavailable, only the mprotect backend is measured\n");
+
+    for (size_t trappedPageCount : {64, 1024, 8192})
+        RunBenchmarks(region, hasUserfaultfd ? &userfaultfd : nullptr, trappedPageCount);
+
+    munmap(mapping, region.size());
+}
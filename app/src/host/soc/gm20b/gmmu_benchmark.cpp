@@ -0,0 +1,368 @@
+// SPDX-License-Identifier: MPL-2.0
+// Copyright © 2022 Skyline Team and Contributors (https://github.com/skyline-emu/)
+
+#include <fstream>
+#include <random>
+#include <sys/mman.h>
+#include <soc/gm20b/gpfifo_trace.h>
+#include <benchmark.h>
+
+/**
+ * @brief Measures the latency of GMMU lookups with the per-thread TLB against the locked lookups it replaced by replaying the accesses from a GPFIFO trace
+ * @note A trace file captured with GPFIFO_TRACE can be supplied as the first argument, a synthetic trace is generated otherwise
+ * @note Only pushbuffer accesses are recorded in GPFIFO traces, constant buffer, shader and texture accesses aren't part of the replay
+ */
+namespace skyline::soc::gm20b {
+    /**
+     * @brief A sequence of GMMU mapping changes and pushbuffer accesses in the order they occurred
+     */
+    struct AccessTrace {
+        static constexpr u32 NoMappings{std::numeric_limits<u32>::max()};
+
+        struct Event {
+            u32 addressSpaceId;
+            u32 mappingsIndex{NoMappings}; //!< The index of the mappings that replace all mappings of the address space, this is NoMappings for accesses
+            u64 iova;
+            u64 size;
+        };
+
+        std::vector<std::vector<trace::Mapping>> mappings;
+        std::vector<Event> events;
+        u32 addressSpaceCount{};
+        size_t accessCount{}, frameCount{};
+
+        void AddMappings(u32 addressSpaceId, std::vector<trace::Mapping> &&addressSpaceMappings) {
+            events.push_back({addressSpaceId, static_cast<u32>(mappings.size())});
+            mappings.emplace_back(std::move(addressSpaceMappings));
+            addressSpaceCount = std::max(addressSpaceCount, addressSpaceId + 1);
+        }
+
+        void AddAccess(u32 addressSpaceId, u64 iova, u64 size) {
+            events.push_back({addressSpaceId, NoMappings, iova, size});
+            accessCount++;
+        }
+    };
+
+    /**
+     * @brief Reads the mapping changes and pushbuffer accesses from a GPFIFO trace file, memory contents are skipped as they don't affect lookups
+     */
+    AccessTrace LoadTrace(const std::string &path) {
+        std::ifstream stream{path, std::ios::binary};
+        trace::Header header{};
+        if (!stream.read(reinterpret_cast<char *>(&header), sizeof(header)) || header.magic != trace::Header::Magic || header.version != trace::Header::Version)
+            throw exception("'{}' isn't a GPFIFO trace file with a supported version", path);
+
+        AccessTrace accessTrace;
+        std::unordered_map<u32, u32> channelAddressSpaces;
+        trace::RecordHeader recordHeader;
+        std::vector<u8> record;
+        while (stream.read(reinterpret_cast<char *>(&recordHeader), sizeof(recordHeader))) {
+            record.resize(recordHeader.size);
+            if (!stream.read(reinterpret_cast<char *>(record.data()), static_cast<std::streamsize>(record.size())))
+                throw exception("GPFIFO trace record is truncated: {} (0x{:X} bytes)", static_cast<u32>(recordHeader.type), recordHeader.size);
+
+            switch (recordHeader.type) {
+                case trace::RecordType::Channel: {
+                    auto &channel{*reinterpret_cast<trace::ChannelRecord *>(record.data())};
+                    channelAddressSpaces[channel.channelId] = channel.addressSpaceId;
+                    break;
+                }
+
+                case trace::RecordType::Mappings: {
+                    auto &mappingsRecord{*reinterpret_cast<trace::MappingsRecord *>(record.data())};
+                    auto mappings{span(record).subspan(sizeof(trace::MappingsRecord)).cast<trace::Mapping>().first(mappingsRecord.count)};
+                    accessTrace.AddMappings(mappingsRecord.addressSpaceId, {mappings.begin(), mappings.end()});
+                    break;
+                }
+
+                case trace::RecordType::Submit: {
+                    auto &submit{*reinterpret_cast<trace::SubmitRecord *>(record.data())};
+                    u32 addressSpaceId{channelAddressSpaces.at(submit.channelId)};
+                    for (const auto &gpEntry : span(record).subspan(sizeof(trace::SubmitRecord)).cast<GpEntry>().first(submit.count))
+                        if (gpEntry.size) // Control entries don't reference a pushbuffer
+                            accessTrace.AddAccess(addressSpaceId, gpEntry.Address(), gpEntry.size * sizeof(u32));
+                    break;
+                }
+
+                case trace::RecordType::Frame:
+                    accessTrace.frameCount++;
+                    break;
+
+                case trace::RecordType::Memory:
+                    break;
+            }
+        }
+
+        return accessTrace;
+    }
+
+    /**
+     * @brief Generates a trace with a single address space, the pushbuffers of every frame are written into a ring of allocations with a fraction of entries referencing prerecorded command lists in other allocations
+     */
+    AccessTrace GenerateTrace() {
+        constexpr size_t FrameCount{120}, EntriesPerFrame{2000};
+        constexpr size_t RingAllocationCount{16}, RingAllocationSize{0x40000}, CommandListCount{256};
+        constexpr u64 BaseIova{0x100000000}, AllocationAlignment{0x20000};
+
+        std::mt19937 rng{0x534B59};
+        auto random{[&](u64 min, u64 max) { return std::uniform_int_distribution<u64>{min, max}(rng); }};
+
+        // Allocations are laid out linearly with gaps between them as the nvdrv allocator does for buffers of different page sizes
+        std::vector<trace::Mapping> mappings;
+        u64 iova{BaseIova};
+        auto allocate{[&](u64 size) {
+            mappings.push_back({iova, size});
+            iova = util::AlignUp(iova + size, AllocationAlignment) + (random(0, 1) * AllocationAlignment);
+        }};
+
+        for (size_t index{}; index < RingAllocationCount; index++)
+            allocate(RingAllocationSize);
+        for (size_t index{}; index < CommandListCount; index++)
+            allocate(random(1, 0x10) * 0x1000);
+        for (size_t index{}; index < 512; index++)
+            allocate(random(1, 0x100) * AllocationAlignment); // Textures and buffers which aren't accessed by the GPFIFO
+
+        AccessTrace accessTrace;
+        accessTrace.AddMappings(0, std::vector<trace::Mapping>{mappings});
+
+        size_t ringAllocation{};
+        u64 ringOffset{};
+        for (size_t frame{}; frame < FrameCount; frame++) {
+            // A few buffers are reallocated every couple of frames, this changes the mappings and invalidates the TLB
+            if (frame % 4 == 3) {
+                for (size_t index{}; index < 4; index++) {
+                    auto &mapping{mappings[RingAllocationCount + CommandListCount + random(0, 511)]};
+                    mapping.iova = iova;
+                    iova = util::AlignUp(iova + mapping.size, AllocationAlignment);
+                }
+                accessTrace.AddMappings(0, std::vector<trace::Mapping>{mappings});
+            }
+
+            for (size_t entry{}; entry < EntriesPerFrame; entry++) {
+                if (random(0, 7) == 0) {
+                    const auto &commandList{mappings[RingAllocationCount + random(0, CommandListCount - 1)]};
+                    accessTrace.AddAccess(0, commandList.iova, commandList.size);
+                    continue;
+                }
+
+                u64 size{random(0x10, 0x200) * sizeof(u32)};
+                if (ringOffset + size > RingAllocationSize) {
+                    ringAllocation = (ringAllocation + 1) % RingAllocationCount;
+                    ringOffset = 0;
+                }
+                accessTrace.AddAccess(0, mappings[ringAllocation].iova + ringOffset, size);
+                ringOffset += size;
+            }
+            accessTrace.frameCount++;
+        }
+
+        return accessTrace;
+    }
+
+    /**
+     * @brief A GMMU which additionally exposes the lookups as they were prior to the TLB and the aggregated TLB statistics
+     */
+    class ReplayGmmu : public GMMU {
+      public:
+        std::pair<span<u8>, u64> LockedLookupBlock(u64 virt) {
+            std::shared_lock lock{blockMutex};
+            return LookupBlockEntry(blockSegmentTable[virt], virt, {});
+        }
+
+        TranslatedAddressRange LockedTranslateRange(u64 virt, u64 size) {
+            std::shared_lock lock{blockMutex};
+
+            auto [blockSpan, rangeOffset]{LookupBlockEntry(blockSegmentTable[virt], virt, {})};
+            if (blockSpan.size() - rangeOffset >= size) {
+                TranslatedAddressRange ranges;
+                ranges.push_back(blockSpan.subspan(blockSpan.valid() ? rangeOffset : 0, size));
+                return ranges;
+            }
+
+            return TranslateRangeImpl(virt, size);
+        }
+
+        void LockedRead(u8 *destination, u64 virt, u64 size) {
+            std::shared_lock lock(blockMutex);
+
+            auto successor{std::upper_bound(blocks.begin(), blocks.end(), virt, [](auto virt, const auto &block) {
+                return virt < block.virt;
+            })};
+            auto predecessor{std::prev(successor)};
+
+            u8 *blockPhys{predecessor->phys + (virt - predecessor->virt)};
+            u64 blockReadSize{std::min(successor->virt - virt, size)};
+            while (size) {
+                if (predecessor->phys == nullptr)
+                    throw exception("Page fault at 0x{:X}", predecessor->virt);
+                else if (predecessor->extraInfo.sparseMapped)
+                    std::memset(destination, 0, blockReadSize);
+                else
+                    std::memcpy(destination, blockPhys, blockReadSize);
+
+                destination += blockReadSize;
+                size -= blockReadSize;
+
+                if (size) {
+                    predecessor = successor++;
+                    blockPhys = predecessor->phys;
+                    blockReadSize = std::min(successor->virt - predecessor->virt, size);
+                }
+            }
+        }
+
+        /**
+         * @return The total amount of TLB hits and misses on all threads, including any that haven't been aggregated yet on the calling thread
+         */
+        static std::pair<u64, u64> GetTlbStatistics() {
+            AggregateTlbStatistics(GetTlb());
+            return {tlbHitCount.load(), tlbMissCount.load()};
+        }
+    };
+
+    /**
+     * @brief Replays the mapping changes of a trace on a set of GMMUs, every mapping is backed by a distinct read-only host address so adjacent mappings aren't merged into a single block
+     */
+    class TraceReplayer {
+      private:
+        const AccessTrace &accessTrace;
+        std::vector<std::unique_ptr<ReplayGmmu>> gmmus;
+        std::vector<u32> currentMappings; //!< The index of the mappings that are currently applied to each GMMU
+        span<u8> hostMemory;
+
+      public:
+        static constexpr size_t HostGapSize{0x1000}; //!< The offset between the host memory of consecutive mappings which ensures they aren't contiguous on the host
+
+        TraceReplayer(const AccessTrace &accessTrace) : accessTrace{accessTrace}, currentMappings(accessTrace.addressSpaceCount, AccessTrace::NoMappings) {
+            size_t maxMappingCount{};
+            for (const auto &mappings : accessTrace.mappings)
+                maxMappingCount = std::max(maxMappingCount, mappings.size());
+
+            // Host memory is never written to so it's backed by the zero page and no memory is committed for it
+            size_t hostMemorySize{(1ULL << GmmuAddressSpaceBits) + (maxMappingCount * HostGapSize)};
+            auto mapping{mmap(nullptr, hostMemorySize, PROT_READ, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0)};
+            if (mapping == MAP_FAILED)
+                throw exception("Failed to reserve host memory for the GMMU mappings: {}", strerror(errno));
+            hostMemory = span<u8>{static_cast<u8 *>(mapping), hostMemorySize};
+
+            for (u32 index{}; index < accessTrace.addressSpaceCount; index++)
+                gmmus.emplace_back(std::make_unique<ReplayGmmu>());
+        }
+
+        ~TraceReplayer() {
+            munmap(hostMemory.data(), hostMemory.size());
+        }
+
+        /**
+         * @brief Applies the mappings of every mapping event in the trace and calls the supplied function for every access
+         * @return The time spent in accesses, this excludes the time spent changing mappings as that's identical with and without the TLB
+         */
+        template<typename AccessFunction>
+        host::Nanoseconds Replay(AccessFunction &&access) {
+            host::Nanoseconds duration{};
+            auto event{accessTrace.events.begin()};
+            while (event != accessTrace.events.end()) {
+                if (event->mappingsIndex == AccessTrace::NoMappings) {
+                    auto start{std::chrono::steady_clock::now()};
+                    for (; event != accessTrace.events.end() && event->mappingsIndex == AccessTrace::NoMappings; event++)
+                        access(*gmmus[event->addressSpaceId], event->iova, event->size);
+                    duration += std::chrono::steady_clock::now() - start;
+                    continue;
+                }
+
+                auto &gmmu{*gmmus[event->addressSpaceId]};
+                auto &current{currentMappings[event->addressSpaceId]};
+                if (current != AccessTrace::NoMappings)
+                    for (const auto &mapping : accessTrace.mappings[current])
+                        gmmu.Unmap(mapping.iova, mapping.size);
+
+                const auto &mappings{accessTrace.mappings[event->mappingsIndex]};
+                for (size_t index{}; index < mappings.size(); index++)
+                    gmmu.Map(mappings[index].iova, hostMemory.data() + mappings[index].iova + (index * HostGapSize), mappings[index].size);
+                current = event->mappingsIndex;
+                event++;
+            }
+            return duration;
+        }
+
+        /**
+         * @brief Replays the trace repeatedly after a single untimed warm-up replay
+         * @return The average duration of a single access
+         */
+        template<typename AccessFunction>
+        host::Nanoseconds Measure(size_t iterations, AccessFunction &&access) {
+            Replay(access);
+
+            host::Nanoseconds duration{};
+            for (size_t iteration{}; iteration < iterations; iteration++)
+                duration += Replay(access);
+            return duration / (iterations * accessTrace.accessCount);
+        }
+    };
+
+    void RunBenchmarks(const AccessTrace &accessTrace) {
+        fmt::print("Replaying {} pushbuffer accesses in {} frames with {} mapping changes\n", accessTrace.accessCount, accessTrace.frameCount, accessTrace.mappings.size());
+        if (!accessTrace.accessCount)
+            return;
+
+        TraceReplayer replayer{accessTrace};
+        constexpr size_t IterationCount{8};
+        std::vector<u32> pushBufferData;
+        u64 checksum{};
+
+        std::pair<u64, u64> lastStatistics{ReplayGmmu::GetTlbStatistics()};
+        auto report{[&](std::string_view name, host::Nanoseconds duration) {
+            host::Report(name, duration);
+
+            // The locked lookups don't use the TLB at all, so the statistics only change after runs that use it
+            auto statistics{ReplayGmmu::GetTlbStatistics()};
+            u64 hits{statistics.first - lastStatistics.first}, misses{statistics.second - lastStatistics.second};
+            if (hits + misses)
+                fmt::print("{:<56} {:>12.1f} % TLB hit rate\n", "", (static_cast<double>(hits) * 100) / static_cast<double>(hits + misses));
+            lastStatistics = statistics;
+        }};
+
+        // The pushbuffer is translated and copied if it spans multiple mappings, as is done by ChannelGpfifo::Process
+        report("Pushbuffer TranslateRange Locked", replayer.Measure(IterationCount, [&](ReplayGmmu &gmmu, u64 iova, u64 size) {
+            auto ranges{gmmu.LockedTranslateRange(iova, size)};
+            if (ranges.size() != 1) {
+                pushBufferData.resize(size / sizeof(u32));
+                gmmu.LockedRead(reinterpret_cast<u8 *>(pushBufferData.data()), iova, size);
+            }
+            checksum += ranges.size();
+        }));
+        report("Pushbuffer TranslateRange TLB", replayer.Measure(IterationCount, [&](ReplayGmmu &gmmu, u64 iova, u64 size) {
+            auto ranges{gmmu.TranslateRange(iova, size)};
+            if (ranges.size() != 1) {
+                pushBufferData.resize(size / sizeof(u32));
+                gmmu.Read<u32>(pushBufferData, iova);
+            }
+            checksum += ranges.size();
+        }));
+
+        report("LookupBlock Locked", replayer.Measure(IterationCount, [&](ReplayGmmu &gmmu, u64 iova, u64) {
+            checksum += gmmu.LockedLookupBlock(iova).second;
+        }));
+        report("LookupBlock TLB", replayer.Measure(IterationCount, [&](ReplayGmmu &gmmu, u64 iova, u64) {
+            checksum += gmmu.LookupBlock(iova).second;
+        }));
+
+        // The first method of every pushbuffer is read individually, as is done for small reads such as semaphores and constant buffer updates
+        report("Read<u32> Locked", replayer.Measure(IterationCount, [&](ReplayGmmu &gmmu, u64 iova, u64) {
+            u32 value;
+            gmmu.LockedRead(reinterpret_cast<u8 *>(&value), iova, sizeof(u32));
+            checksum += value;
+        }));
+        report("Read<u32> TLB", replayer.Measure(IterationCount, [&](ReplayGmmu &gmmu, u64 iova, u64) {
+            checksum += gmmu.Read<u32>(iova);
+        }));
+
+        if (!checksum)
+            throw exception("No accesses were replayed");
+    }
+}
+
+int main(int argc, char **argv) {
+    using namespace skyline::soc::gm20b;
+    RunBenchmarks(argc > 1 ? LoadTrace(argv[1]) : GenerateTrace());
+}
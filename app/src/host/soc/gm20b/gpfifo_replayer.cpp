@@ -0,0 +1,496 @@
+// SPDX-License-Identifier: MPL-2.0
+// Copyright © 2022 Skyline Team and Contributors (https://github.com/skyline-emu/)
+
+#include <fstream>
+#include <lz4.h>
+#include <common/settings.h>
+#include <nce/trap_manager.h>
+#include <loader/loader.h>
+#include <kernel/memory.h>
+#include <vfs/os_filesystem.h>
+#include <gpu.h>
+#include <soc.h>
+#include <soc/gm20b/channel.h>
+#include <soc/gm20b/gpfifo_trace.h>
+
+/**
+ * @brief Replays a GPFIFO trace through the GPU front-end and the Vulkan backend without a guest, this prints the front-end statistics of every frame in the trace as CSV for comparing them across runs
+ * @note The system Vulkan loader is used, a software implementation such as lavapipe can be selected through the loader's environment variables when there's no GPU
+ * @note Any GPU writes to guest memory that were captured in the trace are replayed as CPU writes, as they can't be distinguished from writes by the guest
+ */
+namespace skyline::soc::gm20b {
+    /**
+     * @brief The settings used for replay, these match the defaults of the application other than caching being disabled so every run starts cold
+     */
+    class ReplaySettings final : public Settings {
+      public:
+        ReplaySettings() {
+            Update();
+        }
+
+        void Update() override {
+            isDocked = true;
+            usernameValue = std::string{};
+            profilePictureValue = std::string{};
+            systemLanguage = language::SystemLanguage::AmericanEnglish;
+            systemRegion = region::RegionCode::Auto;
+            isInternetEnabled = false;
+            forceTripleBuffering = true;
+            disableFrameThrottling = false;
+            gpuDriver = std::string{};
+            gpuDriverLibraryName = std::string{};
+            executorSlotCountScale = 6;
+            executorFlushThreshold = 256;
+            useDirectMemoryImport = false;
+            forceMaxGpuClocks = false;
+            disableShaderCache = true;
+            freeGuestTextureMemory = false; // The contents of guest memory are required to replay snapshots which don't rewrite unchanged memory
+            enableDecodedTextureCache = false;
+            enableFastGpuReadbackHack = false;
+            enableFastReadbackWrites = false;
+            disableSubgroupShuffle = false;
+            isAudioOutputDisabled = true;
+            validationLayer = false;
+        }
+    };
+
+    /**
+     * @brief A loader without any executables, it's only used for formatting stack traces on the GPU's error paths
+     */
+    class TraceLoader final : public loader::Loader {
+      public:
+        void *LoadProcessData(const std::shared_ptr<kernel::type::KProcess> &process, const DeviceState &state) override {
+            throw exception("GPFIFO traces don't contain a process to load");
+        }
+    };
+
+    /**
+     * @brief A trap manager which doesn't protect any memory, instead the replayer signals all writes to guest memory explicitly prior to doing them
+     * @note As the GPU never writes to trapped guest memory directly and there's no guest, only the replayer's writes need to be trapped
+     */
+    class HostTrapManager final : public nce::TrapManager {
+      private:
+        struct TrapGroup {
+            std::vector<span<u8>> regions;
+            LockCallback lockCallback;
+            TrapCallback readCallback;
+            TrapCallback writeCallback;
+            bool trapped{}; //!< If the group would be protected from writes, groups are untrapped after their write callback has been called
+        };
+
+        std::mutex mutex; //!< Synchronizes all accesses to the trap groups
+        std::unordered_map<TrapGroup *, std::unique_ptr<TrapGroup>> trapGroups;
+
+        static TrapGroup &GetGroup(TrapHandle handle) {
+            return *static_cast<TrapGroup *>(handle.group);
+        }
+
+      protected:
+        bool HandleHostFault(u8 *address) override {
+            return false; // Memory is never protected so there can't be any faults from traps
+        }
+
+      public:
+        TrapHandle CreateTrap(span<span<u8>> regions, const LockCallback &lockCallback, const TrapCallback &readCallback, const TrapCallback &writeCallback) override {
+            std::scoped_lock lock{mutex};
+            auto group{std::make_unique<TrapGroup>(TrapGroup{{regions.begin(), regions.end()}, lockCallback, readCallback, writeCallback})};
+            TrapHandle handle{group.get()};
+            trapGroups.emplace(group.get(), std::move(group));
+            return handle;
+        }
+
+        void TrapRegions(TrapHandle handle, bool writeOnly) override {
+            std::scoped_lock lock{mutex};
+            GetGroup(handle).trapped = true;
+        }
+
+        void RemoveTrap(TrapHandle handle) override {
+            std::scoped_lock lock{mutex};
+            GetGroup(handle).trapped = false;
+        }
+
+        void DeleteTrap(TrapHandle handle) override {
+            std::scoped_lock lock{mutex};
+            trapGroups.erase(static_cast<TrapGroup *>(handle.group));
+        }
+
+        /**
+         * @brief Calls the write callbacks of all trapped groups overlapping the supplied region, this must be called prior to writing to guest memory
+         * @note If a callback would block, the resource is locked through its lock callback without holding the trap lock and all callbacks are retried
+         */
+        void SignalWrite(span<u8> region) {
+            LockCallback lockCallback{};
+            while (true) {
+                if (lockCallback) {
+                    lockCallback();
+                    lockCallback = {};
+                }
+
+                std::scoped_lock lock{mutex};
+                for (auto &[pointer, group] : trapGroups) {
+                    if (!group->trapped || std::none_of(group->regions.begin(), group->regions.end(), [&](span<u8> trapRegion) { return trapRegion.data() < region.end().base() && region.data() < trapRegion.end().base(); }))
+                        continue;
+
+                    if (!group->writeCallback()) {
+                        lockCallback = group->lockCallback;
+                        break;
+                    }
+                    group->trapped = false;
+                }
+
+                if (!lockCallback)
+                    return;
+            }
+        }
+    };
+
+    /**
+     * @brief A presenter without a display, the frame boundaries of the trace are replayed by advancing the frame ID
+     */
+    class HeadlessPresenter final : public gpu::Presenter {
+      private:
+        std::atomic<size_t> nextFrameId{1};
+
+      public:
+        u64 Present(const std::shared_ptr<gpu::TextureView> &texture, i64 timestamp, i64 swapInterval, service::hosbinder::AndroidRect crop, service::hosbinder::NativeWindowScalingMode scalingMode, service::hosbinder::NativeWindowTransform transform, service::hosbinder::AndroidFence fence, const std::function<void()> &presentCallback) override {
+            throw exception("Frames can't be presented without a display");
+        }
+
+        size_t GetNextFrameId() const override {
+            return nextFrameId.load(std::memory_order_acquire);
+        }
+
+        service::hosbinder::NativeWindowTransform GetTransformHint() override {
+            return service::hosbinder::NativeWindowTransform::Identity;
+        }
+
+        /**
+         * @brief Starts a new frame as if one was presented
+         */
+        void AdvanceFrame() {
+            nextFrameId.fetch_add(1, std::memory_order_release);
+        }
+    };
+
+    static constexpr std::array<std::string_view, 8> SubchannelNames{"3D", "Compute", "Inline2Mem", "2D", "Copy", "Software0", "Software1", "Software2"}; //!< The names of the engines on each subchannel, indexed by SubchannelId
+
+    /**
+     * @brief Applies the records of a GPFIFO trace in order, the memory of all address spaces is backed by the guest memory of a standalone VMM so GPU resources can be mirrored from it
+     * @note Trace playback is serialized with the GPFIFO threads, all channels are drained prior to any writes to guest memory so they can't race with the front-end reading it
+     */
+    class GpfifoReplayer {
+      private:
+        using FrontEndProfile = ChannelGpfifo::FrontEndProfile;
+
+        static constexpr u32 SyncpointId{host1x::SyncpointCount - 1}; //!< The syncpoint incremented by channels to signal they have been drained, this is reserved for the replayer
+        static constexpr u64 SyncPushBufferIova{(1ULL << GmmuAddressSpaceBits) - GmmuSmallPageSize}; //!< The IOVA of the drain pushbuffer in all address spaces, this is reserved for the replayer
+        static constexpr std::chrono::seconds Timeout{30}; //!< The maximum duration a channel may take to process its entries before the replay is considered deadlocked
+
+        /**
+         * @brief A pushbuffer which increments the replayer syncpoint through the GPFIFO engine on the Software0 subchannel
+         * @note The method header is an incrementing method (SecOp 1) with a count of 2 on subchannel 5 at the syncpoint payload register (0x1C), the syncpoint action register (0x1D) follows with an increment of the replayer syncpoint
+         */
+        alignas(GmmuSmallPageSize) static constexpr std::array<u32, 3> SyncPushBuffer{0x2002A01C, 0, (SyncpointId << 8) | 1};
+
+        const DeviceState &state;
+        HostTrapManager &traps;
+        HeadlessPresenter &presenter;
+        kernel::MemoryManager &memory;
+
+        struct AddressSpace {
+            std::shared_ptr<AddressSpaceContext> asCtx;
+            std::map<u64, span<u8>> mappings; //!< A map of the IOVAs of all mappings to the guest memory backing them
+        };
+        std::unordered_map<u32, AddressSpace> addressSpaces;
+        std::unordered_map<u32, std::unique_ptr<ChannelContext>> channels;
+
+        u8 *nextBacking; //!< The next unused address in the region that guest memory for mappings is allocated from
+        std::multimap<size_t, u8 *> freeBackings; //!< Backings of prior mappings that can be reused for mappings of the same size
+
+        u32 syncThreshold{}; //!< The value the replayer syncpoint will reach once all channels are drained
+        bool drainRequired{}; //!< If any entries were pushed since the channels were last drained
+
+        std::mutex profileMutex;
+        std::condition_variable profileCondition;
+        bool collectingProfiles{}; //!< If channels are reporting the statistics of a frame that was ended by the replayer, any reports outside of this are empty reports from new channels
+        size_t profileReportCount{};
+        FrontEndProfile frameProfile; //!< The statistics of all channels for the frame being reported
+        FrontEndProfile totalProfile;
+        u64 lastFrameId{};
+
+        std::vector<u8> memoryBuffer; //!< A reusable buffer for decompressed memory contents
+
+        AddressSpace &GetAddressSpace(u32 id) {
+            auto &addressSpace{addressSpaces[id]};
+            if (!addressSpace.asCtx) {
+                addressSpace.asCtx = std::make_shared<AddressSpaceContext>();
+                addressSpace.asCtx->gmmu.Map(SyncPushBufferIova, reinterpret_cast<u8 *>(const_cast<u32 *>(SyncPushBuffer.data())), GmmuSmallPageSize);
+            }
+            return addressSpace;
+        }
+
+        /**
+         * @brief Waits for all channels to process every entry that was pushed to them
+         */
+        void Drain() {
+            if (!drainRequired)
+                return;
+
+            for (auto &[id, channel] : channels) {
+                channel->gpfifo.Push(GpEntry{SyncPushBufferIova, static_cast<u32>(SyncPushBuffer.size())});
+                syncThreshold++;
+            }
+
+            if (!state.soc->host1x.syncpoints.at(SyncpointId).guest.Wait(syncThreshold, Timeout))
+                throw exception("Channels didn't process their entries within {}s, the front-end is likely deadlocked", Timeout.count());
+            drainRequired = false;
+        }
+
+        span<u8> AllocateBacking(size_t size) {
+            auto freeBacking{freeBackings.find(size)};
+            if (freeBacking != freeBackings.end()) {
+                span<u8> backing{freeBacking->second, size};
+                freeBackings.erase(freeBacking);
+                traps.SignalWrite(backing); // GPU resources created from the prior mapping may still be using the backing
+                return backing;
+            }
+
+            if (nextBacking + size > memory.alias.end().base())
+                throw exception("Ran out of guest memory for backing mappings: 0x{:X} bytes were requested with 0x{:X} bytes remaining", size, memory.alias.end().base() - nextBacking);
+
+            span<u8> backing{nextBacking, size};
+            memory.MapHeapMemory(backing);
+            nextBacking += size;
+            return backing;
+        }
+
+        /**
+         * @brief Replaces all mappings of an address space, mappings that are unchanged keep their backing
+         * @note New mappings copy any contents they share with prior mappings as the trace doesn't rewrite chunks with unchanged contents
+         */
+        void ApplyMappings(AddressSpace &addressSpace, span<trace::Mapping> mappings) {
+            Drain();
+
+            std::map<u64, span<u8>> newMappings;
+            std::vector<std::pair<u64, span<u8>>> addedMappings;
+            for (const auto &mapping : mappings) {
+                if (mapping.iova + mapping.size > SyncPushBufferIova || !util::IsAligned(mapping.size, GmmuSmallPageSize)) [[unlikely]]
+                    throw exception("Trace contains an unsupported mapping: 0x{:X} - 0x{:X}", mapping.iova, mapping.iova + mapping.size);
+
+                auto existing{addressSpace.mappings.find(mapping.iova)};
+                if (existing != addressSpace.mappings.end() && existing->second.size() == mapping.size) {
+                    newMappings.emplace(*existing);
+                    addressSpace.mappings.erase(existing);
+                    continue;
+                }
+
+                auto backing{AllocateBacking(mapping.size)};
+                auto overlapping{addressSpace.mappings.upper_bound(mapping.iova)};
+                if (overlapping != addressSpace.mappings.begin())
+                    overlapping--;
+                for (; overlapping != addressSpace.mappings.end() && overlapping->first < mapping.iova + mapping.size; overlapping++) {
+                    u64 start{std::max(overlapping->first, mapping.iova)}, end{std::min(overlapping->first + overlapping->second.size(), mapping.iova + mapping.size)};
+                    if (start < end)
+                        std::memcpy(backing.data() + (start - mapping.iova), overlapping->second.data() + (start - overlapping->first), end - start);
+                }
+
+                newMappings.emplace(mapping.iova, backing);
+                addedMappings.emplace_back(mapping.iova, backing);
+            }
+
+            for (const auto &[iova, backing] : addressSpace.mappings) {
+                addressSpace.asCtx->gmmu.Unmap(iova, backing.size());
+                freeBackings.emplace(backing.size(), backing.data());
+            }
+
+            for (const auto &[iova, backing] : addedMappings)
+                addressSpace.asCtx->gmmu.Map(iova, backing.data(), backing.size());
+
+            addressSpace.mappings = std::move(newMappings);
+        }
+
+        void WriteMemory(AddressSpace &addressSpace, const trace::MemoryRecord &memoryRecord, span<u8> compressed) {
+            memoryBuffer.resize(memoryRecord.size);
+            if (LZ4_decompress_safe(reinterpret_cast<const char *>(compressed.data()), reinterpret_cast<char *>(memoryBuffer.data()), static_cast<int>(memoryRecord.compressedSize), static_cast<int>(memoryBuffer.size())) != static_cast<int>(memoryRecord.size))
+                throw exception("Failed to decompress the memory at 0x{:X} (0x{:X} bytes)", memoryRecord.iova, memoryRecord.size);
+
+            Drain();
+            addressSpace.asCtx->gmmu.Write(memoryRecord.iova, memoryBuffer.data(), memoryRecord.size, [this](span<u8> region) {
+                traps.SignalWrite(region);
+            });
+        }
+
+        void CreateChannel(const trace::ChannelRecord &channelRecord) {
+            auto channel{std::make_unique<ChannelContext>(state, GetAddressSpace(channelRecord.addressSpaceId).asCtx, channelRecord.numEntries)};
+            channel->gpfifo.SetFrameProfileCallback([this](size_t frameId, const FrontEndProfile &profile) {
+                std::scoped_lock lock{profileMutex};
+                if (!collectingProfiles)
+                    return;
+
+                AccumulateProfile(frameProfile, profile);
+                profileReportCount++;
+                profileCondition.notify_all();
+            });
+            channels[channelRecord.channelId] = std::move(channel);
+        }
+
+        static void AccumulateProfile(FrontEndProfile &total, const FrontEndProfile &profile) {
+            for (size_t i{}; i < total.engines.size(); i++) {
+                total.engines[i].methodCount += profile.engines[i].methodCount;
+                total.engines[i].timeNs += profile.engines[i].timeNs;
+            }
+            total.gpEntryCount += profile.gpEntryCount;
+            total.submitCount += profile.submitCount;
+        }
+
+        static void PrintProfile(std::string_view label, const FrontEndProfile &profile) {
+            u64 timeNs{};
+            for (const auto &engine : profile.engines)
+                timeNs += engine.timeNs;
+
+            fmt::print("{},{},{},{}", label, profile.gpEntryCount, profile.submitCount, timeNs / constant::NsInMicrosecond);
+            for (const auto &engine : profile.engines)
+                fmt::print(",{},{}", engine.methodCount, engine.timeNs / constant::NsInMicrosecond);
+            fmt::print("\n");
+        }
+
+        /**
+         * @brief Ends the current frame and prints the statistics of all channels for it
+         * @note Every channel is pushed an empty entry after the frame ID is advanced, the front-end reports the statistics of the prior frame prior to processing it
+         * @note The entries used by the replayer for draining and ending frames are included in the statistics, they're deterministic for a trace so reports can still be compared across runs
+         */
+        void EndFrame(u64 frameId) {
+            Drain();
+
+            std::unique_lock lock{profileMutex};
+            collectingProfiles = true;
+            profileReportCount = 0;
+            frameProfile = {};
+            presenter.AdvanceFrame();
+            for (auto &[id, channel] : channels)
+                channel->gpfifo.Push(GpEntry{0, 0});
+
+            if (!profileCondition.wait_for(lock, Timeout, [this] { return profileReportCount == channels.size(); }))
+                throw exception("Only {} of {} channels reported statistics for frame {} within {}s", profileReportCount, channels.size(), frameId, Timeout.count());
+            collectingProfiles = false;
+
+            PrintProfile(std::to_string(frameId), frameProfile);
+            AccumulateProfile(totalProfile, frameProfile);
+            totalProfile.frameCount++;
+            lastFrameId = frameId;
+        }
+
+      public:
+        GpfifoReplayer(const DeviceState &state, HostTrapManager &traps, kernel::MemoryManager &memory)
+            : state{state},
+              traps{traps},
+              presenter{static_cast<HeadlessPresenter &>(*state.gpu->presentation)},
+              memory{memory},
+              nextBacking{memory.alias.data()} {}
+
+        void Replay(const std::string &path) {
+            std::ifstream stream{path, std::ios::binary};
+            trace::Header header{};
+            if (!stream.read(reinterpret_cast<char *>(&header), sizeof(header)) || header.magic != trace::Header::Magic || header.version != trace::Header::Version)
+                throw exception("'{}' isn't a GPFIFO trace file with a supported version", path);
+
+            fmt::print("frame,gp_entries,submits,time_us");
+            for (auto name : SubchannelNames)
+                fmt::print(",{0}_methods,{0}_us", name);
+            fmt::print("\n");
+
+            bool frameSubmitted{}; //!< If any entries were submitted since the last frame
+            trace::RecordHeader recordHeader;
+            std::vector<u8> record;
+            while (stream.read(reinterpret_cast<char *>(&recordHeader), sizeof(recordHeader))) {
+                record.resize(recordHeader.size);
+                if (!stream.read(reinterpret_cast<char *>(record.data()), static_cast<std::streamsize>(record.size())))
+                    throw exception("GPFIFO trace record is truncated: {} (0x{:X} bytes)", static_cast<u32>(recordHeader.type), recordHeader.size);
+
+                switch (recordHeader.type) {
+                    case trace::RecordType::Channel:
+                        CreateChannel(*reinterpret_cast<trace::ChannelRecord *>(record.data()));
+                        break;
+
+                    case trace::RecordType::Mappings: {
+                        auto &mappingsRecord{*reinterpret_cast<trace::MappingsRecord *>(record.data())};
+                        auto mappings{span(record).subspan(sizeof(trace::MappingsRecord)).cast<trace::Mapping>().first(mappingsRecord.count)};
+                        ApplyMappings(GetAddressSpace(mappingsRecord.addressSpaceId), mappings);
+                        break;
+                    }
+
+                    case trace::RecordType::Memory: {
+                        auto &memoryRecord{*reinterpret_cast<trace::MemoryRecord *>(record.data())};
+                        WriteMemory(GetAddressSpace(memoryRecord.addressSpaceId), memoryRecord, span(record).subspan(sizeof(trace::MemoryRecord), memoryRecord.compressedSize));
+                        break;
+                    }
+
+                    case trace::RecordType::Submit: {
+                        auto &submit{*reinterpret_cast<trace::SubmitRecord *>(record.data())};
+                        auto entries{span(record).subspan(sizeof(trace::SubmitRecord)).cast<GpEntry>().first(submit.count)};
+                        channels.at(submit.channelId)->gpfifo.Push(entries);
+                        drainRequired = true;
+                        frameSubmitted = true;
+                        break;
+                    }
+
+                    case trace::RecordType::Frame:
+                        EndFrame(reinterpret_cast<trace::FrameRecord *>(record.data())->frameId);
+                        frameSubmitted = false;
+                        break;
+
+                    default:
+                        throw exception("Unknown GPFIFO trace record type: {}", static_cast<u32>(recordHeader.type));
+                }
+            }
+
+            if (frameSubmitted)
+                EndFrame(lastFrameId + 1); // Entries submitted after the last frame are reported as an additional frame
+
+            PrintProfile("total", totalProfile);
+        }
+    };
+}
+
+int main(int argc, char **argv) {
+    using namespace skyline;
+
+    if (argc < 2) {
+        fmt::print(stderr, "Usage: {} <GPFIFO trace> [directory containing shaders/*.spv]\n", argv[0]);
+        return 1;
+    }
+
+    Logger::configLevel = Logger::LogLevel::Warn;
+
+    try {
+        char cacheTemplate[]{"/tmp/skyline-replay-XXXXXX"};
+        if (!mkdtemp(cacheTemplate))
+            throw exception("Failed to create a directory for GPU caches: {}", strerror(errno));
+        std::string cachePath{std::string{cacheTemplate} + '/'}; // A fresh directory is used for every run so pipeline caches from prior runs can't affect the statistics
+
+        // None of these are destroyed as the GPFIFO threads of channels are never joined, the process is exited directly once replay is done
+        auto traps{std::make_shared<soc::gm20b::HostTrapManager>()};
+        auto &state{*new DeviceState{std::make_shared<soc::gm20b::ReplaySettings>(), traps}};
+        state.loader = std::make_shared<soc::gm20b::TraceLoader>();
+
+        auto &guestMemory{*new kernel::MemoryManager{state}};
+        guestMemory.InitializeVmm(memory::AddressSpaceType::AddressSpace39Bit);
+        guestMemory.InitializeRegions(span<u8>{guestMemory.base.data(), constant::PageSize}); // There's no code but the region must be non-empty
+        state.guestMemory = &guestMemory;
+
+        state.gpu = std::make_shared<gpu::GPU>(state, std::make_shared<vfs::OsFileSystem>(argc > 2 ? argv[2] : SKYLINE_HOST_ASSET_DIR), [](const DeviceState &state, gpu::GPU &gpu) -> std::unique_ptr<gpu::Presenter> {
+            return std::make_unique<soc::gm20b::HeadlessPresenter>();
+        });
+        state.soc = std::make_shared<soc::SOC>(state);
+        state.gpu->Initialise(cachePath, "replay");
+
+        (new soc::gm20b::GpfifoReplayer{state, *traps, guestMemory})->Replay(argv[1]);
+    } catch (const std::exception &e) {
+        fmt::print(stderr, "Replay failed: {}\n", e.what());
+        std::fflush(stdout);
+        std::_Exit(1);
+    }
+
+    std::fflush(stdout);
+    std::_Exit(0);
+}
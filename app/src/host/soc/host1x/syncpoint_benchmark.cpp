@@ -0,0 +1,191 @@
+// SPDX-License-Identifier: MPL-2.0
+// Copyright © 2022 Skyline Team and Contributors (https://github.com/skyline-emu/)
+
+#include <list>
+#include <thread>
+#include <soc/host1x/syncpoint.h>
+#include <benchmark.h>
+
+/**
+ * @brief Measures the latency of incrementing host1x syncpoints and waking up threads waiting on them, comparing the waiter heap and futex waits against the sorted waiter list and condition variable they replaced
+ */
+namespace skyline::soc::host1x {
+    /**
+     * @brief A syncpoint as it was prior to the waiter heap, every increment locks the mutex and waits are done on a condition variable
+     */
+    class ListSyncpoint {
+      private:
+        std::atomic<u32> value{};
+
+        std::mutex mutex;
+        std::condition_variable incrementCondition;
+
+        struct Waiter {
+            u32 threshold;
+            std::function<void()> callback;
+
+            Waiter(u32 threshold, std::function<void()> callback) : threshold(threshold), callback(std::move(callback)) {}
+        };
+        std::list<Waiter> waiters;
+
+      public:
+        using WaiterHandle = decltype(waiters)::iterator;
+
+        u32 Load() {
+            return value.load(std::memory_order_acquire);
+        }
+
+        WaiterHandle RegisterWaiter(u32 threshold, const std::function<void()> &callback) {
+            if (value.load(std::memory_order_acquire) >= threshold) {
+                callback();
+                return {};
+            }
+
+            std::scoped_lock lock(mutex);
+            if (value.load(std::memory_order_acquire) >= threshold) {
+                callback();
+                return {};
+            }
+
+            auto it{waiters.begin()};
+            while (it != waiters.end() && threshold >= it->threshold)
+                it++;
+            return waiters.emplace(it, threshold, callback);
+        }
+
+        void DeregisterWaiter(WaiterHandle waiter) {
+            std::scoped_lock lock(mutex);
+            for (auto it{waiters.begin()}; it != waiters.end(); it++) {
+                if (it == waiter) {
+                    waiters.erase(it);
+                    return;
+                }
+            }
+        }
+
+        u32 Increment() {
+            auto readValue{value.fetch_add(1, std::memory_order_acq_rel) + 1};
+
+            std::scoped_lock lock(mutex);
+            bool signalCondition{};
+            auto it{waiters.begin()};
+            while (it != waiters.end() && readValue >= it->threshold) {
+                auto &waiter{*it};
+                if (waiter.callback)
+                    waiter.callback();
+                else
+                    signalCondition = true;
+                it++;
+            }
+
+            waiters.erase(waiters.begin(), it);
+
+            if (signalCondition)
+                incrementCondition.notify_all();
+
+            return readValue;
+        }
+
+        bool Wait(u32 threshold, std::chrono::steady_clock::duration timeout) {
+            if (value.load(std::memory_order_acquire) >= threshold)
+                return {};
+
+            std::unique_lock lock(mutex);
+            auto it{waiters.begin()};
+            while (it != waiters.end() && threshold >= it->threshold)
+                it++;
+            waiters.emplace(it, threshold, nullptr);
+
+            if (timeout == std::chrono::steady_clock::duration::max()) {
+                incrementCondition.wait(lock, [&] { return value.load(std::memory_order_relaxed) >= threshold; });
+                return true;
+            } else {
+                return incrementCondition.wait_for(lock, timeout, [&] { return value.load(std::memory_order_relaxed) >= threshold; });
+            }
+        }
+    };
+
+    constexpr size_t PendingWaiterCount{64}; //!< The amount of callback waiters on far away thresholds, as registered for the fences of in-flight GPU work
+
+    constexpr u32 PendingThreshold{std::numeric_limits<u32>::max() / 2}; //!< The threshold of the first pending waiter, this is never reached during a benchmark
+
+    /**
+     * @brief Registers callback waiters that aren't reached during a benchmark in order of their thresholds, as fences are registered in submission order
+     */
+    template<typename SyncpointType>
+    void RegisterPendingWaiters(SyncpointType &syncpoint) {
+        for (u32 index{}; index < PendingWaiterCount; index++)
+            syncpoint.RegisterWaiter(PendingThreshold + index, [] {});
+    }
+
+    /**
+     * @brief Measures the round trip of two threads incrementing a syncpoint and waiting on the increment of the other one, this is two increment-to-wake latencies
+     */
+    template<typename SyncpointType>
+    host::Nanoseconds MeasurePingPong(bool pendingWaiters) {
+        constexpr size_t IterationCount{50'000};
+        SyncpointType ping, pong;
+        if (pendingWaiters) {
+            RegisterPendingWaiters(ping);
+            RegisterPendingWaiters(pong);
+        }
+
+        std::thread ponger{[&] {
+            for (u32 iteration{1}; iteration <= IterationCount + 1; iteration++) {
+                ping.Wait(iteration, std::chrono::steady_clock::duration::max());
+                pong.Increment();
+            }
+        }};
+
+        u32 threshold{};
+        auto duration{host::Measure(IterationCount, [&] {
+            ping.Increment();
+            pong.Wait(++threshold, std::chrono::steady_clock::duration::max());
+        })};
+        ponger.join();
+        return duration;
+    }
+
+    template<typename SyncpointType>
+    void RunBenchmarks(std::string_view name) {
+        constexpr size_t IterationCount{1'000'000};
+
+        {
+            SyncpointType syncpoint;
+            host::Report(fmt::format("Increment (No waiters) {}", name), host::Measure(IterationCount, [&] {
+                syncpoint.Increment();
+            }));
+        }
+
+        {
+            SyncpointType syncpoint;
+            RegisterPendingWaiters(syncpoint);
+            host::Report(fmt::format("Increment ({} pending waiters) {}", PendingWaiterCount, name), host::Measure(IterationCount, [&] {
+                syncpoint.Increment();
+            }));
+
+            host::Report(fmt::format("Register+Deregister ({} pending waiters) {}", PendingWaiterCount, name), host::Measure(IterationCount, [&] {
+                syncpoint.DeregisterWaiter(syncpoint.RegisterWaiter(PendingThreshold + PendingWaiterCount, [] {})); // The fence of the newest submission has the highest threshold
+            }));
+        }
+
+        {
+            SyncpointType syncpoint;
+            size_t callbackCount{};
+            host::Report(fmt::format("Register+Increment callback {}", name), host::Measure(IterationCount, [&] {
+                syncpoint.RegisterWaiter(syncpoint.Load() + 1, [&] { callbackCount++; });
+                syncpoint.Increment();
+            }));
+            if (callbackCount != IterationCount + 1)
+                throw exception("Only {} of {} callbacks were called", callbackCount, IterationCount + 1);
+        }
+
+        host::Report(fmt::format("Increment->Wake round trip {}", name), MeasurePingPong<SyncpointType>(false));
+        host::Report(fmt::format("Increment->Wake round trip ({} pending waiters) {}", PendingWaiterCount, name), MeasurePingPong<SyncpointType>(true));
+    }
+}
+
+int main() {
+    skyline::soc::host1x::RunBenchmarks<skyline::soc::host1x::ListSyncpoint>("WaiterList");
+    skyline::soc::host1x::RunBenchmarks<skyline::soc::host1x::Syncpoint>("WaiterHeap");
+}
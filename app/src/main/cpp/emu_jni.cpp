@@ -15,6 +15,7 @@
 #include "skyline/os.h"
 #include "skyline/jvm.h"
 #include "skyline/gpu.h"
+#include "skyline/gpu/presentation_engine.h"
 #include "skyline/audio.h"
 #include "skyline/input.h"
 #include "skyline/kernel/types/KProcess.h"
@@ -156,7 +157,7 @@ extern "C" JNIEXPORT jboolean Java_emu_skyline_EmulationActivity_setSurface(JNIE
     auto gpu{GpuWeak.lock()};
     if (!gpu)
         return false;
-    gpu->presentation.UpdateSurface(surface);
+    static_cast<skyline::gpu::PresentationEngine &>(*gpu->presentation).UpdateSurface(surface); // The emulator always creates the GPU with a PresentationEngine
     return true;
 }
 
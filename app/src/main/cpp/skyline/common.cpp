@@ -5,18 +5,23 @@
 #include "nce.h"
 #include "soc.h"
 #include "gpu.h"
+#include "gpu/presentation_engine.h"
 #include "audio.h"
 #include "input.h"
+#include "os.h"
 #include "kernel/types/KProcess.h"
 
 namespace skyline {
     DeviceState::DeviceState(kernel::OS *os, std::shared_ptr<JvmManager> jvmManager, std::shared_ptr<Settings> settings)
         : os(os), jvm(std::move(jvmManager)), settings(std::move(settings)) {
         // We assign these later as they use the state in their constructor and we don't want null pointers
-        gpu = std::make_shared<gpu::GPU>(*this);
+        gpu = std::make_shared<gpu::GPU>(*this, os->assetFileSystem, [](const DeviceState &state, gpu::GPU &gpu) -> std::unique_ptr<gpu::Presenter> {
+            return std::make_unique<gpu::PresentationEngine>(state, gpu);
+        });
         soc = std::make_shared<soc::SOC>(*this);
         audio = std::make_shared<audio::Audio>(*this);
         nce = std::make_shared<nce::NCE>(*this);
+        traps = nce;
         scheduler = std::make_shared<kernel::Scheduler>(*this);
         input = std::make_shared<input::Input>(*this);
     }
@@ -26,6 +26,7 @@ namespace skyline {
     class Settings;
     namespace nce {
         class NCE;
+        class TrapManager;
         struct ThreadContext;
     }
     class JvmManager;
@@ -41,6 +42,7 @@ namespace skyline {
             class KThread;
         }
         class Scheduler;
+        class MemoryManager;
         class OS;
     }
     namespace audio {
@@ -59,6 +61,12 @@ namespace skyline {
     struct DeviceState {
         DeviceState(kernel::OS *os, std::shared_ptr<JvmManager> jvmManager, std::shared_ptr<Settings> settings);
 
+        /**
+         * @brief Creates a state without an OS for running the GPU without any guest code, the GPU and SOC alongside any other required objects must be created by the caller
+         * @note As there's no guest, the loader and process may be null and JNI is unavailable
+         */
+        DeviceState(std::shared_ptr<Settings> settings, std::shared_ptr<nce::TrapManager> traps) : os{}, settings{std::move(settings)}, traps{std::move(traps)} {}
+
         ~DeviceState();
 
         kernel::OS *os;
@@ -66,7 +74,9 @@ namespace skyline {
         std::shared_ptr<Settings> settings;
         std::shared_ptr<loader::Loader> loader;
         std::shared_ptr<nce::NCE> nce;
+        std::shared_ptr<nce::TrapManager> traps; //!< Traps accesses to guest memory that's backing GPU resources, this is NCE when guest code is being executed
         std::shared_ptr<kernel::type::KProcess> process{};
+        kernel::MemoryManager *guestMemory{}; //!< The guest address space that GPU resources are mirrored from, this is the memory of the process when guest code is being executed
         static thread_local inline std::shared_ptr<kernel::type::KThread> thread{}; //!< The KThread of the thread which accesses this object
         static thread_local inline nce::ThreadContext *ctx{}; //!< The context of the guest thread for the corresponding host thread
         std::shared_ptr<gpu::GPU> gpu;
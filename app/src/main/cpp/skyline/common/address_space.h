@@ -92,7 +92,7 @@ namespace skyline {
      */
     template<typename VaType, VaType UnmappedVa, size_t AddressSpaceBits, size_t VaGranularityBits, size_t VaL2GranularityBits> requires AddressSpaceValid<VaType, AddressSpaceBits>
     class FlatMemoryManager : public FlatAddressSpaceMap<VaType, UnmappedVa, u8 *, nullptr, true, AddressSpaceBits, MemoryManagerBlockInfo> {
-      private:
+      protected:
         static constexpr u64 SparseMapSize{0x400000000}; //!< 16GiB pool size for sparse mappings returned by TranslateRange, this number is arbritary and should be large enough to fit the largest sparse mapping in the AS
         u8 *sparseMap; //!< Pointer to a zero filled memory region that is returned by TranslateRange for sparse mappings
 
@@ -109,10 +109,91 @@ namespace skyline {
         static constexpr size_t AddressSpaceSize{1ULL << AddressSpaceBits};
         SegmentTable<SegmentTableEntry, AddressSpaceSize, VaGranularityBits, VaL2GranularityBits> blockSegmentTable; //!< A page table of all buffer mappings for O(1) lookups on full matches
 
+        /**
+         * @brief A cached translation of a single mapped block in the TLB of a thread
+         * @note All pages in a block share the same segment table entry as blocks are only ever split at the boundaries of mappings
+         */
+        struct TlbEntry {
+            VaType virt{}; //!< The VA of the start of the block
+            VaType size{}; //!< The size of the block
+            u8 *phys{}; //!< The host address of the start of the block
+            MemoryManagerBlockInfo extraInfo{}; //!< The extra info of the block, this is used by reads and writes
+            SegmentTableEntry segment{}; //!< The segment table entry for the block, this is used to serve lookups for the full mapping
+        };
+
+        /**
+         * @brief The part of a TLB entry that's compared on lookups, these are stored separately from the entries so all tags can be checked without touching the entries
+         */
+        struct TlbTag {
+            u64 generation{}; //!< The generation of the manager that the entry was filled from, it's stale if it doesn't match the current generation
+            VaType virt{}; //!< The VA of the start of the block
+            VaType size{}; //!< The size of the block
+        };
+
+        /**
+         * @brief A small fully-associative software TLB of recently accessed blocks, every thread has its own TLB which is shared by all managers of the same type
+         */
+        struct Tlb {
+            static constexpr size_t EntryCount{8};
+
+            std::array<TlbTag, EntryCount> tags;
+            std::array<TlbEntry, EntryCount> entries;
+            size_t nextEntry; //!< The index of the entry that'll be replaced on the next fill, entries are replaced in a round-robin fashion
+            u32 hitCount, missCount; //!< The amount of hits and misses since the counts were last aggregated, these are kept per-thread to avoid contention on the lookup path
+        };
+
+        static constexpr u32 TlbStatisticsInterval{0x10000}; //!< The amount of lookups on a thread after which its TLB statistics are aggregated
+
+        static inline std::atomic<u64> generationCounter{}; //!< The source of generations for all managers of the same type, generations are never reused so TLB entries from a destroyed manager can't alias with another manager
+        std::atomic<u64> generation{++generationCounter}; //!< The generation of the mappings, this is changed on every Map/Unmap which implicitly invalidates the TLB entries of all threads
+        static inline std::atomic<u64> tlbHitCount{}, tlbMissCount{}; //!< The aggregated TLB statistics of all threads, these are per-type as the TLBs are shared by all managers of the same type
+
+        static Tlb &GetTlb() {
+            thread_local Tlb tlb{};
+            return tlb;
+        }
+
+        /**
+         * @brief Looks up the range in the TLB of the calling thread without locking
+         * @return The entry for the block containing the entire range or nullptr if there's no such entry
+         * @note Translations may be used concurrently with a Map/Unmap that's in progress, this matches the lifetime of the spans returned by LookupBlock
+         */
+        __attribute__((always_inline)) const TlbEntry *LookupTlb(VaType virt, VaType size) {
+            u64 currentGeneration{generation.load(std::memory_order_acquire)};
+            auto &tlb{GetTlb()};
+            for (size_t index{}; index < Tlb::EntryCount; index++) {
+                const auto &tag{tlb.tags[index]};
+                if (tag.generation == currentGeneration && virt - tag.virt < tag.size && size <= tag.size - (virt - tag.virt)) {
+                    if (++tlb.hitCount + tlb.missCount >= TlbStatisticsInterval) [[unlikely]]
+                        AggregateTlbStatistics(tlb);
+                    return &tlb.entries[index];
+                }
+            }
+            return nullptr;
+        }
+
+        /**
+         * @brief Adds the TLB statistics of the calling thread to the aggregated statistics and reports the hit rate
+         */
+        static void AggregateTlbStatistics(Tlb &tlb);
+
+        /**
+         * @brief Inserts the block containing the supplied VA into the TLB of the calling thread if it's mapped
+         * @note blockMutex MUST be locked when calling this
+         */
+        void FillTlbLocked(VaType virt);
+
+        /**
+         * @brief Invalidates the TLB entries of all threads for this manager
+         * @note blockMutex MUST be locked exclusively when calling this
+         */
+        void InvalidateTlbLocked() {
+            generation.store(++generationCounter, std::memory_order_release);
+        }
+
         TranslatedAddressRange TranslateRangeImpl(VaType virt, VaType size, std::function<void(span<u8>)> cpuAccessCallback = {});
 
-        std::pair<span<u8>, size_t> LookupBlockLocked(VaType virt, std::function<void(span<u8>)> cpuAccessCallback = {}) {
-            const auto &blockEntry{this->blockSegmentTable[virt]};
+        static std::pair<span<u8>, size_t> LookupBlockEntry(const SegmentTableEntry &blockEntry, VaType virt, const std::function<void(span<u8>)> &cpuAccessCallback) {
             VaType segmentOffset{virt - blockEntry.virt};
 
             if (blockEntry.extraInfo.sparseMapped || blockEntry.phys == nullptr)
@@ -125,6 +206,11 @@ namespace skyline {
             return {blockSpan, segmentOffset};
         }
 
+        std::pair<span<u8>, size_t> LookupBlockLocked(VaType virt, std::function<void(span<u8>)> cpuAccessCallback = {}) {
+            FillTlbLocked(virt);
+            return LookupBlockEntry(this->blockSegmentTable[virt], virt, cpuAccessCallback);
+        }
+
       public:
         FlatMemoryManager();
 
@@ -142,6 +228,9 @@ namespace skyline {
          * @return A span of the mapped region and the offset of the input VA in the region
          */
         __attribute__((always_inline)) std::pair<span<u8>, VaType> LookupBlock(VaType virt, std::function<void(span<u8>)> cpuAccessCallback = {}) {
+            if (auto entry{LookupTlb(virt, 0)})
+                return LookupBlockEntry(entry->segment, virt, cpuAccessCallback);
+
             std::shared_lock lock{this->blockMutex};
             return LookupBlockLocked(virt, cpuAccessCallback);
         }
@@ -150,6 +239,15 @@ namespace skyline {
          * @brief Translates a region in the VA space to a corresponding set of regions in the PA space
          */
         TranslatedAddressRange TranslateRange(VaType virt, VaType size, std::function<void(span<u8>)> cpuAccessCallback = {}) {
+            if (auto entry{LookupTlb(virt, size)}) {
+                auto [blockSpan, rangeOffset]{LookupBlockEntry(entry->segment, virt, cpuAccessCallback)};
+                if (blockSpan.size() - rangeOffset >= size) {
+                    TranslatedAddressRange ranges;
+                    ranges.push_back(blockSpan.subspan(blockSpan.valid() ? rangeOffset : 0, size));
+                    return ranges;
+                }
+            }
+
             std::shared_lock lock{this->blockMutex};
 
             // Fast path for when the range is mapped in a single block
@@ -189,7 +287,24 @@ namespace skyline {
         span<u8> ReadTill(Container& destination, VaType virt, Function function, std::function<void(span<u8>)> cpuAccessCallback = {}) {
             //TRACE_EVENT("containers", "FlatMemoryManager::ReadTill");
 
+            if (auto entry{LookupTlb(virt, destination.size())}) {
+                if (entry->extraInfo.sparseMapped) {
+                    std::memset(destination.data(), 0, destination.size());
+                } else {
+                    span<u8> cpuBlock{entry->phys + (virt - entry->virt), destination.size()};
+                    if (cpuAccessCallback)
+                        cpuAccessCallback(cpuBlock);
+
+                    auto end{function(cpuBlock)};
+                    std::memcpy(destination.data(), cpuBlock.data(), end ? *end : cpuBlock.size());
+                    if (end)
+                        return {destination.data(), *end};
+                }
+                return {destination.data(), destination.size()};
+            }
+
             std::shared_lock lock(this->blockMutex);
+            FillTlbLocked(virt);
 
             auto successor{std::upper_bound(this->blocks.begin(), this->blocks.end(), virt, [](auto virt, const auto &block) {
                 return virt < block.virt;
@@ -247,14 +362,32 @@ namespace skyline {
 
         void Copy(VaType dst, VaType src, VaType size, std::function<void(span<u8>)> cpuAccessCallback = {});
 
+        /**
+         * @return All non-sparse mapped blocks in the AS as pairs of their VA and the host memory they map to, in ascending order of VA
+         * @note The returned spans are only valid for as long as the corresponding regions remain mapped, this matches the spans returned by LookupBlock
+         */
+        std::vector<std::pair<VaType, span<u8>>> GetMappings() {
+            std::vector<std::pair<VaType, span<u8>>> mappings;
+
+            std::shared_lock lock(this->blockMutex);
+            // The last block is always unmapped so it never needs to be checked
+            for (auto it{this->blocks.begin()}; std::next(it) != this->blocks.end(); it++)
+                if (it->Mapped() && !it->extraInfo.sparseMapped)
+                    mappings.emplace_back(it->virt, span<u8>{it->phys, std::next(it)->virt - it->virt});
+
+            return mappings;
+        }
+
         void Map(VaType virt, u8 *phys, VaType size, MemoryManagerBlockInfo extraInfo = {}) {
             std::scoped_lock lock(this->blockMutex);
+            InvalidateTlbLocked();
             blockSegmentTable.Set(virt, virt + size, {virt, phys, size, extraInfo});
             this->MapLocked(virt, phys, size, extraInfo);
         }
 
         void Unmap(VaType virt, VaType size) {
             std::scoped_lock lock(this->blockMutex);
+            InvalidateTlbLocked();
             blockSegmentTable.Set(virt, virt + size, {});
             this->UnmapLocked(virt, size);
         }
@@ -1,71 +1,310 @@
 // SPDX-License-Identifier: MPL-2.0
 // Copyright © 2021 Skyline Team and Contributors (https://github.com/skyline-emu/)
 
+#include <condition_variable>
+#include <thread>
+#include <time.h>
 #include <android/log.h>
 #include "utils.h"
 #include "logger.h"
 
 namespace skyline {
+    /**
+     * @brief A single-producer single-consumer ring buffer of log records for a thread
+     */
+    struct LogBuffer {
+        static constexpr size_t Size{0x40000}; //!< The size of the buffer in bytes, this must be a multiple of the record header size
+
+        alignas(64) std::atomic<size_t> head{}; //!< The offset after the last committed record, this is only written by the producer
+        size_t pendingHead{}; //!< The offset after the last allocated record, this is only accessed by the producer
+        std::atomic<size_t> droppedCount{}; //!< The amount of records that were dropped since the last time the buffer was drained
+        alignas(64) std::atomic<size_t> tail{}; //!< The offset of the first record which hasn't been consumed, this is only written by the consumer
+        std::atomic<bool> abandoned{}; //!< If the thread that owns the buffer has exited, the buffer is destroyed after it's drained
+        std::string threadName, logTag; //!< These are only accessed by the consumer after the buffer is registered
+        Logger::LoggerContext *lastContext{}; //!< The context of the last consumed record, this is where dropped records are reported
+        alignas(64) std::array<u8, Size> data;
+    };
+
+    /**
+     * @brief The state of the logger thread which consumes records from the buffers of all threads
+     */
+    struct LogConsumer {
+        static constexpr std::chrono::milliseconds Interval{10}; //!< The maximum duration between buffers being drained
+
+        std::mutex mutex; //!< Synchronizes registration of buffers and draining them, only one thread may drain the buffers at a time
+        std::vector<std::shared_ptr<LogBuffer>> buffers;
+        fmt::memory_buffer message, line; //!< Reusable buffers for formatting records, these are protected by the mutex
+        std::mutex wakeMutex;
+        std::condition_variable wakeCondition; //!< Notified by threads that are blocked on a full buffer to have it drained immediately
+        bool exit{}; //!< Protected by the wake mutex
+        std::atomic<u64> flushRequestCount{}; //!< The amount of flushes requested by TryFlush, these are polled by the logger thread as waking it isn't async-signal-safe
+        std::atomic<u64> flushCompletedCount{}; //!< The value of the flush request count prior to the logger thread's last drain and flush
+        std::thread thread;
+
+        LogConsumer();
+
+        ~LogConsumer();
+
+        void Run();
+
+        /**
+         * @brief Writes out all records that have been committed to any of the buffers
+         * @note The mutex must be locked
+         */
+        void Drain();
+
+        void WriteMessage(LogBuffer &buffer, Logger::LogLevel level, i64 timestamp, Logger::LoggerContext *context, std::string_view str);
+    };
+
+    static std::atomic<LogConsumer *> consumerInstance{}; //!< The consumer once it's been constructed, this allows accessing it from signal handlers without triggering its construction
+
+    LogConsumer::LogConsumer() : thread{&LogConsumer::Run, this} {
+        consumerInstance.store(this, std::memory_order_release);
+    }
+
+    LogConsumer::~LogConsumer() {
+        consumerInstance.store(nullptr, std::memory_order_release);
+        {
+            std::scoped_lock lock{wakeMutex};
+            exit = true;
+        }
+        wakeCondition.notify_all();
+        thread.join();
+    }
+
+    static LogConsumer &GetConsumer() {
+        static LogConsumer consumer; // The consumer is lazily constructed to ensure that it's destroyed prior to the logger contexts
+        return consumer;
+    }
+
+    void LogConsumer::Run() {
+        if (int result{pthread_setname_np(pthread_self(), "Sky-Logger")})
+            __android_log_print(ANDROID_LOG_WARN, "emu-cpp-Sky-Logger", "Failed to set the thread name: %s", strerror(result));
+
+        std::unique_lock wakeLock{wakeMutex};
+        while (!exit) {
+            wakeCondition.wait_for(wakeLock, Interval);
+            wakeLock.unlock();
+
+            u64 flushRequests{flushRequestCount.load(std::memory_order_acquire)}; // Any records committed prior to a flush being requested are written out by this iteration
+            {
+                std::scoped_lock lock{mutex};
+                Drain();
+            }
+
+            // Flushes are batched to once for every time the buffers are drained as opposed to every message
+            for (auto context : {&Logger::EmulationContext, &Logger::LoaderContext}) {
+                std::scoped_lock lock{context->mutex};
+                if (context->dirty) {
+                    context->logFile.flush();
+                    context->dirty = false;
+                }
+            }
+            flushCompletedCount.store(flushRequests, std::memory_order_release);
+
+            wakeLock.lock();
+        }
+
+        std::scoped_lock lock{mutex};
+        Drain();
+    }
+
+    void LogConsumer::Drain() {
+        for (auto it{buffers.begin()}; it != buffers.end();) {
+            auto &buffer{**it};
+            bool abandoned{buffer.abandoned.load(std::memory_order_acquire)}; // This must be loaded prior to the head so no records committed before the thread exited are missed
+            size_t head{buffer.head.load(std::memory_order_acquire)}, tail{buffer.tail.load(std::memory_order_relaxed)};
+            while (tail != head) {
+                auto record{reinterpret_cast<Logger::LogRecord *>(buffer.data.data() + (tail % LogBuffer::Size))};
+                if (record->type != Logger::LogRecord::Type::Padding) {
+                    message.clear();
+                    record->consume(record + 1, message);
+
+                    if (record->type == Logger::LogRecord::Type::ThreadName) {
+                        buffer.threadName.assign(message.data(), message.size());
+                        buffer.logTag = "emu-cpp-" + buffer.threadName;
+                    } else {
+                        WriteMessage(buffer, record->level, record->timestamp, record->context, std::string_view{message.data(), message.size()});
+                    }
+                }
+
+                tail += record->size;
+                buffer.tail.store(tail, std::memory_order_release); // The tail is advanced after every record so any blocked producers can make progress sooner
+            }
+
+            if (auto droppedCount{buffer.droppedCount.exchange(0, std::memory_order_relaxed)})
+                WriteMessage(buffer, Logger::LogLevel::Warn, util::GetTimeNs(), buffer.lastContext, fmt::format("Dropped {} log messages due to the log buffer being full", droppedCount));
+
+            if (abandoned)
+                it = buffers.erase(it);
+            else
+                it++;
+        }
+    }
+
+    void LogConsumer::WriteMessage(LogBuffer &buffer, Logger::LogLevel level, i64 timestamp, Logger::LoggerContext *context, std::string_view str) {
+        constexpr std::array<int, 5> levelAlog{ANDROID_LOG_ERROR, ANDROID_LOG_WARN, ANDROID_LOG_INFO, ANDROID_LOG_DEBUG, ANDROID_LOG_VERBOSE}; // This corresponds to LogLevel and provides its equivalent for NDK Logging
+        constexpr std::array<char, 5> levelCharacter{'E', 'W', 'I', 'D', 'V'}; // The LogLevel as written out to a file
+
+        line.clear();
+        line.append(str);
+        line.push_back('\0');
+        __android_log_write(levelAlog[static_cast<u8>(level)], buffer.logTag.c_str(), line.data());
+
+        buffer.lastContext = context;
+        if (context) {
+            line.clear();
+            // We use RS (\036) and GS (\035) as our delimiters
+            fmt::format_to(std::back_inserter(line), "\036{}\035{}\035{}\035{}\n", levelCharacter[static_cast<u8>(level)], (timestamp / constant::NsInMillisecond) - context->start, buffer.threadName, str);
+            context->Write(std::string_view{line.data(), line.size()});
+        }
+    }
+
     void Logger::LoggerContext::Initialize(const std::string &path) {
+        std::scoped_lock lock{mutex};
         start = util::GetTimeNs() / constant::NsInMillisecond;
         logFile.open(path, std::ios::trunc);
+        GetConsumer();
     }
 
     void Logger::LoggerContext::Finalize() {
+        Flush();
         std::scoped_lock lock{mutex};
         logFile.close();
     }
 
     void Logger::LoggerContext::TryFlush() {
-        std::unique_lock lock(mutex, std::try_to_lock);
-        if (lock)
-            logFile.flush();
+        // Formatting records and writing to the log files isn't async-signal-safe, the logger thread is requested to do so instead while this thread sleeps for a bounded duration
+        auto consumer{consumerInstance.load(std::memory_order_acquire)};
+        if (!consumer)
+            return;
+
+        constexpr size_t MaxWaitIterations{50}; // The maximum amount of 1ms sleeps to wait for the flush, this covers several intervals of the logger thread
+        u64 request{consumer->flushRequestCount.fetch_add(1, std::memory_order_acq_rel) + 1};
+        for (size_t iteration{}; iteration < MaxWaitIterations && consumer->flushCompletedCount.load(std::memory_order_acquire) < request; iteration++) {
+            timespec sleepDuration{.tv_nsec = constant::NsInMillisecond};
+            nanosleep(&sleepDuration, nullptr);
+        }
     }
 
     void Logger::LoggerContext::Flush() {
+        auto &consumer{GetConsumer()};
+        {
+            std::scoped_lock consumerLock{consumer.mutex};
+            consumer.Drain();
+        }
+
         std::scoped_lock lock{mutex};
         logFile.flush();
+        dirty = false;
     }
 
-    thread_local static std::string logTag, threadName;
-    thread_local static Logger::LoggerContext *context{&Logger::EmulationContext};
+    void Logger::LoggerContext::Write(std::string_view str) {
+        std::scoped_lock guard{mutex};
+        if (logFile.is_open()) {
+            logFile.write(str.data(), static_cast<std::streamsize>(str.size()));
+            dirty = true;
+        }
+    }
 
-    void Logger::UpdateTag() {
+    static std::string GetThreadName() {
         std::array<char, 16> name;
         if (!pthread_getname_np(pthread_self(), name.data(), name.size()))
-            threadName = name.data();
+            return name.data();
         else
-            threadName = "unk";
-        logTag = std::string("emu-cpp-") + threadName;
+            return "unk";
     }
 
-    Logger::LoggerContext *Logger::GetContext() {
-        return context;
+    /**
+     * @brief Owns the log buffer of a thread and marks it as abandoned when the thread exits
+     */
+    struct LogBufferOwner {
+        std::shared_ptr<LogBuffer> buffer;
+
+        ~LogBufferOwner() {
+            if (buffer)
+                buffer->abandoned.store(true, std::memory_order_release);
+        }
+    };
+
+    thread_local static LogBufferOwner bufferOwner;
+    thread_local static Logger::LoggerContext *context{&Logger::EmulationContext};
+
+    static LogBuffer &GetThreadBuffer() {
+        if (!bufferOwner.buffer) [[unlikely]] {
+            auto buffer{std::make_shared<LogBuffer>()};
+            buffer->threadName = GetThreadName();
+            buffer->logTag = "emu-cpp-" + buffer->threadName;
+
+            auto &consumer{GetConsumer()};
+            std::scoped_lock lock{consumer.mutex};
+            consumer.buffers.emplace_back(buffer);
+            bufferOwner.buffer = std::move(buffer);
+        }
+        return *bufferOwner.buffer;
     }
 
-    void Logger::SetContext(LoggerContext *pContext) {
-        context = pContext;
+    Logger::LogRecord *Logger::AllocateRecord(LogRecord::Type type, LogLevel level, size_t payloadSize) {
+        auto &buffer{GetThreadBuffer()};
+        size_t size{util::AlignUp(sizeof(LogRecord) + payloadSize, sizeof(LogRecord))};
+        size_t head{buffer.head.load(std::memory_order_relaxed)}, offset{head % LogBuffer::Size};
+        size_t padding{offset + size > LogBuffer::Size ? LogBuffer::Size - offset : 0}; // Records are always contiguous, if one doesn't fit prior to the end of the buffer then it's placed at the start
+
+        size_t used{head - buffer.tail.load(std::memory_order_acquire)};
+        while (used + padding + size > LogBuffer::Size) {
+            // Debug and verbose messages are dropped rather than blocking the thread as they're produced at a high rate, other messages block until the logger thread has made enough space
+            if (type == LogRecord::Type::Message && level >= LogLevel::Debug) {
+                buffer.droppedCount.fetch_add(1, std::memory_order_relaxed);
+                return nullptr;
+            }
+
+            GetConsumer().wakeCondition.notify_one();
+            std::this_thread::yield();
+            used = head - buffer.tail.load(std::memory_order_acquire);
+        }
+
+        if (used <= LogBuffer::Size / 2 && used + padding + size > LogBuffer::Size / 2)
+            GetConsumer().wakeCondition.notify_one(); // The buffer is drained early when it's half full to avoid blocking or dropping records during bursts
+
+        if (padding) {
+            auto paddingRecord{reinterpret_cast<LogRecord *>(buffer.data.data() + offset)};
+            paddingRecord->size = static_cast<u16>(padding);
+            paddingRecord->type = LogRecord::Type::Padding;
+            offset = 0;
+        }
+
+        auto record{reinterpret_cast<LogRecord *>(buffer.data.data() + offset)};
+        record->size = static_cast<u16>(size);
+        record->type = type;
+        record->level = level;
+        record->timestamp = util::GetTimeNs();
+        record->context = context;
+        buffer.pendingHead = head + padding + size;
+        return record;
     }
 
-    void Logger::WriteAndroid(LogLevel level, const std::string &str) {
-        constexpr std::array<int, 5> levelAlog{ANDROID_LOG_ERROR, ANDROID_LOG_WARN, ANDROID_LOG_INFO, ANDROID_LOG_DEBUG, ANDROID_LOG_VERBOSE}; // This corresponds to LogLevel and provides its equivalent for NDK Logging
-        if (logTag.empty())
-            UpdateTag();
+    void Logger::CommitRecord() {
+        auto &buffer{*bufferOwner.buffer};
+        buffer.head.store(buffer.pendingHead, std::memory_order_release);
+    }
 
-        __android_log_write(levelAlog[static_cast<u8>(level)], logTag.c_str(), str.c_str());
+    void Logger::UpdateTag() {
+        Enqueue(LogRecord::Type::ThreadName, LogLevel::Info, [name = GetThreadName()](fmt::memory_buffer &output) {
+            output.append(name);
+        });
     }
 
-    void Logger::Write(LogLevel level, const std::string &str) {
-        constexpr std::array<char, 5> levelCharacter{'E', 'W', 'I', 'D', 'V'}; // The LogLevel as written out to a file
-        WriteAndroid(level, str);
+    Logger::LoggerContext *Logger::GetContext() {
+        return context;
+    }
 
-        if (context)
-            // We use RS (\036) and GS (\035) as our delimiters
-            context->Write(fmt::format("\036{}\035{}\035{}\035{}\n", levelCharacter[static_cast<u8>(level)], (util::GetTimeNs() / constant::NsInMillisecond) - context->start, threadName, str));
+    void Logger::SetContext(LoggerContext *pContext) {
+        context = pContext;
     }
 
-    void Logger::LoggerContext::Write(const std::string &str) {
-        std::scoped_lock guard{mutex};
-        logFile << str;
+    void Logger::Write(LogLevel level, std::string str) {
+        Enqueue(LogRecord::Type::Message, level, [str = std::move(str)](fmt::memory_buffer &output) {
+            output.append(str);
+        });
     }
 }
@@ -5,16 +5,24 @@
 
 #include <fstream>
 #include <mutex>
+#include <concepts>
+#include <limits>
+#include <new>
 #include "base.h"
 
 namespace skyline {
+    struct LogConsumer;
+
     /**
      * @brief A wrapper around writing logs into a log file and logcat using Android Log APIs
+     * @note Messages are recorded into a lock-free buffer for every thread with their formatting deferred where possible, they're formatted and written out by a dedicated logger thread
      */
     class Logger {
       private:
         Logger() {}
 
+        friend LogConsumer;
+
       public:
         enum class LogLevel {
             Error,
@@ -33,6 +41,7 @@ namespace skyline {
             std::mutex mutex; //!< Synchronizes all output I/O to ensure there are no races
             std::ofstream logFile; //!< An output stream to the log file
             i64 start; //!< A timestamp in milliseconds for when the logger was started, this is used as the base for all log timestamps
+            bool dirty{}; //!< If the log file has been written to since it was last flushed, this is protected by the mutex
 
             LoggerContext() {}
 
@@ -40,14 +49,119 @@ namespace skyline {
 
             void Finalize();
 
+            /**
+             * @brief Requests the logger thread to write out all pending messages and flush the log files, this waits for a bounded duration for it to do so
+             * @note This is async-signal-safe and is used by signal handlers to flush logs prior to crashing, it never formats or writes messages on the calling thread
+             */
             void TryFlush();
 
+            /**
+             * @brief Writes out all pending messages from all threads and flushes the log file
+             */
             void Flush();
 
-            void Write(const std::string &str);
+            void Write(std::string_view str);
         };
         static inline LoggerContext EmulationContext, LoaderContext;
 
+      private:
+        /**
+         * @brief The header of a record in the log buffer of a thread, it's followed by a payload that's consumed by the logger thread
+         */
+        struct alignas(32) LogRecord {
+            enum class Type : u8 {
+                Message, //!< A log message, the payload formats it into the output
+                ThreadName, //!< A new name for the thread, the payload writes it into the output
+                Padding, //!< Unused space up to the end of the buffer, this has no payload
+            };
+
+            i64 timestamp; //!< The time at which the record was created in nanoseconds
+            LoggerContext *context; //!< The context of the thread at the time the record was created
+            void (*consume)(void *payload, fmt::memory_buffer &output); //!< Writes the payload into the output and destroys it
+            LogLevel level;
+            u16 size; //!< The size of the record including the payload, this is a multiple of the size of the header
+            Type type;
+        };
+        static_assert(sizeof(LogRecord) == 32);
+
+        /**
+         * @brief Allocates a record in the log buffer of the calling thread, this blocks until there's enough space unless the record can be dropped
+         * @return The allocated record or nullptr if the record was dropped due to the buffer being full
+         */
+        static LogRecord *AllocateRecord(LogRecord::Type type, LogLevel level, size_t payloadSize);
+
+        /**
+         * @brief Makes the last record allocated by the calling thread visible to the logger thread
+         */
+        static void CommitRecord();
+
+        /**
+         * @brief Records the supplied payload into the log buffer of the calling thread, it's invoked with the output buffer and destroyed on the logger thread
+         */
+        template<typename Payload>
+        static void Enqueue(LogRecord::Type type, LogLevel level, Payload &&payload) {
+            using PayloadType = std::decay_t<Payload>;
+            static_assert(alignof(PayloadType) <= alignof(LogRecord) && sizeof(PayloadType) <= std::numeric_limits<u16>::max() - 2 * sizeof(LogRecord));
+
+            if (auto record{AllocateRecord(type, level, sizeof(PayloadType))}) {
+                new (record + 1) PayloadType{std::forward<Payload>(payload)};
+                record->consume = [](void *payload, fmt::memory_buffer &output) {
+                    auto &object{*static_cast<PayloadType *>(payload)};
+                    object(output);
+                    object.~PayloadType();
+                };
+                CommitRecord();
+            }
+        }
+
+        /**
+         * @brief If an argument can be copied into a record to be formatted later, this excludes any types which might reference memory that could be freed prior to formatting
+         * @note String arguments are copied into a std::string as they can't be assumed to outlive the call
+         */
+        template<typename T>
+        static constexpr bool IsDeferrable{[] {
+            using CastType = decltype(util::FmtCast(std::declval<std::decay_t<T>>()));
+            return std::is_arithmetic_v<CastType> || std::is_enum_v<CastType> || std::is_same_v<CastType, std::string> || std::is_same_v<CastType, std::string_view> || std::is_same_v<CastType, char *> || std::is_same_v<CastType, const char *>;
+        }()};
+
+        template<typename T>
+        static auto DeferArgument(T &&argument) {
+            auto object{util::FmtCast(std::forward<T>(argument))};
+            if constexpr (std::is_pointer_v<decltype(object)>)
+                return object ? std::string{object} : std::string{};
+            else if constexpr (std::is_same_v<decltype(object), std::string_view>)
+                return std::string{object};
+            else
+                return object;
+        }
+
+        /**
+         * @brief Records a message which is formatted on the logger thread if all arguments can be deferred, it's formatted on the calling thread otherwise
+         * @param formatString A string literal or a std::string which is owned by the record
+         * @param function The name of the function to prefix the message with or nullptr for no prefix
+         */
+        template<typename S, typename... Args>
+        static void WriteFormatted(LogLevel level, S &&formatString, const char *function, Args &&... args) {
+            if constexpr ((IsDeferrable<Args> && ...)) {
+                Enqueue(LogRecord::Type::Message, level, [formatString = std::forward<S>(formatString), function, ...args = DeferArgument(std::forward<Args>(args))](fmt::memory_buffer &output) {
+                    if (function)
+                        fmt::format_to(std::back_inserter(output), "{}: ", function);
+                    size_t prefixSize{output.size()};
+                    try {
+                        fmt::format_to(std::back_inserter(output), fmt::runtime(formatString), args...);
+                    } catch (const fmt::format_error &) {
+                        // Messages which aren't valid format strings (such as exception messages) are written out verbatim
+                        output.resize(prefixSize);
+                        output.append(std::string_view{formatString});
+                    }
+                });
+            } else {
+                auto message{util::Format(formatString, std::forward<Args>(args)...)};
+                Write(level, function ? fmt::format("{}: {}", function, message) : std::move(message));
+            }
+        }
+
+      public:
         /**
          * @brief Update the tag in log messages with a new thread name
          */
@@ -57,9 +171,7 @@ namespace skyline {
 
         static void SetContext(LoggerContext *context);
 
-        static void WriteAndroid(LogLevel level, const std::string &str);
-
-        static void Write(LogLevel level, const std::string &str);
+        static void Write(LogLevel level, std::string str);
 
         /**
          * @brief A wrapper around a string which captures the calling function using Clang source location builtins
@@ -70,73 +182,97 @@ namespace skyline {
         struct FunctionString {
             S string;
             const char *function;
+            bool isLiteral{}; //!< If the string is a string literal, these are the only strings which can be referenced by a record rather than copied
 
-            FunctionString(S string, const char *function = __builtin_FUNCTION()) : string(std::move(string)), function(function) {}
+            template<typename T> requires std::same_as<std::decay_t<T>, S>
+            FunctionString(T &&string, const char *function = __builtin_FUNCTION()) : string(std::forward<T>(string)), function(function) {}
 
-            std::string operator*() {
-                return std::string(function) + ": " + std::string(string);
-            }
+            /**
+             * @note This is more specialized than the constructor above so it's preferred for string literals, it being consteval ensures that it can't be used with arrays that aren't constant
+             */
+            template<size_t N> requires std::same_as<S, const char *>
+            consteval FunctionString(const char (&string)[N], const char *function = __builtin_FUNCTION()) : string(string), function(function), isLiteral(true) {}
         };
 
+      private:
+        template<typename... Args>
+        static void Log(LogLevel level, FunctionString<const char *> &formatString, Args &&... args) {
+            if (formatString.isLiteral)
+                WriteFormatted(level, formatString.string, formatString.function, std::forward<Args>(args)...);
+            else
+                WriteFormatted(level, std::string{formatString.string}, formatString.function, std::forward<Args>(args)...);
+        }
+
+        template<typename... Args>
+        static void Log(LogLevel level, FunctionString<std::string> &formatString, Args &&... args) {
+            WriteFormatted(level, std::move(formatString.string), formatString.function, std::forward<Args>(args)...);
+        }
+
+        template<typename S, typename... Args>
+        static void LogNoPrefix(LogLevel level, S &&formatString, Args &&... args) {
+            WriteFormatted(level, std::string{std::forward<S>(formatString)}, nullptr, std::forward<Args>(args)...);
+        }
+
+      public:
         template<typename... Args>
         static void Error(FunctionString<const char *> formatString, Args &&... args) {
             if (LogLevel::Error <= configLevel)
-                Write(LogLevel::Error, util::Format(*formatString, args...));
+                Log(LogLevel::Error, formatString, std::forward<Args>(args)...);
         }
 
         template<typename... Args>
         static void Error(FunctionString<std::string> formatString, Args &&... args) {
             if (LogLevel::Error <= configLevel)
-                Write(LogLevel::Error, util::Format(*formatString, args...));
+                Log(LogLevel::Error, formatString, std::forward<Args>(args)...);
         }
 
         template<typename S, typename... Args>
-        static void ErrorNoPrefix(S formatString, Args &&... args) {
+        static void ErrorNoPrefix(S &&formatString, Args &&... args) {
             if (LogLevel::Error <= configLevel)
-                Write(LogLevel::Error, util::Format(formatString, args...));
+                LogNoPrefix(LogLevel::Error, std::forward<S>(formatString), std::forward<Args>(args)...);
         }
 
         template<typename... Args>
         static void Warn(FunctionString<const char *> formatString, Args &&... args) {
             if (LogLevel::Warn <= configLevel)
-                Write(LogLevel::Warn, util::Format(*formatString, args...));
+                Log(LogLevel::Warn, formatString, std::forward<Args>(args)...);
         }
 
         template<typename... Args>
         static void Warn(FunctionString<std::string> formatString, Args &&... args) {
             if (LogLevel::Warn <= configLevel)
-                Write(LogLevel::Warn, util::Format(*formatString, args...));
+                Log(LogLevel::Warn, formatString, std::forward<Args>(args)...);
         }
 
         template<typename S, typename... Args>
-        static void WarnNoPrefix(S formatString, Args &&... args) {
+        static void WarnNoPrefix(S &&formatString, Args &&... args) {
             if (LogLevel::Warn <= configLevel)
-                Write(LogLevel::Warn, util::Format(formatString, args...));
+                LogNoPrefix(LogLevel::Warn, std::forward<S>(formatString), std::forward<Args>(args)...);
         }
 
         template<typename... Args>
         static void Info(FunctionString<const char *> formatString, Args &&... args) {
             if (LogLevel::Info <= configLevel)
-                Write(LogLevel::Info, util::Format(*formatString, args...));
+                Log(LogLevel::Info, formatString, std::forward<Args>(args)...);
         }
 
         template<typename... Args>
         static void Info(FunctionString<std::string> formatString, Args &&... args) {
             if (LogLevel::Info <= configLevel)
-                Write(LogLevel::Info, util::Format(*formatString, args...));
+                Log(LogLevel::Info, formatString, std::forward<Args>(args)...);
         }
 
         template<typename S, typename... Args>
-        static void InfoNoPrefix(S formatString, Args &&... args) {
+        static void InfoNoPrefix(S &&formatString, Args &&... args) {
             if (LogLevel::Info <= configLevel)
-                Write(LogLevel::Info, util::Format(formatString, args...));
+                LogNoPrefix(LogLevel::Info, std::forward<S>(formatString), std::forward<Args>(args)...);
         }
 
         template<typename... Args>
         static void Debug(FunctionString<const char *> formatString, Args &&... args) {
             #ifndef NDEBUG
             if (LogLevel::Debug <= configLevel)
-                Write(LogLevel::Debug, util::Format(*formatString, args...));
+                Log(LogLevel::Debug, formatString, std::forward<Args>(args)...);
             #endif
         }
 
@@ -144,15 +280,15 @@ namespace skyline {
         static void Debug(FunctionString<std::string> formatString, Args &&... args) {
             #ifndef NDEBUG
             if (LogLevel::Debug <= configLevel)
-                Write(LogLevel::Debug, util::Format(*formatString, args...));
+                Log(LogLevel::Debug, formatString, std::forward<Args>(args)...);
             #endif
         }
 
         template<typename S, typename... Args>
-        static void DebugNoPrefix(S formatString, Args &&... args) {
+        static void DebugNoPrefix(S &&formatString, Args &&... args) {
             #ifndef NDEBUG
             if (LogLevel::Debug <= configLevel)
-                Write(LogLevel::Debug, util::Format(formatString, args...));
+                LogNoPrefix(LogLevel::Debug, std::forward<S>(formatString), std::forward<Args>(args)...);
             #endif
         }
 
@@ -160,7 +296,7 @@ namespace skyline {
         static void Verbose(FunctionString<const char *> formatString, Args &&... args) {
             #ifndef NDEBUG
             if (LogLevel::Verbose <= configLevel)
-                Write(LogLevel::Verbose, util::Format(*formatString, args...));
+                Log(LogLevel::Verbose, formatString, std::forward<Args>(args)...);
             #endif
         }
 
@@ -168,15 +304,15 @@ namespace skyline {
         static void Verbose(FunctionString<std::string> formatString, Args &&... args) {
             #ifndef NDEBUG
             if (LogLevel::Verbose <= configLevel)
-                Write(LogLevel::Verbose, util::Format(*formatString, args...));
+                Log(LogLevel::Verbose, formatString, std::forward<Args>(args)...);
             #endif
         }
 
         template<typename S, typename... Args>
-        static void VerboseNoPrefix(S formatString, Args &&... args) {
+        static void VerboseNoPrefix(S &&formatString, Args &&... args) {
             #ifndef NDEBUG
             if (LogLevel::Verbose <= configLevel)
-                Write(LogLevel::Verbose, util::Format(formatString, args...));
+                LogNoPrefix(LogLevel::Verbose, std::forward<S>(formatString), std::forward<Args>(args)...);
             #endif
         }
     };
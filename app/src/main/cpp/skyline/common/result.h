@@ -3,6 +3,7 @@
 
 #pragma once
 
+#include <optional>
 #include "base.h"
 
 namespace skyline {
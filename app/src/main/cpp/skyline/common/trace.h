@@ -16,7 +16,8 @@ PERFETTO_DEFINE_CATEGORIES(
     perfetto::Category("host").SetDescription("Events relating to host code"),
     perfetto::Category("gpu").SetDescription("Events from the emulated GPU"),
     perfetto::Category("service").SetDescription("Events from the HLE sysmodule implementations"),
-    perfetto::Category("containers").SetDescription("Events from custom container implementations")
+    perfetto::Category("containers").SetDescription("Events from custom container implementations"),
+    perfetto::Category("vfs").SetDescription("Events from the virtual filesystem")
 );
 
 namespace skyline::trace {
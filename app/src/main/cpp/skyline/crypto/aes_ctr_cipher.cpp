@@ -0,0 +1,218 @@
+// SPDX-License-Identifier: MPL-2.0
+// Copyright © 2022 Skyline Team and Contributors (https://github.com/skyline-emu/)
+
+#if defined(__aarch64__)
+#include <arm_neon.h>
+#include <sys/auxv.h>
+#include <asm/hwcap.h>
+#elif defined(__AES__)
+#include <wmmintrin.h>
+#endif
+#include "aes_ctr_cipher.h"
+
+namespace skyline::crypto {
+    namespace {
+        constexpr u8 RotateLeft(u8 value, int shift) {
+            return static_cast<u8>((value << shift) | (value >> (8 - shift)));
+        }
+
+        /**
+         * @brief The AES S-box, this is generated by iterating over GF(2^8) alongside the multiplicative inverse of every element and applying the affine transformation to the inverse
+         */
+        constexpr std::array<u8, 0x100> SBox{[]() {
+            std::array<u8, 0x100> sBox{};
+            u8 p{1}, q{1};
+            do {
+                p = static_cast<u8>(p ^ (p << 1) ^ ((p & 0x80) ? 0x1B : 0)); // Multiply p by 3
+                q = static_cast<u8>(q ^ (q << 1));
+                q = static_cast<u8>(q ^ (q << 2));
+                q = static_cast<u8>(q ^ (q << 4));
+                if (q & 0x80)
+                    q ^= 0x09; // Divide q by 3, q is now the inverse of p
+                sBox[p] = static_cast<u8>(q ^ RotateLeft(q, 1) ^ RotateLeft(q, 2) ^ RotateLeft(q, 3) ^ RotateLeft(q, 4) ^ 0x63);
+            } while (p != 1);
+            sBox[0] = 0x63; // 0 has no inverse and is special-cased
+            return sBox;
+        }()};
+        static_assert(SBox[0x00] == 0x63 && SBox[0x01] == 0x7C && SBox[0x53] == 0xED && SBox[0xFF] == 0x16);
+
+        /**
+         * @brief A 128-bit big-endian counter split into its halves in host byte order
+         */
+        struct Counter {
+            u64 high;
+            u64 low;
+
+            Counter(const AesCtrCipher::Block &ctr) {
+                std::memcpy(&high, ctr.data(), sizeof(u64));
+                std::memcpy(&low, ctr.data() + sizeof(u64), sizeof(u64));
+                high = util::SwapEndianness(high);
+                low = util::SwapEndianness(low);
+            }
+
+            void Increment() {
+                if (++low == 0) [[unlikely]]
+                    high++;
+            }
+
+            void Store(AesCtrCipher::Block &ctr) const {
+                u64 highBe{util::SwapEndianness(high)}, lowBe{util::SwapEndianness(low)};
+                std::memcpy(ctr.data(), &highBe, sizeof(u64));
+                std::memcpy(ctr.data() + sizeof(u64), &lowBe, sizeof(u64));
+            }
+        };
+    }
+
+    AesCtrCipher::AesCtrCipher(const std::array<u8, BlockSize> &key) {
+        mbedtls_aes_init(&softwareContext);
+        if (mbedtls_aes_setkey_enc(&softwareContext, key.data(), BlockSize * 8) != 0)
+            throw exception("Failed to set key for AES-CTR context");
+
+        // Expand the key schedule for the hardware path, see FIPS-197 Section 5.2
+        auto schedule{reinterpret_cast<u8 *>(roundKeys.data())};
+        std::memcpy(schedule, key.data(), BlockSize);
+        u8 rcon{1};
+        for (size_t i{BlockSize}; i < sizeof(roundKeys); i += 4) {
+            std::array<u8, 4> word;
+            std::memcpy(word.data(), schedule + i - 4, word.size());
+            if (i % BlockSize == 0) {
+                // RotWord, SubWord and the round constant
+                word = {static_cast<u8>(SBox[word[1]] ^ rcon), SBox[word[2]], SBox[word[3]], SBox[word[0]]};
+                rcon = static_cast<u8>((rcon << 1) ^ ((rcon & 0x80) ? 0x1B : 0));
+            }
+
+            for (size_t j{}; j < word.size(); j++)
+                schedule[i + j] = schedule[i - BlockSize + j] ^ word[j];
+        }
+
+        #if defined(__aarch64__)
+        hasHardwareAes = getauxval(AT_HWCAP) & HWCAP_AES;
+        #elif defined(__AES__)
+        hasHardwareAes = true;
+        #endif
+    }
+
+    AesCtrCipher::~AesCtrCipher() {
+        mbedtls_aes_free(&softwareContext);
+    }
+
+    void AesCtrCipher::XorKeystreamSoftware(u8 *data, size_t blockCount, Block &ctr) const {
+        Counter counter{ctr};
+        Block counterBlock, keystream;
+        for (size_t block{}; block < blockCount; block++, data += BlockSize) {
+            counter.Store(counterBlock);
+            counter.Increment();
+            mbedtls_aes_crypt_ecb(&softwareContext, MBEDTLS_AES_ENCRYPT, counterBlock.data(), keystream.data());
+            for (size_t i{}; i < BlockSize; i++)
+                data[i] ^= keystream[i];
+        }
+        counter.Store(ctr);
+    }
+
+    #if defined(__aarch64__)
+
+    /**
+     * @note This file is compiled with the cryptography extensions enabled, this function must only be called after checking for them at runtime
+     */
+    void AesCtrCipher::XorKeystreamHardware(u8 *data, size_t blockCount, Block &ctr) const {
+        std::array<uint8x16_t, RoundCount + 1> keys;
+        for (size_t round{}; round <= RoundCount; round++)
+            keys[round] = vld1q_u8(roundKeys[round].data());
+
+        Counter counter{ctr};
+        auto encryptCounter{[&]() {
+            uint8x16_t block{vcombine_u8(vreinterpret_u8_u64(vdup_n_u64(util::SwapEndianness(counter.high))), vreinterpret_u8_u64(vdup_n_u64(util::SwapEndianness(counter.low))))};
+            counter.Increment();
+            for (size_t round{}; round < RoundCount - 1; round++)
+                block = vaesmcq_u8(vaeseq_u8(block, keys[round]));
+            return veorq_u8(vaeseq_u8(block, keys[RoundCount - 1]), keys[RoundCount]);
+        }};
+
+        // Blocks are processed four at a time as they're independent, this allows the AES instructions of every block to be pipelined
+        size_t block{};
+        for (; block + 4 <= blockCount; block += 4, data += 4 * BlockSize) {
+            uint8x16_t keystream0{encryptCounter()}, keystream1{encryptCounter()}, keystream2{encryptCounter()}, keystream3{encryptCounter()};
+            vst1q_u8(data, veorq_u8(vld1q_u8(data), keystream0));
+            vst1q_u8(data + BlockSize, veorq_u8(vld1q_u8(data + BlockSize), keystream1));
+            vst1q_u8(data + (2 * BlockSize), veorq_u8(vld1q_u8(data + (2 * BlockSize)), keystream2));
+            vst1q_u8(data + (3 * BlockSize), veorq_u8(vld1q_u8(data + (3 * BlockSize)), keystream3));
+        }
+        for (; block < blockCount; block++, data += BlockSize)
+            vst1q_u8(data, veorq_u8(vld1q_u8(data), encryptCounter()));
+
+        counter.Store(ctr);
+    }
+
+    #elif defined(__AES__)
+
+    void AesCtrCipher::XorKeystreamHardware(u8 *data, size_t blockCount, Block &ctr) const {
+        __m128i keys[RoundCount + 1];
+        for (size_t round{}; round <= RoundCount; round++)
+            keys[round] = _mm_loadu_si128(reinterpret_cast<const __m128i *>(roundKeys[round].data()));
+
+        Counter counter{ctr};
+        auto encryptCounter{[&]() {
+            __m128i block{_mm_xor_si128(_mm_set_epi64x(static_cast<i64>(util::SwapEndianness(counter.low)), static_cast<i64>(util::SwapEndianness(counter.high))), keys[0])};
+            counter.Increment();
+            for (size_t round{1}; round < RoundCount; round++)
+                block = _mm_aesenc_si128(block, keys[round]);
+            return _mm_aesenclast_si128(block, keys[RoundCount]);
+        }};
+
+        size_t block{};
+        for (; block + 4 <= blockCount; block += 4, data += 4 * BlockSize) {
+            __m128i keystream[4]{encryptCounter(), encryptCounter(), encryptCounter(), encryptCounter()};
+            for (size_t i{}; i < 4; i++) {
+                auto blockData{reinterpret_cast<__m128i *>(data + (i * BlockSize))};
+                _mm_storeu_si128(blockData, _mm_xor_si128(_mm_loadu_si128(blockData), keystream[i]));
+            }
+        }
+        for (; block < blockCount; block++, data += BlockSize) {
+            auto blockData{reinterpret_cast<__m128i *>(data)};
+            _mm_storeu_si128(blockData, _mm_xor_si128(_mm_loadu_si128(blockData), encryptCounter()));
+        }
+
+        counter.Store(ctr);
+    }
+
+    #else
+
+    void AesCtrCipher::XorKeystreamHardware(u8 *data, size_t blockCount, Block &ctr) const {
+        XorKeystreamSoftware(data, blockCount, ctr);
+    }
+
+    #endif
+
+    void AesCtrCipher::XorKeystream(u8 *data, size_t blockCount, Block &ctr) const {
+        if (hasHardwareAes)
+            XorKeystreamHardware(data, blockCount, ctr);
+        else
+            XorKeystreamSoftware(data, blockCount, ctr);
+    }
+
+    void AesCtrCipher::Decrypt(span<u8> data, Block ctr, size_t blockOffset) const {
+        if (data.empty())
+            return;
+
+        // Partial blocks at the start and end are decrypted in a block-sized buffer on the stack
+        auto decryptPartial{[&](span<u8> partial, size_t offset) {
+            Block block{};
+            std::memcpy(block.data() + offset, partial.data(), partial.size());
+            XorKeystream(block.data(), 1, ctr);
+            std::memcpy(partial.data(), block.data() + offset, partial.size());
+        }};
+
+        if (blockOffset) {
+            size_t headSize{std::min(BlockSize - blockOffset, data.size())};
+            decryptPartial(data.first(headSize), blockOffset);
+            data = data.subspan(headSize);
+        }
+
+        size_t blockCount{data.size() / BlockSize};
+        XorKeystream(data.data(), blockCount, ctr);
+        data = data.subspan(blockCount * BlockSize);
+
+        if (!data.empty())
+            decryptPartial(data, 0);
+    }
+}
@@ -0,0 +1,51 @@
+// SPDX-License-Identifier: MPL-2.0
+// Copyright © 2022 Skyline Team and Contributors (https://github.com/skyline-emu/)
+
+#pragma once
+
+#include <mbedtls/aes.h>
+#include <common.h>
+
+namespace skyline::crypto {
+    /**
+     * @brief A stateless AES-128-CTR cipher, the counter is supplied with every call so a single instance can be used concurrently from any amount of threads
+     * @note The keystream is generated with the ARMv8 Cryptography Extensions or AES-NI when they're supported by the host, mbedtls is used otherwise
+     */
+    class AesCtrCipher {
+      public:
+        static constexpr size_t BlockSize{0x10};
+        using Block = std::array<u8, BlockSize>;
+
+      private:
+        static constexpr size_t RoundCount{10}; //!< The amount of rounds in AES-128
+
+        std::array<Block, RoundCount + 1> roundKeys{}; //!< The AES-128 encryption key schedule, this is only used by the hardware path
+        mutable mbedtls_aes_context softwareContext; //!< The context used by the software path, it's never modified after construction which makes it safe to share between threads
+        bool hasHardwareAes{}; //!< If the host supports AES instructions
+
+        /**
+         * @brief XORs full blocks of data in-place with the keystream starting at the supplied counter, the counter is advanced past all blocks
+         */
+        void XorKeystream(u8 *data, size_t blockCount, Block &ctr) const;
+
+        void XorKeystreamSoftware(u8 *data, size_t blockCount, Block &ctr) const;
+
+        void XorKeystreamHardware(u8 *data, size_t blockCount, Block &ctr) const;
+
+      public:
+        AesCtrCipher(const std::array<u8, BlockSize> &key);
+
+        AesCtrCipher(const AesCtrCipher &) = delete;
+
+        AesCtrCipher &operator=(const AesCtrCipher &) = delete;
+
+        ~AesCtrCipher();
+
+        /**
+         * @brief Decrypts the supplied data in-place without any heap allocations
+         * @param ctr The counter for the block containing the first byte of the data, it is incremented as a 128-bit big-endian integer for every subsequent block
+         * @param blockOffset The offset of the first byte of the data into its block
+         */
+        void Decrypt(span<u8> data, Block ctr, size_t blockOffset = 0) const;
+    };
+}
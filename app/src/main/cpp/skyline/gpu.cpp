@@ -12,7 +12,7 @@ namespace skyline::gpu {
     static vk::raii::Instance CreateInstance(const DeviceState &state, const vk::raii::Context &context) {
         vk::ApplicationInfo applicationInfo{
             .pApplicationName = "Skyline",
-            .applicationVersion = static_cast<uint32_t>(state.jvm->GetVersionCode()), // Get the application version from JNI
+            .applicationVersion = state.jvm ? static_cast<uint32_t>(state.jvm->GetVersionCode()) : 0, // Get the application version from JNI
             .pEngineName = "FTX1", // "Fast Tegra X1"
             .apiVersion = VkApiVersion,
         };
@@ -38,10 +38,12 @@ namespace skyline::gpu {
                 throw exception("Cannot find Vulkan layer: \"{}\"", requiredLayer);
         }
 
-        constexpr std::array<const char *, 3> requiredInstanceExtensions{
+        constexpr std::array requiredInstanceExtensions{
             VK_EXT_DEBUG_REPORT_EXTENSION_NAME,
             VK_KHR_SURFACE_EXTENSION_NAME,
+            #ifdef VK_USE_PLATFORM_ANDROID_KHR
             VK_KHR_ANDROID_SURFACE_EXTENSION_NAME,
+            #endif
         };
 
         auto instanceExtensions{context.enumerateInstanceExtensionProperties()};
@@ -340,6 +342,14 @@ namespace skyline::gpu {
     }
 
     static PFN_vkGetInstanceProcAddr LoadVulkanDriver(const DeviceState &state, adrenotools_gpu_mapping *mapping) {
+        if (!state.os) {
+            // There's no app to load drivers from without an OS, the system Vulkan loader is used instead
+            void *libvulkanHandle{dlopen("libvulkan.so.1", RTLD_NOW)};
+            if (!libvulkanHandle)
+                throw exception("Failed to load the system Vulkan loader: {}", dlerror());
+            return reinterpret_cast<PFN_vkGetInstanceProcAddr>(dlsym(libvulkanHandle, "vkGetInstanceProcAddr"));
+        }
+
         void *libvulkanHandle{};
 
         // If the user has selected a custom driver, try to load it
@@ -385,7 +395,7 @@ namespace skyline::gpu {
         return reinterpret_cast<PFN_vkGetInstanceProcAddr>(dlsym(libvulkanHandle, "vkGetInstanceProcAddr"));
     }
 
-    GPU::GPU(const DeviceState &state)
+    GPU::GPU(const DeviceState &state, std::shared_ptr<vfs::FileSystem> assetFileSystem, const PresenterFactory &createPresenter)
         : state(state),
           vkContext(LoadVulkanDriver(state, &adrenotoolsImportMapping)),
           vkInstance(CreateInstance(state, vkContext)),
@@ -395,25 +405,31 @@ namespace skyline::gpu {
           vkQueue(vkDevice, vkQueueFamilyIndex, 0),
           memory(*this),
           scheduler(state, *this),
-          presentation(state, *this),
+          presentation(createPresenter(state, *this)),
           texture(*this),
           buffer(*this),
           megaBufferAllocator(*this),
           descriptor(*this),
-          helperShaders(*this, state.os->assetFileSystem),
+          helperShaders(*this, std::move(assetFileSystem)),
           renderPassCache(*this),
           framebufferCache(*this),
           debugTracingBuffer(memory.AllocateBuffer(DebugTracingBufferSize)) {}
 
     void GPU::Initialise() {
-        std::string titleId{state.loader->nacp->GetSaveDataOwnerId()};
-        graphicsPipelineAssembler.emplace(*this, state.os->publicAppFilesPath + "vk_graphics_pipeline_cache/" + titleId);
+        Initialise(state.os->publicAppFilesPath, state.loader->nacp->GetSaveDataOwnerId());
+    }
+
+    void GPU::Initialise(const std::string &appFilesPath, const std::string &titleId) {
+        graphicsPipelineAssembler.emplace(*this, appFilesPath + "vk_graphics_pipeline_cache/" + titleId);
         shader.emplace(state, *this,
-                       state.os->publicAppFilesPath + "shader_replacements/" + titleId,
-                       state.os->publicAppFilesPath + "shader_dumps/" + titleId);
+                       appFilesPath + "shader_replacements/" + titleId,
+                       appFilesPath + "shader_dumps/" + titleId,
+                       *state.settings->disableShaderCache ? "" : appFilesPath + "spirv_module_cache/" + titleId);
         if (!*state.settings->disableShaderCache)
             graphicsPipelineCacheManager.emplace(state,
-                                                 state.os->publicAppFilesPath + "graphics_pipeline_cache/" + titleId);
-        graphicsPipelineManager.emplace(*this, *state.jvm);
+                                                 appFilesPath + "graphics_pipeline_cache/" + titleId);
+        graphicsPipelineManager.emplace(*this, state.jvm.get());
+        if (*state.settings->enableDecodedTextureCache)
+            decodedTextureCache.emplace(appFilesPath + "decoded_texture_cache/" + titleId);
     }
 }
@@ -3,11 +3,12 @@
 
 #pragma once
 
+#include <BS_thread_pool.hpp>
 #include <adrenotools/driver.h>
 #include "gpu/trait_manager.h"
 #include "gpu/memory_manager.h"
 #include "gpu/command_scheduler.h"
-#include "gpu/presentation_engine.h"
+#include "gpu/presenter.h"
 #include "gpu/texture_manager.h"
 #include "gpu/buffer_manager.h"
 #include "gpu/megabuffer.h"
@@ -18,6 +19,7 @@
 #include "gpu/shaders/helper_shaders.h"
 #include "gpu/cache/renderpass_cache.h"
 #include "gpu/cache/framebuffer_cache.h"
+#include "gpu/cache/decoded_texture_cache.h"
 #include "gpu/interconnect/maxwell_3d/pipeline_manager.h"
 #include "gpu/interconnect/kepler_compute/pipeline_manager.h"
 
@@ -46,9 +48,11 @@ namespace skyline::gpu {
         std::mutex queueMutex; //!< Synchronizes access to the queue as it is externally synchronized
         vk::raii::Queue vkQueue; //!< A Vulkan Queue supporting graphics and compute operations
 
+        BS::thread_pool workerPool; //!< A pool of worker threads for splitting CPU-bound GPU work (such as texture deswizzling and decoding) into independent jobs
+
         memory::MemoryManager memory;
         CommandScheduler scheduler;
-        PresentationEngine presentation;
+        std::unique_ptr<Presenter> presentation;
 
         TextureManager texture;
         BufferManager buffer;
@@ -62,6 +66,7 @@ namespace skyline::gpu {
         std::optional<GraphicsPipelineAssembler> graphicsPipelineAssembler;
         cache::RenderPassCache renderPassCache;
         cache::FramebufferCache framebufferCache;
+        std::optional<cache::DecodedTextureCache> decodedTextureCache;
 
         std::mutex channelLock;
         std::optional<PipelineCacheManager> graphicsPipelineCacheManager;
@@ -71,11 +76,24 @@ namespace skyline::gpu {
         static constexpr size_t DebugTracingBufferSize{0x80000}; //!< 512KiB
         memory::Buffer debugTracingBuffer; //!< General use buffer for debug tracing, first 4 bytes are allocated for checkpoints
 
-        GPU(const DeviceState &state);
+        using PresenterFactory = std::function<std::unique_ptr<Presenter>(const DeviceState &state, GPU &gpu)>;
+
+        /**
+         * @param assetFileSystem The filesystem that the SPIR-V of the helper shaders is loaded from
+         * @param createPresenter Creates the presenter that frames are submitted to, this is called during construction after the scheduler is created
+         */
+        GPU(const DeviceState &state, std::shared_ptr<vfs::FileSystem> assetFileSystem, const PresenterFactory &createPresenter);
 
         /**
          * @brief Should be called after loader population to initialize the per-title caches
          */
         void Initialise();
+
+        /**
+         * @brief Initializes the per-title caches without requiring a loader or OS
+         * @param appFilesPath The directory that the per-title caches are stored in, it must end with a slash
+         * @param titleId The ID of the title that the caches are for
+         */
+        void Initialise(const std::string &appFilesPath, const std::string &titleId);
     };
 }
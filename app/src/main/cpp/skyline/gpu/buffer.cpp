@@ -4,7 +4,6 @@
 #include <adrenotools/driver.h>
 #include <gpu.h>
 #include <kernel/memory.h>
-#include <kernel/types/KProcess.h>
 #include <common/trace.h>
 #include <common/settings.h>
 #include "buffer.h"
@@ -25,7 +24,7 @@ namespace skyline::gpu {
 
         // We can't just capture this in the lambda since the lambda could exceed the lifetime of the buffer
         std::weak_ptr<Buffer> weakThis{shared_from_this()};
-        trapHandle = gpu.state.nce->CreateTrap(*guest, [weakThis] {
+        trapHandle = gpu.state.traps->CreateTrap(*guest, [weakThis] {
             auto buffer{weakThis.lock()};
             if (!buffer)
                 return;
@@ -346,7 +345,7 @@ namespace skyline::gpu {
         if (dirtyState == DirtyState::GpuDirty)
             return;
 
-        gpu.state.nce->TrapRegions(*trapHandle, false); // This has to occur prior to any synchronization as it'll skip trapping
+        gpu.state.traps->TrapRegions(*trapHandle, false); // This has to occur prior to any synchronization as it'll skip trapping
 
         if (dirtyState == DirtyState::CpuDirty)
             SynchronizeHost(true); // Will transition the Buffer to Clean
@@ -369,7 +368,7 @@ namespace skyline::gpu {
     Buffer::Buffer(LinearAllocatorState<> &delegateAllocator, GPU &gpu, GuestBuffer guest, size_t id, bool direct)
         : gpu{gpu},
           guest{guest},
-          mirror{gpu.state.process->memory.CreateMirror(guest)},
+          mirror{gpu.state.guestMemory->CreateMirror(guest)},
           delegate{delegateAllocator.EmplaceUntracked<BufferDelegate>(this)},
           isDirect{direct},
           id{id},
@@ -392,7 +391,7 @@ namespace skyline::gpu {
 
     Buffer::~Buffer() {
         if (trapHandle)
-            gpu.state.nce->DeleteTrap(*trapHandle);
+            gpu.state.traps->DeleteTrap(*trapHandle);
         SynchronizeGuest(true);
         if (mirror.valid())
             munmap(mirror.data(), mirror.size());
@@ -430,7 +429,7 @@ namespace skyline::gpu {
 
     void Buffer::Invalidate() {
         if (trapHandle) {
-            gpu.state.nce->DeleteTrap(*trapHandle);
+            gpu.state.traps->DeleteTrap(*trapHandle);
             trapHandle = {};
         }
 
@@ -455,7 +454,7 @@ namespace skyline::gpu {
             AdvanceSequence(); // We are modifying GPU backing contents so advance to the next sequence
 
             if (!skipTrap)
-                gpu.state.nce->TrapRegions(*trapHandle, true); // Trap any future CPU writes to this buffer, must be done before the memcpy so that any modifications during the copy are tracked
+                gpu.state.traps->TrapRegions(*trapHandle, true); // Trap any future CPU writes to this buffer, must be done before the memcpy so that any modifications during the copy are tracked
         }
 
         std::memcpy(backing->data(), mirror.data(), mirror.size());
@@ -483,7 +482,7 @@ namespace skyline::gpu {
         }
 
         if (!skipTrap)
-            gpu.state.nce->TrapRegions(*trapHandle, true);
+            gpu.state.traps->TrapRegions(*trapHandle, true);
 
         return true;
     }
@@ -596,6 +595,14 @@ namespace skyline::gpu {
         sequenceNumber++;
     }
 
+    u32 Buffer::GetSequenceNumber() {
+        // CPU writes to directly mapped buffers don't advance the sequence and the contents of GPU dirty buffers are indeterminate on the CPU
+        if (isDirect || dirtyState == DirtyState::GpuDirty)
+            return 0;
+
+        return sequenceNumber;
+    }
+
     span<u8> Buffer::GetReadOnlyBackingSpan(bool isFirstUsage, const std::function<void()> &flushHostCallback) {
         if (!isDirect) {
             std::unique_lock lock{stateMutex};
@@ -708,6 +715,10 @@ namespace skyline::gpu {
         return backing.subspan(GetOffset(), size);
     }
 
+    u32 BufferView::GetSequenceNumber() const {
+        return delegate->GetBuffer()->GetSequenceNumber();
+    }
+
     void BufferView::CopyFrom(BufferView src, UsageTracker &usageTracker, const std::function<void()> &gpuCopyCallback) {
         if (src.size != size)
             throw exception("Copy size mismatch!");
@@ -6,7 +6,7 @@
 #include <boost/functional/hash.hpp>
 #include <common/linear_allocator.h>
 #include <common/spin_lock.h>
-#include <nce.h>
+#include <nce/trap_manager.h>
 #include <gpu/tag_allocator.h>
 #include "usage_tracker.h"
 #include "megabuffer.h"
@@ -33,6 +33,8 @@ namespace skyline::gpu {
 
         BufferBinding(MegaBufferAllocator::Allocation allocation) : buffer{allocation.buffer}, offset{allocation.offset}, size{allocation.region.size()} {}
 
+        bool operator==(const BufferBinding &) const = default;
+
         operator bool() const {
             return buffer;
         }
@@ -60,7 +62,7 @@ namespace skyline::gpu {
         std::optional<memory::Buffer> backing;
         std::optional<memory::ImportedBuffer> directBacking;
 
-        std::optional<nce::NCE::TrapHandle> trapHandle{}; //!< (Staged) The handle of the traps for the guest mappings
+        std::optional<nce::TrapManager::TrapHandle> trapHandle{}; //!< (Staged) The handle of the traps for the guest mappings
 
         enum class DirtyState {
             Clean, //!< The CPU mappings are in sync with the GPU buffer
@@ -412,6 +414,12 @@ namespace skyline::gpu {
          */
         void AdvanceSequence();
 
+        /**
+         * @return The sequence number of the buffer which identifies its current contents within an execution, this is 0 if the contents can't be tracked by sequencing as the buffer is directly mapped or GPU dirty
+         * @note The buffer **must** be locked prior to calling this
+         */
+        u32 GetSequenceNumber();
+
         /**
          * @param isFirstUsage If this is the first usage of this resource in the context as returned from LockWithTag(...)
          * @param flushHostCallback Callback to flush and execute all pending GPU work to allow for synchronisation of GPU dirty buffers
@@ -558,6 +566,12 @@ namespace skyline::gpu {
          */
         span<u8> GetReadOnlyBackingSpan(bool isFirstUsage, const std::function<void()> &flushHostCallback);
 
+        /**
+         * @note The view **must** be locked prior to calling this
+         * @note See Buffer::GetSequenceNumber
+         */
+        u32 GetSequenceNumber() const;
+
         /**
          * @brief Copies the contents of one view into this one
          * @note The src/dst views **must** be locked prior to calling this
@@ -0,0 +1,244 @@
+// SPDX-License-Identifier: MPL-2.0
+// Copyright © 2022 Skyline Team and Contributors (https://github.com/skyline-emu/)
+
+#include <charconv>
+#include <filesystem>
+#include <fstream>
+#include <lz4.h>
+#include "decoded_texture_cache.h"
+
+namespace skyline::gpu::cache {
+    struct DecodedTextureFileHeader {
+        static constexpr u32 Magic{util::MakeMagic<u32>("DTEX")}; //!< The magic value used to identify a decoded texture cache entry
+        static constexpr u32 Version{1}; //!< The version of the entry format, MUST be incremented for any format changes including changes to the output of the decoders
+
+        u32 magic{Magic};
+        u32 version{Version};
+        u64 key{}; //!< The key of the entry, this is used to guard against truncated or misnamed files
+        u64 decodedSize{}; //!< The size of the decompressed payload
+        u64 compressedSize{}; //!< The size of the LZ4-compressed payload following the header
+
+        bool IsValid() const {
+            return magic == Magic && version == Version;
+        }
+    };
+
+    std::string DecodedTextureCache::GetEntryPath(u64 key) const {
+        return fmt::format("{}/{:016X}.bin", path, key);
+    }
+
+    void DecodedTextureCache::ScanEntries() {
+        std::vector<std::pair<std::filesystem::file_time_type, Entry>> entries;
+        std::error_code error;
+        for (const auto &file : std::filesystem::directory_iterator{path, error}) {
+            auto filePath{file.path()};
+            if (filePath.extension() == ".tmp") {
+                // Temporary files are left behind if the process was killed during a write
+                std::filesystem::remove(filePath, error);
+                continue;
+            }
+
+            auto stem{filePath.stem().string()};
+            if (filePath.extension() != ".bin" || stem.size() != 16)
+                continue;
+
+            u64 key{};
+            if (std::from_chars(stem.data(), stem.data() + stem.size(), key, 16).ec != std::errc{})
+                continue;
+
+            auto size{file.file_size(error)};
+            auto time{file.last_write_time(error)};
+            if (!error)
+                entries.emplace_back(time, Entry{key, size});
+        }
+
+        std::sort(entries.begin(), entries.end(), [](const auto &a, const auto &b) { return a.first > b.first; });
+        for (const auto &[time, entry] : entries) {
+            index.emplace(entry.key, lruList.insert(lruList.end(), entry));
+            totalSize += entry.size;
+        }
+    }
+
+    void DecodedTextureCache::WriteEntry(u64 key, span<u8> decoded) {
+        std::vector<char> compressed(static_cast<size_t>(LZ4_compressBound(static_cast<int>(decoded.size_bytes()))));
+        auto compressedSize{LZ4_compress_default(reinterpret_cast<const char *>(decoded.data()), compressed.data(), static_cast<int>(decoded.size_bytes()), static_cast<int>(compressed.size()))};
+        if (compressedSize <= 0) {
+            Logger::Warn("Failed to compress decoded texture cache entry: {:016X}", key);
+            return;
+        }
+
+        DecodedTextureFileHeader header{
+            .key = key,
+            .decodedSize = decoded.size_bytes(),
+            .compressedSize = static_cast<u64>(compressedSize),
+        };
+
+        // The entry is written to a temporary file which is then renamed over the final path, this ensures a concurrent load never observes a partially written entry
+        auto entryPath{GetEntryPath(key)};
+        auto temporaryPath{fmt::format("{}.tmp", entryPath)};
+        {
+            std::ofstream stream{temporaryPath, std::ios::binary | std::ios::trunc};
+            stream.write(reinterpret_cast<const char *>(&header), sizeof(DecodedTextureFileHeader));
+            stream.write(compressed.data(), compressedSize);
+            if (stream.fail()) {
+                Logger::Warn("Failed to write decoded texture cache entry: {:016X}", key);
+                stream.close();
+                std::filesystem::remove(temporaryPath);
+                return;
+            }
+        }
+
+        std::error_code error;
+        std::filesystem::rename(temporaryPath, entryPath, error);
+        if (error) {
+            std::filesystem::remove(temporaryPath, error);
+            return;
+        }
+
+        std::vector<u64> evictedKeys;
+        {
+            std::scoped_lock lock{indexMutex};
+            u64 size{sizeof(DecodedTextureFileHeader) + static_cast<u64>(compressedSize)};
+            if (auto it{index.find(key)}; it != index.end()) {
+                totalSize -= it->second->size;
+                lruList.erase(it->second);
+            }
+            index[key] = lruList.insert(lruList.begin(), Entry{key, size});
+            totalSize += size;
+
+            // Entries are evicted from the index first so they're never loaded while being removed
+            while (totalSize > MaxCacheSize && lruList.size() > 1) {
+                auto &entry{lruList.back()};
+                evictedKeys.push_back(entry.key);
+                totalSize -= entry.size;
+                index.erase(entry.key);
+                lruList.pop_back();
+            }
+        }
+
+        for (auto evictedKey : evictedKeys)
+            std::filesystem::remove(GetEntryPath(evictedKey), error);
+    }
+
+    void DecodedTextureCache::Run() {
+        if (int result{pthread_setname_np(pthread_self(), "Sky-TexCache")})
+            Logger::Warn("Failed to set the thread name: {}", strerror(result));
+
+        while (true) {
+            std::unique_lock lock{writeMutex};
+            writeCondition.wait(lock, [this] { return !writeQueue.empty() || exiting; });
+            if (writeQueue.empty())
+                return; // The queue is always drained prior to exiting so no entries are lost
+
+            auto request{std::move(writeQueue.front())};
+            writeQueue.pop();
+            queuedSize -= request.decoded.size();
+            lock.unlock();
+
+            try {
+                if (request.decoded.empty()) {
+                    // Updating the modification time persists the LRU position of the entry across runs
+                    std::error_code error;
+                    std::filesystem::last_write_time(GetEntryPath(request.key), std::filesystem::file_time_type::clock::now(), error);
+                } else {
+                    WriteEntry(request.key, request.decoded);
+                }
+            } catch (const std::exception &e) {
+                Logger::Warn("Failed to write decoded texture cache entry {:016X}: {}", request.key, e.what());
+            }
+
+            if (!request.decoded.empty()) {
+                std::scoped_lock indexLock{indexMutex};
+                pendingKeys.erase(request.key);
+            }
+        }
+    }
+
+    DecodedTextureCache::DecodedTextureCache(const std::string &path) : path{path} {
+        std::filesystem::create_directories(path);
+        ScanEntries();
+        writerThread = std::thread(&DecodedTextureCache::Run, this);
+    }
+
+    DecodedTextureCache::~DecodedTextureCache() {
+        {
+            std::scoped_lock lock{writeMutex};
+            exiting = true;
+        }
+        writeCondition.notify_one();
+        writerThread.join();
+    }
+
+    u64 DecodedTextureCache::GetKey(span<u8> encoded, vk::Format format, u32 width, u32 height) {
+        struct {
+            vk::Format format;
+            u32 width;
+            u32 height;
+        } parameters{format, width, height};
+        return XXH64(encoded.data(), encoded.size_bytes(), XXH64(&parameters, sizeof(parameters), 0));
+    }
+
+    bool DecodedTextureCache::Load(u64 key, span<u8> decoded) {
+        {
+            std::scoped_lock lock{indexMutex};
+            auto it{index.find(key)};
+            if (it == index.end())
+                return false;
+
+            lruList.splice(lruList.begin(), lruList, it->second);
+        }
+
+        {
+            std::scoped_lock lock{writeMutex};
+            writeQueue.push(WriteRequest{key, {}});
+        }
+        writeCondition.notify_one();
+
+        std::ifstream stream{GetEntryPath(key), std::ios::binary};
+        if (stream.fail())
+            return false;
+
+        DecodedTextureFileHeader header{};
+        stream.read(reinterpret_cast<char *>(&header), sizeof(DecodedTextureFileHeader));
+        if (stream.fail() || !header.IsValid() || header.key != key || header.decodedSize != decoded.size_bytes() || header.compressedSize > static_cast<u64>(LZ4_compressBound(static_cast<int>(decoded.size_bytes()))))
+            return false;
+
+        std::vector<char> compressed(header.compressedSize);
+        stream.read(compressed.data(), static_cast<std::streamsize>(compressed.size()));
+        if (stream.fail())
+            return false;
+
+        auto decompressedSize{LZ4_decompress_safe(compressed.data(), reinterpret_cast<char *>(decoded.data()), static_cast<int>(compressed.size()), static_cast<int>(decoded.size_bytes()))};
+        if (decompressedSize != static_cast<int>(decoded.size_bytes())) {
+            Logger::Warn("Discarding corrupt decoded texture cache entry: {:016X}", key);
+            return false;
+        }
+
+        return true;
+    }
+
+    void DecodedTextureCache::Store(u64 key, span<u8> decoded) {
+        if (decoded.empty())
+            return;
+
+        {
+            std::scoped_lock lock{indexMutex};
+            if (index.contains(key) || !pendingKeys.emplace(key).second)
+                return;
+        }
+
+        {
+            std::scoped_lock lock{writeMutex};
+            if (queuedSize + decoded.size() > MaxQueuedSize) {
+                // The writer thread can't keep up, dropping the entry only means it'll be decoded again on the next run
+                std::scoped_lock indexLock{indexMutex};
+                pendingKeys.erase(key);
+                return;
+            }
+
+            queuedSize += decoded.size();
+            writeQueue.push(WriteRequest{key, std::vector<u8>(decoded.begin(), decoded.end())});
+        }
+        writeCondition.notify_one();
+    }
+}
@@ -0,0 +1,93 @@
+// SPDX-License-Identifier: MPL-2.0
+// Copyright © 2022 Skyline Team and Contributors (https://github.com/skyline-emu/)
+
+#pragma once
+
+#include <condition_variable>
+#include <list>
+#include <queue>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+#include <vulkan/vulkan.hpp>
+#include <common.h>
+
+namespace skyline::gpu::cache {
+    /**
+     * @brief A disk cache of texture levels that were decoded on the CPU (such as ASTC on hosts without native support), this allows skipping the decode on subsequent runs
+     * @note Every entry is stored as an individual LZ4-compressed file named after its key, entries are written atomically so they can be loaded and stored concurrently
+     * @note Entries are compressed and written on a dedicated thread, the cache is bounded to MaxCacheSize bytes on disk with the least recently used entries being evicted past it
+     */
+    class DecodedTextureCache {
+      private:
+        static constexpr u64 MaxCacheSize{512 * 1024 * 1024}; //!< The maximum total size of all entries on disk (512MiB)
+        static constexpr size_t MaxQueuedSize{64 * 1024 * 1024}; //!< The maximum total size of decoded data queued for writing (64MiB), any stores past this are dropped
+
+        std::string path; //!< The directory containing all cache entries
+
+        /**
+         * @brief An entry that exists on disk
+         */
+        struct Entry {
+            u64 key;
+            u64 size; //!< The size of the entry's file
+        };
+
+        std::mutex indexMutex; //!< Synchronizes access to the index and the pending keys
+        std::list<Entry> lruList; //!< All entries on disk ordered from the most to the least recently used
+        std::unordered_map<u64, std::list<Entry>::iterator> index; //!< A map from the key of every entry on disk to its position in the LRU list
+        std::unordered_set<u64> pendingKeys; //!< The keys of all entries queued for writing, these are used to avoid queuing the same entry multiple times
+        u64 totalSize{}; //!< The total size of all entries on disk
+
+        /**
+         * @brief A request for the writer thread, an empty request only updates the modification time of an existing entry to persist its LRU position
+         */
+        struct WriteRequest {
+            u64 key;
+            std::vector<u8> decoded;
+        };
+
+        std::thread writerThread;
+        std::mutex writeMutex; //!< Synchronizes access to the write queue
+        std::condition_variable writeCondition; //!< Notifies the writer thread of new requests or that it should exit
+        std::queue<WriteRequest> writeQueue;
+        size_t queuedSize{}; //!< The total size of all decoded data in the write queue
+        bool exiting{}; //!< If the writer thread should exit after draining the write queue
+
+        std::string GetEntryPath(u64 key) const;
+
+        /**
+         * @brief Builds the index from all entries on disk with their modification time determining their LRU position
+         */
+        void ScanEntries();
+
+        /**
+         * @brief Compresses and writes an entry to disk, evicting the least recently used entries if the cache exceeds its size budget
+         */
+        void WriteEntry(u64 key, span<u8> decoded);
+
+        void Run();
+
+      public:
+        DecodedTextureCache(const std::string &path);
+
+        ~DecodedTextureCache();
+
+        /**
+         * @return A key identifying the decoded contents of the supplied encoded data
+         */
+        static u64 GetKey(span<u8> encoded, vk::Format format, u32 width, u32 height);
+
+        /**
+         * @brief Loads the decoded contents of an entry into the supplied buffer
+         * @return If the entry exists and its decoded size matches the size of the buffer
+         * @note Entries which aren't on disk are looked up in memory without any file I/O
+         */
+        bool Load(u64 key, span<u8> decoded);
+
+        /**
+         * @brief Queues an entry to be written to the cache, the decoded contents are copied so the supplied buffer can be reused immediately
+         */
+        void Store(u64 key, span<u8> decoded);
+    };
+}
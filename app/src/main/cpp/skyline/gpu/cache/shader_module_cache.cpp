@@ -0,0 +1,256 @@
+// SPDX-License-Identifier: MPL-2.0
+// Copyright © 2022 Skyline Team and Contributors (https://github.com/skyline-emu/)
+
+#include <filesystem>
+#include <lz4.h>
+#include "shader_module_cache.h"
+
+namespace skyline::gpu::cache {
+    static_assert(std::is_trivially_copyable_v<Shader::Backend::Bindings>, "Bindings are stored in the cache file as raw bytes");
+
+    struct ShaderModuleCacheFileHeader {
+        static constexpr u32 Magic{util::MakeMagic<u32>("SPVC")}; //!< The magic value used to identify a SPIR-V module cache file
+        static constexpr u32 Version{1}; //!< The version of the file format, MUST be incremented for any format changes
+
+        u32 magic{Magic};
+        u32 version{Version};
+        u32 compilerVersion{ShaderModuleCache::CompilerVersion};
+        u32 _pad_{};
+        u64 fingerprint{};
+
+        bool IsValid(u64 expectedFingerprint) const {
+            return magic == Magic && version == Version && compilerVersion == ShaderModuleCache::CompilerVersion && fingerprint == expectedFingerprint;
+        }
+    };
+
+    /**
+     * @brief The header of every entry in the cache file, this is followed by the bindings and the LZ4-compressed SPIR-V
+     * @note Entries are only ever appended, if there are multiple entries with the same key then the last one takes precedence
+     */
+    struct ShaderModuleCacheEntryHeader {
+        static constexpr u32 MaxSize{16 * 1024 * 1024}; //!< The maximum size of the SPIR-V in an entry, this is used to reject corrupted entries before allocating any memory for them
+
+        u64 key;
+        u64 checksum; //!< The XXH64 hash of the bindings and the decompressed SPIR-V
+        u32 size; //!< The size of the decompressed SPIR-V in bytes
+        u32 compressedSize;
+
+        bool IsValid() const {
+            return size && size <= MaxSize && size % sizeof(u32) == 0 && compressedSize && compressedSize <= static_cast<u32>(LZ4_compressBound(static_cast<int>(size)));
+        }
+    };
+
+    /**
+     * @return The size of an entry with the supplied compressed SPIR-V size in the cache file
+     */
+    static u64 GetRecordSize(size_t compressedSize) {
+        return sizeof(ShaderModuleCacheEntryHeader) + sizeof(Shader::Backend::Bindings) + compressedSize;
+    }
+
+    static u64 GetChecksum(u64 key, span<const u32> spirv, const Shader::Backend::Bindings &bindings) {
+        return XXH64(spirv.data(), spirv.size_bytes(), XXH64(&bindings, sizeof(bindings), key));
+    }
+
+    size_t ShaderModuleCache::ReadEntries(u64 fingerprint) {
+        std::ifstream input{path, std::ios::binary | std::ios::ate};
+        if (input.fail())
+            return 0;
+
+        std::vector<u8> file(static_cast<size_t>(input.tellg()));
+        input.seekg(0, std::ios::beg);
+        input.read(reinterpret_cast<char *>(file.data()), static_cast<std::streamsize>(file.size()));
+        if (input.fail() || file.size() < sizeof(ShaderModuleCacheFileHeader))
+            return 0;
+
+        ShaderModuleCacheFileHeader header;
+        std::memcpy(&header, file.data(), sizeof(ShaderModuleCacheFileHeader));
+        if (!header.IsValid(fingerprint)) {
+            Logger::Info("Discarding SPIR-V module cache as it was created by a different shader compiler or configuration");
+            return 0;
+        }
+
+        size_t offset{sizeof(ShaderModuleCacheFileHeader)};
+        while (file.size() - offset >= sizeof(ShaderModuleCacheEntryHeader) + sizeof(Shader::Backend::Bindings)) {
+            ShaderModuleCacheEntryHeader entryHeader;
+            std::memcpy(&entryHeader, file.data() + offset, sizeof(ShaderModuleCacheEntryHeader));
+            size_t dataOffset{offset + sizeof(ShaderModuleCacheEntryHeader) + sizeof(Shader::Backend::Bindings)};
+            if (!entryHeader.IsValid() || file.size() - dataOffset < entryHeader.compressedSize)
+                break;
+
+            Entry entry{
+                .checksum = entryHeader.checksum,
+                .size = entryHeader.size,
+                .compressed = std::vector<char>(file.begin() + static_cast<ssize_t>(dataOffset), file.begin() + static_cast<ssize_t>(dataOffset + entryHeader.compressedSize)),
+            };
+            std::memcpy(&entry.bindings, file.data() + offset + sizeof(ShaderModuleCacheEntryHeader), sizeof(Shader::Backend::Bindings));
+            InsertEntry(entryHeader.key, std::move(entry));
+
+            offset = dataOffset + entryHeader.compressedSize;
+        }
+
+        if (offset != file.size())
+            Logger::Warn("Discarding {} bytes of truncated or corrupted entries at the end of the SPIR-V module cache", file.size() - offset);
+
+        return offset;
+    }
+
+    void ShaderModuleCache::InsertEntry(u64 key, Entry &&entry) {
+        if (auto it{entries.find(key)}; it != entries.end()) {
+            liveSize -= GetRecordSize(it->second.compressed.size());
+            insertionOrder.erase(it->second.sequence);
+            entries.erase(it);
+        }
+
+        entry.sequence = nextSequence++;
+        liveSize += GetRecordSize(entry.compressed.size());
+        insertionOrder.emplace(entry.sequence, key);
+        entries.emplace(key, std::move(entry));
+
+        // Shaders from prior versions of a title or ones that are no longer used are never looked up again, the oldest entries are evicted to bound the size of the cache
+        while (liveSize > MaxCacheSize && insertionOrder.size() > 1) {
+            auto oldest{insertionOrder.begin()};
+            auto it{entries.find(oldest->second)};
+            liveSize -= GetRecordSize(it->second.compressed.size());
+            entries.erase(it);
+            insertionOrder.erase(oldest);
+        }
+    }
+
+    bool ShaderModuleCache::Compact(u64 fingerprint) {
+        // The compacted file is written separately and renamed over the cache file, an interrupted compaction leaves the cache file intact
+        auto compactionPath{path + ".compaction"};
+        {
+            std::ofstream compactStream{compactionPath, std::ios::binary | std::ios::trunc};
+            ShaderModuleCacheFileHeader header{.fingerprint = fingerprint};
+            compactStream.write(reinterpret_cast<const char *>(&header), sizeof(ShaderModuleCacheFileHeader));
+
+            // Entries are written in their order of insertion so the oldest entries remain the first to be evicted on subsequent runs
+            for (auto [sequence, key] : insertionOrder) {
+                const auto &entry{entries.at(key)};
+                ShaderModuleCacheEntryHeader entryHeader{
+                    .key = key,
+                    .checksum = entry.checksum,
+                    .size = entry.size,
+                    .compressedSize = static_cast<u32>(entry.compressed.size()),
+                };
+                compactStream.write(reinterpret_cast<const char *>(&entryHeader), sizeof(ShaderModuleCacheEntryHeader));
+                compactStream.write(reinterpret_cast<const char *>(&entry.bindings), sizeof(Shader::Backend::Bindings));
+                compactStream.write(entry.compressed.data(), static_cast<std::streamsize>(entry.compressed.size()));
+            }
+
+            compactStream.flush();
+            if (compactStream.fail()) {
+                Logger::Warn("Failed to compact the SPIR-V module cache");
+                compactStream.close();
+                std::filesystem::remove(compactionPath);
+                return false;
+            }
+        }
+
+        std::error_code error;
+        std::filesystem::rename(compactionPath, path, error);
+        if (error) {
+            Logger::Warn("Failed to replace the SPIR-V module cache with its compacted version: {}", error.message());
+            std::filesystem::remove(compactionPath, error);
+            return false;
+        }
+
+        return true;
+    }
+
+    ShaderModuleCache::ShaderModuleCache(const std::string &path, u64 fingerprint) : path{path} {
+        size_t validSize{ReadEntries(fingerprint)};
+
+        // Superseded and evicted entries are only removed from the file by rewriting it, this is only done once enough dead data has accumulated
+        u64 fileLiveSize{sizeof(ShaderModuleCacheFileHeader) + liveSize};
+        if (validSize && validSize - fileLiveSize > std::max(MinCompactionSize, liveSize / 4) && Compact(fingerprint)) {
+            Logger::Info("Compacted the SPIR-V module cache, reclaimed 0x{:X} bytes", validSize - fileLiveSize);
+            validSize = fileLiveSize;
+        }
+
+        if (validSize) {
+            // Any invalid data at the end of the file is removed so new entries are appended directly after the last valid entry
+            std::error_code error;
+            std::filesystem::resize_file(path, validSize, error);
+            if (error)
+                Logger::Warn("Failed to truncate the SPIR-V module cache: {}", error.message());
+
+            stream.open(path, std::ios::binary | std::ios::app);
+        } else {
+            entries.clear();
+            insertionOrder.clear();
+            liveSize = 0;
+            std::filesystem::create_directories(std::filesystem::path{path}.parent_path());
+            stream.open(path, std::ios::binary | std::ios::trunc);
+
+            ShaderModuleCacheFileHeader header{.fingerprint = fingerprint};
+            stream.write(reinterpret_cast<const char *>(&header), sizeof(ShaderModuleCacheFileHeader));
+        }
+
+        if (stream.fail())
+            Logger::Warn("Failed to open the SPIR-V module cache for writing, new shaders will not be cached");
+        else
+            Logger::Info("Loaded {} SPIR-V modules from the SPIR-V module cache", entries.size());
+    }
+
+    bool ShaderModuleCache::Load(u64 key, std::vector<u32> &spirv, Shader::Backend::Bindings &bindings) {
+        {
+            std::shared_lock lock{mutex};
+            auto it{entries.find(key)};
+            if (it != entries.end()) {
+                const auto &entry{it->second};
+                std::vector<u32> decompressed(entry.size / sizeof(u32));
+                auto decompressedSize{LZ4_decompress_safe(entry.compressed.data(), reinterpret_cast<char *>(decompressed.data()), static_cast<int>(entry.compressed.size()), static_cast<int>(entry.size))};
+                if (decompressedSize == static_cast<int>(entry.size) && GetChecksum(key, decompressed, entry.bindings) == entry.checksum) {
+                    spirv = std::move(decompressed);
+                    bindings = entry.bindings;
+                    hitCount.fetch_add(1, std::memory_order_relaxed);
+                    return true;
+                }
+
+                // The entry will be replaced by the caller storing the newly translated shader
+                Logger::Warn("Discarding corrupted SPIR-V module cache entry: {:016X}", key);
+            }
+        }
+
+        missCount.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+
+    void ShaderModuleCache::Store(u64 key, span<const u32> spirv, const Shader::Backend::Bindings &bindings) {
+        if (spirv.empty() || spirv.size_bytes() > ShaderModuleCacheEntryHeader::MaxSize)
+            return;
+
+        u64 checksum{GetChecksum(key, spirv, bindings)};
+        std::vector<char> compressed(static_cast<size_t>(LZ4_compressBound(static_cast<int>(spirv.size_bytes()))));
+        auto compressedSize{LZ4_compress_default(reinterpret_cast<const char *>(spirv.data()), compressed.data(), static_cast<int>(spirv.size_bytes()), static_cast<int>(compressed.size()))};
+        if (compressedSize <= 0) {
+            Logger::Warn("Failed to compress SPIR-V module cache entry: {:016X}", key);
+            return;
+        }
+        compressed.resize(static_cast<size_t>(compressedSize));
+
+        ShaderModuleCacheEntryHeader entryHeader{
+            .key = key,
+            .checksum = checksum,
+            .size = static_cast<u32>(spirv.size_bytes()),
+            .compressedSize = static_cast<u32>(compressedSize),
+        };
+
+        std::unique_lock lock{mutex};
+        auto it{entries.find(key)};
+        if (it != entries.end() && it->second.checksum == checksum)
+            return; // Another thread raced us to translate and store the same shader
+
+        if (stream.good()) {
+            stream.write(reinterpret_cast<const char *>(&entryHeader), sizeof(ShaderModuleCacheEntryHeader));
+            stream.write(reinterpret_cast<const char *>(&bindings), sizeof(Shader::Backend::Bindings));
+            stream.write(compressed.data(), compressedSize);
+            stream.flush();
+            if (stream.fail())
+                Logger::Warn("Failed to write to the SPIR-V module cache, new shaders will not be cached");
+        }
+
+        InsertEntry(key, Entry{bindings, checksum, entryHeader.size, std::move(compressed)});
+    }
+}
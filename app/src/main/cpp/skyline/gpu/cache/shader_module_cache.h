@@ -0,0 +1,87 @@
+// SPDX-License-Identifier: MPL-2.0
+// Copyright © 2022 Skyline Team and Contributors (https://github.com/skyline-emu/)
+
+#pragma once
+
+#include <fstream>
+#include <map>
+#include <unordered_map>
+#include <shader_compiler/backend/bindings.h>
+#include <common.h>
+
+namespace skyline::gpu::cache {
+    /**
+     * @brief A persistent cache of SPIR-V emitted by the shader compiler, this allows skipping the backend passes and SPIR-V emission for shaders that were translated on a prior run
+     * @note The entire cache is a single append-only file which is read into memory on construction, all entries are tied to a fingerprint of the shader compiler and its configuration and are discarded if it changes
+     * @note The cache is bounded to MaxCacheSize bytes with the oldest entries being evicted past it, superseded and evicted entries are removed from the file by compacting it on construction
+     * @note All methods are thread-safe
+     */
+    class ShaderModuleCache {
+      public:
+        static constexpr u32 CompilerVersion{1}; //!< A version for the output of the shader compiler, this MUST be incremented whenever the shader compiler is updated or modified in a way that may change its output
+
+      private:
+        static constexpr u64 MaxCacheSize{128 * 1024 * 1024}; //!< The maximum total size of all live entries in the cache file (128MiB)
+        static constexpr u64 MinCompactionSize{1024 * 1024}; //!< The minimum amount of dead data in the cache file for it to be compacted, the file is also only compacted when the dead data exceeds a quarter of the live data
+
+        struct Entry {
+            Shader::Backend::Bindings bindings; //!< The state of the bindings after emitting the SPIR-V
+            u64 checksum; //!< The XXH64 hash of the decompressed SPIR-V
+            u32 size; //!< The size of the decompressed SPIR-V in bytes
+            std::vector<char> compressed; //!< The LZ4-compressed SPIR-V
+            u64 sequence; //!< The position of the entry in the order of insertion, older entries are evicted first
+        };
+
+        std::string path;
+        std::shared_mutex mutex; //!< Protects the entries and the output stream, entries are only read under a shared lock
+        std::unordered_map<u64, Entry> entries;
+        std::map<u64, u64> insertionOrder; //!< A map from the sequence number of every entry to its key
+        u64 nextSequence{};
+        u64 liveSize{}; //!< The total size of all entries in the cache file including their headers
+        std::ofstream stream; //!< The stream used to append new entries to the cache file
+
+        std::atomic<u64> hitCount{}, missCount{};
+
+        /**
+         * @brief Reads all valid entries from the cache file
+         * @return The offset of the end of the last valid entry, or 0 if the file is missing or doesn't match the supplied fingerprint
+         */
+        size_t ReadEntries(u64 fingerprint);
+
+        /**
+         * @brief Inserts an entry or replaces an existing one with the same key, evicting the oldest entries if the cache exceeds its size budget
+         */
+        void InsertEntry(u64 key, Entry &&entry);
+
+        /**
+         * @brief Rewrites the cache file with only the live entries, this is done into a separate file which is renamed over the cache file
+         * @return If the cache file was rewritten successfully
+         */
+        bool Compact(u64 fingerprint);
+
+      public:
+        /**
+         * @param fingerprint A hash of all configuration that affects the output of the shader compiler (such as the profile), the cache is invalidated when this changes
+         */
+        ShaderModuleCache(const std::string &path, u64 fingerprint);
+
+        /**
+         * @brief Looks up the SPIR-V for the supplied key and writes it alongside the bindings after it was emitted into the supplied arguments
+         * @return If the entry was found, the arguments are left untouched if not
+         */
+        bool Load(u64 key, std::vector<u32> &spirv, Shader::Backend::Bindings &bindings);
+
+        /**
+         * @brief Inserts the SPIR-V for the supplied key into the cache and appends it to the cache file
+         */
+        void Store(u64 key, span<const u32> spirv, const Shader::Backend::Bindings &bindings);
+
+        u64 GetHitCount() const {
+            return hitCount.load(std::memory_order_relaxed);
+        }
+
+        u64 GetMissCount() const {
+            return missCount.load(std::memory_order_relaxed);
+        }
+    };
+}
@@ -2,73 +2,98 @@
 // Copyright © 2021 Skyline Team and Contributors (https://github.com/skyline-emu/)
 
 #include <gpu.h>
-#include <soc/gm20b/engines/maxwell/types.h>
 #include "descriptor_allocator.h"
 
 namespace skyline::gpu {
-    DescriptorAllocator::DescriptorSetSlot::DescriptorSetSlot(vk::DescriptorSet descriptorSet) : descriptorSet{descriptorSet} {}
+    DescriptorAllocator::DescriptorPool::DescriptorPool(const vk::raii::Device &device, const vk::DescriptorPoolCreateInfo &createInfo, u32 descriptorMultiplier) : vk::raii::DescriptorPool{device, createInfo}, descriptorMultiplier{descriptorMultiplier} {}
 
-    DescriptorAllocator::DescriptorSetSlot::DescriptorSetSlot(DescriptorAllocator::DescriptorSetSlot &&other) : descriptorSet{other.descriptorSet} {
-        other.descriptorSet = nullptr;
-    }
+    std::shared_ptr<DescriptorAllocator::DescriptorPool> DescriptorAllocator::AcquirePool() {
+        u32 descriptorMultiplier{recycler->descriptorMultiplier.load(std::memory_order_relaxed)};
 
-    DescriptorAllocator::DescriptorPool::DescriptorPool(const vk::raii::Device &device, const vk::DescriptorPoolCreateInfo &createInfo) : vk::raii::DescriptorPool{device, createInfo}, freeSetCount{createInfo.maxSets} {}
-
-    void DescriptorAllocator::AllocateDescriptorPool() {
-        namespace maxwell3d = soc::gm20b::engine::maxwell3d::type; // We use Maxwell3D as reference for base descriptor counts
-        using DescriptorSizes = std::array<vk::DescriptorPoolSize, 6>;
-
-        constexpr DescriptorSizes BaseDescriptorSizes{
-            vk::DescriptorPoolSize{
-                .descriptorCount = 512,
-                .type = vk::DescriptorType::eUniformBuffer,
-            },
-            vk::DescriptorPoolSize{
-                .descriptorCount = 64,
-                .type = vk::DescriptorType::eStorageBuffer,
-            },
-            vk::DescriptorPoolSize{
-                .descriptorCount = 256,
-                .type = vk::DescriptorType::eCombinedImageSampler,
-            },
-            vk::DescriptorPoolSize{
-                .descriptorCount = 16,
-                .type = vk::DescriptorType::eStorageImage,
-            },
-            vk::DescriptorPoolSize{
-                .descriptorCount = 4,
-                .type = vk::DescriptorType::eUniformTexelBuffer,
-            },
-            vk::DescriptorPoolSize{
-                .descriptorCount = 4,
-                .type = vk::DescriptorType::eStorageTexelBuffer,
-            } //!< Approximated descriptor counts based off empirical testing, the total amount will grow in these ratios
-        };
+        std::unique_ptr<DescriptorPool> pool;
+        {
+            std::scoped_lock lock{recycler->mutex};
+            while (!pool && !recycler->freePools.empty()) {
+                pool = std::move(recycler->freePools.back());
+                recycler->freePools.pop_back();
 
-        DescriptorSizes descriptorSizes{BaseDescriptorSizes};
-        for (auto &descriptorSize : descriptorSizes)
-            descriptorSize.descriptorCount *= descriptorMultiplier;
+                if (pool->descriptorMultiplier != descriptorMultiplier)
+                    pool.reset(); // Pools that were recycled prior to the multiplier being increased are too small for current demands
+            }
+        }
 
-        pool = std::make_shared<DescriptorPool>(gpu.vkDevice, vk::DescriptorPoolCreateInfo{
-            .maxSets = descriptorSetCount,
-            .pPoolSizes = descriptorSizes.data(),
-            .poolSizeCount = descriptorSizes.size(),
-        });
+        if (!pool) {
+            using DescriptorSizes = std::array<vk::DescriptorPoolSize, 6>;
+
+            constexpr DescriptorSizes BaseDescriptorSizes{
+                vk::DescriptorPoolSize{
+                    .descriptorCount = 2048,
+                    .type = vk::DescriptorType::eUniformBuffer,
+                },
+                vk::DescriptorPoolSize{
+                    .descriptorCount = 256,
+                    .type = vk::DescriptorType::eStorageBuffer,
+                },
+                vk::DescriptorPoolSize{
+                    .descriptorCount = 1024,
+                    .type = vk::DescriptorType::eCombinedImageSampler,
+                },
+                vk::DescriptorPoolSize{
+                    .descriptorCount = 64,
+                    .type = vk::DescriptorType::eStorageImage,
+                },
+                vk::DescriptorPoolSize{
+                    .descriptorCount = 16,
+                    .type = vk::DescriptorType::eUniformTexelBuffer,
+                },
+                vk::DescriptorPoolSize{
+                    .descriptorCount = 16,
+                    .type = vk::DescriptorType::eStorageTexelBuffer,
+                } //!< Approximated descriptor counts for PoolSetCount sets based off empirical testing, the total amount will grow in these ratios
+            };
+
+            DescriptorSizes descriptorSizes{BaseDescriptorSizes};
+            for (auto &descriptorSize : descriptorSizes)
+                descriptorSize.descriptorCount *= descriptorMultiplier;
+
+            // Sets are never freed individually so the pool is created without eFreeDescriptorSet, this allows the driver to use a linear allocator
+            pool = std::make_unique<DescriptorPool>(gpu.vkDevice, vk::DescriptorPoolCreateInfo{
+                .maxSets = PoolSetCount,
+                .pPoolSizes = descriptorSizes.data(),
+                .poolSizeCount = descriptorSizes.size(),
+            }, descriptorMultiplier);
+
+            TRACE_COUNTER("gpu", "Descriptor Pools", poolCount.fetch_add(1, std::memory_order_relaxed) + 1);
+        }
+
+        return std::shared_ptr<DescriptorPool>{pool.release(), [weakRecycler = std::weak_ptr{recycler}](DescriptorPool *pool) {
+            auto recycler{weakRecycler.lock()};
+            if (!recycler || pool->descriptorMultiplier != recycler->descriptorMultiplier.load(std::memory_order_relaxed)) {
+                // Pools which are too small for current demands or outlived the allocator aren't recycled
+                delete pool;
+                return;
+            }
+
+            // All sets allocated from the pool have been released so no other thread can be accessing it
+            pool->reset();
+            pool->allocatedSetCount = 0;
 
-        pool->freeSetCount = descriptorSetCount;
+            std::scoped_lock lock{recycler->mutex};
+            recycler->freePools.emplace_back(pool);
+        }};
     }
 
-    vk::ResultValue<vk::DescriptorSet> DescriptorAllocator::AllocateVkDescriptorSet(vk::DescriptorSetLayout layout) {
+    vk::ResultValue<vk::DescriptorSet> DescriptorAllocator::AllocateVkDescriptorSet(DescriptorPool &pool, vk::DescriptorSetLayout layout) {
         vk::DescriptorSetAllocateInfo allocateInfo{
-            .descriptorPool = **pool,
+            .descriptorPool = *pool,
             .pSetLayouts = &layout,
             .descriptorSetCount = 1,
         };
         vk::DescriptorSet descriptorSet{};
 
         auto result{(*gpu.vkDevice).allocateDescriptorSets(&allocateInfo, &descriptorSet, *gpu.vkDevice.getDispatcher())};
-        if (pool->freeSetCount > 0)
-            pool->freeSetCount--;
+        if (result == vk::Result::eSuccess)
+            pool.allocatedSetCount++;
 
         return vk::createResultValue(result, descriptorSet, __builtin_FUNCTION(), {
             vk::Result::eSuccess,
@@ -77,83 +102,32 @@ namespace skyline::gpu {
         });
     }
 
-    DescriptorAllocator::ActiveDescriptorSet::ActiveDescriptorSet(std::shared_ptr<DescriptorPool> pPool, DescriptorSetSlot *slot) : pool{std::move(pPool)}, slot{slot} {}
+    DescriptorAllocator::ActiveDescriptorSet::ActiveDescriptorSet(std::shared_ptr<DescriptorPool> pPool, vk::DescriptorSet descriptorSet) : pool{std::move(pPool)}, descriptorSet{descriptorSet} {}
 
-    DescriptorAllocator::ActiveDescriptorSet::ActiveDescriptorSet(DescriptorAllocator::ActiveDescriptorSet &&other) noexcept {
-        pool = std::move(other.pool);
-        slot = std::exchange(other.slot, nullptr);
-    }
-
-    DescriptorAllocator::ActiveDescriptorSet::~ActiveDescriptorSet() {
-        if (slot)
-            slot->active.clear(std::memory_order_release);
-    }
-
-    DescriptorAllocator::DescriptorAllocator(GPU &gpu) : gpu{gpu} {
-        AllocateDescriptorPool();
-    }
+    DescriptorAllocator::DescriptorAllocator(GPU &gpu) : gpu{gpu}, recycler{std::make_shared<PoolRecycler>()} {}
 
     DescriptorAllocator::ActiveDescriptorSet DescriptorAllocator::AllocateSet(vk::DescriptorSetLayout layout) {
-        std::scoped_lock allocatorLock{mutex};
-
-        auto it{pool->layoutSlots.find(layout)};
-        vk::Result lastResult{};
-        if (it != pool->layoutSlots.end()) {
-            auto &slots{it->second};
-            for (auto slotIt{it->second.begin()} ; slotIt != it->second.end() ; slotIt++) {
-                if (!slotIt->active.test_and_set(std::memory_order_acq_rel)) {
-                    // Move active slots to end of list to reduce search time
-                    it->second.splice(it->second.end(), it->second, slotIt);
-                    return ActiveDescriptorSet{pool, &*slotIt};
-                }
-            }
+        TRACE_COUNTER("gpu", "Descriptor Set Allocations", allocationCount.fetch_add(1, std::memory_order_relaxed) + 1);
 
-            // If we couldn't find an available slot, we need to allocate a new one
-            auto set{AllocateVkDescriptorSet(layout)};
-            if (set.result == vk::Result::eSuccess) {
-                auto &slot{slots.emplace_back(set.value)};
-                slot.active.test_and_set(std::memory_order_release);
-                return ActiveDescriptorSet{pool, &slot};
-            } else {
-                lastResult = set.result;
-            }
-        } else {
-            // If we couldn't find a layout, we need to allocate a new one
-            auto set{AllocateVkDescriptorSet(layout)};
-            if (set.result == vk::Result::eSuccess) {
-                auto &layoutSlots{pool->layoutSlots.try_emplace(layout).first->second};
-                auto &slot{layoutSlots.emplace_back(set.value)};
-                slot.active.test_and_set(std::memory_order_release);
-                return ActiveDescriptorSet{pool, &slot};
-            } else {
-                lastResult = set.result;
-            }
+        auto &threadPool{GetThreadPool()};
+        if (threadPool.generation != generation || !threadPool.pool) [[unlikely]] {
+            threadPool.pool = AcquirePool();
+            threadPool.generation = generation;
         }
 
         while (true) {
-            // We attempt to modify the pool based on the last result
-            if (lastResult == vk::Result::eErrorOutOfPoolMemory) {
-                if (pool->freeSetCount == 0)
-                    // The amount of maximum descriptor sets is insufficient
-                    descriptorSetCount += DescriptorSetCountIncrement;
-                else
-                    // The amount of maximum descriptors is insufficient
-                    descriptorMultiplier++;
-                AllocateDescriptorPool();
-            } else if (lastResult == vk::Result::eErrorFragmentedPool) {
-                AllocateDescriptorPool(); // If the pool is fragmented, we reallocate without increasing the size
+            auto set{AllocateVkDescriptorSet(*threadPool.pool, layout)};
+            if (set.result == vk::Result::eSuccess)
+                return ActiveDescriptorSet{threadPool.pool, set.value};
+
+            if (set.result == vk::Result::eErrorOutOfPoolMemory && threadPool.pool->allocatedSetCount < PoolSetCount) {
+                // The pool ran out of descriptors prior to running out of sets, future pools are created with more descriptors to balance them
+                u32 descriptorMultiplier{threadPool.pool->descriptorMultiplier};
+                recycler->descriptorMultiplier.compare_exchange_strong(descriptorMultiplier, descriptorMultiplier + 1, std::memory_order_relaxed);
             }
 
-            // Try to allocate a new layout
-            auto set{AllocateVkDescriptorSet(layout)};
-            if (set.result == vk::Result::eSuccess) {
-                auto &layoutSlots{pool->layoutSlots.try_emplace(layout).first->second};
-                auto &slot{layoutSlots.emplace_back(set.value)};
-                slot.active.test_and_set(std::memory_order_release);
-                return ActiveDescriptorSet{pool, &slot};
-            } else {
-                lastResult = set.result;
-            }
+            // The pool is retired, it'll be reset and recycled after all sets allocated from it have been released
+            threadPool.pool = AcquirePool();
         }
     }
 }
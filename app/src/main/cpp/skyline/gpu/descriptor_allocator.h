@@ -9,88 +9,99 @@
 
 namespace skyline::gpu {
     /**
-     * @brief A dynamic descriptor set allocator with internal resizing of the descriptor pool to size up to allocation demand
+     * @brief A descriptor set allocator which linearly allocates sets from per-thread descriptor pools, pools are reset wholesale and recycled once all sets allocated from them have been released
+     * @note Sets are never freed individually, a thread retires its pool once it's exhausted and the pool is reset after the last set allocated from it is released which generally happens when the FenceCycle it was attached to is signalled
      */
     class DescriptorAllocator {
       private:
         GPU &gpu;
-        SpinLock mutex; //!< Synchronizes the creation and replacement of the pool object
 
-        static constexpr u32 DescriptorSetCountIncrement{64}; //!< The amount of descriptor sets that we allocate in increments of
-        u32 descriptorSetCount{DescriptorSetCountIncrement}; //!< The maximum amount of descriptor sets in the pool
-        u32 descriptorMultiplier{1}; //!< A multiplier for the maximum amount of descriptors in the pool
+        static constexpr u32 PoolSetCount{256}; //!< The maximum amount of descriptor sets in a single pool
 
         /**
-         * @brief A slot representing a single descriptor set dynamically allocated from the pool
+         * @brief A VkDescriptorPool which is only ever accessed by a single thread at a time, either the thread allocating from it or the thread resetting it
          */
-        struct DescriptorSetSlot {
-            std::atomic_flag active{true}; //!< If the descriptor is currently being utilized
-            vk::DescriptorSet descriptorSet; //!< The descriptor set allocated from the pool
-
-            DescriptorSetSlot(vk::DescriptorSet descriptorSet);
+        struct DescriptorPool : public vk::raii::DescriptorPool {
+            u32 descriptorMultiplier; //!< The multiplier for the descriptor counts that the pool was created with
+            u32 allocatedSetCount{}; //!< The amount of sets allocated from the pool since it was last reset
 
-            DescriptorSetSlot(DescriptorSetSlot &&other);
+            DescriptorPool(vk::raii::Device const &device, vk::DescriptorPoolCreateInfo const &createInfo, u32 descriptorMultiplier);
         };
 
         /**
-         * @brief A lockable VkDescriptorPool for maintaining external synchronization requirements
+         * @brief The state that pools are returned to once all of their sets have been released, this is shared with outstanding pools as they may be released after the allocator is destroyed
          */
-        struct DescriptorPool : public vk::raii::DescriptorPool {
-            size_t freeSetCount{}; //!< The amount of sets free to allocate from this pool
-            std::unordered_map<vk::DescriptorSetLayout, std::list<DescriptorSetSlot>> layoutSlots; //!< A map of pools based on the layout of the descriptor sets
+        struct PoolRecycler {
+            SpinLock mutex; //!< Synchronizes access to the free pools
+            std::vector<std::unique_ptr<DescriptorPool>> freePools; //!< Pools that have been reset and can be handed out again
+            std::atomic<u32> descriptorMultiplier{1}; //!< A multiplier for the descriptor counts of new pools, pools with an older multiplier are destroyed rather than recycled
+        };
+
+        std::shared_ptr<PoolRecycler> recycler;
+
+        static inline std::atomic<u64> generationCounter{}; //!< The source of generations for all allocators, generations are never reused so per-thread state of a destroyed allocator can't alias with a new one
+        u64 generation{++generationCounter};
 
-            DescriptorPool(vk::raii::Device const &device, vk::DescriptorPoolCreateInfo const &createInfo);
+        /**
+         * @brief The pool that a thread is currently allocating sets from
+         */
+        struct ThreadPool {
+            u64 generation{}; //!< The generation of the allocator that the pool belongs to
+            std::shared_ptr<DescriptorPool> pool;
         };
 
-        std::shared_ptr<DescriptorPool> pool; //!< The current pool used by any allocations in the class, replaced when an error is ran into
+        static ThreadPool &GetThreadPool() {
+            thread_local ThreadPool threadPool{};
+            return threadPool;
+        }
+
+        std::atomic<u64> allocationCount{}, poolCount{};
 
         /**
-         * @brief (Re-)Allocates the descriptor pool with the current multiplier applied to the descriptor counts and the current descriptor set count
-         * @note `DescriptorAllocator::mutex` **must** be locked prior to calling this
+         * @brief Takes a pool from the recycler or creates a new pool if there are no free pools
+         * @note The returned pool is returned to the recycler once all references to it are released
          */
-        void AllocateDescriptorPool();
+        std::shared_ptr<DescriptorPool> AcquirePool();
 
         /**
-         * @brief Allocates a descriptor set with the specified layout from the pool
+         * @brief Allocates a descriptor set with the specified layout from the supplied pool
          * @return An error code that's either `eSuccess`, `eErrorOutOfPoolMemory` or `eErrorFragmentedPool`
          */
-        vk::ResultValue<vk::DescriptorSet> AllocateVkDescriptorSet(vk::DescriptorSetLayout layout);
+        vk::ResultValue<vk::DescriptorSet> AllocateVkDescriptorSet(DescriptorPool &pool, vk::DescriptorSetLayout layout);
 
       public:
         /**
-         * @brief A RAII-bound descriptor set that automatically frees resources into the pool on destruction while respecting external synchronization requirements
+         * @brief A RAII-bound descriptor set that keeps the pool it was allocated from from being reset until it's destroyed
          */
         struct ActiveDescriptorSet {
           private:
             std::shared_ptr<DescriptorPool> pool;
-            DescriptorSetSlot *slot;
+            vk::DescriptorSet descriptorSet;
 
             friend class DescriptorAllocator;
 
-            ActiveDescriptorSet(std::shared_ptr<DescriptorPool> pool, DescriptorSetSlot *slot);
+            ActiveDescriptorSet(std::shared_ptr<DescriptorPool> pool, vk::DescriptorSet descriptorSet);
 
           public:
-            ActiveDescriptorSet(ActiveDescriptorSet &&other) noexcept;
+            ActiveDescriptorSet(ActiveDescriptorSet &&other) noexcept = default;
 
             /* Delete the copy constructor/assignment to prevent early freeing of the descriptor set */
             ActiveDescriptorSet(const ActiveDescriptorSet &) = delete;
 
             ActiveDescriptorSet &operator=(const ActiveDescriptorSet &) = delete;
 
-            ~ActiveDescriptorSet();
-
-            vk::DescriptorSet &operator*() const {
-                return slot->descriptorSet;
+            const vk::DescriptorSet &operator*() const {
+                return descriptorSet;
             }
         };
 
         DescriptorAllocator(GPU &gpu);
 
         /**
-         * @brief Allocates a descriptor set from the pool with the supplied layout
-         * @note The layout object must be reused for equivalent layouts to avoid unnecessary descriptor set creation
-         * @note It is UB to allocate a set with a descriptor type that isn't in the pool as defined in AllocateDescriptorPool()
+         * @brief Allocates a descriptor set with the supplied layout from the calling thread's pool
+         * @note It is UB to allocate a set with a descriptor type that isn't in the pool as defined in AcquirePool()
          * @note The supplied ActiveDescriptorSet **must** stay alive until the descriptor set can be freed, it must not be destroyed after being bound but after any associated commands have completed execution
+         * @note The contents of the returned set are undefined, all bindings used by the pipeline must be written or copied into it prior to use
          */
         ActiveDescriptorSet AllocateSet(vk::DescriptorSetLayout layout);
     };
@@ -11,7 +11,7 @@
 #include <gpu.h>
 #include <dlfcn.h>
 #include "command_executor.h"
-#include <nce.h>
+#include <nce/trap_manager.h>
 
 namespace skyline::gpu::interconnect {
     static void RecordFullBarrier(vk::raii::CommandBuffer &commandBuffer) {
@@ -243,7 +243,7 @@ namespace skyline::gpu::interconnect {
     }
 
     void ExecutionWaiterThread::Run() {
-        signal::SetSignalHandler({SIGSEGV}, nce::NCE::HostSignalHandler); // We may access NCE trapped memory
+        signal::SetSignalHandler({SIGSEGV}, nce::TrapManager::HostSignalHandler); // We may access NCE trapped memory
 
         // Enable turbo clocks to begin with if requested
         if (*state.settings->forceMaxGpuClocks)
@@ -1,6 +1,7 @@
 // SPDX-License-Identifier: MPL-2.0
 // Copyright © 2022 Skyline Team and Contributors (https://github.com/skyline-emu/)
 
+#include <gpu.h>
 #include <gpu/buffer_manager.h>
 #include <soc/gm20b/channel.h>
 #include <soc/gm20b/gmmu.h>
@@ -56,4 +57,35 @@ namespace skyline::gpu::interconnect {
         ContextLock lock{executor.tag, view};
         view.Read(lock.IsFirstUsage(), FlushHostCallback, dstBuffer, srcOffset);
     }
+
+    DescriptorInfoStorage::DescriptorInfoStorage(LinearAllocatorState<> &allocator, u32 bufferDescCount, u32 imageDescCount) {
+        static_assert(alignof(vk::DescriptorImageInfo) <= alignof(vk::DescriptorBufferInfo) && sizeof(vk::DescriptorBufferInfo) % alignof(vk::DescriptorImageInfo) == 0, "Image infos directly following buffer infos must be aligned");
+        size_t bufferDescsSize{bufferDescCount * sizeof(vk::DescriptorBufferInfo)};
+        data = allocator.Allocate(bufferDescsSize + imageDescCount * sizeof(vk::DescriptorImageInfo), false);
+        bufferDescs = {reinterpret_cast<vk::DescriptorBufferInfo *>(data), bufferDescCount};
+        imageDescs = {reinterpret_cast<vk::DescriptorImageInfo *>(data + bufferDescsSize), imageDescCount};
+    }
+
+    vk::raii::DescriptorUpdateTemplate CreateDescriptorUpdateTemplate(GPU &gpu, span<const vk::WriteDescriptorSet> writes, const DescriptorInfoStorage &storage, vk::DescriptorSetLayout descriptorSetLayout) {
+        std::vector<vk::DescriptorUpdateTemplateEntry> entries;
+        entries.reserve(writes.size());
+        for (const auto &write : writes) {
+            auto info{write.pBufferInfo ? reinterpret_cast<const u8 *>(write.pBufferInfo) : reinterpret_cast<const u8 *>(write.pImageInfo)};
+            entries.push_back(vk::DescriptorUpdateTemplateEntry{
+                .dstBinding = write.dstBinding,
+                .dstArrayElement = write.dstArrayElement,
+                .descriptorCount = write.descriptorCount,
+                .descriptorType = write.descriptorType,
+                .offset = static_cast<size_t>(info - storage.data),
+                .stride = write.pBufferInfo ? sizeof(vk::DescriptorBufferInfo) : sizeof(vk::DescriptorImageInfo),
+            });
+        }
+
+        return vk::raii::DescriptorUpdateTemplate{gpu.vkDevice, vk::DescriptorUpdateTemplateCreateInfo{
+            .descriptorUpdateEntryCount = static_cast<u32>(entries.size()),
+            .pDescriptorUpdateEntries = entries.data(),
+            .templateType = vk::DescriptorUpdateTemplateType::eDescriptorSet,
+            .descriptorSetLayout = descriptorSetLayout,
+        }};
+    }
 }
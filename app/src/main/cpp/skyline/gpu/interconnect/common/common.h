@@ -4,6 +4,7 @@
 #pragma once
 
 #include <common/dirty_tracking.h>
+#include <common/linear_allocator.h>
 #include <vulkan/vulkan_raii.hpp>
 #include <gpu/buffer.h>
 #include <soc/gm20b/engines/engine.h>
@@ -30,7 +31,7 @@ namespace skyline::gpu::interconnect {
         soc::gm20b::ChannelContext &channelCtx;
         CommandExecutor &executor;
         GPU &gpu;
-        nce::NCE &nce;
+        nce::TrapManager &nce;
         kernel::MemoryManager &memory;
     };
 
@@ -97,5 +98,24 @@ namespace skyline::gpu::interconnect {
         vk::DescriptorSetLayout descriptorSetLayout;
         vk::PipelineBindPoint bindPoint;
         u32 descriptorSetIndex;
+        vk::DescriptorUpdateTemplate updateTemplate{}; //!< An optional template equivalent to `writes` which is used in their place when the set isn't updated with push descriptors, this can only be used when there are no copies
+        const void *templateData{}; //!< The descriptor infos that `updateTemplate` reads from
     };
+
+    /**
+     * @brief Storage for the buffer and image infos of a descriptor update which are laid out in a single allocation, this allows them to be read with fixed offsets by a descriptor update template
+     */
+    struct DescriptorInfoStorage {
+        u8 *data;
+        span<vk::DescriptorBufferInfo> bufferDescs; //!< The buffer infos, these are at the start of the storage
+        span<vk::DescriptorImageInfo> imageDescs; //!< The image infos, these directly follow the buffer infos
+
+        DescriptorInfoStorage(LinearAllocatorState<> &allocator, u32 bufferDescCount, u32 imageDescCount);
+    };
+
+    /**
+     * @brief Creates a descriptor update template which performs the same updates as the supplied writes
+     * @param writes Writes with all buffer and image infos pointing into the supplied storage, the layout of the storage must be the same for all updates using the template
+     */
+    vk::raii::DescriptorUpdateTemplate CreateDescriptorUpdateTemplate(GPU &gpu, span<const vk::WriteDescriptorSet> writes, const DescriptorInfoStorage &storage, vk::DescriptorSetLayout descriptorSetLayout);
 }
@@ -62,11 +62,17 @@ namespace skyline::gpu::interconnect {
         return it->value;
     }
 
-    static constexpr u32 MaxSerialisedBundleSize{1 << 20}; ///< The maximum size of a serialised bundle (1 MiB)
+    u64 PipelineStateBundle::HashShaderInputs() const {
+        u64 hash{XXH64(constantBufferValues.data(), constantBufferValues.size() * sizeof(ConstantBufferValue), 0)};
+        hash = XXH64(textureTypes.data(), textureTypes.size() * sizeof(TextureTypeEntry), hash);
+        for (const auto &stage : pipelineStages) {
+            hash = XXH64(&stage.binaryBaseOffset, sizeof(stage.binaryBaseOffset), hash);
+            hash = XXH64(stage.binary.data(), stage.binary.size(), hash);
+        }
+        return hash;
+    }
 
-    /*  Bundle header format pseudocode:
-        u64 hash
-        u32 bundleSize
+    /*  Bundle format pseudocode:
         u32 keySize;
         u32 constantBufferValueCount
         u32 textureTypeCount
@@ -88,7 +94,7 @@ namespace skyline::gpu::interconnect {
         struct PipelineStage {
             u32 binaryBaseOffset
             u32 binarySize
-            u8 binary[binarySize]
+            u64 binaryHash // The XXH64 hash of the binary, the binary itself is stored separately so it can be shared between bundles
         } pipelineStages[pipelineStageCount];
     */
 
@@ -99,12 +105,116 @@ namespace skyline::gpu::interconnect {
         u32 pipelineStageCount;
     };
 
-    struct PipelineBinaryDataHeader {
+    struct PipelineBinaryReference {
+        u32 binaryBaseOffset;
+        u32 binarySize;
+        u64 binaryHash;
+    };
+
+    void PipelineStateBundle::Serialise(std::vector<u8> &output, const std::function<void(u64 hash, span<u8> binary)> &writeBinary) {
+        size_t bundleSize{sizeof(BundleDataHeader) +
+                          key.size() +
+                          constantBufferValues.size() * sizeof(ConstantBufferValue) +
+                          textureTypes.size() * sizeof(TextureTypeEntry) +
+                          pipelineStages.size() * sizeof(PipelineBinaryReference)};
+
+        output.resize(bundleSize);
+
+        auto data{span(output)};
+        auto &header{data.as<BundleDataHeader>()};
+        size_t offset{sizeof(BundleDataHeader)};
+
+        header.keySize = static_cast<u32>(key.size());
+        header.constantBufferValueCount = static_cast<u32>(constantBufferValues.size());
+        header.textureTypeCount = static_cast<u32>(textureTypes.size());
+        header.pipelineStageCount = static_cast<u32>(pipelineStages.size());
+
+        data.subspan(offset, header.keySize).copy_from(key);
+        offset += header.keySize;
+
+        data.subspan(offset, header.constantBufferValueCount * sizeof(ConstantBufferValue)).copy_from(constantBufferValues);
+        offset += header.constantBufferValueCount * sizeof(ConstantBufferValue);
+
+        data.subspan(offset, header.textureTypeCount * sizeof(TextureTypeEntry)).copy_from(textureTypes);
+        offset += header.textureTypeCount * sizeof(TextureTypeEntry);
+
+        for (auto &stage : pipelineStages) {
+            u64 binaryHash{XXH64(stage.binary.data(), stage.binary.size(), 0)};
+            data.subspan(offset).as<PipelineBinaryReference>() = {
+                .binaryBaseOffset = stage.binaryBaseOffset,
+                .binarySize = static_cast<u32>(stage.binary.size()),
+                .binaryHash = binaryHash,
+            };
+            offset += sizeof(PipelineBinaryReference);
+
+            if (!stage.binary.empty())
+                writeBinary(binaryHash, stage.binary);
+        }
+    }
+
+    void PipelineStateBundle::Deserialise(span<const u8> data, const std::function<void(u64 hash, std::vector<u8> &binary)> &readBinary) {
+        if (data.size() < sizeof(BundleDataHeader))
+            throw exception("Pipeline state bundle is truncated: 0x{:X}", data.size());
+
+        auto header{data.as<const BundleDataHeader>()};
+        size_t expectedSize{sizeof(BundleDataHeader) +
+                            header.keySize +
+                            static_cast<size_t>(header.constantBufferValueCount) * sizeof(ConstantBufferValue) +
+                            static_cast<size_t>(header.textureTypeCount) * sizeof(TextureTypeEntry) +
+                            static_cast<size_t>(header.pipelineStageCount) * sizeof(PipelineBinaryReference)};
+        if (data.size() != expectedSize)
+            throw exception("Pipeline state bundle size mismatch: 0x{:X} (Expected: 0x{:X})", data.size(), expectedSize);
+
+        size_t offset{sizeof(BundleDataHeader)};
+
+        Reset(data.subspan(offset, header.keySize));
+        offset += header.keySize;
+
+        auto readConstantBufferValues{data.subspan(offset, header.constantBufferValueCount * sizeof(ConstantBufferValue)).cast<const ConstantBufferValue>()};
+        constantBufferValues.insert(constantBufferValues.end(), readConstantBufferValues.begin(), readConstantBufferValues.end());
+        offset += header.constantBufferValueCount * sizeof(ConstantBufferValue);
+
+        auto readTextureTypes{data.subspan(offset, header.textureTypeCount * sizeof(TextureTypeEntry)).cast<const TextureTypeEntry>()};
+        textureTypes.insert(textureTypes.end(), readTextureTypes.begin(), readTextureTypes.end());
+        offset += header.textureTypeCount * sizeof(TextureTypeEntry);
+
+        pipelineStages.resize(header.pipelineStageCount);
+        for (auto &stage : pipelineStages) {
+            auto reference{data.subspan(offset).as<const PipelineBinaryReference>()};
+            offset += sizeof(PipelineBinaryReference);
+
+            stage.binaryBaseOffset = reference.binaryBaseOffset;
+            if (reference.binarySize) {
+                readBinary(reference.binaryHash, stage.binary);
+                if (stage.binary.size() != reference.binarySize)
+                    throw exception("Pipeline shader binary size mismatch: 0x{:X} (Expected: 0x{:X})", stage.binary.size(), reference.binarySize);
+            }
+        }
+    }
+
+    static constexpr u32 MaxLegacySerialisedBundleSize{1 << 20}; ///< The maximum size of a serialised bundle in the legacy format (1 MiB)
+
+    /*  Legacy (v3) bundle format pseudocode, this is identical to the current format other than all shader binaries being stored inline:
+        u64 hash
+        u32 bundleSize
+        BundleDataHeader header;
+        u8 key[keySize];
+        ConstantBufferValue constantBufferValues[constantBufferValueCount];
+        TextureType textureType[textureTypeCount];
+
+        struct PipelineStage {
+            u32 binaryBaseOffset
+            u32 binarySize
+            u8 binary[binarySize]
+        } pipelineStages[pipelineStageCount];
+    */
+
+    struct LegacyPipelineBinaryDataHeader {
         u32 binaryBaseOffset;
         u32 binarySize;
     };
 
-    bool PipelineStateBundle::Deserialise(std::ifstream &stream) {
+    bool PipelineStateBundle::DeserialiseLegacy(std::ifstream &stream) {
         if (stream.peek() == EOF)
             return false;
 
@@ -113,13 +223,12 @@ namespace skyline::gpu::interconnect {
 
         u32 bundleSize{};
         stream.read(reinterpret_cast<char *>(&bundleSize), sizeof(bundleSize));
-        if (bundleSize > MaxSerialisedBundleSize)
+        if (bundleSize > MaxLegacySerialisedBundleSize)
             throw exception("Pipeline state bundle is too large: 0x{:X}", bundleSize);
 
         fileBuffer.resize(static_cast<size_t>(bundleSize));
         stream.read(reinterpret_cast<char *>(fileBuffer.data()), static_cast<std::streamsize>(bundleSize));
-
-        if (XXH64(fileBuffer.data(), bundleSize, 0) != hash)
+        if (stream.fail() || XXH64(fileBuffer.data(), bundleSize, 0) != hash)
             throw exception("Pipeline state bundle hash mismatch");
 
         auto data{span(fileBuffer)};
@@ -130,19 +239,17 @@ namespace skyline::gpu::interconnect {
         offset += header.keySize;
 
         auto readConstantBufferValues{data.subspan(offset, header.constantBufferValueCount * sizeof(ConstantBufferValue)).cast<ConstantBufferValue>()};
-        textureTypes.reserve(header.textureTypeCount);
         constantBufferValues.insert(constantBufferValues.end(), readConstantBufferValues.begin(), readConstantBufferValues.end());
         offset += header.constantBufferValueCount * sizeof(ConstantBufferValue);
 
         auto readTextureTypes{data.subspan(offset, header.textureTypeCount * sizeof(TextureTypeEntry)).cast<TextureTypeEntry>()};
-        textureTypes.reserve(header.textureTypeCount);
         textureTypes.insert(textureTypes.end(), readTextureTypes.begin(), readTextureTypes.end());
         offset += header.textureTypeCount * sizeof(TextureTypeEntry);
 
         pipelineStages.resize(header.pipelineStageCount);
         for (u32 i{}; i < header.pipelineStageCount; i++) {
-            const auto &pipelineHeader{data.subspan(offset).as<PipelineBinaryDataHeader>()};
-            offset += sizeof(PipelineBinaryDataHeader);
+            const auto &pipelineHeader{data.subspan(offset).as<LegacyPipelineBinaryDataHeader>()};
+            offset += sizeof(LegacyPipelineBinaryDataHeader);
 
             pipelineStages[i].binaryBaseOffset = pipelineHeader.binaryBaseOffset;
             pipelineStages[i].binary.resize(pipelineHeader.binarySize);
@@ -152,50 +259,4 @@ namespace skyline::gpu::interconnect {
 
         return true;
     }
-
-    void PipelineStateBundle::Serialise(std::ofstream &stream) {
-        u32 bundleSize{static_cast<u32>(sizeof(BundleDataHeader) +
-                                        key.size() +
-                                        constantBufferValues.size() * sizeof(ConstantBufferValue) +
-                                        textureTypes.size() * sizeof(TextureTypeEntry) +
-                                        std::accumulate(pipelineStages.begin(), pipelineStages.end(), 0UL, [](size_t acc, const auto &stage) {
-                                            return acc + sizeof(PipelineBinaryDataHeader) + stage.binary.size();
-                                        }))};
-
-        fileBuffer.resize(bundleSize);
-
-        auto data{span(fileBuffer)};
-        auto &header{data.as<BundleDataHeader>()};
-        size_t offset{sizeof(BundleDataHeader)};
-
-        header.keySize = static_cast<u32>(key.size());
-        header.constantBufferValueCount = static_cast<u32>(constantBufferValues.size());
-        header.textureTypeCount = static_cast<u32>(textureTypes.size());
-        header.pipelineStageCount = static_cast<u32>(pipelineStages.size());
-
-        data.subspan(offset, header.keySize).copy_from(key);
-        offset += header.keySize;
-
-        data.subspan(offset, header.constantBufferValueCount * sizeof(ConstantBufferValue)).copy_from(constantBufferValues);
-        offset += header.constantBufferValueCount * sizeof(ConstantBufferValue);
-
-        data.subspan(offset, header.textureTypeCount * sizeof(TextureTypeEntry)).copy_from(textureTypes);
-        offset += header.textureTypeCount * sizeof(TextureTypeEntry);
-
-        for (const auto &stage : pipelineStages) {
-            auto &pipelineHeader{data.subspan(offset).as<PipelineBinaryDataHeader>()};
-            offset += sizeof(PipelineBinaryDataHeader);
-
-            pipelineHeader.binaryBaseOffset = stage.binaryBaseOffset;
-            pipelineHeader.binarySize = static_cast<u32>(stage.binary.size());
-
-            data.subspan(offset, pipelineHeader.binarySize).copy_from(stage.binary);
-            offset += pipelineHeader.binarySize;
-        }
-
-        u64 hash{XXH64(fileBuffer.data(), bundleSize, 0)};
-        stream.write(reinterpret_cast<const char *>(&hash), sizeof(hash));
-        stream.write(reinterpret_cast<const char *>(&bundleSize), sizeof(bundleSize));
-        stream.write(reinterpret_cast<const char *>(fileBuffer.data()), static_cast<std::streamsize>(bundleSize));
-    }
 }
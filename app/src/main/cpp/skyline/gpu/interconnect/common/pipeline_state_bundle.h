@@ -3,6 +3,7 @@
 
 #pragma once
 
+#include <functional>
 #include <shader_compiler/shader_info.h>
 #include "common.h"
 
@@ -105,8 +106,29 @@ namespace skyline::gpu::interconnect {
          */
         u32 LookupConstantBufferValue(u32 shaderStage, u32 index, u32 offset);
 
-        bool Deserialise(std::ifstream &stream);
+        /**
+         * @return A hash of all state in the bundle that is used as an input to shader translation: the shader binaries, constant buffer values and texture types
+         */
+        u64 HashShaderInputs() const;
+
+        /**
+         * @brief Serialises the bundle into the supplied buffer, shader binaries are referenced by their hash rather than being stored inline
+         * @param writeBinary A callback that is called with the hash and contents of every shader binary referenced by the bundle, this is responsible for storing them
+         */
+        void Serialise(std::vector<u8> &output, const std::function<void(u64 hash, span<u8> binary)> &writeBinary);
 
-        void Serialise(std::ofstream &stream);
+        /**
+         * @brief Deserialises a bundle that was serialised with Serialise()
+         * @param readBinary A callback that is called with the hash of every shader binary referenced by the bundle, this is responsible for filling the supplied vector with the binary
+         * @note An exception is thrown if the data is malformed
+         */
+        void Deserialise(span<const u8> data, const std::function<void(u64 hash, std::vector<u8> &binary)> &readBinary);
+
+        /**
+         * @brief Deserialises a bundle from a stream in the legacy (v3) pipeline cache format, where every bundle is stored inline with all its shader binaries
+         * @return If a bundle was read, false is returned at the end of the stream
+         * @note This is only used for migrating legacy pipeline caches
+         */
+        bool DeserialiseLegacy(std::ifstream &stream);
     };
 }
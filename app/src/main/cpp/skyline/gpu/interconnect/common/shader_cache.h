@@ -18,7 +18,7 @@ namespace skyline::gpu::interconnect {
         struct MirrorEntry {
             span<u8> mirror;
             tsl::robin_map<u8 *, std::pair<ShaderBinary, u64>> cache;
-            std::optional<nce::NCE::TrapHandle> trap;
+            std::optional<nce::TrapManager::TrapHandle> trap;
 
             static constexpr u32 SkipTrapThreshold{20}; //!< Threshold for the number of times a mirror trap needs to be hit before we fallback to always hashing
             u32 trapCount{}; //!< The number of times the trap has been hit, used to avoid trapping in cases where the constant retraps would harm performance
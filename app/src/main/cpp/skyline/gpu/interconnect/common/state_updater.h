@@ -228,21 +228,30 @@ namespace skyline::gpu::interconnect {
             if constexpr (PushDescriptor) {
                 commandBuffer.pushDescriptorSetKHR(updateInfo->bindPoint, updateInfo->pipelineLayout, updateInfo->descriptorSetIndex, updateInfo->writes);
             } else {
-                // Set the destination/(source) descriptor set(s) for all writes/(copies)
-                for (auto &write : updateInfo->writes)
-                    write.dstSet = **dstSet;
-
-                for (auto &copy : updateInfo->copies) {
-                    copy.dstSet = **dstSet;
-                    copy.srcSet = **srcSet;
+                auto startTime{util::GetTimeNs()};
+
+                if (updateInfo->updateTemplate) {
+                    // Templates read the descriptor infos directly which avoids the driver needing to parse a write for every binding
+                    (*gpu.vkDevice).updateDescriptorSetWithTemplate(**dstSet, updateInfo->updateTemplate, updateInfo->templateData, *gpu.vkDevice.getDispatcher());
+                } else {
+                    // Set the destination/(source) descriptor set(s) for all writes/(copies)
+                    for (auto &write : updateInfo->writes)
+                        write.dstSet = **dstSet;
+
+                    for (auto &copy : updateInfo->copies) {
+                        copy.dstSet = **dstSet;
+                        copy.srcSet = **srcSet;
+                    }
+
+                    // Perform the updates, doing copies first to avoid overwriting
+                    if (!updateInfo->copies.empty())
+                        gpu.vkDevice.updateDescriptorSets({}, updateInfo->copies);
+
+                    if (!updateInfo->writes.empty())
+                        gpu.vkDevice.updateDescriptorSets(updateInfo->writes, {});
                 }
 
-                // Perform the updates, doing copies first to avoid overwriting
-                if (!updateInfo->copies.empty())
-                    gpu.vkDevice.updateDescriptorSets({}, updateInfo->copies);
-
-                if (!updateInfo->writes.empty())
-                    gpu.vkDevice.updateDescriptorSets(updateInfo->writes, {});
+                TRACE_COUNTER("gpu", "Descriptor Update Time", util::GetTimeNs() - startTime);
 
                 // Bind the updated descriptor set and we're done!
                 commandBuffer.bindDescriptorSets(updateInfo->bindPoint, updateInfo->pipelineLayout, updateInfo->descriptorSetIndex, **dstSet, {});
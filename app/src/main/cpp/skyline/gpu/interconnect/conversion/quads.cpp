@@ -6,7 +6,7 @@
 namespace skyline::gpu::interconnect::conversion::quads {
     void GenerateQuadListConversionBuffer(u32 *dest, u32 vertexCount) {
         #pragma clang loop vectorize(enable) interleave(enable) unroll(enable)
-        for (u32 i{}; i < vertexCount; i += 4) {
+        for (u32 i{}; i + 4 <= vertexCount; i += 4) {
             // Given a quad ABCD, we want to generate triangles ABC & CDA
             // Triangle ABC
             *(dest++) = i + 0;
@@ -23,7 +23,7 @@ namespace skyline::gpu::interconnect::conversion::quads {
     template<typename S>
     static void GenerateQuadIndexConversionBufferImpl(S *__restrict__ dest, S *__restrict__ source, u32 indexCount) {
         #pragma clang loop vectorize(enable) interleave(enable) unroll(enable)
-        for (size_t i{}; i < indexCount; i += 4, source += 4) {
+        for (size_t i{}; i + 4 <= indexCount; i += 4, source += 4) {
             // Given a quad ABCD, we want to generate triangles ABC & CDA
             // Triangle ABC
             *(dest++) = *(source + 0);
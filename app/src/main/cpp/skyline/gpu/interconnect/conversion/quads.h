@@ -13,10 +13,10 @@ namespace skyline::gpu::interconnect::conversion::quads {
     constexpr u32 QuadVertexCount{4}; //!< The amount of vertices a quad is composed of
 
     /**
-     * @return The amount of indices emitted converting a buffer with the supplied element count
+     * @return The amount of indices emitted converting a buffer with the supplied element count, any trailing vertices which don't form a complete quad are dropped
      */
     constexpr u32 GetIndexCount(u32 count) {
-        return (count * EmittedIndexCount) / QuadVertexCount;
+        return (count / QuadVertexCount) * EmittedIndexCount;
     }
 
     /**
@@ -11,7 +11,7 @@
 namespace skyline::gpu::interconnect::kepler_compute {
     KeplerCompute::KeplerCompute(GPU &gpu,
                                  soc::gm20b::ChannelContext &channelCtx,
-                                 nce::NCE &nce,
+                                 nce::TrapManager &nce,
                                  kernel::MemoryManager &memoryManager,
                                  DirtyManager &manager,
                                  const EngineRegisterBundle &registerBundle)
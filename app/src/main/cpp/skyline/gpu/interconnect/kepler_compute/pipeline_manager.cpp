@@ -126,11 +126,13 @@ namespace skyline::gpu::interconnect::kepler_compute {
         u32 writeIdx{};
         auto writes{ctx.executor.allocator->AllocateUntracked<vk::WriteDescriptorSet>(descriptorInfo.totalWriteDescCount)};
 
+        DescriptorInfoStorage descriptorInfoStorage{*ctx.executor.allocator, descriptorInfo.totalBufferDescCount, descriptorInfo.totalImageDescCount};
+
         u32 bufferIdx{};
-        auto bufferDescs{ctx.executor.allocator->AllocateUntracked<vk::DescriptorBufferInfo>(descriptorInfo.totalBufferDescCount)};
+        auto bufferDescs{descriptorInfoStorage.bufferDescs};
         auto bufferDescDynamicBindings{ctx.executor.allocator->AllocateUntracked<DynamicBufferBinding>(descriptorInfo.totalBufferDescCount)};
         u32 imageIdx{};
-        auto imageDescs{ctx.executor.allocator->AllocateUntracked<vk::DescriptorImageInfo>(descriptorInfo.totalImageDescCount)};
+        auto imageDescs{descriptorInfoStorage.imageDescs};
 
         u32 storageBufferIdx{};
         u32 bindingIdx{};
@@ -205,6 +207,10 @@ namespace skyline::gpu::interconnect::kepler_compute {
         if (!writeIdx)
             return nullptr;
 
+        // The layout of the writes only depends on the pipeline so a template can be created from the first update and reused for all further updates
+        if (!ctx.gpu.traits.supportsPushDescriptors && !descriptorUpdateTemplate)
+            descriptorUpdateTemplate.emplace(CreateDescriptorUpdateTemplate(ctx.gpu, writes.first(writeIdx), descriptorInfoStorage, *compiledPipeline.descriptorSetLayout));
+
         return ctx.executor.allocator->EmplaceUntracked<DescriptorUpdateInfo>(DescriptorUpdateInfo{
             .writes = writes.first(writeIdx),
             .bufferDescs = bufferDescs.first(bufferIdx),
@@ -213,6 +219,8 @@ namespace skyline::gpu::interconnect::kepler_compute {
             .descriptorSetLayout = *compiledPipeline.descriptorSetLayout,
             .bindPoint = vk::PipelineBindPoint::eCompute,
             .descriptorSetIndex = 0,
+            .updateTemplate = descriptorUpdateTemplate ? **descriptorUpdateTemplate : vk::DescriptorUpdateTemplate{},
+            .templateData = descriptorInfoStorage.data,
         });
     }
 }
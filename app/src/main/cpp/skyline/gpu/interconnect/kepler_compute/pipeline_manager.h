@@ -42,6 +42,7 @@ namespace skyline::gpu::interconnect::kepler_compute {
         DescriptorInfo descriptorInfo;
         std::vector<CachedMappedBufferView> storageBufferViews;
         ContextTag lastExecutionTag{}; //!< The last execution tag this pipeline was used at
+        std::optional<vk::raii::DescriptorUpdateTemplate> descriptorUpdateTemplate; //!< A template for descriptor updates, this is created on the first update when push descriptors aren't supported
 
         void SyncCachedStorageBufferViews(ContextTag executionTag);
 
@@ -4,6 +4,7 @@
 // Copyright © 2022 Skyline Team and Contributors (https://github.com/skyline-emu/)
 
 #include <limits>
+#include <boost/functional/hash.hpp>
 #include <range/v3/algorithm.hpp>
 #include <soc/gm20b/channel.h>
 #include <soc/gm20b/gmmu.h>
@@ -120,6 +121,78 @@ namespace skyline::gpu::interconnect::maxwell3d {
         manager.Bind(handle, indexBuffer.indexSize, indexBuffer.address, indexBuffer.limit);
     }
 
+    size_t IndexBufferState::QuadConversionKeyHash::operator()(const QuadConversionKey &key) const {
+        size_t hash{};
+        boost::hash_combine(hash, key.buffer);
+        boost::hash_combine(hash, key.offset);
+        boost::hash_combine(hash, key.sequenceNumber);
+        boost::hash_combine(hash, key.elementCount);
+        boost::hash_combine(hash, static_cast<u32>(key.indexSize));
+        return hash;
+    }
+
+    IndexBufferState::QuadConversion IndexBufferState::ConvertQuads(InterconnectContext &ctx, u32 firstIndex, u32 elementCount, bool convertWholeView) {
+        constexpr vk::DeviceSize MaxConversionSize{MegaBufferChunkSize / 2}; //!< The maximum size of a converted index buffer, this must fit within a single megabuffer chunk
+
+        // The cached conversions are megabuffer allocations which are invalidated at the end of the execution
+        if (quadConversionCacheTag != ctx.executor.executionTag) {
+            quadConversionCache.clear();
+            quadConversionCacheTag = ctx.executor.executionTag;
+        }
+
+        auto indexSize{engine->indexBuffer.indexSize};
+        vk::DeviceSize indexBytes{GetIndexBufferSize(indexSize, 1)};
+        if (convertWholeView) {
+            firstIndex = 0;
+            elementCount = static_cast<u32>(std::min<vk::DeviceSize>(view->size / indexBytes, std::numeric_limits<u32>::max()));
+        }
+
+        if (conversion::quads::GetRequiredBufferSize(elementCount, sizeof(u32)) > MaxConversionSize) {
+            Logger::Warn("Quad conversion of 0x{:X} indices exceeds the maximum size, only the initial indices will be drawn", elementCount);
+            elementCount = static_cast<u32>(MaxConversionSize / sizeof(u32) / conversion::quads::EmittedIndexCount * conversion::quads::QuadVertexCount);
+        }
+
+        QuadConversionKey key{
+            .buffer = view->GetBuffer(),
+            .offset = view->GetOffset() + firstIndex * indexBytes,
+            .sequenceNumber = view->GetSequenceNumber(),
+            .elementCount = elementCount,
+            .indexSize = indexSize,
+        };
+
+        // Buffers that can't be sequenced could have been modified since any prior conversion
+        if (key.sequenceNumber)
+            if (auto it{quadConversionCache.find(key)}; it != quadConversionCache.end())
+                return it->second;
+
+        // Indirect draws always need to be converted on the GPU as the index count is unknown on the CPU, falling back to converting the whole view on the CPU if that isn't possible
+        QuadConversion conversion{};
+        u32 quadCount{elementCount / conversion::quads::QuadVertexCount};
+        u32 convertedElementCount{quadCount * conversion::quads::QuadVertexCount};
+        vk::DeviceSize sourceSize{quadCount * conversion::quads::QuadVertexCount * indexBytes}, destinationSize{conversion::quads::GetRequiredBufferSize(elementCount, sizeof(u32))};
+        if ((convertWholeView || elementCount >= GpuQuadConversionThreshold)
+            && QuadConversionHelperShader::CanBind(ctx.gpu, sourceSize) && QuadConversionHelperShader::CanBind(ctx.gpu, destinationSize)
+            && key.offset % indexBytes == 0) {
+            auto allocation{ctx.gpu.megaBufferAllocator.Allocate(ctx.executor.cycle, destinationSize, true)};
+            conversion = {BufferBinding{allocation.buffer, allocation.offset, destinationSize}, vk::IndexType::eUint32, convertedElementCount};
+
+            // The backing is read on the GPU at the time of the dispatch so it must not be modified on the CPU by any sequenced writes
+            view->GetBuffer()->BlockSequencedCpuBackingWrites();
+
+            ctx.executor.AddOutsideRpCommand([source = *view, sourceOffset = firstIndex * indexBytes, sourceSize, destination = conversion.binding, quadCount, indexType = ConvertIndexType(indexSize)](vk::raii::CommandBuffer &commandBuffer, const std::shared_ptr<FenceCycle> &cycle, GPU &gpu) {
+                auto sourceBinding{source.GetBinding(gpu)};
+                cycle->AttachObject(gpu.helperShaders.quadConversionHelperShader.ConvertIndices(gpu, commandBuffer, BufferBinding{sourceBinding.buffer, sourceBinding.offset + sourceOffset, sourceSize}, destination, quadCount, indexType));
+            });
+        } else {
+            conversion = {GenerateQuadConversionIndexBuffer(ctx, indexSize, *view, firstIndex, elementCount), ConvertIndexType(indexSize), convertedElementCount};
+        }
+
+        if (key.sequenceNumber)
+            quadConversionCache.emplace(key, conversion);
+
+        return conversion;
+    }
+
     IndexBufferState::IndexBufferState(dirty::Handle dirtyHandle, DirtyManager &manager, const EngineRegisters &engine) : engine{manager, dirtyHandle, engine} {}
 
     void IndexBufferState::Flush(InterconnectContext &ctx, StateUpdateBuilder &builder, vk::PipelineStageFlags &srcStageMask, vk::PipelineStageFlags &dstStageMask, bool quadConversion, bool estimateSize, u32 firstIndex, u32 elementCount) {
@@ -127,10 +200,11 @@ namespace skyline::gpu::interconnect::maxwell3d {
         usedElementCount = elementCount;
         usedFirstIndex = firstIndex;
         usedQuadConversion = quadConversion;
+        quadConversionElementCount = 0;
 
         size_t size{[&] () {
             if (estimateSize)
-                return engine->indexBuffer.address - engine->indexBuffer.limit + 1;
+                return engine->indexBuffer.limit - engine->indexBuffer.address + 1;
             else
                 return GetIndexBufferSize(engine->indexBuffer.indexSize, firstIndex + elementCount);
         }()};
@@ -146,10 +220,14 @@ namespace skyline::gpu::interconnect::maxwell3d {
 
         indexType = ConvertIndexType(engine->indexBuffer.indexSize);
 
-        if (quadConversion)
-            megaBufferBinding = GenerateQuadConversionIndexBuffer(ctx, engine->indexBuffer.indexSize, *view, firstIndex, elementCount);
-        else
+        if (quadConversion) {
+            auto conversion{ConvertQuads(ctx, firstIndex, elementCount, estimateSize)};
+            megaBufferBinding = conversion.binding;
+            indexType = conversion.indexType;
+            quadConversionElementCount = conversion.elementCount;
+        } else {
             megaBufferBinding = view->TryMegaBuffer(ctx.executor.cycle, ctx.gpu.megaBufferAllocator, ctx.executor.executionTag);
+        }
 
         if (megaBufferBinding)
             builder.SetIndexBuffer(megaBufferBinding, indexType);
@@ -164,10 +242,15 @@ namespace skyline::gpu::interconnect::maxwell3d {
         if (didEstimateSize != estimateSize || (elementCount + firstIndex > usedElementCount + usedFirstIndex) || quadConversion != usedQuadConversion)
             return true;
 
-        // TODO: optimise this to use buffer sequencing to avoid needing to regenerate the quad buffer every time. We can't use as it is rn though because sequences aren't globally unique and may conflict after buffer recreation
         if (usedQuadConversion) {
-            megaBufferBinding = GenerateQuadConversionIndexBuffer(ctx, engine->indexBuffer.indexSize, *view, firstIndex, elementCount);
-            builder.SetIndexBuffer(megaBufferBinding, indexType);
+            // Conversions are cached with the buffer pointer alongside its sequence number, this is only done within an execution as buffers can't be recreated while they're attached to it
+            if (auto conversion{ConvertQuads(ctx, firstIndex, elementCount, estimateSize)};
+                conversion.binding != megaBufferBinding || conversion.indexType != indexType) {
+                megaBufferBinding = conversion.binding;
+                indexType = conversion.indexType;
+                quadConversionElementCount = conversion.elementCount;
+                builder.SetIndexBuffer(megaBufferBinding, indexType);
+            }
         } else if (megaBufferBinding) {
             if (auto newMegaBufferBinding{view->TryMegaBuffer(ctx.executor.cycle, ctx.gpu.megaBufferAllocator, ctx.executor.executionTag)};
                 newMegaBufferBinding != megaBufferBinding) {
@@ -186,6 +269,11 @@ namespace skyline::gpu::interconnect::maxwell3d {
     void IndexBufferState::PurgeCaches() {
         view.PurgeCaches();
         megaBufferBinding = {};
+        quadConversionCache.clear();
+    }
+
+    u32 IndexBufferState::GetQuadConversionElementCount() const {
+        return quadConversionElementCount;
     }
 
     /* Transform Feedback Buffer */
@@ -470,6 +558,10 @@ namespace skyline::gpu::interconnect::maxwell3d {
         return pipeline.Get().depthAttachment;
     }
 
+    u32 ActiveState::GetQuadConversionElementCount() {
+        return indexBuffer.Get().GetQuadConversionElementCount();
+    }
+
     std::shared_ptr<TextureView> ActiveState::GetColorRenderTargetForClear(InterconnectContext &ctx, size_t index) {
         return pipeline.Get().GetColorRenderTargetForClear(ctx, index);
     }
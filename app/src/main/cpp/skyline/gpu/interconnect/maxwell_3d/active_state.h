@@ -43,6 +43,31 @@ namespace skyline::gpu::interconnect::maxwell3d {
         };
 
       private:
+        /**
+         * @brief The source of a quad conversion, the sequence number of the buffer ensures that the contents haven't changed since the conversion
+         */
+        struct QuadConversionKey {
+            Buffer *buffer; //!< The buffer is attached to the execution that the cache is valid for so it can't be destroyed
+            vk::DeviceSize offset; //!< The offset of the first converted index in the buffer
+            u32 sequenceNumber;
+            u32 elementCount;
+            engine::IndexBuffer::IndexSize indexSize;
+
+            bool operator==(const QuadConversionKey &) const = default;
+        };
+
+        struct QuadConversionKeyHash {
+            size_t operator()(const QuadConversionKey &key) const;
+        };
+
+        struct QuadConversion {
+            BufferBinding binding;
+            vk::IndexType indexType; //!< Conversions done on the GPU always output 32-bit indices
+            u32 elementCount; //!< The amount of source indices that were converted, this may be less than requested if the conversion was too large
+        };
+
+        static constexpr u32 GpuQuadConversionThreshold{0x40000}; //!< The minimum amount of indices for quads to be converted on the GPU rather than on the CPU, this requires splitting the render pass so it's only beneficial for very large draws
+
         dirty::BoundSubresource<EngineRegisters> engine;
         CachedMappedBufferView view{};
         BufferBinding megaBufferBinding{};
@@ -51,6 +76,15 @@ namespace skyline::gpu::interconnect::maxwell3d {
         u32 usedElementCount{};
         u32 usedFirstIndex{};
         bool usedQuadConversion{};
+        u32 quadConversionElementCount{}; //!< The amount of source indices converted for the bound index buffer, this is only valid if `usedQuadConversion` is true
+        std::unordered_map<QuadConversionKey, QuadConversion, QuadConversionKeyHash> quadConversionCache; //!< Converted index buffers from the current execution, these are megabuffer allocations which are only valid for the execution they were made in
+        ContextTag quadConversionCacheTag{}; //!< The execution tag of the execution that the quad conversion cache is valid for
+
+        /**
+         * @brief Converts the quads in the bound index buffer into a triangle list, reusing the result of a prior conversion of the same indices in the current execution if possible
+         * @param convertWholeView If the entire index buffer view should be converted regardless of the draw parameters, this is used for indirect draws
+         */
+        QuadConversion ConvertQuads(InterconnectContext &ctx, u32 firstIndex, u32 elementCount, bool convertWholeView);
 
       public:
         IndexBufferState(dirty::Handle dirtyHandle, DirtyManager &manager, const EngineRegisters &engine);
@@ -60,6 +94,11 @@ namespace skyline::gpu::interconnect::maxwell3d {
         bool Refresh(InterconnectContext &ctx, StateUpdateBuilder &builder, vk::PipelineStageFlags &srcStageMask, vk::PipelineStageFlags &dstStageMask, bool quadConversion, bool estimateSize, u32 firstIndex, u32 elementCount);
 
         void PurgeCaches();
+
+        /**
+         * @return The amount of indices from the first index that are available in the bound quad conversion index buffer
+         */
+        u32 GetQuadConversionElementCount() const;
     };
 
     class TransformFeedbackBufferState : dirty::CachedManualDirty, dirty::RefreshableManualDirty {
@@ -272,6 +311,11 @@ namespace skyline::gpu::interconnect::maxwell3d {
 
         TextureView *GetDepthAttachment();
 
+        /**
+         * @return The amount of indices from the first index that are available in the bound quad conversion index buffer
+         */
+        u32 GetQuadConversionElementCount();
+
         std::shared_ptr<TextureView> GetColorRenderTargetForClear(InterconnectContext &ctx, size_t index);
 
         std::shared_ptr<TextureView> GetDepthRenderTargetForClear(InterconnectContext &ctx);
@@ -13,7 +13,7 @@
 namespace skyline::gpu::interconnect::maxwell3d {
     Maxwell3D::Maxwell3D(GPU &gpu,
                          soc::gm20b::ChannelContext &channelCtx,
-                         nce::NCE &nce,
+                         nce::TrapManager &nce,
                          skyline::kernel::MemoryManager &memoryManager,
                          DirtyManager &manager,
                          const EngineRegisterBundle &registerBundle)
@@ -48,13 +48,14 @@ namespace skyline::gpu::interconnect::maxwell3d {
         });
     }
 
-    vk::DeviceSize Maxwell3D::UpdateQuadConversionBuffer(u32 count, u32 firstVertex) {
-        vk::DeviceSize offset{conversion::quads::GetRequiredBufferSize(firstVertex, sizeof(u32))};
-        vk::DeviceSize size{conversion::quads::GetRequiredBufferSize(count, sizeof(u32)) + offset};
+    void Maxwell3D::UpdateQuadConversionBuffer(u32 count) {
+        vk::DeviceSize size{conversion::quads::GetRequiredBufferSize(count, sizeof(u32))};
 
         if (!quadConversionBuffer || quadConversionBuffer->size_bytes() < size) {
-            quadConversionBuffer = std::make_shared<memory::Buffer>(ctx.gpu.memory.AllocateBuffer(util::AlignUp(size, PAGE_SIZE)));
-            conversion::quads::GenerateQuadListConversionBuffer(quadConversionBuffer->cast<u32>().data(), firstVertex + count);
+            // The buffer is grown geometrically and filled entirely to avoid regenerating it for every draw that's slightly larger than the last
+            vk::DeviceSize allocationSize{std::max<vk::DeviceSize>(std::bit_ceil(size), PAGE_SIZE)};
+            quadConversionBuffer = std::make_shared<memory::Buffer>(ctx.gpu.memory.AllocateBuffer(allocationSize));
+            conversion::quads::GenerateQuadListConversionBuffer(quadConversionBuffer->cast<u32>().data(), static_cast<u32>(allocationSize / sizeof(u32) / conversion::quads::EmittedIndexCount * conversion::quads::QuadVertexCount));
             quadConversionBufferAttached = false;
         }
 
@@ -62,8 +63,6 @@ namespace skyline::gpu::interconnect::maxwell3d {
             ctx.executor.AttachDependency(quadConversionBuffer);
             quadConversionBufferAttached = true;
         }
-
-        return offset;
     }
 
     vk::Rect2D Maxwell3D::GetClearScissor() {
@@ -303,15 +302,17 @@ namespace skyline::gpu::interconnect::maxwell3d {
         PrepareDraw(builder, topology, indexed, false, first, count, srcStageMask, dstStageMask);
 
         if (directState.inputAssembly.NeedsQuadConversion()) {
-            count = conversion::quads::GetIndexCount(count);
-            first = 0;
-
             if (!indexed) {
-                // Use an index buffer to emulate quad lists with a triangle list input topology
-                vk::DeviceSize offset{UpdateQuadConversionBuffer(count, first)};
-                builder.SetIndexBuffer(BufferBinding{quadConversionBuffer->vkBuffer, offset}, vk::IndexType::eUint32);
+                // Use an index buffer to emulate quad lists with a triangle list input topology, the first vertex is applied as a vertex offset so the buffer contents are independent of it
+                UpdateQuadConversionBuffer(count);
+                builder.SetIndexBuffer(BufferBinding{quadConversionBuffer->vkBuffer}, vk::IndexType::eUint32);
+                vertexOffset = first;
                 indexed = true;
             }
+
+            // Indexed draws use an index buffer converted from the first index onwards
+            count = conversion::quads::GetIndexCount(count);
+            first = 0;
         }
 
         auto stateUpdater{builder.Build()};
@@ -366,8 +367,9 @@ namespace skyline::gpu::interconnect::maxwell3d {
 
         PrepareDraw(builder, topology, indexed, true, 0, 0, srcStageMask, dstStageMask);
 
-        if (directState.inputAssembly.NeedsQuadConversion())
-            throw exception("Quad conversion is not supported for indirect draws!");
+        bool quadConversion{directState.inputAssembly.NeedsQuadConversion()};
+        if (quadConversion && !indexed)
+            throw exception("Quad conversion is not supported for non-indexed indirect draws!");
 
         if (indirectBufferView)
             indirectBufferView = indirectBufferView.GetBuffer()->TryGetView(indirectBuffer);
@@ -378,6 +380,23 @@ namespace skyline::gpu::interconnect::maxwell3d {
 
         indirectBufferView.GetBuffer()->BlockSequencedCpuBackingWrites();
 
+        BufferBinding convertedIndirectBuffer{};
+        if (quadConversion) {
+            // The entire index buffer is converted by PrepareDraw as the draw parameters are unknown on the CPU, the commands are rewritten on the GPU to draw the corresponding converted indices
+            if (!util::IsWordAligned(indirectBuffer.data()) || !util::IsWordAligned(stride) || !QuadConversionHelperShader::CanBind(ctx.gpu, indirectBufferView.size))
+                throw exception("Unsupported indirect buffer for quad conversion: 0x{:X} with a stride of 0x{:X}", reinterpret_cast<uintptr_t>(indirectBuffer.data()), stride);
+
+            vk::DeviceSize convertedSize{static_cast<vk::DeviceSize>(count) * QuadConversionHelperShader::IndirectCommandSize};
+            auto allocation{ctx.gpu.megaBufferAllocator.Allocate(ctx.executor.cycle, convertedSize, true)};
+            convertedIndirectBuffer = BufferBinding{allocation.buffer, allocation.offset, convertedSize};
+
+            // The whole view conversion may have been truncated if it was too large, the commands are clamped to only draw the converted indices
+            ctx.executor.AddOutsideRpCommand([source = indirectBufferView, destination = convertedIndirectBuffer, count, stride, convertedIndexCount = activeState.GetQuadConversionElementCount()](vk::raii::CommandBuffer &commandBuffer, const std::shared_ptr<FenceCycle> &cycle, GPU &gpu) {
+                cycle->AttachObject(gpu.helperShaders.quadConversionHelperShader.ConvertIndirectCommands(gpu, commandBuffer, source.GetBinding(gpu), destination, count, stride, convertedIndexCount));
+            });
+            stride = QuadConversionHelperShader::IndirectCommandSize;
+        }
+
         auto stateUpdater{builder.Build()};
 
         /**
@@ -386,13 +405,14 @@ namespace skyline::gpu::interconnect::maxwell3d {
         struct DrawParams {
             StateUpdater stateUpdater;
             BufferView indirectBuffer;
+            BufferBinding convertedIndirectBuffer; //!< If valid, this is used instead of the indirect buffer
             u32 count;
             u32 stride;
             bool indexed;
             bool transformFeedbackEnable;
         };
         auto *drawParams{ctx.executor.allocator->EmplaceUntracked<DrawParams>(DrawParams{stateUpdater,
-                                                                                         indirectBufferView,
+                                                                                         indirectBufferView, convertedIndirectBuffer,
                                                                                          count, stride, indexed,
                                                                                          ctx.gpu.traits.supportsTransformFeedback ? transformFeedbackEnable : false})};
 
@@ -406,7 +426,7 @@ namespace skyline::gpu::interconnect::maxwell3d {
             if (drawParams->transformFeedbackEnable)
                 commandBuffer.beginTransformFeedbackEXT(0, {}, {});
 
-            auto indirectBinding{drawParams->indirectBuffer.GetBinding(gpu)};
+            auto indirectBinding{drawParams->convertedIndirectBuffer ? drawParams->convertedIndirectBuffer : drawParams->indirectBuffer.GetBinding(gpu)};
             if (drawParams->indexed)
                 commandBuffer.drawIndexedIndirect(indirectBinding.buffer, indirectBinding.offset, drawParams->count, drawParams->stride);
             else
@@ -59,7 +59,10 @@ namespace skyline::gpu::interconnect::maxwell3d {
         DescriptorAllocator::ActiveDescriptorSet *activeDescriptorSet{};
         std::vector<TextureView *> activeDescriptorSetSampledImages{};
 
-        size_t UpdateQuadConversionBuffer(u32 count, u32 firstVertex);
+        /**
+         * @brief Ensures the quad list conversion buffer can convert the supplied amount of vertices and attaches it to the current execution
+         */
+        void UpdateQuadConversionBuffer(u32 count);
 
         /**
          * @brief A scissor derived from the current clear register state
@@ -83,7 +86,7 @@ namespace skyline::gpu::interconnect::maxwell3d {
 
         Maxwell3D(GPU &gpu,
                   soc::gm20b::ChannelContext &channelCtx,
-                  nce::NCE &nce,
+                  nce::TrapManager &nce,
                   kernel::MemoryManager &memoryManager,
                   DirtyManager &manager,
                   const EngineRegisterBundle &registerBundle);
@@ -195,7 +195,58 @@ namespace skyline::gpu::interconnect::maxwell3d {
         return info;
     }
 
-    static std::array<ShaderStage, engine::ShaderStageCount> MakePipelineShaders(GPU &gpu, const PipelineStateAccessor &accessor, const PackedPipelineState &packedState) {
+    /**
+     * @brief Hashes all packed state that can affect the output of TranslatePipelineShaders, pipelines with an identical hash and identical shader inputs (binaries, constant buffer values and texture types) will have identical translated shader stages
+     * @param seed A hash of the shader inputs
+     * @note This MUST be kept in sync with the state read by TranslatePipelineShaders and MakeRuntimeInfo, the hash may include state that doesn't affect translation but it must never miss any state that does
+     */
+    static u64 HashShaderState(const PackedPipelineState &packedState, u64 seed) {
+        struct {
+            std::array<u64, engine::PipelineCount> shaderHashes;
+            std::array<u32, 8> postVtgShaderAttributeSkipMask;
+            std::array<Shader::AttributeType, engine::VertexAttributeCount> attributeTypes;
+            float alphaRef;
+            float pointSize;
+            u8 topology;
+            u8 domainType;
+            u8 spacing;
+            u8 outputPrimitives;
+            u8 alphaFunc;
+            u8 bindlessTextureConstantBufferSlotSelect;
+            bool alphaTestEnable;
+            bool transformFeedbackEnable;
+            bool openGlNdc;
+            bool apiMandatedEarlyZ;
+            bool flipYEnable;
+            bool viewportTransformEnable;
+        } shaderState;
+        std::memset(&shaderState, 0, sizeof(shaderState)); // Padding is hashed so it needs to be deterministic
+
+        shaderState.shaderHashes = packedState.shaderHashes;
+        shaderState.postVtgShaderAttributeSkipMask = packedState.postVtgShaderAttributeSkipMask;
+        ranges::transform(packedState.vertexAttributes, shaderState.attributeTypes.begin(), &ConvertShaderAttributeType);
+        shaderState.alphaRef = packedState.alphaRef;
+        shaderState.pointSize = packedState.pointSize;
+        shaderState.topology = static_cast<u8>(packedState.topology);
+        shaderState.domainType = static_cast<u8>(packedState.domainType);
+        shaderState.spacing = static_cast<u8>(packedState.spacing);
+        shaderState.outputPrimitives = static_cast<u8>(packedState.outputPrimitives);
+        shaderState.alphaFunc = packedState.alphaFunc;
+        shaderState.bindlessTextureConstantBufferSlotSelect = packedState.bindlessTextureConstantBufferSlotSelect;
+        shaderState.alphaTestEnable = packedState.alphaTestEnable;
+        shaderState.transformFeedbackEnable = packedState.transformFeedbackEnable;
+        shaderState.openGlNdc = packedState.openGlNdc;
+        shaderState.apiMandatedEarlyZ = packedState.apiMandatedEarlyZ;
+        shaderState.flipYEnable = packedState.flipYEnable;
+        shaderState.viewportTransformEnable = packedState.viewportTransformEnable;
+
+        u64 hash{XXH64(&shaderState, sizeof(shaderState), seed)};
+        if (packedState.transformFeedbackEnable)
+            hash = XXH64(packedState.transformFeedbackVaryings.data(), packedState.transformFeedbackVaryings.size() * sizeof(packedState.transformFeedbackVaryings[0]), hash);
+        return hash;
+    }
+
+    static TranslatedShaderStages TranslatePipelineShaders(GPU &gpu, const PipelineStateAccessor &accessor, const PackedPipelineState &packedState) {
         gpu.shader->ResetPools();
 
         using PipelineStage = engine::Pipeline::Shader::Type;
@@ -203,6 +254,7 @@ namespace skyline::gpu::interconnect::maxwell3d {
         auto stageIdx{[](PipelineStage stage) { return static_cast<u8>(stage); }};
 
         std::array<Shader::IR::Program, engine::PipelineCount> programs;
+        std::array<u64, engine::PipelineCount> programInputHashes{}; //!< Hashes of all inputs to parsing each program that aren't covered by HashShaderState, this includes the result of every constant buffer or texture type read performed by the program
         Shader::IR::Program *layerConversionSourceProgram{};
         bool ignoreVertexCullBeforeFetch{};
 
@@ -215,6 +267,8 @@ namespace skyline::gpu::interconnect::maxwell3d {
             }
 
             auto binary{accessor.GetShaderBinary(i)};
+            auto &inputHash{programInputHashes[i]};
+            inputHash = XXH64(&binary.baseOffset, sizeof(binary.baseOffset), i);
             auto program{gpu.shader->ParseGraphicsShader(
                 packedState.postVtgShaderAttributeSkipMask,
                 ConvertCompilerShaderStage(static_cast<PipelineStage>(i)),
@@ -223,12 +277,19 @@ namespace skyline::gpu::interconnect::maxwell3d {
                 packedState.viewportTransformEnable,
                 [&](u32 index, u32 offset) {
                     u32 shaderStage{i > 0 ? (i - 1) : 0};
-                    return accessor.GetConstantBufferValue(shaderStage, index, offset);
+                    u32 value{accessor.GetConstantBufferValue(shaderStage, index, offset)};
+                    std::array<u32, 3> read{index, offset, value};
+                    inputHash = XXH64(read.data(), sizeof(read), inputHash);
+                    return value;
                 }, [&](u32 index) {
-                    return accessor.GetTextureType(BindlessHandle{ .raw = index }.textureIndex);
+                    auto type{accessor.GetTextureType(BindlessHandle{ .raw = index }.textureIndex)};
+                    std::array<u32, 2> read{index, static_cast<u32>(type)};
+                    inputHash = XXH64(read.data(), sizeof(read), inputHash);
+                    return type;
                 })};
             if (i == stageIdx(PipelineStage::Vertex) && packedState.shaderHashes[stageIdx(PipelineStage::VertexCullBeforeFetch)]) {
                 ignoreVertexCullBeforeFetch = true;
+                inputHash = XXH64(&programInputHashes[stageIdx(PipelineStage::VertexCullBeforeFetch)], sizeof(u64), inputHash);
                 programs[i] = gpu.shader->CombineVertexShaders(programs[stageIdx(PipelineStage::VertexCullBeforeFetch)], program, binary.binary);
             } else {
                 programs[i] = program;
@@ -242,20 +303,37 @@ namespace skyline::gpu::interconnect::maxwell3d {
         Shader::Backend::Bindings bindings{};
         Shader::IR::Program *lastProgram{};
 
-        std::array<ShaderStage, engine::ShaderStageCount> shaderStages{};
+        TranslatedShaderStages translatedStages{};
+
+        // The SPIR-V of a stage depends on its own program, the packed state and all prior stages (through the bindings and their outputs), so the cache key of each stage is chained from the prior one
+        u64 cacheKey{HashShaderState(packedState, static_cast<u64>(hasGeometry))};
 
         for (u32 i{stageIdx(ignoreVertexCullBeforeFetch ? PipelineStage::Vertex : PipelineStage::VertexCullBeforeFetch)}; i < engine::PipelineCount; i++) {
             if (!packedState.shaderHashes[i] && !(i == stageIdx(PipelineStage::Geometry) && layerConversionSourceProgram))
                 continue;
 
+            std::array<u64, 2> stageKey{programInputHashes[i], i}; // Generated passthrough geometry shaders have no inputs of their own, they're fully determined by the prior stages and the packed state
+            cacheKey = XXH64(stageKey.data(), sizeof(stageKey), cacheKey);
+
             auto runtimeInfo{MakeRuntimeInfo(packedState, programs[i], lastProgram, hasGeometry)};
-            shaderStages[i - (i >= 1 ? 1 : 0)] = {ConvertVkShaderStage(pipelineStage(i)),
-                                                  gpu.shader->CompileShader(runtimeInfo, programs[i], bindings, packedState.shaderHashes[i]),
-                                                  programs[i].info};
+            translatedStages[i - (i >= 1 ? 1 : 0)] = {ConvertVkShaderStage(pipelineStage(i)),
+                                                      gpu.shader->TranslateShader(runtimeInfo, programs[i], bindings, packedState.shaderHashes[i], cacheKey),
+                                                      programs[i].info};
 
             lastProgram = &programs[i];
         }
 
+        return translatedStages;
+    }
+
+    static std::array<ShaderStage, engine::ShaderStageCount> MakePipelineShaders(GPU &gpu, const TranslatedShaderStages &translatedStages) {
+        std::array<ShaderStage, engine::ShaderStageCount> shaderStages{};
+        for (size_t i{}; i < engine::ShaderStageCount; i++) {
+            const auto &translatedStage{translatedStages[i]};
+            if (!translatedStage.spirv.empty())
+                shaderStages[i] = {translatedStage.stage, gpu.shader->CreateShaderModule(translatedStage.spirv), translatedStage.info};
+        }
+
         return shaderStages;
     }
 
@@ -662,8 +740,11 @@ namespace skyline::gpu::interconnect::maxwell3d {
     }
 
     Pipeline::Pipeline(GPU &gpu, PipelineStateAccessor &accessor, const PackedPipelineState &packedState)
+        : Pipeline{gpu, accessor, packedState, TranslatePipelineShaders(gpu, accessor, packedState)} {}
+
+    Pipeline::Pipeline(GPU &gpu, PipelineStateAccessor &accessor, const PackedPipelineState &packedState, const TranslatedShaderStages &translatedStages)
         : sourcePackedState{packedState} {
-        auto shaderStages{MakePipelineShaders(gpu, accessor, sourcePackedState)};
+        auto shaderStages{MakePipelineShaders(gpu, translatedStages)};
         descriptorInfo = MakePipelineDescriptorInfo(shaderStages, gpu.traits.quirks.needsIndividualTextureBindingWrites);
         compiledPipeline = MakeCompiledPipeline(gpu, sourcePackedState, shaderStages, descriptorInfo.descriptorSetLayoutBindings);
 
@@ -736,11 +817,13 @@ namespace skyline::gpu::interconnect::maxwell3d {
         u32 writeIdx{};
         auto writes{ctx.executor.allocator->AllocateUntracked<vk::WriteDescriptorSet>(descriptorInfo.totalWriteDescCount)};
 
+        DescriptorInfoStorage descriptorInfoStorage{*ctx.executor.allocator, descriptorInfo.totalBufferDescCount, descriptorInfo.totalImageDescCount};
+
         u32 bufferIdx{};
-        auto bufferDescs{ctx.executor.allocator->AllocateUntracked<vk::DescriptorBufferInfo>(descriptorInfo.totalBufferDescCount)};
+        auto bufferDescs{descriptorInfoStorage.bufferDescs};
         auto bufferDescDynamicBindings{ctx.executor.allocator->AllocateUntracked<DynamicBufferBinding>(descriptorInfo.totalBufferDescCount)};
         u32 imageIdx{};
-        auto imageDescs{ctx.executor.allocator->AllocateUntracked<vk::DescriptorImageInfo>(descriptorInfo.totalImageDescCount)};
+        auto imageDescs{descriptorInfoStorage.imageDescs};
 
         u32 storageBufferIdx{}; // Need to keep track of this to index into the cached view array
         u32 combinedImageSamplerIdx{}; // Need to keep track of this to index into the sampled image array
@@ -837,6 +920,10 @@ namespace skyline::gpu::interconnect::maxwell3d {
             bindingIdx += stage.storageImageDescs.size();
         }
 
+        // The layout of the writes only depends on the pipeline so a template can be created from the first update and reused for all further updates
+        if (!ctx.gpu.traits.supportsPushDescriptors && !descriptorUpdateTemplate)
+            descriptorUpdateTemplate.emplace(CreateDescriptorUpdateTemplate(ctx.gpu, writes.first(writeIdx), descriptorInfoStorage, *compiledPipeline.descriptorSetLayout));
+
         return ctx.executor.allocator->EmplaceUntracked<DescriptorUpdateInfo>(DescriptorUpdateInfo{
             .writes = writes.first(writeIdx),
             .bufferDescs = bufferDescs.first(bufferIdx),
@@ -845,6 +932,8 @@ namespace skyline::gpu::interconnect::maxwell3d {
             .descriptorSetLayout = *compiledPipeline.descriptorSetLayout,
             .bindPoint = vk::PipelineBindPoint::eGraphics,
             .descriptorSetIndex = 0,
+            .updateTemplate = descriptorUpdateTemplate ? **descriptorUpdateTemplate : vk::DescriptorUpdateTemplate{},
+            .templateData = descriptorInfoStorage.data,
         });
     }
 
@@ -943,61 +1032,130 @@ namespace skyline::gpu::interconnect::maxwell3d {
         });
     }
 
-    PipelineManager::PipelineManager(GPU &gpu, JvmManager &jvm) {
+    PipelineManager::PipelineManager(GPU &gpu, JvmManager *jvm) {
         if (!gpu.graphicsPipelineCacheManager)
             return;
 
         std::atomic<u32> compiledCount{};
-        auto [stream, totalPipelineCount]{gpu.graphicsPipelineCacheManager->OpenReadStream()};
-        i64 lastKnownGoodOffset{stream.tellg()};
+        auto &cacheManager{*gpu.graphicsPipelineCacheManager};
+        u32 totalPipelineCount{cacheManager.GetBundleCount()};
 
-        jvm.ShowPipelineLoadingScreen(totalPipelineCount);
+        if (jvm)
+            jvm->ShowPipelineLoadingScreen(totalPipelineCount);
         gpu.graphicsPipelineAssembler->RegisterCompilationCallback([&]() {
-            jvm.UpdatePipelineLoadingProgress(++compiledCount);
+            u32 count{++compiledCount};
+            if (jvm)
+                jvm->UpdatePipelineLoadingProgress(count);
         });
 
-        try {
-            auto startTime{util::GetTimeNs()};
-            PipelineStateBundle bundle;
+        auto startTime{util::GetTimeNs()};
+
+        // Many cached pipelines only differ in state that doesn't affect their shaders, the translated shaders are shared between them so each unique set is only translated once
+        using TranslationFuture = std::shared_future<std::shared_ptr<const TranslatedShaderStages>>;
+        std::mutex translationMutex;
+        std::unordered_map<u64, TranslationFuture> translations;
 
-            while (bundle.Deserialise(stream)) {
-                lastKnownGoodOffset = stream.tellg();
+        std::mutex mapMutex; //!< Protects the pipeline map (and stats) while bundles are being loaded concurrently
+        std::vector<Pipeline *> loadedPipelines(totalPipelineCount); //!< The pipeline loaded from each bundle, this is used to drop pipelines loaded past a corrupted bundle
+        std::atomic<u32> corruptBundleIndex{totalPipelineCount}; //!< The lowest index of a bundle that failed to load
+        std::string corruptBundleError;
+
+        auto loadBundle{[&](u32 bundleIndex) {
+            try {
+                PipelineStateBundle bundle;
+                cacheManager.ReadBundle(bundleIndex, bundle);
                 auto accessor{FilePipelineStateAccessor{bundle}};
-                auto *pipeline{map.emplace(bundle.GetKey<PackedPipelineState>(), std::make_unique<Pipeline>(gpu, accessor, bundle.GetKey<PackedPipelineState>())).first.value().get()};
+                const auto &packedState{bundle.GetKey<PackedPipelineState>()};
+
+                std::promise<std::shared_ptr<const TranslatedShaderStages>> translationPromise;
+                TranslationFuture translation;
+                bool isTranslationOwner{};
+                {
+                    std::scoped_lock lock{translationMutex};
+                    auto [it, inserted]{translations.try_emplace(HashShaderState(packedState, bundle.HashShaderInputs()))};
+                    if (inserted) {
+                        it->second = translationPromise.get_future().share();
+                        isTranslationOwner = true;
+                    }
+                    translation = it->second;
+                }
+
+                if (isTranslationOwner) {
+                    try {
+                        translationPromise.set_value(std::make_shared<const TranslatedShaderStages>(TranslatePipelineShaders(gpu, accessor, packedState)));
+                    } catch (...) {
+                        translationPromise.set_exception(std::current_exception());
+                        throw;
+                    }
+                }
+
+                auto pipeline{std::make_unique<Pipeline>(gpu, accessor, packedState, *translation.get())};
+
+                std::scoped_lock lock{mapMutex};
+                auto [it, inserted]{map.emplace(packedState, std::move(pipeline))};
+                auto *pipelinePtr{it.value().get()};
+                if (inserted)
+                    loadedPipelines[bundleIndex] = pipelinePtr;
                 #ifdef PIPELINE_STATS
-                auto sharedIt{sharedPipelines.find(pipeline->sourcePackedState.shaderHashes)};
+                auto sharedIt{sharedPipelines.find(pipelinePtr->sourcePackedState.shaderHashes)};
                 if (sharedIt == sharedPipelines.end())
-                    sharedPipelines.emplace(pipeline->sourcePackedState.shaderHashes, std::list<Pipeline *>{pipeline});
+                    sharedPipelines.emplace(pipelinePtr->sourcePackedState.shaderHashes, std::list<Pipeline *>{pipelinePtr});
                 else
-                    sharedIt->second.push_back(pipeline);
-                #else
-                (void)pipeline;
+                    sharedIt->second.push_back(pipelinePtr);
                 #endif
+            } catch (const std::exception &e) {
+                std::scoped_lock lock{mapMutex};
+                if (bundleIndex < corruptBundleIndex.load(std::memory_order_relaxed)) {
+                    corruptBundleIndex.store(bundleIndex, std::memory_order_relaxed);
+                    corruptBundleError = e.what();
+                }
             }
+        }};
 
-            gpu.graphicsPipelineAssembler->WaitIdle();
-            Logger::Info("Loaded {} graphics pipelines in {}ms", map.size(), (util::GetTimeNs() - startTime) / constant::NsInMillisecond);
-
-            gpu.graphicsPipelineAssembler->SavePipelineCache();
-
-            #ifdef PIPELINE_STATS
-            for (auto &[key, list] : sharedPipelines) {
-                sortedSharedPipelines.push_back(&list);
+        std::vector<std::future<void>> loadFutures;
+        loadFutures.reserve(totalPipelineCount);
+        for (u32 bundleIndex{}; bundleIndex < totalPipelineCount; bundleIndex++)
+            loadFutures.emplace_back(gpu.workerPool.submit(loadBundle, bundleIndex));
+        for (auto &future : loadFutures)
+            future.wait();
+
+        gpu.graphicsPipelineAssembler->WaitIdle();
+
+        if (u32 corruptIndex{corruptBundleIndex.load()}; corruptIndex != totalPipelineCount) {
+            Logger::Warn("Pipeline cache corrupted at bundle: {}, error: {}", corruptIndex, corruptBundleError);
+            cacheManager.InvalidateAllAfter(corruptIndex);
+
+            // Bundles are loaded out of order so pipelines from bundles past the corrupted one might've been loaded, they're dropped to match the invalidated cache so they'll be recreated and written to the cache again when they're used
+            for (u32 bundleIndex{corruptIndex}; bundleIndex < totalPipelineCount; bundleIndex++) {
+                if (auto pipeline{loadedPipelines[bundleIndex]}) {
+                    #ifdef PIPELINE_STATS
+                    sharedPipelines[pipeline->sourcePackedState.shaderHashes].remove(pipeline);
+                    #endif
+                    auto packedState{pipeline->sourcePackedState}; // The key is copied as it's owned by the pipeline being erased
+                    map.erase(packedState);
+                }
             }
-            std::sort(sortedSharedPipelines.begin(), sortedSharedPipelines.end(), [](const auto &a, const auto &b) {
-                return a->size() > b->size();
-            });
+        }
+
+        auto [moduleCacheHits, moduleCacheMisses]{gpu.shader->GetModuleCacheStats()};
+        Logger::Info("Loaded {} graphics pipelines ({} unique shader sets, {} SPIR-V cache hits, {} misses) in {}ms", map.size(), translations.size(), moduleCacheHits, moduleCacheMisses, (util::GetTimeNs() - startTime) / constant::NsInMillisecond);
 
-            raise(SIGTRAP);
-            #endif
+        gpu.graphicsPipelineAssembler->SavePipelineCache();
 
-        } catch (const exception &e) {
-            Logger::Warn("Pipeline cache corrupted at: 0x{:X}, error: {}", lastKnownGoodOffset, e.what());
-            gpu.graphicsPipelineCacheManager->InvalidateAllAfter(static_cast<u64>(lastKnownGoodOffset));
+        #ifdef PIPELINE_STATS
+        for (auto &[key, list] : sharedPipelines) {
+            sortedSharedPipelines.push_back(&list);
         }
+        std::sort(sortedSharedPipelines.begin(), sortedSharedPipelines.end(), [](const auto &a, const auto &b) {
+            return a->size() > b->size();
+        });
+
+        raise(SIGTRAP);
+        #endif
 
         gpu.graphicsPipelineAssembler->UnregisterCompilationCallback();
-        jvm.HidePipelineLoadingScreen();
+        if (jvm)
+            jvm->HidePipelineLoadingScreen();
     }
 
     Pipeline *PipelineManager::FindOrCreate(InterconnectContext &ctx, Textures &textures, ConstantBufferSet &constantBuffers, const PackedPipelineState &packedState, const std::array<ShaderBinary, engine::PipelineCount> &shaderBinaries) {
@@ -20,6 +20,17 @@ namespace skyline::gpu {
 }
 
 namespace skyline::gpu::interconnect::maxwell3d {
+    /**
+     * @brief The translated SPIR-V of a single shader stage of a pipeline alongside the info required to create a pipeline from it
+     */
+    struct TranslatedShaderStage {
+        vk::ShaderStageFlagBits stage;
+        std::vector<u32> spirv;
+        Shader::Info info;
+    };
+
+    using TranslatedShaderStages = std::array<TranslatedShaderStage, engine::ShaderStageCount>;
+
     class Pipeline {
       public:
         /**
@@ -225,6 +236,8 @@ namespace skyline::gpu::interconnect::maxwell3d {
 
         tsl::robin_map<Pipeline *, bool> bindingMatchCache; //!< Cache of which pipelines have bindings that match this pipeline
 
+        std::optional<vk::raii::DescriptorUpdateTemplate> descriptorUpdateTemplate; //!< A template for full descriptor updates, this is created on the first full update when push descriptors aren't supported
+
         void SyncCachedStorageBufferViews(ContextTag executionTag);
 
       public:
@@ -232,6 +245,11 @@ namespace skyline::gpu::interconnect::maxwell3d {
 
         Pipeline(GPU &gpu, PipelineStateAccessor &accessor, const PackedPipelineState &packedState);
 
+        /**
+         * @brief Creates a pipeline from shader stages that were already translated, this allows sharing translated shaders between pipelines with identical shader state
+         */
+        Pipeline(GPU &gpu, PipelineStateAccessor &accessor, const PackedPipelineState &packedState, const TranslatedShaderStages &translatedStages);
+
         /**
          * @brief Returns the pipeline in the transition cache (if present) that matches the given state
          */
@@ -272,7 +290,10 @@ namespace skyline::gpu::interconnect::maxwell3d {
         #endif
 
       public:
-        PipelineManager(GPU &gpu, JvmManager &jvm);
+        /**
+         * @param jvm The JVM that the pipeline loading screen is shown with while loading cached pipelines, this may be null if there's no UI
+         */
+        PipelineManager(GPU &gpu, JvmManager *jvm);
 
         Pipeline *FindOrCreate(InterconnectContext &ctx, Textures &textures, ConstantBufferSet &constantBuffers, const PackedPipelineState &packedState, const std::array<ShaderBinary, engine::PipelineCount> &shaderBinaries);
     };
@@ -3,6 +3,7 @@
 // Copyright © 2022 Skyline Team and Contributors (https://github.com/skyline-emu/)
 
 #include <gpu/buffer_manager.h>
+#include <gpu/texture_manager.h>
 #include <soc/gm20b/gmmu.h>
 #include <soc/gm20b/channel.h>
 #include "maxwell_dma.h"
@@ -80,4 +81,33 @@ namespace skyline::gpu::interconnect {
             }, {}, {});
         });
     }
+
+    bool MaxwellDma::CopyBlockLinearToPitch(span<u8> dstMapping, span<u8> srcMapping, const BlockLinearHelperShader::CopyLayout &layout) {
+        if (!util::IsWordAligned(dstMapping.data()) || !util::IsWordAligned(srcMapping.data()) || !BlockLinearHelperShader::CanCopy(gpu, layout, srcMapping.size(), dstMapping.size()))
+            return false;
+
+        // Buffers don't synchronize with textures aliasing them, the source could be stale if a texture (such as a render target) wrote to it on the GPU and writes to the destination wouldn't be visible to textures, the CPU path handles these through the texture traps instead
+        if (gpu.texture.HasOverlap(srcMapping) || gpu.texture.HasOverlap(dstMapping))
+            return false;
+
+        auto srcBuf{gpu.buffer.FindOrCreate(srcMapping, executor.tag, [this](std::shared_ptr<Buffer> buffer, ContextLock<Buffer> &&lock) {
+            executor.AttachLockedBuffer(buffer, std::move(lock));
+        })};
+        executor.AttachBuffer(srcBuf);
+
+        auto dstBuf{gpu.buffer.FindOrCreate(dstMapping, executor.tag, [this](std::shared_ptr<Buffer> buffer, ContextLock<Buffer> &&lock) {
+            executor.AttachLockedBuffer(buffer, std::move(lock));
+        })};
+        executor.AttachBuffer(dstBuf);
+
+        // The source must not be written to on the CPU until the shader has read it, the destination isn't entirely written by the shader so the rest of its contents are sequenced on the GPU
+        srcBuf.GetBuffer()->BlockAllCpuBackingWrites();
+        dstBuf.GetBuffer()->BlockSequencedCpuBackingWrites();
+        dstBuf.GetBuffer()->MarkGpuDirty(executor.usageTracker);
+
+        executor.AddOutsideRpCommand([srcBuf, dstBuf, layout](vk::raii::CommandBuffer &commandBuffer, const std::shared_ptr<FenceCycle> &cycle, GPU &gpu) {
+            cycle->AttachObject(gpu.helperShaders.blockLinearHelperShader.Copy(gpu, commandBuffer, srcBuf.GetBinding(gpu), dstBuf.GetBinding(gpu), layout, true));
+        });
+        return true;
+    }
 }
@@ -5,6 +5,7 @@
 #pragma once
 
 #include <soc/gm20b/gmmu.h>
+#include <gpu/shaders/helper_shaders.h>
 
 namespace skyline::gpu {
     class GPU;
@@ -32,5 +33,11 @@ namespace skyline::gpu::interconnect {
         void Copy(span<u8> dstMapping, span<u8> srcMapping);
 
         void Clear(span<u8> mapping, u32 value);
+
+        /**
+         * @brief Copies a block-linear surface into a pitch-linear surface on the GPU using the block-linear helper shader
+         * @return If the copy was done, it can't be done if the helper shader doesn't support it, either mapping isn't word-aligned or any texture overlaps either mapping
+         */
+        bool CopyBlockLinearToPitch(span<u8> dstMapping, span<u8> srcMapping, const BlockLinearHelperShader::CopyLayout &layout);
     };
 }
@@ -1,6 +1,7 @@
 // SPDX-License-Identifier: MPL-2.0
 // Copyright © 2021 Skyline Team and Contributors (https://github.com/skyline-emu/)
 
+#include <numeric>
 #include <gpu.h>
 #include "memory_manager.h"
 
@@ -18,6 +19,70 @@ namespace skyline::gpu::memory {
             vmaDestroyBuffer(vmaAllocator, vkBuffer, vmaAllocation);
     }
 
+    StagingRing::StagingRing(Buffer &&backing) : backing{std::move(backing)} {}
+
+    std::optional<std::pair<u64, vk::DeviceSize>> StagingRing::TryAllocate(vk::DeviceSize size, vk::DeviceSize alignment) {
+        std::scoped_lock lock{mutex};
+
+        vk::DeviceSize offset;
+        if (regions.empty()) {
+            // The ring is entirely free so we can start allocating from the beginning again
+            if (size > backing.size())
+                return std::nullopt;
+            offset = 0;
+        } else {
+            // The alignment isn't necessarily a power of two (it includes the texel block size) so any padding between the head and the region is skipped over, it's reclaimed alongside the prior region
+            vk::DeviceSize tail{regions.front().offset}, alignedHead{util::AlignUpNpot(head, static_cast<ssize_t>(alignment))};
+            if (head > tail) {
+                // The free space is split between the end and the beginning of the ring, any space at the end that's too small for the region is skipped
+                if (alignedHead + size <= backing.size())
+                    offset = alignedHead;
+                else if (size <= tail)
+                    offset = 0;
+                else
+                    return std::nullopt;
+            } else if (alignedHead + size <= tail) {
+                // The ring has wrapped around, the only free space is between the head and the tail
+                offset = alignedHead;
+            } else {
+                return std::nullopt;
+            }
+        }
+
+        head = offset + size;
+        regions.push_back(Region{offset});
+        return std::pair{frontSequence + regions.size() - 1, offset};
+    }
+
+    void StagingRing::Release(u64 sequence) {
+        std::scoped_lock lock{mutex};
+
+        regions[sequence - frontSequence].released = true;
+        while (!regions.empty() && regions.front().released) {
+            regions.pop_front();
+            frontSequence++;
+        }
+    }
+
+    StagingBuffer::StagingBuffer(std::shared_ptr<StagingRing> pRing, u64 ringSequence, vk::DeviceSize offset, vk::DeviceSize size)
+        : span{pRing->GetBacking().subspan(offset, size)},
+          ring{std::move(pRing)},
+          ringSequence{ringSequence},
+          vkBuffer{ring->GetBacking().vkBuffer},
+          offset{offset} {
+        TRACE_COUNTER("gpu", "Staging Bytes In Flight", bytesInFlight.fetch_add(size, std::memory_order_relaxed) + size);
+    }
+
+    StagingBuffer::StagingBuffer(Buffer &&pDedicated) : span{pDedicated}, dedicated{std::move(pDedicated)}, vkBuffer{dedicated->vkBuffer} {
+        TRACE_COUNTER("gpu", "Staging Bytes In Flight", bytesInFlight.fetch_add(size(), std::memory_order_relaxed) + size());
+    }
+
+    StagingBuffer::~StagingBuffer() {
+        TRACE_COUNTER("gpu", "Staging Bytes In Flight", bytesInFlight.fetch_sub(size(), std::memory_order_relaxed) - size());
+        if (ring)
+            ring->Release(ringSequence);
+    }
+
     Image::~Image() {
         if (vmaAllocator && vmaAllocation && vkImage) {
             if (pointer)
@@ -68,16 +133,20 @@ namespace skyline::gpu::memory {
             .vulkanApiVersion = VkApiVersion,
         };
         ThrowOnFail(vmaCreateAllocator(&allocatorCreateInfo, &vmaAllocator));
+
+        stagingAlignment = std::max<vk::DeviceSize>(gpu.traits.minimumStorageBufferAlignment, 4);
     }
 
     MemoryManager::~MemoryManager() {
+        stagingRings.clear(); // The backings of the rings must be destroyed prior to the allocator
         vmaDestroyAllocator(vmaAllocator);
     }
 
-    std::shared_ptr<StagingBuffer> MemoryManager::AllocateStagingBuffer(vk::DeviceSize size) {
+    Buffer MemoryManager::AllocateStagingBacking(vk::DeviceSize size) {
+        // Staging buffers are also bound as storage buffers for the block-linear helper shader to deswizzle between them
         vk::BufferCreateInfo bufferCreateInfo{
             .size = size,
-            .usage = vk::BufferUsageFlagBits::eTransferSrc | vk::BufferUsageFlagBits::eTransferDst,
+            .usage = vk::BufferUsageFlagBits::eTransferSrc | vk::BufferUsageFlagBits::eTransferDst | vk::BufferUsageFlagBits::eStorageBuffer,
             .sharingMode = vk::SharingMode::eExclusive,
             .queueFamilyIndexCount = 1,
             .pQueueFamilyIndices = &gpu.vkQueueFamilyIndex,
@@ -92,7 +161,32 @@ namespace skyline::gpu::memory {
         VmaAllocationInfo allocationInfo;
         ThrowOnFail(vmaCreateBuffer(vmaAllocator, &static_cast<const VkBufferCreateInfo &>(bufferCreateInfo), &allocationCreateInfo, &buffer, &allocation, &allocationInfo));
 
-        return std::make_shared<memory::StagingBuffer>(reinterpret_cast<u8 *>(allocationInfo.pMappedData), size, vmaAllocator, buffer, allocation);
+        return Buffer(reinterpret_cast<u8 *>(allocationInfo.pMappedData), size, vmaAllocator, buffer, allocation);
+    }
+
+    std::shared_ptr<StagingBuffer> MemoryManager::AllocateStagingBuffer(vk::DeviceSize size, vk::DeviceSize texelBlockSize) {
+        if (size <= MaxStagingRingAllocationSize) {
+            // Buffer-image copy offsets must be a multiple of the texel block size (which isn't a power of two for formats such as R16G16B16 or R32G32B32) and of 4, they must also satisfy the storage buffer alignment for the block-linear helper shader
+            vk::DeviceSize alignment{std::lcm(stagingAlignment, std::lcm(texelBlockSize, vk::DeviceSize{4}))};
+            // Regions are padded to the storage alignment to avoid zero-sized regions and to keep the common power-of-two case from requiring any padding between regions
+            vk::DeviceSize alignedSize{std::max(util::AlignUp(size, stagingAlignment), stagingAlignment)};
+
+            std::scoped_lock lock{stagingMutex};
+            for (auto &ring : stagingRings)
+                if (auto allocation{ring->TryAllocate(alignedSize, alignment)})
+                    return std::make_shared<StagingBuffer>(ring, allocation->first, allocation->second, size);
+
+            if (stagingRings.size() < MaxStagingRingCount) {
+                auto &ring{stagingRings.emplace_back(std::make_shared<StagingRing>(AllocateStagingBacking(StagingRingSize)))};
+                auto allocation{ring->TryAllocate(alignedSize, alignment)};
+                return std::make_shared<StagingBuffer>(ring, allocation->first, allocation->second, size);
+            }
+
+            // Waiting on the rings to be drained could deadlock as regions are only reclaimed once their fence cycle releases them, so a dedicated allocation is used instead
+            TRACE_COUNTER("gpu", "Staging Ring Overflows", stagingRingOverflows.fetch_add(1, std::memory_order_relaxed) + 1);
+        }
+
+        return std::make_shared<StagingBuffer>(AllocateStagingBacking(size));
     }
 
     Buffer MemoryManager::AllocateBuffer(vk::DeviceSize size) {
@@ -3,7 +3,9 @@
 
 #pragma once
 
+#include <deque>
 #include <vk_mem_alloc.h>
+#include <common/spin_lock.h>
 #include "fence_cycle.h"
 
 namespace skyline::gpu::memory {
@@ -38,10 +40,71 @@ namespace skyline::gpu::memory {
     };
 
     /**
-     * @brief A Buffer that can be independently attached to a fence cycle
+     * @brief A persistently mapped buffer which staging buffers are linearly suballocated from, regions are reclaimed in allocation order once they've been released
+     * @note Regions may be released in any order, a released region is only reclaimed once all regions allocated prior to it have been released as well
      */
-    class StagingBuffer : public Buffer {
-        using Buffer::Buffer;
+    class StagingRing {
+      private:
+        /**
+         * @brief A region of the ring which hasn't been reclaimed yet
+         */
+        struct Region {
+            vk::DeviceSize offset;
+            bool released{}; //!< If the staging buffer for the region has been destroyed
+        };
+
+        SpinLock mutex; //!< Synchronizes access to the regions and head of the ring
+        Buffer backing;
+        std::deque<Region> regions; //!< All regions which haven't been reclaimed in the order they were allocated in
+        u64 frontSequence{}; //!< The sequence number of the region at the front of `regions`, the sequence number of every subsequent region is incremented by one
+        vk::DeviceSize head{}; //!< The offset in the ring at which the last allocated region ends
+
+      public:
+        StagingRing(Buffer &&backing);
+
+        /**
+         * @brief Allocates a region from the ring if there's enough contiguous space for it
+         * @param size The size of the region, this must be non-zero
+         * @param alignment The alignment of the offset of the region, this isn't required to be a power of two
+         * @return The sequence number and offset of the region, or std::nullopt if the ring doesn't have enough space
+         */
+        std::optional<std::pair<u64, vk::DeviceSize>> TryAllocate(vk::DeviceSize size, vk::DeviceSize alignment);
+
+        /**
+         * @brief Releases the region with the supplied sequence number, reclaiming it and any subsequent released regions if all prior regions have been reclaimed
+         */
+        void Release(u64 sequence);
+
+        const Buffer &GetBacking() const {
+            return backing;
+        }
+    };
+
+    /**
+     * @brief A CPU-mapped region of a Vulkan buffer used as a transfer source or destination that can be independently attached to a fence cycle
+     * @note The region is either suballocated from a StagingRing and returned to it on destruction or backed by a dedicated allocation, all accesses to the buffer **must** be offset by `offset`
+     */
+    class StagingBuffer : public span<u8> {
+      private:
+        std::shared_ptr<StagingRing> ring; //!< The ring that the region was suballocated from, this is null for dedicated allocations
+        u64 ringSequence{}; //!< The sequence number of the region in the ring
+        std::optional<Buffer> dedicated; //!< The dedicated allocation backing the region if it wasn't suballocated from a ring
+
+      public:
+        vk::Buffer vkBuffer;
+        vk::DeviceSize offset{}; //!< The offset of the region in `vkBuffer`
+
+        static inline std::atomic<u64> bytesInFlight{}; //!< The total size of all staging buffers that are currently alive
+
+        StagingBuffer(std::shared_ptr<StagingRing> ring, u64 ringSequence, vk::DeviceSize offset, vk::DeviceSize size);
+
+        StagingBuffer(Buffer &&dedicated);
+
+        StagingBuffer(const StagingBuffer &) = delete;
+
+        StagingBuffer &operator=(const StagingBuffer &) = delete;
+
+        ~StagingBuffer();
     };
 
     /**
@@ -121,15 +184,31 @@ namespace skyline::gpu::memory {
         GPU &gpu;
         VmaAllocator vmaAllocator{VK_NULL_HANDLE};
 
+        static constexpr vk::DeviceSize StagingRingSize{32 * 1024 * 1024}; //!< The size of a single staging ring (32MiB)
+        static constexpr size_t MaxStagingRingCount{4}; //!< The maximum amount of staging rings, allocations which don't fit in any ring past this are dedicated
+        static constexpr vk::DeviceSize MaxStagingRingAllocationSize{StagingRingSize / 4}; //!< The maximum size of an allocation from a staging ring, larger allocations are dedicated as they would exhaust the ring too quickly
+
+        std::mutex stagingMutex; //!< Synchronizes access to the staging rings
+        std::vector<std::shared_ptr<StagingRing>> stagingRings; //!< The staging rings which staging buffers are suballocated from, these are created lazily
+        vk::DeviceSize stagingAlignment{}; //!< The minimum alignment of all staging buffers suballocated from a ring, this satisfies storage buffer binding requirements and is a power of two
+        std::atomic<u64> stagingRingOverflows{};
+
+        /**
+         * @brief Creates a persistently mapped buffer with the usage flags required for staging buffers
+         */
+        Buffer AllocateStagingBacking(vk::DeviceSize size);
+
       public:
         MemoryManager(GPU &gpu);
 
         ~MemoryManager();
 
         /**
-         * @brief Creates a buffer which is optimized for staging (Transfer Source)
+         * @brief Allocates a buffer which is optimized for staging (Transfer Source/Destination), it's suballocated from a staging ring unless it's too large or all rings are exhausted
+         * @param texelBlockSize The size of a texel block of the format of any image the buffer is copied to or from, the offset of the buffer is aligned to it
+         * @note The returned buffer must be attached to the fence cycle of any commands using it, its region is only recycled after it's destroyed
          */
-        std::shared_ptr<StagingBuffer> AllocateStagingBuffer(vk::DeviceSize size);
+        std::shared_ptr<StagingBuffer> AllocateStagingBuffer(vk::DeviceSize size, vk::DeviceSize texelBlockSize = 4);
 
         /**
          * @brief Creates a buffer with a CPU mapping and all usage flags
@@ -2,33 +2,121 @@
 // Copyright © 2022 Skyline Team and Contributors (https://github.com/skyline-emu/)
 
 #include <ostream>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <lz4.h>
 #include <os.h>
 #include "pipeline_cache_manager.h"
 
 namespace skyline::gpu {
+    /*  Main file format pseudocode:
+        PipelineCacheFileHeader header;
+        u8 data[]; // LZ4-compressed shader binaries and bundles, these are referenced by the index entries
+        IndexEntry binaryIndex[header.binaryCount]; // Located at header.indexOffset and sorted by hash
+        IndexEntry bundleIndex[header.bundleCount]; // Located directly after the binary index in the order the bundles were written
+
+        New data is always appended to the end of the file followed by a new index, the header is rewritten last so an interrupted merge leaves the prior index intact
+        Superseded indices and invalidated bundles are left as dead data, the file is compacted into a new file once the dead data exceeds a threshold
+     */
     struct PipelineCacheFileHeader {
         static constexpr u32 Magic{util::MakeMagic<u32>("PCHE")}; //!< The magic value used to identify a pipeline cache file
-        static constexpr u32 Version{3}; //!< The version of the pipeline cache file format, MUST be incremented for any format changes
+        static constexpr u32 Version{4}; //!< The version of the pipeline cache file format, MUST be incremented for any format changes
 
         u32 magic{Magic};
         u32 version{Version};
-        u32 count{0}; //!< The total number of pipeline cache bundles in the file
-
-        auto operator<=>(const PipelineCacheFileHeader &) const = default;
+        u32 bundleCount{};
+        u32 binaryCount{};
+        u64 indexOffset{sizeof(PipelineCacheFileHeader)}; //!< The offset of the index in the file, this is always aligned to 8 bytes
 
         /**
-         * @brief Checks if the header is valid
+         * @brief Checks if the header is valid and its index is contained within a file of the given size
          */
-        bool IsValid() {
+        bool IsValid(size_t fileSize) const {
+            return magic == Magic && version == Version && util::IsAligned(indexOffset, alignof(PipelineCacheManager::IndexEntry)) && indexOffset <= fileSize && (fileSize - indexOffset) / sizeof(PipelineCacheManager::IndexEntry) >= static_cast<u64>(bundleCount) + binaryCount;
+        }
+    };
+
+    /**
+     * @brief The header of pipeline cache files in the legacy v3 format, all bundles were stored sequentially after it
+     */
+    struct LegacyPipelineCacheFileHeader {
+        static constexpr u32 Version{3};
+
+        u32 magic;
+        u32 version;
+        u32 count;
+
+        bool IsValid() const {
+            return magic == PipelineCacheFileHeader::Magic && version == Version;
+        }
+    };
+
+    /*  Staging file format pseudocode:
+        PipelineCacheStagingHeader header;
+        struct {
+            StagingRecordHeader header;
+            u8 data[header.compressedSize]; // LZ4-compressed
+        } records[]; // Read until the end of the file or the first truncated record
+     */
+    struct PipelineCacheStagingHeader {
+        static constexpr u32 Magic{util::MakeMagic<u32>("PCST")}; //!< The magic value used to identify a pipeline cache staging file
+        static constexpr u32 Version{1}; //!< The version of the staging file format, MUST be incremented for any format changes
+
+        u32 magic{Magic};
+        u32 version{Version};
+
+        bool IsValid() const {
             return magic == Magic && version == Version;
         }
     };
 
+    struct StagingRecordHeader {
+        u32 type; //!< The StagingRecordType of the record
+        u32 size; //!< The size of the decompressed data
+        u32 compressedSize;
+        u32 _pad_{};
+        u64 hash;
+        u64 checksum; //!< The XXH64 hash of the decompressed data
+    };
+
+    static constexpr size_t MaxEntrySize{16 * 1024 * 1024}; //!< The maximum size of a single (decompressed) entry, anything larger is treated as corruption
+    static constexpr u64 MinCompactionSize{1024 * 1024}; //!< The minimum amount of dead data in the main file for it to be compacted, the file is also only compacted when the dead data exceeds a quarter of the live data
+
+    void PipelineCacheManager::StagingWriter::WriteRecord(StagingRecordType type, u64 hash, span<u8> data) {
+        compressionBuffer.resize(static_cast<size_t>(LZ4_compressBound(static_cast<int>(data.size()))));
+        auto compressedSize{LZ4_compress_default(reinterpret_cast<const char *>(data.data()), compressionBuffer.data(), static_cast<int>(data.size()), static_cast<int>(compressionBuffer.size()))};
+        if (compressedSize <= 0)
+            throw exception("Failed to compress pipeline cache record: {:016X}", hash);
+
+        StagingRecordHeader header{
+            .type = static_cast<u32>(type),
+            .size = static_cast<u32>(data.size()),
+            .compressedSize = static_cast<u32>(compressedSize),
+            .hash = hash,
+            .checksum = XXH64(data.data(), data.size(), 0),
+        };
+        stream.write(reinterpret_cast<const char *>(&header), sizeof(StagingRecordHeader));
+        stream.write(compressionBuffer.data(), compressedSize);
+    }
+
+    void PipelineCacheManager::StagingWriter::Write(interconnect::PipelineStateBundle &bundle) {
+        // Shader binaries are commonly shared between many pipelines, they're only written the first time they're encountered
+        bundle.Serialise(bundleBuffer, [this](u64 hash, span<u8> binary) {
+            if (writtenBinaries.emplace(hash).second)
+                WriteRecord(StagingRecordType::ShaderBinary, hash, binary);
+        });
+
+        auto key{bundle.GetKey()};
+        WriteRecord(StagingRecordType::Bundle, XXH64(key.data(), key.size(), 0), bundleBuffer);
+    }
+
     void PipelineCacheManager::Run() {
         std::ofstream stream{stagingPath, std::ios::binary | std::ios::trunc};
-        PipelineCacheFileHeader header{};
-        stream.write(reinterpret_cast<const char *>(&header), sizeof(PipelineCacheFileHeader));
+        PipelineCacheStagingHeader header{};
+        stream.write(reinterpret_cast<const char *>(&header), sizeof(PipelineCacheStagingHeader));
 
+        StagingWriter writer{stream, writtenBinaries};
         while (true) {
             std::unique_lock lock(writeMutex);
             if (writeQueue.empty())
@@ -39,96 +127,339 @@ namespace skyline::gpu {
             writeQueue.pop();
             lock.unlock();
 
-            bundle->Serialise(stream);
-
-            header.count++;
-            // Rewrite the header with the updated count
-            auto savedPosition{stream.tellp()};
-            stream.seekp(0, std::ios_base::beg);
-            stream.write(reinterpret_cast<const char *>(&header), sizeof(PipelineCacheFileHeader));
-            stream.seekp(savedPosition);
+            writer.Write(*bundle);
         }
     }
 
-    bool PipelineCacheManager::ValidateHeader(std::ifstream &stream) {
-        if (stream.fail())
-            return false;
+    void PipelineCacheManager::MigrateLegacy() {
+        auto migrationPath{stagingPath + ".migration"};
+        size_t migratedCount{};
+        {
+            std::ofstream stream{migrationPath, std::ios::binary | std::ios::trunc};
+            PipelineCacheStagingHeader header{};
+            stream.write(reinterpret_cast<const char *>(&header), sizeof(PipelineCacheStagingHeader));
 
-        PipelineCacheFileHeader header{};
-        stream.read(reinterpret_cast<char *>(&header), sizeof(PipelineCacheFileHeader));
-        return header.IsValid();
+            std::unordered_set<u64> migratedBinaries;
+            StagingWriter writer{stream, migratedBinaries};
+            interconnect::PipelineStateBundle bundle;
+            auto migrateFile{[&](const std::string &path) {
+                std::ifstream legacyStream{path, std::ios::binary};
+                LegacyPipelineCacheFileHeader legacyHeader{};
+                legacyStream.read(reinterpret_cast<char *>(&legacyHeader), sizeof(LegacyPipelineCacheFileHeader));
+                if (legacyStream.fail() || !legacyHeader.IsValid())
+                    return;
+
+                try {
+                    while (bundle.DeserialiseLegacy(legacyStream)) {
+                        writer.Write(bundle);
+                        migratedCount++;
+                    }
+                } catch (const exception &e) {
+                    Logger::Warn("Legacy pipeline cache corrupted at: 0x{:X}, error: {}", static_cast<i64>(legacyStream.tellg()), e.what());
+                }
+            }};
+
+            migrateFile(mainPath);
+            migrateFile(stagingPath);
+        }
+
+        std::filesystem::rename(migrationPath, stagingPath);
+        std::filesystem::remove(mainPath);
+        Logger::Info("Migrated {} pipelines from the legacy pipeline cache", migratedCount);
     }
 
     void PipelineCacheManager::MergeStaging() {
+        PipelineCacheFileHeader header{};
+        std::vector<IndexEntry> binaries, bundles;
+        std::fstream mainStream{mainPath, std::ios::binary | std::ios::in | std::ios::out};
+        if (!mainStream.fail()) {
+            mainStream.read(reinterpret_cast<char *>(&header), sizeof(PipelineCacheFileHeader));
+            if (!mainStream.fail() && header.IsValid(std::filesystem::file_size(mainPath))) {
+                binaries.resize(header.binaryCount);
+                bundles.resize(header.bundleCount);
+                mainStream.seekg(static_cast<std::streamoff>(header.indexOffset));
+                mainStream.read(reinterpret_cast<char *>(binaries.data()), static_cast<std::streamsize>(binaries.size() * sizeof(IndexEntry)));
+                mainStream.read(reinterpret_cast<char *>(bundles.data()), static_cast<std::streamsize>(bundles.size() * sizeof(IndexEntry)));
+            } else {
+                Logger::Warn("Discarding invalid pipeline cache main file");
+                mainStream.close();
+            }
+        }
+
+        if (!mainStream.is_open() || mainStream.fail()) {
+            // If the main file didn't exist or was invalid then it's recreated with an empty index
+            std::filesystem::create_directories(std::filesystem::path{mainPath}.parent_path());
+            header = {};
+            binaries.clear();
+            bundles.clear();
+            {
+                std::ofstream newStream{mainPath, std::ios::binary | std::ios::trunc};
+                newStream.write(reinterpret_cast<const char *>(&header), sizeof(PipelineCacheFileHeader));
+            }
+            mainStream = std::fstream{mainPath, std::ios::binary | std::ios::in | std::ios::out};
+        }
+
         std::ifstream stagingStream{stagingPath, std::ios::binary};
         if (stagingStream.fail())
             return; // If the staging file doesn't exist then there's nothing to merge
 
-        PipelineCacheFileHeader stagingHeader{};
-        stagingStream.read(reinterpret_cast<char *>(&stagingHeader), sizeof(PipelineCacheFileHeader));
-        if (!stagingHeader.IsValid()) {
+        PipelineCacheStagingHeader stagingHeader{};
+        stagingStream.read(reinterpret_cast<char *>(&stagingHeader), sizeof(PipelineCacheStagingHeader));
+        if (stagingStream.fail() || !stagingHeader.IsValid()) {
             Logger::Warn("Discarding invalid pipeline cache staging file");
             return;
         }
 
-        std::fstream mainStream{mainPath, std::ios::binary | std::ios::in | std::ios::out};
-        PipelineCacheFileHeader mainHeader{};
-        mainStream.seekg(0, std::ios_base::beg);
-        mainStream.read(reinterpret_cast<char *>(&mainHeader), sizeof(PipelineCacheFileHeader));
+        std::unordered_set<u64> binaryHashes, bundleHashes;
+        for (const auto &entry : binaries)
+            binaryHashes.emplace(entry.hash);
+        for (const auto &entry : bundles)
+            bundleHashes.emplace(entry.hash);
+
+        mainStream.seekp(0, std::ios::end);
+        auto writeOffset{static_cast<u64>(mainStream.tellp())};
+        size_t mergedCount{};
+        std::vector<char> buffer;
+        while (true) {
+            // A crash while writing the staging file will leave a truncated record at the end of it, all records prior to it are still valid
+            StagingRecordHeader record{};
+            stagingStream.read(reinterpret_cast<char *>(&record), sizeof(StagingRecordHeader));
+            if (stagingStream.fail() || record.size > MaxEntrySize || record.compressedSize > static_cast<u32>(LZ4_compressBound(static_cast<int>(record.size))))
+                break;
+
+            buffer.resize(record.compressedSize);
+            stagingStream.read(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+            if (stagingStream.fail())
+                break;
+
+            // Records which already exist in the main file are skipped, this deduplicates both bundles and shader binaries
+            auto type{static_cast<StagingRecordType>(record.type)};
+            std::vector<IndexEntry> *index;
+            if (type == StagingRecordType::ShaderBinary && binaryHashes.emplace(record.hash).second)
+                index = &binaries;
+            else if (type == StagingRecordType::Bundle && bundleHashes.emplace(record.hash).second)
+                index = &bundles;
+            else
+                continue;
+
+            mainStream.write(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+            index->push_back(IndexEntry{
+                .hash = record.hash,
+                .checksum = record.checksum,
+                .offset = writeOffset,
+                .size = record.size,
+                .compressedSize = record.compressedSize,
+            });
+            writeOffset += record.compressedSize;
+            mergedCount++;
+        }
+
+        if (!mergedCount)
+            return;
+
+        std::sort(binaries.begin(), binaries.end(), [](const IndexEntry &a, const IndexEntry &b) { return a.hash < b.hash; });
+
+        // Pad the data so the index is aligned, this allows using it directly from the mapping
+        std::array<char, alignof(IndexEntry)> padding{};
+        auto paddingSize{util::AlignUp(writeOffset, alignof(IndexEntry)) - writeOffset};
+        mainStream.write(padding.data(), static_cast<std::streamsize>(paddingSize));
+
+        header.indexOffset = writeOffset + paddingSize;
+        header.binaryCount = static_cast<u32>(binaries.size());
+        header.bundleCount = static_cast<u32>(bundles.size());
+        mainStream.write(reinterpret_cast<const char *>(binaries.data()), static_cast<std::streamsize>(binaries.size() * sizeof(IndexEntry)));
+        mainStream.write(reinterpret_cast<const char *>(bundles.data()), static_cast<std::streamsize>(bundles.size() * sizeof(IndexEntry)));
+        mainStream.flush();
 
-        // Update the main header with the new count
-        mainHeader.count += stagingHeader.count;
+        // The header is only updated after all the data and the index have been written
         mainStream.seekp(0, std::ios_base::beg);
-        mainStream.write(reinterpret_cast<const char *>(&mainHeader), sizeof(PipelineCacheFileHeader));
+        mainStream.write(reinterpret_cast<const char *>(&header), sizeof(PipelineCacheFileHeader));
+        mainStream.flush();
+        if (mainStream.fail())
+            throw exception("Failed to write pipeline cache main file");
 
-        mainStream.seekp(0, std::ios::end);
-        mainStream << stagingStream.rdbuf();
+        Logger::Info("Merged {} pipeline cache records from the staging file", mergedCount);
+    }
+
+    void PipelineCacheManager::CompactMain() {
+        std::ifstream mainStream{mainPath, std::ios::binary};
+        if (mainStream.fail())
+            return;
+
+        PipelineCacheFileHeader header{};
+        mainStream.read(reinterpret_cast<char *>(&header), sizeof(PipelineCacheFileHeader));
+        auto fileSize{std::filesystem::file_size(mainPath)};
+        if (mainStream.fail() || !header.IsValid(fileSize))
+            return;
+
+        std::vector<IndexEntry> binaries(header.binaryCount), bundles(header.bundleCount);
+        mainStream.seekg(static_cast<std::streamoff>(header.indexOffset));
+        mainStream.read(reinterpret_cast<char *>(binaries.data()), static_cast<std::streamsize>(binaries.size() * sizeof(IndexEntry)));
+        mainStream.read(reinterpret_cast<char *>(bundles.data()), static_cast<std::streamsize>(bundles.size() * sizeof(IndexEntry)));
+        if (mainStream.fail())
+            return;
+
+        u64 liveSize{sizeof(PipelineCacheFileHeader) + (binaries.size() + bundles.size()) * sizeof(IndexEntry)};
+        for (const auto &entry : binaries)
+            liveSize += entry.compressedSize;
+        for (const auto &entry : bundles)
+            liveSize += entry.compressedSize;
+
+        u64 deadSize{fileSize > liveSize ? fileSize - liveSize : 0};
+        if (deadSize <= std::max(MinCompactionSize, liveSize / 4))
+            return;
+
+        // The compacted file is written separately and renamed over the main file, an interrupted compaction leaves the main file intact
+        auto compactionPath{mainPath + ".compaction"};
+        {
+            std::ofstream compactStream{compactionPath, std::ios::binary | std::ios::trunc};
+            PipelineCacheFileHeader compactHeader{
+                .bundleCount = header.bundleCount,
+                .binaryCount = header.binaryCount,
+            };
+            compactStream.write(reinterpret_cast<const char *>(&compactHeader), sizeof(PipelineCacheFileHeader));
+
+            u64 writeOffset{sizeof(PipelineCacheFileHeader)};
+            std::vector<char> buffer;
+            auto copyEntries{[&](std::vector<IndexEntry> &entries) {
+                for (auto &entry : entries) {
+                    buffer.resize(entry.compressedSize);
+                    mainStream.seekg(static_cast<std::streamoff>(entry.offset));
+                    mainStream.read(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+                    compactStream.write(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+                    entry.offset = writeOffset;
+                    writeOffset += entry.compressedSize;
+                }
+            }};
+            copyEntries(binaries);
+            copyEntries(bundles);
+
+            std::array<char, alignof(IndexEntry)> padding{};
+            auto paddingSize{util::AlignUp(writeOffset, alignof(IndexEntry)) - writeOffset};
+            compactStream.write(padding.data(), static_cast<std::streamsize>(paddingSize));
+
+            compactHeader.indexOffset = writeOffset + paddingSize;
+            compactStream.write(reinterpret_cast<const char *>(binaries.data()), static_cast<std::streamsize>(binaries.size() * sizeof(IndexEntry)));
+            compactStream.write(reinterpret_cast<const char *>(bundles.data()), static_cast<std::streamsize>(bundles.size() * sizeof(IndexEntry)));
+
+            compactStream.seekp(0, std::ios_base::beg);
+            compactStream.write(reinterpret_cast<const char *>(&compactHeader), sizeof(PipelineCacheFileHeader));
+            compactStream.flush();
+            if (mainStream.fail() || compactStream.fail()) {
+                Logger::Warn("Failed to compact pipeline cache main file");
+                compactStream.close();
+                std::filesystem::remove(compactionPath);
+                return;
+            }
+        }
+
+        mainStream.close();
+        std::filesystem::rename(compactionPath, mainPath);
+        Logger::Info("Compacted pipeline cache main file, reclaimed 0x{:X} bytes", deadSize);
+    }
+
+    void PipelineCacheManager::MapMain() {
+        int fd{open(mainPath.c_str(), O_RDONLY | O_CLOEXEC)};
+        if (fd < 0)
+            throw exception("Failed to open pipeline cache main file: {}", strerror(errno));
+
+        struct stat fileStat{};
+        if (fstat(fd, &fileStat) < 0) {
+            close(fd);
+            throw exception("Failed to stat pipeline cache main file: {}", strerror(errno));
+        }
+
+        auto fileSize{static_cast<size_t>(fileStat.st_size)};
+        auto pointer{mmap(nullptr, fileSize, PROT_READ, MAP_PRIVATE, fd, 0)};
+        close(fd);
+        if (pointer == MAP_FAILED)
+            throw exception("Failed to map pipeline cache main file: {}", strerror(errno));
+        mapping = span<const u8>{static_cast<const u8 *>(pointer), fileSize};
+
+        auto header{mapping.as<const PipelineCacheFileHeader>()};
+        if (!header.IsValid(fileSize))
+            throw exception("Pipeline cache main file corrupted at runtime!");
+
+        binaryIndex = mapping.subspan(header.indexOffset, header.binaryCount * sizeof(IndexEntry)).cast<const IndexEntry>();
+        bundleIndex = mapping.subspan(header.indexOffset + header.binaryCount * sizeof(IndexEntry), header.bundleCount * sizeof(IndexEntry)).cast<const IndexEntry>();
+    }
+
+    void PipelineCacheManager::ReadEntry(const IndexEntry &entry, std::vector<u8> &output) const {
+        if (entry.offset > mapping.size() || mapping.size() - entry.offset < entry.compressedSize || entry.size > MaxEntrySize)
+            throw exception("Pipeline cache entry out of bounds: 0x{:X} (Size: 0x{:X})", entry.offset, entry.compressedSize);
+
+        output.resize(entry.size);
+        auto decompressedSize{LZ4_decompress_safe(reinterpret_cast<const char *>(mapping.data() + entry.offset), reinterpret_cast<char *>(output.data()), static_cast<int>(entry.compressedSize), static_cast<int>(entry.size))};
+        if (decompressedSize != static_cast<int>(entry.size) || XXH64(output.data(), output.size(), 0) != entry.checksum)
+            throw exception("Pipeline cache entry checksum mismatch: {:016X}", entry.hash);
     }
 
     PipelineCacheManager::PipelineCacheManager(const DeviceState &state, const std::string &path)
         : stagingPath{path + ".staging"}, mainPath{path} {
-        bool didExist{std::filesystem::exists(mainPath)};
-        if (didExist) { // If the main file exists then we need to validate it
+        {
             std::ifstream mainStream{mainPath, std::ios::binary};
-            if (!ValidateHeader(mainStream)) { // Force a recreation of the file if it's invalid
-                Logger::Warn("Discarding invalid pipeline cache main file");
-                std::filesystem::remove(mainPath);
-                didExist = false;
+            LegacyPipelineCacheFileHeader legacyHeader{};
+            mainStream.read(reinterpret_cast<char *>(&legacyHeader), sizeof(LegacyPipelineCacheFileHeader));
+            if (!mainStream.fail() && legacyHeader.IsValid()) {
+                mainStream.close();
+                MigrateLegacy();
             }
         }
 
-        if (!didExist) { // If the main file didn't exist we need to write the header
-            std::filesystem::create_directories(std::filesystem::path{mainPath}.parent_path());
-            std::ofstream mainStream{mainPath, std::ios::binary | std::ios::app};
-            PipelineCacheFileHeader header{};
-            mainStream.write(reinterpret_cast<const char *>(&header), sizeof(PipelineCacheFileHeader));
-        }
-
-        // Merge any staging changes into the main file before starting the writer thread
+        // Merge any staging changes into the main file before mapping it and starting the writer thread
         MergeStaging();
+        CompactMain();
+        MapMain();
+
+        writtenBinaries.reserve(binaryIndex.size());
+        for (const auto &entry : binaryIndex)
+            writtenBinaries.emplace(entry.hash);
+
         writerThread = std::thread(&PipelineCacheManager::Run, this);
     }
 
+    PipelineCacheManager::~PipelineCacheManager() {
+        if (!mapping.empty())
+            munmap(const_cast<u8 *>(mapping.data()), mapping.size());
+    }
+
     void PipelineCacheManager::QueueWrite(std::unique_ptr<interconnect::PipelineStateBundle> bundle) {
         std::scoped_lock lock{writeMutex};
         writeQueue.emplace(std::move(bundle));
         writeCondition.notify_one();
     }
 
-    std::pair<std::ifstream, u32> PipelineCacheManager::OpenReadStream() {
-        auto mainStream{std::ifstream{mainPath, std::ios::binary}};
-        if (mainStream.fail())
-            throw exception("Pipeline cache main file missing at runtime!");
+    void PipelineCacheManager::ReadBundle(u32 index, interconnect::PipelineStateBundle &bundle) const {
+        std::vector<u8> bundleData;
+        ReadEntry(bundleIndex[index], bundleData);
 
-        PipelineCacheFileHeader header{};
-        mainStream.read(reinterpret_cast<char *>(&header), sizeof(PipelineCacheFileHeader));
-        if (!header.IsValid())
-            throw exception("Pipeline cache main file corrupted at runtime!");
+        bundle.Deserialise(bundleData, [this](u64 hash, std::vector<u8> &binary) {
+            auto it{std::lower_bound(binaryIndex.begin(), binaryIndex.end(), hash, [](const IndexEntry &entry, u64 hash) { return entry.hash < hash; })};
+            if (it == binaryIndex.end() || it->hash != hash)
+                throw exception("Pipeline shader binary missing from cache: {:016X}", hash);
 
-        return {std::move(mainStream), header.count};
+            ReadEntry(*it, binary);
+        });
     }
 
-    void PipelineCacheManager::InvalidateAllAfter(u64 offset) {
-        std::filesystem::resize_file(mainPath, offset);
+    void PipelineCacheManager::InvalidateAllAfter(u32 index) {
+        if (index >= bundleIndex.size())
+            return;
+
+        // Only the bundle count in the header needs to be reduced, the invalidated bundles will be left as dead data in the file
+        auto header{mapping.as<const PipelineCacheFileHeader>()};
+        header.bundleCount = index;
+
+        std::fstream mainStream{mainPath, std::ios::binary | std::ios::in | std::ios::out};
+        mainStream.write(reinterpret_cast<const char *>(&header), sizeof(PipelineCacheFileHeader));
+        mainStream.flush();
+        if (mainStream.fail()) {
+            // The invalidated bundles would be loaded again on the next launch, the entire main file is discarded instead as it can't be trusted
+            Logger::Warn("Failed to invalidate pipeline cache bundles, discarding the main file");
+            mainStream.close();
+            std::error_code error;
+            std::filesystem::remove(mainPath, error);
+        }
+        bundleIndex = bundleIndex.first(index);
     }
 }
@@ -4,15 +4,36 @@
 #pragma once
 
 #include <queue>
+#include <unordered_set>
 #include <common.h>
 #include "interconnect/common/pipeline_state_bundle.h"
 
 namespace skyline::gpu {
     /**
      * @brief Manages access and validation of the underlying pipeline cache files
+     * @note The main cache file is indexed and memory-mapped, bundles can be read in any order and from any thread
+     * @note New bundles are appended to a staging journal at runtime which is merged into the main file on the next launch
      */
     class PipelineCacheManager {
+      public:
+        /**
+         * @brief An entry in the index of the main file, this is used for both bundles and shader binaries
+         */
+        struct IndexEntry {
+            u64 hash; //!< The hash of the pipeline key for bundles or the hash of the contents for shader binaries
+            u64 checksum; //!< The XXH64 hash of the decompressed data
+            u64 offset; //!< The offset of the LZ4-compressed data in the file
+            u32 size; //!< The size of the decompressed data
+            u32 compressedSize;
+        };
+        static_assert(sizeof(IndexEntry) == 0x20);
+
       private:
+        enum class StagingRecordType : u32 {
+            ShaderBinary = 0, //!< A shader binary which is referenced by hash from bundles
+            Bundle = 1, //!< A serialised pipeline state bundle
+        };
+
         std::thread writerThread;
         std::queue<std::unique_ptr<interconnect::PipelineStateBundle>> writeQueue; //!< The queue of pipeline state bundles to be written to the cache
         std::mutex writeMutex; //!< Protects access to the write queue
@@ -20,29 +41,79 @@ namespace skyline::gpu {
         std::string stagingPath; //!< The path to the staging pipeline cache file, which will be actively written to at runtime
         std::string mainPath; //!< The path to the main pipeline cache file
 
+        span<const u8> mapping; //!< A read-only mapping of the main pipeline cache file
+        span<const IndexEntry> bundleIndex; //!< The index of all bundles in the main file, in the order they were written
+        span<const IndexEntry> binaryIndex; //!< The index of all shader binaries in the main file, sorted by hash
+        std::unordered_set<u64> writtenBinaries; //!< The hashes of all shader binaries in either the main or the staging file, this is only accessed by the writer thread after construction
+
+        /**
+         * @brief A reusable set of buffers for serialising bundles into the staging file
+         */
+        struct StagingWriter {
+            std::ofstream &stream;
+            std::unordered_set<u64> &writtenBinaries;
+            std::vector<u8> bundleBuffer;
+            std::vector<char> compressionBuffer;
+
+            void WriteRecord(StagingRecordType type, u64 hash, span<u8> data);
+
+            void Write(interconnect::PipelineStateBundle &bundle);
+        };
+
         void Run();
 
-        bool ValidateHeader(std::ifstream &stream);
+        /**
+         * @brief Converts the legacy (v3) main and staging files into a staging file in the current format, the legacy main file is deleted afterwards
+         */
+        void MigrateLegacy();
 
+        /**
+         * @brief Appends all new records in the staging file to the main file and rewrites its index
+         */
         void MergeStaging();
 
+        /**
+         * @brief Rewrites the main file without any dead data if the amount of it exceeds a threshold, dead data consists of superseded indices and invalidated bundles
+         */
+        void CompactMain();
+
+        /**
+         * @brief Maps the main file into memory and validates its index
+         */
+        void MapMain();
+
+        /**
+         * @brief Decompresses and validates the data of an index entry into the supplied buffer
+         */
+        void ReadEntry(const IndexEntry &entry, std::vector<u8> &output) const;
+
       public:
         PipelineCacheManager(const DeviceState &state, const std::string &path);
 
+        ~PipelineCacheManager();
+
         /**
          * @brief Queues a pipeline state bundle to be written to the cache
          */
         void QueueWrite(std::unique_ptr<interconnect::PipelineStateBundle> bundle);
 
         /**
-         * @brief Opens the main pipeline cache file for reading
-         * @return A pair containing the stream and the total pipeline count
+         * @return The total amount of bundles in the main file
+         */
+        u32 GetBundleCount() const {
+            return static_cast<u32>(bundleIndex.size());
+        }
+
+        /**
+         * @brief Reads a bundle from the main file into the supplied bundle
+         * @note This is thread-safe and bundles can be read in any order
+         * @note An exception is thrown if the bundle is corrupted
          */
-        std::pair<std::ifstream, u32> OpenReadStream();
+        void ReadBundle(u32 index, interconnect::PipelineStateBundle &bundle) const;
 
         /**
-         * @brief Shrinks the pipeline cache file to `offset` bytes, removing any (potentially invalid) data after that point
+         * @brief Removes the bundle at `index` and all bundles after it from the main file, this is used to drop (potentially invalid) bundles after corruption was detected
          */
-        void InvalidateAllAfter(u64 offset);
+        void InvalidateAllAfter(u32 index);
     };
 }
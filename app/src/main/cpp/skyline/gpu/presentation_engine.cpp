@@ -22,12 +22,12 @@ namespace skyline::gpu {
     using namespace service::hosbinder;
 
     PresentationEngine::PresentationEngine(const DeviceState &state, GPU &gpu)
-        : state{state},
+        : Presenter{std::make_shared<kernel::type::KEvent>(state, true)},
+          state{state},
           gpu{gpu},
           presentSemaphores{util::MakeFilledArray<vk::raii::Semaphore, MaxSwapchainImageCount>(gpu.vkDevice, vk::SemaphoreCreateInfo{})},
           acquireSemaphores{util::MakeFilledArray<vk::raii::Semaphore, MaxSwapchainImageCount>(gpu.vkDevice, vk::SemaphoreCreateInfo{})},
           presentationTrack{static_cast<u64>(trace::TrackIds::Presentation), perfetto::ProcessTrack::Current()},
-          vsyncEvent{std::make_shared<kernel::type::KEvent>(state, true)},
           choreographerThread{&PresentationEngine::ChoreographerThread, this},
           presentationThread{&PresentationEngine::PresentationThread, this} {
         auto desc{presentationTrack.Serialize()};
@@ -398,19 +398,25 @@ namespace skyline::gpu {
             surfaceCondition.wait(lock, [this] { return vkSurface.has_value(); });
         }
 
+        size_t frameId{nextFrameId.load(std::memory_order_relaxed)};
         presentQueue.Push(PresentableFrame{
             texture,
             fence,
             timestamp,
             swapInterval,
             presentCallback,
-            nextFrameId,
+            frameId,
             crop,
             scalingMode,
             transform
         });
 
-        return nextFrameId++;
+        #ifdef GPFIFO_TRACE
+        state.soc->gpfifoTrace.Frame(frameId, util::GetTimeNs());
+        #endif
+
+        nextFrameId.store(frameId + 1, std::memory_order_release);
+        return frameId;
     }
 
     NativeWindowTransform PresentationEngine::GetTransformHint() {
@@ -9,7 +9,7 @@
 #include <common/circular_queue.h>
 #include <kernel/types/KEvent.h>
 #include <services/hosbinder/GraphicBufferProducer.h>
-#include "texture/texture.h"
+#include "presenter.h"
 
 struct ANativeWindow;
 
@@ -17,7 +17,7 @@ namespace skyline::gpu {
     /**
      * @brief All host presentation is handled by this, it manages the host surface and swapchain alongside dynamically recreating it when required
      */
-    class PresentationEngine {
+    class PresentationEngine : public Presenter {
       private:
         const DeviceState &state;
         GPU &gpu;
@@ -53,7 +53,6 @@ namespace skyline::gpu {
 
       public:
         std::atomic<bool> skipSignal; //!< If true, the next signal will be skipped by the choreographer thread
-        std::shared_ptr<kernel::type::KEvent> vsyncEvent; //!< Signalled every time a frame is drawn
 
       private:
         std::thread choreographerThread; //!< A thread for signalling the V-Sync event and measure the refresh cycle duration using AChoreographer
@@ -78,7 +77,7 @@ namespace skyline::gpu {
         std::thread presentationThread; //!< A thread for asynchronously presenting queued frames after their corresponded fences are signalled
         static constexpr size_t PresentQueueFrameCount{5}; //!< The amount of frames the presentation queue can hold
         CircularQueue<PresentableFrame> presentQueue{PresentQueueFrameCount}; //!< A circular queue containing all the frames that we can present
-        size_t nextFrameId{1}; //!< The frame ID to use for the next frame
+        std::atomic<size_t> nextFrameId{1}; //!< The frame ID to use for the next frame, this is atomic as it may be read by other threads
 
         /**
          * @url https://developer.android.com/ndk/reference/group/choreographer#achoreographer_postframecallback64
@@ -108,30 +107,19 @@ namespace skyline::gpu {
       public:
         PresentationEngine(const DeviceState &state, GPU &gpu);
 
-        ~PresentationEngine();
+        ~PresentationEngine() override;
 
         /**
          * @brief Replaces the underlying Android surface with a new one, it handles resetting the swapchain and such
          */
         void UpdateSurface(jobject newSurface);
 
-        /**
-         * @brief Queue the supplied texture to be presented to the screen
-         * @param timestamp The earliest timestamp (relative to skyline::util::GetTickNs) at which the frame must be presented, it should be 0 when it doesn't matter
-         * @param swapInterval The amount of display refreshes that must take place prior to presenting this image
-         * @param crop A rectangle with bounds that the image will be cropped to
-         * @param scalingMode The mode by which the image must be scaled up to the surface
-         * @param transform A transformation that should be performed on the image
-         * @param fence The fence to wait on prior to presenting the texture
-         * @param presentCallback The callback to be called when the texture is presented to the surface
-         * @return The ID of this frame for correlating it with presentation timing readouts
-         * @note The texture **must** be locked prior to calling this
-         */
-        u64 Present(const std::shared_ptr<TextureView> &texture, i64 timestamp, i64 swapInterval, service::hosbinder::AndroidRect crop, service::hosbinder::NativeWindowScalingMode scalingMode, service::hosbinder::NativeWindowTransform transform, skyline::service::hosbinder::AndroidFence fence, const std::function<void()>& presentCallback);
+        u64 Present(const std::shared_ptr<TextureView> &texture, i64 timestamp, i64 swapInterval, service::hosbinder::AndroidRect crop, service::hosbinder::NativeWindowScalingMode scalingMode, service::hosbinder::NativeWindowTransform transform, skyline::service::hosbinder::AndroidFence fence, const std::function<void()> &presentCallback) override;
 
-        /**
-         * @return A transform that the application should render with to elide costly transforms later
-         */
-        service::hosbinder::NativeWindowTransform GetTransformHint();
+        size_t GetNextFrameId() const override {
+            return nextFrameId.load(std::memory_order_acquire);
+        }
+
+        service::hosbinder::NativeWindowTransform GetTransformHint() override;
     };
 }
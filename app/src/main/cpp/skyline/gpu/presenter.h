@@ -0,0 +1,50 @@
+// SPDX-License-Identifier: MPL-2.0
+// Copyright © 2022 Skyline Team and Contributors (https://github.com/skyline-emu/)
+
+#pragma once
+
+#include <services/hosbinder/android_types.h>
+#include <services/hosbinder/native_window.h>
+#include "texture/texture.h"
+
+namespace skyline::kernel::type {
+    class KEvent;
+}
+
+namespace skyline::gpu {
+    /**
+     * @brief An interface for presenting frames submitted by the guest, this is implemented by PresentationEngine for presenting to an Android surface
+     */
+    class Presenter {
+      public:
+        std::shared_ptr<kernel::type::KEvent> vsyncEvent; //!< Signalled every time a frame is drawn, this may be null if there's no guest to signal
+
+        Presenter(std::shared_ptr<kernel::type::KEvent> vsyncEvent = {}) : vsyncEvent{std::move(vsyncEvent)} {}
+
+        virtual ~Presenter() = default;
+
+        /**
+         * @brief Queue the supplied texture to be presented to the screen
+         * @param timestamp The earliest timestamp (relative to skyline::util::GetTickNs) at which the frame must be presented, it should be 0 when it doesn't matter
+         * @param swapInterval The amount of display refreshes that must take place prior to presenting this image
+         * @param crop A rectangle with bounds that the image will be cropped to
+         * @param scalingMode The mode by which the image must be scaled up to the surface
+         * @param transform A transformation that should be performed on the image
+         * @param fence The fence to wait on prior to presenting the texture
+         * @param presentCallback The callback to be called when the texture is presented to the surface
+         * @return The ID of this frame for correlating it with presentation timing readouts
+         * @note The texture **must** be locked prior to calling this
+         */
+        virtual u64 Present(const std::shared_ptr<TextureView> &texture, i64 timestamp, i64 swapInterval, service::hosbinder::AndroidRect crop, service::hosbinder::NativeWindowScalingMode scalingMode, service::hosbinder::NativeWindowTransform transform, service::hosbinder::AndroidFence fence, const std::function<void()> &presentCallback) = 0;
+
+        /**
+         * @return The ID that will be assigned to the next frame passed to Present, this can be used to detect frame boundaries from other threads
+         */
+        virtual size_t GetNextFrameId() const = 0;
+
+        /**
+         * @return A transform that the application should render with to elide costly transforms later
+         */
+        virtual service::hosbinder::NativeWindowTransform GetTransformHint() = 0;
+    };
+}
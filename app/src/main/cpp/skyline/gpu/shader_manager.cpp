@@ -71,7 +71,7 @@ namespace skyline::gpu {
         return binary;
     }
 
-    ShaderManager::ShaderManager(const DeviceState &state, GPU &gpu, std::string_view replacementDir, std::string_view dumpDir) : gpu{gpu}, dumpPath{dumpDir} {
+    ShaderManager::ShaderManager(const DeviceState &state, GPU &gpu, std::string_view replacementDir, std::string_view dumpDir, std::string_view moduleCachePath) : gpu{gpu}, dumpPath{dumpDir} {
         LoadShaderReplacements(replacementDir);
 
         if constexpr (DumpShaders) {
@@ -142,6 +142,29 @@ namespace skyline::gpu {
                 .active = false,
             },
         };
+
+        // Cached SPIR-V would bypass shader replacement and dumping, so the cache is only used when neither of them are
+        if (!moduleCachePath.empty() && guestShaderReplacements.empty() && hostShaderReplacements.empty() && !DumpShaders) {
+            // The fingerprint covers all state that is supplied to the shader compiler besides the per-shader inputs, every value is hashed individually as the structures may contain padding
+            u64 fingerprint{};
+            auto hashValues{[&fingerprint](const auto &...values) {
+                ((fingerprint = XXH64(&values, sizeof(values), fingerprint)), ...);
+            }};
+            hashValues(profile.supported_spirv, profile.unified_descriptor_binding, profile.support_descriptor_aliasing, profile.support_int8, profile.support_int16, profile.support_int64,
+                       profile.support_vertex_instance_id, profile.support_float_controls, profile.support_separate_denorm_behavior, profile.support_separate_rounding_mode,
+                       profile.support_fp16_denorm_preserve, profile.support_fp32_denorm_preserve, profile.support_fp16_denorm_flush, profile.support_fp32_denorm_flush,
+                       profile.support_fp16_signed_zero_nan_preserve, profile.support_fp32_signed_zero_nan_preserve, profile.support_fp64_signed_zero_nan_preserve,
+                       profile.support_explicit_workgroup_layout, profile.support_vote, profile.support_viewport_index_layer_non_geometry, profile.support_viewport_mask,
+                       profile.support_typeless_image_loads, profile.support_demote_to_helper_invocation, profile.support_int64_atomics, profile.support_derivative_control,
+                       profile.support_geometry_shader_passthrough, profile.support_native_ndc, profile.warp_size_potentially_larger_than_guest, profile.lower_left_origin_mode,
+                       profile.need_declared_frag_colors, profile.has_broken_spirv_position_input, profile.has_broken_spirv_subgroup_mask_vector_extract_dynamic,
+                       profile.has_broken_spirv_subgroup_shuffle, profile.max_subgroup_size, profile.has_broken_spirv_vector_access_chain, profile.disable_subgroup_shuffle);
+            hashValues(hostTranslateInfo.support_float16, hostTranslateInfo.support_int64, hostTranslateInfo.needs_demote_reorder, hostTranslateInfo.support_snorm_render_buffer,
+                       hostTranslateInfo.support_viewport_index_layer, hostTranslateInfo.min_ssbo_alignment, hostTranslateInfo.support_geometry_shader_passthrough);
+            hashValues(Shader::Settings::values.renderer_debug, Shader::Settings::values.disable_shader_loop_safety_checks);
+
+            moduleCache.emplace(std::string{moduleCachePath}, fingerprint);
+        }
     }
 
     /**
@@ -387,24 +410,20 @@ namespace skyline::gpu {
                                                            const ConstantBufferRead &constantBufferRead, const GetTextureType &getTextureType) {
         binary = ProcessShaderBinary(false, hash, binary);
 
-        std::scoped_lock lock{poolMutex};
-
+        auto &pools{GetThreadPools()};
         GraphicsEnvironment environment{postVtgShaderAttributeSkipMask, stage, binary, baseOffset, textureConstantBufferIndex, viewportTransformEnabled, constantBufferRead, getTextureType};
-        Shader::Maxwell::Flow::CFG cfg{environment, flowBlockPool, Shader::Maxwell::Location{static_cast<u32>(baseOffset + sizeof(Shader::ProgramHeader))}};
-        return  Shader::Maxwell::TranslateProgram(instructionPool, blockPool, environment, cfg, hostTranslateInfo);
+        Shader::Maxwell::Flow::CFG cfg{environment, pools.flowBlockPool, Shader::Maxwell::Location{static_cast<u32>(baseOffset + sizeof(Shader::ProgramHeader))}};
+        return  Shader::Maxwell::TranslateProgram(pools.instructionPool, pools.blockPool, environment, cfg, hostTranslateInfo);
     }
 
     Shader::IR::Program ShaderManager::CombineVertexShaders(Shader::IR::Program &vertexA, Shader::IR::Program &vertexB, span<u8> vertexBBinary) {
-        std::scoped_lock lock{poolMutex};
-
         VertexBEnvironment env{vertexBBinary};
         return Shader::Maxwell::MergeDualVertexPrograms(vertexA, vertexB, env);
     }
 
     Shader::IR::Program ShaderManager::GenerateGeometryPassthroughShader(Shader::IR::Program &layerSource, Shader::OutputTopology topology) {
-        std::scoped_lock lock{poolMutex};
-
-        return Shader::Maxwell::GenerateGeometryPassthrough(instructionPool, blockPool, hostTranslateInfo, layerSource, topology);
+        auto &pools{GetThreadPools()};
+        return Shader::Maxwell::GenerateGeometryPassthrough(pools.instructionPool, pools.blockPool, hostTranslateInfo, layerSource, topology);
     }
 
     Shader::IR::Program ShaderManager::ParseComputeShader(u64 hash, span<u8> binary, u32 baseOffset,
@@ -414,22 +433,34 @@ namespace skyline::gpu {
                                                           const ConstantBufferRead &constantBufferRead, const GetTextureType &getTextureType) {
         binary = ProcessShaderBinary(false, hash, binary);
 
-        std::scoped_lock lock{poolMutex};
-
+        auto &pools{GetThreadPools()};
         ComputeEnvironment environment{binary, baseOffset, textureConstantBufferIndex, localMemorySize, sharedMemorySize, workgroupDimensions, constantBufferRead, getTextureType};
-        Shader::Maxwell::Flow::CFG cfg{environment, flowBlockPool, Shader::Maxwell::Location{static_cast<u32>(baseOffset)}};
-        return Shader::Maxwell::TranslateProgram(instructionPool, blockPool, environment, cfg, hostTranslateInfo);
+        Shader::Maxwell::Flow::CFG cfg{environment, pools.flowBlockPool, Shader::Maxwell::Location{static_cast<u32>(baseOffset)}};
+        return Shader::Maxwell::TranslateProgram(pools.instructionPool, pools.blockPool, environment, cfg, hostTranslateInfo);
     }
 
-    vk::ShaderModule ShaderManager::CompileShader(const Shader::RuntimeInfo &runtimeInfo, Shader::IR::Program &program, Shader::Backend::Bindings &bindings, u64 hash) {
-        std::scoped_lock lock{poolMutex};
-
+    std::vector<u32> ShaderManager::TranslateShader(const Shader::RuntimeInfo &runtimeInfo, Shader::IR::Program &program, Shader::Backend::Bindings &bindings, u64 hash, u64 cacheKey) {
+        // This modifies the program info which is used after translation so it's done regardless of if the SPIR-V is cached
         if (program.info.loads.Legacy() || program.info.stores.Legacy())
             Shader::Maxwell::ConvertLegacyToGeneric(program, runtimeInfo);
 
+        bool useModuleCache{moduleCache && cacheKey};
+        std::vector<u32> spirvCached;
+        if (useModuleCache && moduleCache->Load(cacheKey, spirvCached, bindings))
+            return spirvCached;
+
         auto spirvEmitted{Shader::Backend::SPIRV::EmitSPIRV(profile, runtimeInfo, program, bindings)};
+        if (useModuleCache)
+            moduleCache->Store(cacheKey, spirvEmitted, bindings);
+
         auto spirv{ProcessShaderBinary(true, hash, span<u32>{spirvEmitted}.cast<u8>()).cast<u32>()};
+        if (spirv.data() != spirvEmitted.data())
+            return {spirv.begin(), spirv.end()}; // The shader was replaced
+
+        return spirvEmitted;
+    }
 
+    vk::ShaderModule ShaderManager::CreateShaderModule(span<const u32> spirv) {
         vk::ShaderModuleCreateInfo createInfo{
             .pCode = spirv.data(),
             .codeSize = spirv.size_bytes(),
@@ -438,11 +469,25 @@ namespace skyline::gpu {
         return (*gpu.vkDevice).createShaderModule(createInfo, nullptr, *gpu.vkDevice.getDispatcher());
     }
 
+    vk::ShaderModule ShaderManager::CompileShader(const Shader::RuntimeInfo &runtimeInfo, Shader::IR::Program &program, Shader::Backend::Bindings &bindings, u64 hash) {
+        return CreateShaderModule(TranslateShader(runtimeInfo, program, bindings, hash));
+    }
+
+    ShaderManager::Pools &ShaderManager::GetThreadPools() {
+        thread_local Pools pools;
+        return pools;
+    }
+
     void ShaderManager::ResetPools() {
-        std::scoped_lock lock{poolMutex};
+        auto &pools{GetThreadPools()};
+        pools.instructionPool.ReleaseContents();
+        pools.blockPool.ReleaseContents();
+        pools.flowBlockPool.ReleaseContents();
+    }
 
-        instructionPool.ReleaseContents();
-        blockPool.ReleaseContents();
-        flowBlockPool.ReleaseContents();
+    std::pair<u64, u64> ShaderManager::GetModuleCacheStats() const {
+        if (!moduleCache)
+            return {};
+        return {moduleCache->GetHitCount(), moduleCache->GetMissCount()};
     }
 }
@@ -15,6 +15,7 @@
 #include <shader_compiler/runtime_info.h>
 #include <shader_compiler/backend/bindings.h>
 #include <common.h>
+#include "cache/shader_module_cache.h"
 
 namespace skyline::gpu {
     /**
@@ -25,16 +26,27 @@ namespace skyline::gpu {
         GPU &gpu;
         Shader::HostTranslateInfo hostTranslateInfo;
         Shader::Profile profile;
-        Shader::ObjectPool<Shader::Maxwell::Flow::Block> flowBlockPool;
-        Shader::ObjectPool<Shader::IR::Inst> instructionPool;
-        Shader::ObjectPool<Shader::IR::Block> blockPool;
+
+        /**
+         * @brief The object pools used for allocating shader IR, these are per-thread so shaders can be translated concurrently without any locking
+         * @note All IR returned by the ShaderManager is only valid on the thread it was created on and until the next call to ResetPools() on that thread
+         */
+        struct Pools {
+            Shader::ObjectPool<Shader::Maxwell::Flow::Block> flowBlockPool;
+            Shader::ObjectPool<Shader::IR::Inst> instructionPool;
+            Shader::ObjectPool<Shader::IR::Block> blockPool;
+        };
+
+        static Pools &GetThreadPools();
+
         std::unordered_map<u64, std::vector<u8>> guestShaderReplacements; //!< Map of guest shader hash -> replacement guest shader binary, populated at init time and must not be modified after
         std::unordered_map<u64, std::vector<u8>> hostShaderReplacements; //!< ^^ same as above but for host
 
-        std::mutex poolMutex;
         std::filesystem::path dumpPath;
         std::mutex dumpMutex;
 
+        std::optional<cache::ShaderModuleCache> moduleCache; //!< The persistent cache of emitted SPIR-V, this is disabled alongside the pipeline cache
+
         /**
          * @brief Called at init time to populate the shader replacements map from the input directory
          */
@@ -50,7 +62,10 @@ namespace skyline::gpu {
         using ConstantBufferRead = std::function<u32(u32 index, u32 offset)>; //!< A function which reads a constant buffer at the specified offset and returns the value
         using GetTextureType = std::function<Shader::TextureType(u32 handle)>; //!< A function which determines the type of a texture from its handle by checking the corresponding TIC
 
-        ShaderManager(const DeviceState &state, GPU &gpu, std::string_view replacementDir, std::string_view dumpDir);
+        /**
+         * @param moduleCachePath The path to the SPIR-V module cache file, the cache is disabled if this is empty
+         */
+        ShaderManager(const DeviceState &state, GPU &gpu, std::string_view replacementDir, std::string_view dumpDir, std::string_view moduleCachePath);
 
         /**
          * @return A shader program that corresponds to all the supplied state including the current state of the constant buffers
@@ -70,8 +85,24 @@ namespace skyline::gpu {
 
         Shader::IR::Program ParseComputeShader(u64 hash, span<u8> binary, u32 baseOffset, u32 textureConstantBufferIndex, u32 localMemorySize, u32 sharedMemorySize, std::array<u32, 3> workgroupDimensions, const ConstantBufferRead &constantBufferRead, const GetTextureType &getTextureType);
 
+        /**
+         * @return The SPIR-V for the supplied program, this will be the host shader replacement if one exists
+         * @param cacheKey A key uniquely identifying the inputs to the translation of this program (including the state of the bindings), if this is non-zero the SPIR-V will be looked up in and stored to the SPIR-V module cache
+         */
+        std::vector<u32> TranslateShader(const Shader::RuntimeInfo &runtimeInfo, Shader::IR::Program &program, Shader::Backend::Bindings &bindings, u64 hash = 0, u64 cacheKey = 0);
+
+        vk::ShaderModule CreateShaderModule(span<const u32> spirv);
+
         vk::ShaderModule CompileShader(const Shader::RuntimeInfo &runtimeInfo, Shader::IR::Program &program, Shader::Backend::Bindings &bindings, u64 hash = 0);
 
+        /**
+         * @brief Releases all IR allocated by the calling thread
+         */
         void ResetPools();
+
+        /**
+         * @return The amount of hits and misses in the SPIR-V module cache so far
+         */
+        std::pair<u64, u64> GetModuleCacheStats() const;
     };
 }
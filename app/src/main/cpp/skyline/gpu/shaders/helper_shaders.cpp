@@ -389,8 +389,331 @@ namespace skyline::gpu {
         });
     }
 
+    namespace block_linear {
+        struct ComputePushConstantLayout {
+            u32 blockLinearOffset; //!< In words
+            u32 pitchOffset; //!< In words
+            u32 pitchBytes;
+            u32 pitchSliceBytes;
+            u32 widthWords;
+            u32 height;
+            u32 originXBytes;
+            u32 originY;
+            u32 blockSize;
+            u32 robSize;
+            u32 mobSize;
+            u32 gobBlockHeight;
+            u32 gobBlockDepth;
+            glsl::Bool blockLinearToPitch;
+        };
+
+        constexpr static vk::PushConstantRange PushConstantRange{
+            .stageFlags = vk::ShaderStageFlagBits::eCompute,
+            .size = sizeof(ComputePushConstantLayout),
+            .offset = 0
+        };
+
+        constexpr static std::array<vk::DescriptorSetLayoutBinding, 2> LayoutBindings{
+            vk::DescriptorSetLayoutBinding{
+                .binding = 0,
+                .descriptorType = vk::DescriptorType::eStorageBuffer,
+                .descriptorCount = 1,
+                .stageFlags = vk::ShaderStageFlagBits::eCompute
+            }, vk::DescriptorSetLayoutBinding{
+                .binding = 1,
+                .descriptorType = vk::DescriptorType::eStorageBuffer,
+                .descriptorCount = 1,
+                .stageFlags = vk::ShaderStageFlagBits::eCompute
+            }
+        };
+
+        constexpr u32 GobWidth{64}; //!< The width of a GOB in bytes
+        constexpr u32 GobHeight{8}; //!< The height of a GOB in lines
+        constexpr u32 GobSize{GobWidth * GobHeight}; //!< The size of a GOB in bytes
+
+        constexpr u32 WorkgroupWidth{32}; //!< The width of a workgroup in words, this must match the shader
+        constexpr u32 WorkgroupHeight{8}; //!< The height of a workgroup in lines, this must match the shader
+    }
+
+    BlockLinearHelperShader::BlockLinearHelperShader(GPU &gpu, std::shared_ptr<vfs::FileSystem> shaderFileSystem)
+        : shaderModule{CreateShaderModule(gpu, *shaderFileSystem->OpenFile("shaders/block_linear.comp.spv"))},
+          descriptorSetLayout{gpu.vkDevice, vk::DescriptorSetLayoutCreateInfo{
+              .pBindings = block_linear::LayoutBindings.data(),
+              .bindingCount = static_cast<u32>(block_linear::LayoutBindings.size()),
+          }},
+          pipelineLayout{gpu.vkDevice, vk::PipelineLayoutCreateInfo{
+              .pSetLayouts = &*descriptorSetLayout,
+              .setLayoutCount = 1,
+              .pPushConstantRanges = &block_linear::PushConstantRange,
+              .pushConstantRangeCount = 1,
+          }},
+          pipeline{gpu.vkDevice, nullptr, vk::ComputePipelineCreateInfo{
+              .stage = vk::PipelineShaderStageCreateInfo{
+                  .stage = vk::ShaderStageFlagBits::eCompute,
+                  .module = *shaderModule,
+                  .pName = "main"
+              },
+              .layout = *pipelineLayout,
+          }} {}
+
+    bool BlockLinearHelperShader::CanCopy(GPU &gpu, const CopyLayout &layout, vk::DeviceSize blockLinearSize, vk::DeviceSize pitchSize) {
+        // Every invocation copies a single word, bindings are also extended backwards to an aligned offset which needs to fit within the range limit
+        if (!layout.widthBytes || !layout.height || !layout.depth || !layout.gobBlockHeight || !layout.gobBlockDepth
+            || !util::IsWordAligned(layout.widthBytes) || !util::IsWordAligned(layout.pitch) || !util::IsWordAligned(layout.originXBytes)
+            || !util::IsWordAligned(layout.blockLinearOffset) || !util::IsWordAligned(layout.pitchOffset)
+            || blockLinearSize + gpu.traits.minimumStorageBufferAlignment > gpu.traits.maximumStorageBufferRange
+            || pitchSize + gpu.traits.minimumStorageBufferAlignment > gpu.traits.maximumStorageBufferRange)
+            return false;
+
+        // The copied region must be entirely within both surfaces as the shader doesn't do any bounds checks of its own
+        vk::DeviceSize robHeight{block_linear::GobHeight * layout.gobBlockHeight}, robCount{util::DivideCeil<vk::DeviceSize>(layout.blockLinearHeight, robHeight)};
+        vk::DeviceSize robSize{block_linear::GobSize * layout.gobBlockHeight * layout.gobBlockDepth * util::DivideCeil<vk::DeviceSize>(layout.blockLinearWidthBytes, block_linear::GobWidth)};
+        vk::DeviceSize mobCount{util::DivideCeil<vk::DeviceSize>(layout.depth, layout.gobBlockDepth)};
+        return vk::DeviceSize{layout.originXBytes} + layout.widthBytes <= util::AlignUp(vk::DeviceSize{layout.blockLinearWidthBytes}, block_linear::GobWidth)
+            && vk::DeviceSize{layout.originY} + layout.height <= robCount * robHeight
+            && layout.blockLinearOffset + robSize * robCount * mobCount <= blockLinearSize
+            && layout.widthBytes <= layout.pitch
+            && layout.pitchOffset + vk::DeviceSize{layout.pitch} * layout.height * layout.depth <= pitchSize;
+    }
+
+    std::shared_ptr<DescriptorAllocator::ActiveDescriptorSet> BlockLinearHelperShader::Copy(GPU &gpu, const vk::raii::CommandBuffer &commandBuffer,
+                                                                                            BufferBinding blockLinear, BufferBinding pitch,
+                                                                                            span<const CopyLayout> copies, bool blockLinearToPitch) {
+        // Storage buffers can only be bound at aligned offsets, any remainder is applied to the offsets of the copies instead
+        auto getBufferInfo{[&gpu](BufferBinding binding) {
+            vk::DeviceSize alignedOffset{util::AlignDown(binding.offset, gpu.traits.minimumStorageBufferAlignment)};
+            return vk::DescriptorBufferInfo{
+                .buffer = binding.buffer,
+                .offset = alignedOffset,
+                .range = binding.size + (binding.offset - alignedOffset),
+            };
+        }};
+
+        std::array<vk::DescriptorBufferInfo, 2> bufferInfos{getBufferInfo(blockLinear), getBufferInfo(pitch)};
+        vk::DeviceSize blockLinearBase{blockLinear.offset - bufferInfos[0].offset}, pitchBase{pitch.offset - bufferInfos[1].offset};
+
+        auto descriptorSet{std::make_shared<DescriptorAllocator::ActiveDescriptorSet>(gpu.descriptor.AllocateSet(*descriptorSetLayout))};
+        std::array<vk::WriteDescriptorSet, 2> writes{vk::WriteDescriptorSet{
+            .dstSet = **descriptorSet,
+            .dstBinding = 0,
+            .descriptorCount = 1,
+            .descriptorType = vk::DescriptorType::eStorageBuffer,
+            .pBufferInfo = &bufferInfos[0]
+        }, vk::WriteDescriptorSet{
+            .dstSet = **descriptorSet,
+            .dstBinding = 1,
+            .descriptorCount = 1,
+            .descriptorType = vk::DescriptorType::eStorageBuffer,
+            .pBufferInfo = &bufferInfos[1]
+        }};
+        gpu.vkDevice.updateDescriptorSets(writes, nullptr);
+
+        commandBuffer.pipelineBarrier(vk::PipelineStageFlagBits::eAllCommands, vk::PipelineStageFlagBits::eComputeShader, {}, vk::MemoryBarrier{
+            .srcAccessMask = vk::AccessFlagBits::eMemoryWrite,
+            .dstAccessMask = vk::AccessFlagBits::eShaderRead | vk::AccessFlagBits::eShaderWrite
+        }, {}, {});
+
+        commandBuffer.bindPipeline(vk::PipelineBindPoint::eCompute, *pipeline);
+        commandBuffer.bindDescriptorSets(vk::PipelineBindPoint::eCompute, *pipelineLayout, 0, **descriptorSet, nullptr);
+
+        for (const auto &copy : copies) {
+            vk::DeviceSize blockLinearOffset{blockLinearBase + copy.blockLinearOffset}, pitchOffset{pitchBase + copy.pitchOffset};
+            if (!util::IsWordAligned(blockLinearOffset) || !util::IsWordAligned(pitchOffset))
+                throw exception("Block-linear helper shader copy offsets aren't word-aligned: 0x{:X}, 0x{:X}", blockLinearOffset, pitchOffset);
+
+            u32 blockSize{block_linear::GobSize * copy.gobBlockHeight * copy.gobBlockDepth};
+            u32 robSize{blockSize * util::DivideCeil<u32>(copy.blockLinearWidthBytes, block_linear::GobWidth)};
+            u32 robCount{util::DivideCeil<u32>(copy.blockLinearHeight, block_linear::GobHeight * copy.gobBlockHeight)};
+
+            block_linear::ComputePushConstantLayout pushConstants{
+                .blockLinearOffset = static_cast<u32>(blockLinearOffset / sizeof(u32)),
+                .pitchOffset = static_cast<u32>(pitchOffset / sizeof(u32)),
+                .pitchBytes = copy.pitch,
+                .pitchSliceBytes = copy.pitch * copy.height,
+                .widthWords = copy.widthBytes / static_cast<u32>(sizeof(u32)),
+                .height = copy.height,
+                .originXBytes = copy.originXBytes,
+                .originY = copy.originY,
+                .blockSize = blockSize,
+                .robSize = robSize,
+                .mobSize = robSize * robCount,
+                .gobBlockHeight = copy.gobBlockHeight,
+                .gobBlockDepth = copy.gobBlockDepth,
+                .blockLinearToPitch = blockLinearToPitch,
+            };
+
+            commandBuffer.pushConstants(*pipelineLayout, vk::ShaderStageFlagBits::eCompute, 0, vk::ArrayProxy<const block_linear::ComputePushConstantLayout>{pushConstants});
+            commandBuffer.dispatch(util::DivideCeil(pushConstants.widthWords, block_linear::WorkgroupWidth), util::DivideCeil(copy.height, block_linear::WorkgroupHeight), copy.depth);
+        }
+
+        commandBuffer.pipelineBarrier(vk::PipelineStageFlagBits::eComputeShader, vk::PipelineStageFlagBits::eAllCommands, {}, vk::MemoryBarrier{
+            .srcAccessMask = vk::AccessFlagBits::eShaderWrite,
+            .dstAccessMask = vk::AccessFlagBits::eMemoryRead | vk::AccessFlagBits::eMemoryWrite,
+        }, {}, {});
+
+        return descriptorSet;
+    }
+
+    namespace quad_conversion {
+        struct ComputePushConstantLayout {
+            u32 sourceOffset; //!< In bytes
+            u32 destinationOffset; //!< In words
+            u32 count;
+            u32 indexSizeShift;
+            u32 sourceStride; //!< In words
+            u32 convertedIndexCount;
+            glsl::Bool convertIndirectCommands;
+        };
+
+        constexpr static vk::PushConstantRange PushConstantRange{
+            .stageFlags = vk::ShaderStageFlagBits::eCompute,
+            .size = sizeof(ComputePushConstantLayout),
+            .offset = 0
+        };
+
+        constexpr static std::array<vk::DescriptorSetLayoutBinding, 2> LayoutBindings{
+            vk::DescriptorSetLayoutBinding{
+                .binding = 0,
+                .descriptorType = vk::DescriptorType::eStorageBuffer,
+                .descriptorCount = 1,
+                .stageFlags = vk::ShaderStageFlagBits::eCompute
+            }, vk::DescriptorSetLayoutBinding{
+                .binding = 1,
+                .descriptorType = vk::DescriptorType::eStorageBuffer,
+                .descriptorCount = 1,
+                .stageFlags = vk::ShaderStageFlagBits::eCompute
+            }
+        };
+
+        constexpr u32 WorkgroupSize{64}; //!< The amount of quads or commands converted by a workgroup, this must match the shader
+    }
+
+    QuadConversionHelperShader::QuadConversionHelperShader(GPU &gpu, std::shared_ptr<vfs::FileSystem> shaderFileSystem)
+        : shaderModule{CreateShaderModule(gpu, *shaderFileSystem->OpenFile("shaders/quad_conversion.comp.spv"))},
+          descriptorSetLayout{gpu.vkDevice, vk::DescriptorSetLayoutCreateInfo{
+              .pBindings = quad_conversion::LayoutBindings.data(),
+              .bindingCount = static_cast<u32>(quad_conversion::LayoutBindings.size()),
+          }},
+          pipelineLayout{gpu.vkDevice, vk::PipelineLayoutCreateInfo{
+              .pSetLayouts = &*descriptorSetLayout,
+              .setLayoutCount = 1,
+              .pPushConstantRanges = &quad_conversion::PushConstantRange,
+              .pushConstantRangeCount = 1,
+          }},
+          pipeline{gpu.vkDevice, nullptr, vk::ComputePipelineCreateInfo{
+              .stage = vk::PipelineShaderStageCreateInfo{
+                  .stage = vk::ShaderStageFlagBits::eCompute,
+                  .module = *shaderModule,
+                  .pName = "main"
+              },
+              .layout = *pipelineLayout,
+          }} {}
+
+    bool QuadConversionHelperShader::CanBind(GPU &gpu, vk::DeviceSize size) {
+        // Bindings are extended backwards to an aligned offset and forwards to a whole word which needs to fit within the range limit
+        return size && size + gpu.traits.minimumStorageBufferAlignment + sizeof(u32) <= gpu.traits.maximumStorageBufferRange;
+    }
+
+    std::shared_ptr<DescriptorAllocator::ActiveDescriptorSet> QuadConversionHelperShader::Dispatch(GPU &gpu, const vk::raii::CommandBuffer &commandBuffer,
+                                                                                                   BufferBinding source, BufferBinding destination,
+                                                                                                   u32 count, u32 indexSizeShift, u32 sourceStride, u32 convertedIndexCount, bool convertIndirectCommands) {
+        // Storage buffers can only be bound at aligned offsets, any remainder is applied to the offsets in the push constants instead
+        // The range is rounded up to a whole word for the shader to read the final word of sub-word indices, this is always within the buffer as guest buffers are page-aligned
+        auto getBufferInfo{[&gpu](BufferBinding binding) {
+            vk::DeviceSize alignedOffset{util::AlignDown(binding.offset, gpu.traits.minimumStorageBufferAlignment)};
+            return vk::DescriptorBufferInfo{
+                .buffer = binding.buffer,
+                .offset = alignedOffset,
+                .range = util::AlignUp(binding.size + (binding.offset - alignedOffset), sizeof(u32)),
+            };
+        }};
+
+        std::array<vk::DescriptorBufferInfo, 2> bufferInfos{getBufferInfo(source), getBufferInfo(destination)};
+        vk::DeviceSize sourceOffset{source.offset - bufferInfos[0].offset}, destinationOffset{destination.offset - bufferInfos[1].offset};
+        if (!util::IsWordAligned(destinationOffset))
+            throw exception("Quad conversion helper shader destination offset isn't word-aligned: 0x{:X}", destinationOffset);
+
+        auto descriptorSet{std::make_shared<DescriptorAllocator::ActiveDescriptorSet>(gpu.descriptor.AllocateSet(*descriptorSetLayout))};
+        std::array<vk::WriteDescriptorSet, 2> writes{vk::WriteDescriptorSet{
+            .dstSet = **descriptorSet,
+            .dstBinding = 0,
+            .descriptorCount = 1,
+            .descriptorType = vk::DescriptorType::eStorageBuffer,
+            .pBufferInfo = &bufferInfos[0]
+        }, vk::WriteDescriptorSet{
+            .dstSet = **descriptorSet,
+            .dstBinding = 1,
+            .descriptorCount = 1,
+            .descriptorType = vk::DescriptorType::eStorageBuffer,
+            .pBufferInfo = &bufferInfos[1]
+        }};
+        gpu.vkDevice.updateDescriptorSets(writes, nullptr);
+
+        commandBuffer.pipelineBarrier(vk::PipelineStageFlagBits::eAllCommands, vk::PipelineStageFlagBits::eComputeShader, {}, vk::MemoryBarrier{
+            .srcAccessMask = vk::AccessFlagBits::eMemoryWrite,
+            .dstAccessMask = vk::AccessFlagBits::eShaderRead | vk::AccessFlagBits::eShaderWrite
+        }, {}, {});
+
+        commandBuffer.bindPipeline(vk::PipelineBindPoint::eCompute, *pipeline);
+        commandBuffer.bindDescriptorSets(vk::PipelineBindPoint::eCompute, *pipelineLayout, 0, **descriptorSet, nullptr);
+
+        quad_conversion::ComputePushConstantLayout pushConstants{
+            .sourceOffset = static_cast<u32>(sourceOffset),
+            .destinationOffset = static_cast<u32>(destinationOffset / sizeof(u32)),
+            .count = count,
+            .indexSizeShift = indexSizeShift,
+            .sourceStride = sourceStride,
+            .convertedIndexCount = convertedIndexCount,
+            .convertIndirectCommands = convertIndirectCommands,
+        };
+
+        commandBuffer.pushConstants(*pipelineLayout, vk::ShaderStageFlagBits::eCompute, 0, vk::ArrayProxy<const quad_conversion::ComputePushConstantLayout>{pushConstants});
+        commandBuffer.dispatch(util::DivideCeil(count, quad_conversion::WorkgroupSize), 1, 1);
+
+        // The output is consumed as an index or indirect buffer by the draw
+        commandBuffer.pipelineBarrier(vk::PipelineStageFlagBits::eComputeShader, vk::PipelineStageFlagBits::eAllCommands, {}, vk::MemoryBarrier{
+            .srcAccessMask = vk::AccessFlagBits::eShaderWrite,
+            .dstAccessMask = vk::AccessFlagBits::eMemoryRead | vk::AccessFlagBits::eMemoryWrite,
+        }, {}, {});
+
+        return descriptorSet;
+    }
+
+    std::shared_ptr<DescriptorAllocator::ActiveDescriptorSet> QuadConversionHelperShader::ConvertIndices(GPU &gpu, const vk::raii::CommandBuffer &commandBuffer,
+                                                                                                         BufferBinding source, BufferBinding destination,
+                                                                                                         u32 quadCount, vk::IndexType indexType) {
+        u32 indexSizeShift{[&]() -> u32 {
+            switch (indexType) {
+                case vk::IndexType::eUint8EXT:
+                    return 0;
+                case vk::IndexType::eUint16:
+                    return 1;
+                case vk::IndexType::eUint32:
+                    return 2;
+                default:
+                    throw exception("Unsupported index type for quad conversion: {}", vk::to_string(indexType));
+            }
+        }()};
+
+        if (source.offset & ((1U << indexSizeShift) - 1))
+            throw exception("Quad conversion helper shader source offset isn't aligned to the index size: 0x{:X}", source.offset);
+
+        return Dispatch(gpu, commandBuffer, source, destination, quadCount, indexSizeShift, 0, 0, false);
+    }
+
+    std::shared_ptr<DescriptorAllocator::ActiveDescriptorSet> QuadConversionHelperShader::ConvertIndirectCommands(GPU &gpu, const vk::raii::CommandBuffer &commandBuffer,
+                                                                                                                  BufferBinding source, BufferBinding destination,
+                                                                                                                  u32 count, u32 stride, u32 convertedIndexCount) {
+        if (!util::IsWordAligned(source.offset) || !util::IsWordAligned(stride))
+            throw exception("Quad conversion helper shader indirect commands aren't word-aligned: 0x{:X}, 0x{:X}", source.offset, stride);
+
+        return Dispatch(gpu, commandBuffer, source, destination, count, 0, stride / static_cast<u32>(sizeof(u32)), convertedIndexCount, true);
+    }
+
     HelperShaders::HelperShaders(GPU &gpu, std::shared_ptr<vfs::FileSystem> shaderFileSystem)
         : blitHelperShader(gpu, shaderFileSystem),
-          clearHelperShader(gpu, shaderFileSystem) {}
+          clearHelperShader(gpu, shaderFileSystem),
+          blockLinearHelperShader(gpu, shaderFileSystem),
+          quadConversionHelperShader(gpu, shaderFileSystem) {}
 
 }
\ No newline at end of file
@@ -6,6 +6,7 @@
 #include <vulkan/vulkan_raii.hpp>
 #include <gpu/descriptor_allocator.h>
 #include <gpu/graphics_pipeline_assembler.h>
+#include <gpu/buffer.h>
 
 namespace skyline::vfs {
     class FileSystem;
@@ -108,12 +109,106 @@ namespace skyline::gpu {
                   std::function<void(std::function<void(vk::raii::CommandBuffer &, const std::shared_ptr<FenceCycle> &, GPU &, vk::RenderPass, u32)> &&)> &&recordCb);
     };
 
+    /**
+     * @brief Compute shader for copying between block-linear and pitch-linear surfaces in buffers, this is used instead of the CPU swizzling functions for large copies
+     */
+    class BlockLinearHelperShader {
+      private:
+        vk::raii::ShaderModule shaderModule;
+        vk::raii::DescriptorSetLayout descriptorSetLayout;
+        vk::raii::PipelineLayout pipelineLayout;
+        vk::raii::Pipeline pipeline;
+
+      public:
+        BlockLinearHelperShader(GPU &gpu, std::shared_ptr<vfs::FileSystem> shaderFileSystem);
+
+        /**
+         * @brief The layout of a single copy between a block-linear and a pitch-linear surface, all widths are in bytes and all heights are in lines of format blocks
+         */
+        struct CopyLayout {
+            vk::DeviceSize blockLinearOffset; //!< The offset of the block-linear surface from the start of its binding
+            vk::DeviceSize pitchOffset; //!< The offset of the pitch-linear surface from the start of its binding
+            u32 widthBytes, height, depth; //!< The extent of the copied region
+            u32 pitch; //!< The stride between lines of the pitch-linear surface, slices are tightly packed
+            u32 blockLinearWidthBytes, blockLinearHeight; //!< The extent of the entire block-linear surface, this determines the size of ROBs and MOBs
+            u32 gobBlockHeight, gobBlockDepth;
+            u32 originXBytes, originY; //!< The origin of the copied region in the block-linear surface
+        };
+
+        /**
+         * @return If the supplied copy between bindings of the supplied sizes can be done by the shader
+         * @note The offsets of the bindings must also be word-aligned, this can't be checked here as they're only known at record time
+         */
+        static bool CanCopy(GPU &gpu, const CopyLayout &layout, vk::DeviceSize blockLinearSize, vk::DeviceSize pitchSize);
+
+        /**
+         * @brief Records dispatches for the supplied copies between a pair of buffers alongside barriers to synchronize them with any prior and subsequent commands
+         * @param blockLinearToPitch If the copies are from the block-linear surface to the pitch-linear surface or the other way around
+         * @return The descriptor set used by the dispatches, this **must** be attached to the fence cycle of the command buffer
+         */
+        std::shared_ptr<DescriptorAllocator::ActiveDescriptorSet> Copy(GPU &gpu, const vk::raii::CommandBuffer &commandBuffer,
+                                                                       BufferBinding blockLinear, BufferBinding pitch,
+                                                                       span<const CopyLayout> copies, bool blockLinearToPitch);
+    };
+
+    /**
+     * @brief Compute shader for expanding quad lists into triangle lists on the GPU, this is used for large and indirect quad draws where the indices can't or shouldn't be converted on the CPU
+     */
+    class QuadConversionHelperShader {
+      private:
+        vk::raii::ShaderModule shaderModule;
+        vk::raii::DescriptorSetLayout descriptorSetLayout;
+        vk::raii::PipelineLayout pipelineLayout;
+        vk::raii::Pipeline pipeline;
+
+        /**
+         * @brief Records a dispatch of the shader between the supplied bindings alongside barriers to synchronize it with any prior and subsequent commands
+         */
+        std::shared_ptr<DescriptorAllocator::ActiveDescriptorSet> Dispatch(GPU &gpu, const vk::raii::CommandBuffer &commandBuffer,
+                                                                           BufferBinding source, BufferBinding destination,
+                                                                           u32 count, u32 indexSizeShift, u32 sourceStride, u32 convertedIndexCount, bool convertIndirectCommands);
+
+      public:
+        static constexpr u32 IndirectCommandSize{sizeof(vk::DrawIndexedIndirectCommand)}; //!< The stride of the tightly packed indirect commands written by ConvertIndirectCommands
+
+        QuadConversionHelperShader(GPU &gpu, std::shared_ptr<vfs::FileSystem> shaderFileSystem);
+
+        /**
+         * @return If a binding of the supplied size can be used as the source or destination of a conversion
+         */
+        static bool CanBind(GPU &gpu, vk::DeviceSize size);
+
+        /**
+         * @brief Records a conversion of the quads in the source index buffer into a triangle list with 32-bit indices in the destination buffer
+         * @param source The source indices, the offset of this must be aligned to the size of an index
+         * @param destination A buffer of at least `GetRequiredBufferSize(quadCount * 4, sizeof(u32))` bytes at a word-aligned offset
+         * @return The descriptor set used by the dispatch, this **must** be attached to the fence cycle of the command buffer
+         */
+        std::shared_ptr<DescriptorAllocator::ActiveDescriptorSet> ConvertIndices(GPU &gpu, const vk::raii::CommandBuffer &commandBuffer,
+                                                                                 BufferBinding source, BufferBinding destination,
+                                                                                 u32 quadCount, vk::IndexType indexType);
+
+        /**
+         * @brief Records a conversion of indexed indirect quad draw commands into commands drawing the output of ConvertIndices for the entire index buffer
+         * @param stride The stride between the source commands, this must be word-aligned
+         * @param convertedIndexCount The amount of indices that were converted from the start of the index buffer, the commands are clamped to not draw past these
+         * @note The first index of every command must be a multiple of 4 as the quads are converted from the start of the index buffer
+         * @param destination A buffer of at least `count * IndirectCommandSize` bytes at a word-aligned offset
+         * @return The descriptor set used by the dispatch, this **must** be attached to the fence cycle of the command buffer
+         */
+        std::shared_ptr<DescriptorAllocator::ActiveDescriptorSet> ConvertIndirectCommands(GPU &gpu, const vk::raii::CommandBuffer &commandBuffer,
+                                                                                          BufferBinding source, BufferBinding destination,
+                                                                                          u32 count, u32 stride, u32 convertedIndexCount);
+    };
+
     /**
      * @brief Holds all helper shaders to avoid redundantly recreating them on each usage
      */
     struct HelperShaders {
         BlitHelperShader blitHelperShader;
         ClearHelperShader clearHelperShader;
+        BlockLinearHelperShader blockLinearHelperShader;
+        QuadConversionHelperShader quadConversionHelperShader;
 
         HelperShaders(GPU &gpu, std::shared_ptr<vfs::FileSystem> shaderFileSystem);
     };
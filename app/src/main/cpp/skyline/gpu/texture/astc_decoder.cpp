@@ -0,0 +1,816 @@
+// SPDX-License-Identifier: MPL-2.0
+// Copyright © 2022 Skyline Team and Contributors (https://github.com/skyline-emu/)
+
+#if defined(__aarch64__)
+#include <arm_neon.h>
+#elif defined(__SSE4_1__)
+#include <smmintrin.h>
+#endif
+#include "astc_decoder.h"
+
+// Reference on ASTC: Khronos Data Format Specification 1.3, Section 23 (ASTC Compressed Texture Image Formats)
+namespace skyline::gpu::texture::astc {
+    constexpr size_t BlockSize{16}; //!< The size of an ASTC block in bytes
+    constexpr size_t MaxBlockDimension{12}; //!< The largest width or height of a 2D ASTC block footprint
+    constexpr size_t MaxWeightCount{64}; //!< The maximum amount of weights in a block including both planes
+    constexpr size_t MaxColorValueCount{18}; //!< The maximum amount of color endpoint values in a block
+    constexpr size_t R8g8b8a8Bpp{4}; //!< The amount of bytes per pixel in R8G8B8A8
+    constexpr std::array<u8, 4> ErrorColor{0xFF, 0x00, 0xFF, 0xFF}; //!< The color invalid blocks decode to, this is magenta as mandated by the specification
+
+    /**
+     * @brief The 128 bits of a single ASTC block, allowing for reading arbitrary bitfields from it
+     */
+    struct BlockBits {
+        u64 low;
+        u64 high;
+
+        constexpr u32 Read(size_t offset, size_t count) const {
+            if (!count)
+                return 0;
+
+            u64 value;
+            if (offset >= 64)
+                value = high >> (offset - 64);
+            else if (offset == 0)
+                value = low;
+            else
+                value = (low >> offset) | (high << (64 - offset));
+
+            return static_cast<u32>(value & ((1ULL << count) - 1));
+        }
+
+        /**
+         * @return A copy of the bits in the supplied range shifted down to the start with all other bits cleared
+         */
+        constexpr BlockBits Extract(size_t offset, size_t count) const {
+            BlockBits bits{*this};
+            if (offset >= 64) {
+                bits.low = high >> (offset - 64);
+                bits.high = 0;
+            } else if (offset) {
+                bits.low = (low >> offset) | (high << (64 - offset));
+                bits.high = high >> offset;
+            }
+
+            if (count < 64) {
+                bits.low &= (1ULL << count) - 1;
+                bits.high = 0;
+            } else if (count < 128) {
+                bits.high &= (1ULL << (count - 64)) - 1;
+            }
+            return bits;
+        }
+
+        /**
+         * @return The block with the order of all 128 bits reversed, weights are stored starting from the most significant bit
+         */
+        constexpr BlockBits Reverse() const {
+            constexpr auto reverse{[](u64 value) {
+                value = ((value >> 1) & 0x5555555555555555) | ((value & 0x5555555555555555) << 1);
+                value = ((value >> 2) & 0x3333333333333333) | ((value & 0x3333333333333333) << 2);
+                value = ((value >> 4) & 0x0F0F0F0F0F0F0F0F) | ((value & 0x0F0F0F0F0F0F0F0F) << 4);
+                return __builtin_bswap64(value);
+            }};
+            return {reverse(high), reverse(low)};
+        }
+    };
+
+    /**
+     * @brief The encoding of a range of values using Bounded Integer Sequence Encoding (BISE)
+     */
+    struct IntegerEncoding {
+        enum class Type : u8 {
+            Bits, //!< Values are stored as raw bits
+            Trit, //!< Values are stored as a trit (base-3 digit) and raw bits, 5 trits are packed into 8 bits
+            Quint, //!< Values are stored as a quint (base-5 digit) and raw bits, 3 quints are packed into 7 bits
+        } type;
+        u8 bits; //!< The amount of raw bits per value
+
+        /**
+         * @param levels The amount of levels in the range, this must be of the form 2^n, 3*2^n or 5*2^n
+         */
+        static constexpr IntegerEncoding ForLevels(u32 levels) {
+            if (levels % 3 == 0)
+                return {Type::Trit, static_cast<u8>(std::countr_zero(levels / 3))};
+            else if (levels % 5 == 0)
+                return {Type::Quint, static_cast<u8>(std::countr_zero(levels / 5))};
+            else
+                return {Type::Bits, static_cast<u8>(std::countr_zero(levels))};
+        }
+
+        /**
+         * @return The amount of bits required to store the specified amount of values
+         */
+        constexpr size_t GetBitLength(size_t count) const {
+            switch (type) {
+                case Type::Trit:
+                    return (bits * count) + ((8 * count + 4) / 5);
+                case Type::Quint:
+                    return (bits * count) + ((7 * count + 2) / 3);
+                default:
+                    return bits * count;
+            }
+        }
+    };
+
+    /**
+     * @brief Tables for unpacking the trits and quints in a packed group of them
+     */
+    constexpr auto TritTable{[]() {
+        std::array<std::array<u8, 5>, 256> table{};
+        for (u32 t{}; t < 256; t++) {
+            auto bit{[t](u32 index) { return (t >> index) & 1; }};
+            u32 c;
+            auto &trits{table[t]};
+            if (((t >> 2) & 0b111) == 0b111) {
+                c = (((t >> 5) & 0b111) << 2) | (t & 0b11);
+                trits[4] = 2;
+                trits[3] = 2;
+            } else {
+                c = t & 0b11111;
+                if (((t >> 5) & 0b11) == 0b11) {
+                    trits[4] = 2;
+                    trits[3] = static_cast<u8>(bit(7));
+                } else {
+                    trits[4] = static_cast<u8>(bit(7));
+                    trits[3] = static_cast<u8>((t >> 5) & 0b11);
+                }
+            }
+
+            auto cBit{[c](u32 index) { return (c >> index) & 1; }};
+            if ((c & 0b11) == 0b11) {
+                trits[2] = 2;
+                trits[1] = static_cast<u8>(cBit(4));
+                trits[0] = static_cast<u8>((cBit(3) << 1) | (cBit(2) & ~cBit(3) & 1));
+            } else if (((c >> 2) & 0b11) == 0b11) {
+                trits[2] = 2;
+                trits[1] = 2;
+                trits[0] = static_cast<u8>(c & 0b11);
+            } else {
+                trits[2] = static_cast<u8>(cBit(4));
+                trits[1] = static_cast<u8>((c >> 2) & 0b11);
+                trits[0] = static_cast<u8>((cBit(1) << 1) | (cBit(0) & ~cBit(1) & 1));
+            }
+        }
+        return table;
+    }()};
+
+    constexpr auto QuintTable{[]() {
+        std::array<std::array<u8, 3>, 128> table{};
+        for (u32 q{}; q < 128; q++) {
+            auto bit{[q](u32 index) { return (q >> index) & 1; }};
+            auto &quints{table[q]};
+            if (((q >> 1) & 0b11) == 0b11 && ((q >> 5) & 0b11) == 0) {
+                quints[2] = static_cast<u8>((bit(0) << 2) | ((bit(4) & ~bit(0) & 1) << 1) | (bit(3) & ~bit(0) & 1));
+                quints[1] = 4;
+                quints[0] = 4;
+            } else {
+                u32 c;
+                if (((q >> 1) & 0b11) == 0b11) {
+                    quints[2] = 4;
+                    c = (((q >> 3) & 0b11) << 3) | ((~(q >> 5) & 0b11) << 1) | bit(0);
+                } else {
+                    quints[2] = static_cast<u8>((q >> 5) & 0b11);
+                    c = q & 0b11111;
+                }
+
+                if ((c & 0b111) == 0b101) {
+                    quints[1] = 4;
+                    quints[0] = static_cast<u8>((c >> 3) & 0b11);
+                } else {
+                    quints[1] = static_cast<u8>((c >> 3) & 0b11);
+                    quints[0] = static_cast<u8>(c & 0b111);
+                }
+            }
+        }
+        return table;
+    }()};
+
+    /**
+     * @brief Decodes a sequence of BISE encoded values into their quantized values
+     * @param bits The bits of the sequence starting from bit 0, any bits past the end of the sequence must be zero
+     */
+    void DecodeIntegerSequence(const BlockBits &bits, IntegerEncoding encoding, size_t count, u8 *output) {
+        size_t offset{};
+        auto read{[&](size_t amount) {
+            u32 value{bits.Read(offset, amount)};
+            offset += amount;
+            return value;
+        }};
+
+        switch (encoding.type) {
+            case IntegerEncoding::Type::Bits:
+                for (size_t index{}; index < count; index++)
+                    output[index] = static_cast<u8>(read(encoding.bits));
+                break;
+
+            case IntegerEncoding::Type::Trit:
+                for (size_t index{}; index < count; index += 5) {
+                    std::array<u32, 5> m;
+                    u32 t;
+                    m[0] = read(encoding.bits);
+                    t = read(2);
+                    m[1] = read(encoding.bits);
+                    t |= read(2) << 2;
+                    m[2] = read(encoding.bits);
+                    t |= read(1) << 4;
+                    m[3] = read(encoding.bits);
+                    t |= read(2) << 5;
+                    m[4] = read(encoding.bits);
+                    t |= read(1) << 7;
+
+                    const auto &trits{TritTable[t]};
+                    for (size_t value{}; value < 5 && index + value < count; value++)
+                        output[index + value] = static_cast<u8>((trits[value] << encoding.bits) | m[value]);
+                }
+                break;
+
+            case IntegerEncoding::Type::Quint:
+                for (size_t index{}; index < count; index += 3) {
+                    std::array<u32, 3> m;
+                    u32 q;
+                    m[0] = read(encoding.bits);
+                    q = read(3);
+                    m[1] = read(encoding.bits);
+                    q |= read(2) << 3;
+                    m[2] = read(encoding.bits);
+                    q |= read(2) << 5;
+
+                    const auto &quints{QuintTable[q]};
+                    for (size_t value{}; value < 3 && index + value < count; value++)
+                        output[index + value] = static_cast<u8>((quints[value] << encoding.bits) | m[value]);
+                }
+                break;
+        }
+    }
+
+    /**
+     * @return The value replicated to fill the specified amount of bits
+     */
+    constexpr u32 ReplicateBits(u32 value, u32 bits, u32 targetBits) {
+        if (!bits)
+            return 0;
+
+        u32 result{};
+        i32 shift{static_cast<i32>(targetBits)};
+        while (shift > 0) {
+            shift -= static_cast<i32>(bits);
+            result |= shift >= 0 ? (value << shift) : (value >> -shift);
+        }
+        return result & ((1U << targetBits) - 1);
+    }
+
+    constexpr std::array<u32, 17> ColorRangeLevels{6, 8, 10, 12, 16, 20, 24, 32, 40, 48, 64, 80, 96, 128, 160, 192, 256}; //!< The amount of levels in every range that color endpoints can be quantized to
+    constexpr std::array<u32, 12> WeightRangeLevels{2, 3, 4, 5, 6, 8, 10, 12, 16, 20, 24, 32}; //!< The amount of levels in every range that weights can be quantized to
+
+    /**
+     * @brief Tables for unquantizing color endpoint values in every range to 0-255
+     */
+    constexpr auto ColorUnquantizationTable{[]() {
+        std::array<std::array<u8, 256>, ColorRangeLevels.size()> table{};
+        for (size_t range{}; range < ColorRangeLevels.size(); range++) {
+            auto encoding{IntegerEncoding::ForLevels(ColorRangeLevels[range])};
+            for (u32 value{}; value < ColorRangeLevels[range]; value++) {
+                u32 m{value & ((1U << encoding.bits) - 1)}, d{value >> encoding.bits};
+                if (encoding.type == IntegerEncoding::Type::Bits) {
+                    table[range][value] = static_cast<u8>(ReplicateBits(value, encoding.bits, 8));
+                    continue;
+                }
+
+                u32 a{(m & 1) ? 0x1FFU : 0U}, b{}, c{};
+                u32 mHigh{m >> 1};
+                if (encoding.type == IntegerEncoding::Type::Trit) {
+                    switch (encoding.bits) {
+                        case 1: c = 204; break;
+                        case 2: c = 93; b = (mHigh << 8) | (mHigh << 4) | (mHigh << 2) | (mHigh << 1); break;
+                        case 3: c = 44; b = (mHigh << 7) | (mHigh << 2) | mHigh; break;
+                        case 4: c = 22; b = (mHigh << 6) | mHigh; break;
+                        case 5: c = 11; b = (mHigh << 5) | (mHigh >> 2); break;
+                        case 6: c = 5; b = (mHigh << 4) | (mHigh >> 4); break;
+                    }
+                } else {
+                    switch (encoding.bits) {
+                        case 1: c = 113; break;
+                        case 2: c = 54; b = (mHigh << 8) | (mHigh << 3) | (mHigh << 2); break;
+                        case 3: c = 26; b = (mHigh << 7) | (mHigh << 1) | (mHigh >> 1); break;
+                        case 4: c = 13; b = (mHigh << 6) | (mHigh >> 1); break;
+                        case 5: c = 6; b = (mHigh << 5) | (mHigh >> 3); break;
+                    }
+                }
+
+                u32 t{((d * c) + b) ^ a};
+                table[range][value] = static_cast<u8>((a & 0x80) | (t >> 2));
+            }
+        }
+        return table;
+    }()};
+
+    /**
+     * @brief Tables for unquantizing weights in every range to 0-64
+     */
+    constexpr auto WeightUnquantizationTable{[]() {
+        std::array<std::array<u8, 32>, WeightRangeLevels.size()> table{};
+        for (size_t range{}; range < WeightRangeLevels.size(); range++) {
+            auto encoding{IntegerEncoding::ForLevels(WeightRangeLevels[range])};
+            for (u32 value{}; value < WeightRangeLevels[range]; value++) {
+                u32 m{value & ((1U << encoding.bits) - 1)}, d{value >> encoding.bits};
+                u32 result{};
+                if (encoding.type == IntegerEncoding::Type::Bits) {
+                    result = ReplicateBits(value, encoding.bits, 6);
+                } else if (encoding.bits == 0) {
+                    if (encoding.type == IntegerEncoding::Type::Trit)
+                        result = std::array<u32, 3>{0, 32, 63}[d];
+                    else
+                        result = std::array<u32, 5>{0, 16, 32, 47, 63}[d];
+                } else {
+                    u32 a{(m & 1) ? 0x7FU : 0U}, b{}, c{};
+                    u32 mHigh{m >> 1};
+                    if (encoding.type == IntegerEncoding::Type::Trit) {
+                        switch (encoding.bits) {
+                            case 1: c = 50; break;
+                            case 2: c = 23; b = (mHigh << 6) | (mHigh << 2) | mHigh; break;
+                            case 3: c = 11; b = (mHigh << 5) | mHigh; break;
+                        }
+                    } else {
+                        switch (encoding.bits) {
+                            case 1: c = 28; break;
+                            case 2: c = 13; b = (mHigh << 6) | (mHigh << 1); break;
+                        }
+                    }
+
+                    u32 t{((d * c) + b) ^ a};
+                    result = (a & 0x20) | (t >> 2);
+                }
+
+                table[range][value] = static_cast<u8>(result > 32 ? result + 1 : result);
+            }
+        }
+        return table;
+    }()};
+
+    /**
+     * @brief The weight grid parameters encoded in the 11-bit block mode of a block
+     */
+    struct BlockMode {
+        u8 gridWidth;
+        u8 gridHeight;
+        u8 weightRange; //!< The index of the weight range in WeightRangeLevels
+        u8 weightBits; //!< The amount of bits taken up by the weights of both planes
+        bool dualPlane;
+        bool error; //!< If the block mode is reserved or the weights don't fit in a block, this doesn't include any checks dependent on the block footprint
+    };
+
+    constexpr auto BlockModeTable{[]() {
+        std::array<BlockMode, 2048> table{};
+        for (u32 mode{}; mode < table.size(); mode++) {
+            auto &blockMode{table[mode]};
+            auto bits{[mode](u32 offset, u32 count) { return (mode >> offset) & ((1U << count) - 1); }};
+
+            // Void-extent blocks and reserved encodings with the lowest 4 bits or bits 6-8 all clear are handled as errors here
+            if ((mode & 0xF) == 0 || ((mode & 0b11) == 0 && (mode & 0x1C0) == 0x1C0)) {
+                blockMode.error = true;
+                continue;
+            }
+
+            u32 a{bits(5, 2)}, r, width, height;
+            bool isLayoutB{(mode & 0b11) == 0};
+            bool hasPrecisionBits{true};
+            if (!isLayoutB) {
+                r = (bits(0, 2) << 1) | bits(4, 1);
+                u32 b{bits(7, 2)};
+                switch (bits(2, 2)) {
+                    case 0b00: width = b + 4; height = a + 2; break;
+                    case 0b01: width = b + 8; height = a + 2; break;
+                    case 0b10: width = a + 2; height = b + 8; break;
+                    default:
+                        if (bits(8, 1)) {
+                            width = bits(7, 1) + 2;
+                            height = a + 2;
+                        } else {
+                            width = a + 2;
+                            height = bits(7, 1) + 6;
+                        }
+                        break;
+                }
+            } else {
+                r = (bits(2, 2) << 1) | bits(4, 1);
+                switch (bits(7, 2)) {
+                    case 0b00: width = 12; height = a + 2; break;
+                    case 0b01: width = a + 2; height = 12; break;
+                    case 0b10:
+                        width = a + 6;
+                        height = bits(9, 2) + 6;
+                        hasPrecisionBits = false; // Bits 9 and 10 encode the height rather than the precision and dual plane bits
+                        break;
+                    default:
+                        if (bits(5, 1)) {
+                            width = 10;
+                            height = 6;
+                        } else {
+                            width = 6;
+                            height = 10;
+                        }
+                        break;
+                }
+            }
+
+            bool highPrecision{hasPrecisionBits && bits(9, 1)};
+            blockMode.dualPlane = hasPrecisionBits && bits(10, 1);
+            blockMode.gridWidth = static_cast<u8>(width);
+            blockMode.gridHeight = static_cast<u8>(height);
+            blockMode.weightRange = static_cast<u8>((r - 2) + (highPrecision ? 6 : 0));
+
+            size_t weightCount{width * height * (blockMode.dualPlane ? 2U : 1U)};
+            size_t weightBits{IntegerEncoding::ForLevels(WeightRangeLevels[blockMode.weightRange]).GetBitLength(weightCount)};
+            blockMode.weightBits = static_cast<u8>(weightBits);
+            blockMode.error = weightCount > MaxWeightCount || weightBits < 24 || weightBits > 96;
+        }
+        return table;
+    }()};
+
+    /**
+     * @brief The partition hash function from the specification, used to select the partition of a texel
+     */
+    constexpr u32 HashPartitionSeed(u32 p) {
+        p ^= p >> 15;
+        p -= p << 17;
+        p += p << 7;
+        p += p << 4;
+        p ^= p >> 5;
+        p += p << 16;
+        p ^= p >> 7;
+        p ^= p >> 3;
+        p ^= p << 6;
+        p ^= p >> 17;
+        return p;
+    }
+
+    constexpr u8 SelectPartition(u32 seed, u32 x, u32 y, u32 partitionCount, bool smallBlock) {
+        if (smallBlock) {
+            x <<= 1;
+            y <<= 1;
+        }
+
+        seed += (partitionCount - 1) * 1024;
+        u32 rnum{HashPartitionSeed(seed)};
+
+        std::array<u32, 8> seeds{};
+        for (u32 index{}; index < seeds.size(); index++) {
+            seeds[index] = (rnum >> (index * 4)) & 0xF;
+            seeds[index] *= seeds[index];
+        }
+
+        u32 shift1, shift2;
+        if (seed & 1) {
+            shift1 = (seed & 2) ? 4 : 5;
+            shift2 = (partitionCount == 3) ? 6 : 5;
+        } else {
+            shift1 = (partitionCount == 3) ? 6 : 5;
+            shift2 = (seed & 2) ? 4 : 5;
+        }
+
+        for (u32 index{}; index < seeds.size(); index++)
+            seeds[index] >>= (index & 1) ? shift2 : shift1;
+
+        // The Z-axis terms are omitted as only 2D blocks are supported
+        u32 a{(seeds[0] * x + seeds[1] * y + (rnum >> 14)) & 0x3F};
+        u32 b{(seeds[2] * x + seeds[3] * y + (rnum >> 10)) & 0x3F};
+        u32 c{partitionCount < 3 ? 0 : (seeds[4] * x + seeds[5] * y + (rnum >> 6)) & 0x3F};
+        u32 d{partitionCount < 4 ? 0 : (seeds[6] * x + seeds[7] * y + (rnum >> 2)) & 0x3F};
+
+        if (a >= b && a >= c && a >= d)
+            return 0;
+        else if (b >= c && b >= d)
+            return 1;
+        else if (c >= d)
+            return 2;
+        else
+            return 3;
+    }
+
+    using Color = std::array<i32, 4>;
+
+    /**
+     * @brief Transfers a bit from one value to another, this is used by the base+offset endpoint modes for extending the precision of the base
+     */
+    constexpr void BitTransferSigned(i32 &a, i32 &b) {
+        b >>= 1;
+        b |= a & 0x80;
+        a >>= 1;
+        a &= 0x3F;
+        if (a & 0x20)
+            a -= 0x40;
+    }
+
+    constexpr Color BlueContract(i32 r, i32 g, i32 b, i32 a) {
+        return {(r + b) >> 1, (g + b) >> 1, b, a};
+    }
+
+    constexpr Color ClampColor(Color color) {
+        for (auto &channel : color)
+            channel = std::clamp(channel, 0, 0xFF);
+        return color;
+    }
+
+    /**
+     * @brief Decodes the endpoints of a single partition from its unquantized color values
+     * @return If the endpoint mode is supported by LDR decoding, HDR modes result in the error color
+     */
+    bool DecodeEndpoints(u32 mode, const u8 *values, Color &e0, Color &e1) {
+        std::array<i32, 8> v{};
+        for (size_t index{}; index < ((mode >> 2) + 1) * 2; index++)
+            v[index] = values[index];
+
+        switch (mode) {
+            case 0: // Luminance, direct
+                e0 = {v[0], v[0], v[0], 0xFF};
+                e1 = {v[1], v[1], v[1], 0xFF};
+                return true;
+
+            case 1: { // Luminance, base+offset
+                i32 l0{(v[0] >> 2) | (v[1] & 0xC0)};
+                i32 l1{std::min(l0 + (v[1] & 0x3F), 0xFF)};
+                e0 = {l0, l0, l0, 0xFF};
+                e1 = {l1, l1, l1, 0xFF};
+                return true;
+            }
+
+            case 4: // Luminance-Alpha, direct
+                e0 = {v[0], v[0], v[0], v[2]};
+                e1 = {v[1], v[1], v[1], v[3]};
+                return true;
+
+            case 5: // Luminance-Alpha, base+offset
+                BitTransferSigned(v[1], v[0]);
+                BitTransferSigned(v[3], v[2]);
+                e0 = {v[0], v[0], v[0], v[2]};
+                e1 = ClampColor({v[0] + v[1], v[0] + v[1], v[0] + v[1], v[2] + v[3]});
+                return true;
+
+            case 6: // RGB, base+scale
+                e0 = {(v[0] * v[3]) >> 8, (v[1] * v[3]) >> 8, (v[2] * v[3]) >> 8, 0xFF};
+                e1 = {v[0], v[1], v[2], 0xFF};
+                return true;
+
+            case 8: // RGB, direct
+                if (v[1] + v[3] + v[5] >= v[0] + v[2] + v[4]) {
+                    e0 = {v[0], v[2], v[4], 0xFF};
+                    e1 = {v[1], v[3], v[5], 0xFF};
+                } else {
+                    e0 = BlueContract(v[1], v[3], v[5], 0xFF);
+                    e1 = BlueContract(v[0], v[2], v[4], 0xFF);
+                }
+                return true;
+
+            case 9: // RGB, base+offset
+                BitTransferSigned(v[1], v[0]);
+                BitTransferSigned(v[3], v[2]);
+                BitTransferSigned(v[5], v[4]);
+                if (v[1] + v[3] + v[5] >= 0) {
+                    e0 = {v[0], v[2], v[4], 0xFF};
+                    e1 = {v[0] + v[1], v[2] + v[3], v[4] + v[5], 0xFF};
+                } else {
+                    e0 = BlueContract(v[0] + v[1], v[2] + v[3], v[4] + v[5], 0xFF);
+                    e1 = BlueContract(v[0], v[2], v[4], 0xFF);
+                }
+                e0 = ClampColor(e0);
+                e1 = ClampColor(e1);
+                return true;
+
+            case 10: // RGB, base+scale plus two alpha endpoints
+                e0 = {(v[0] * v[3]) >> 8, (v[1] * v[3]) >> 8, (v[2] * v[3]) >> 8, v[4]};
+                e1 = {v[0], v[1], v[2], v[5]};
+                return true;
+
+            case 12: // RGBA, direct
+                if (v[1] + v[3] + v[5] >= v[0] + v[2] + v[4]) {
+                    e0 = {v[0], v[2], v[4], v[6]};
+                    e1 = {v[1], v[3], v[5], v[7]};
+                } else {
+                    e0 = BlueContract(v[1], v[3], v[5], v[7]);
+                    e1 = BlueContract(v[0], v[2], v[4], v[6]);
+                }
+                return true;
+
+            case 13: // RGBA, base+offset
+                BitTransferSigned(v[1], v[0]);
+                BitTransferSigned(v[3], v[2]);
+                BitTransferSigned(v[5], v[4]);
+                BitTransferSigned(v[7], v[6]);
+                if (v[1] + v[3] + v[5] >= 0) {
+                    e0 = {v[0], v[2], v[4], v[6]};
+                    e1 = {v[0] + v[1], v[2] + v[3], v[4] + v[5], v[6] + v[7]};
+                } else {
+                    e0 = BlueContract(v[0] + v[1], v[2] + v[3], v[4] + v[5], v[6] + v[7]);
+                    e1 = BlueContract(v[0], v[2], v[4], v[6]);
+                }
+                e0 = ClampColor(e0);
+                e1 = ClampColor(e1);
+                return true;
+
+            default: // HDR endpoint modes (2, 3, 7, 11, 14 and 15)
+                return false;
+        }
+    }
+
+    /**
+     * @brief Interpolates between a pair of 16-bit expanded endpoints with per-channel weights and writes the top 8 bits of the result
+     */
+    __attribute__((always_inline)) inline void Interpolate(const std::array<u16, 4> &e0, const std::array<u16, 4> &e1, const std::array<u16, 4> &weights, u8 *output) {
+        // The result is floor((e0 * (64 - w) + e1 * w + 32) / 64) >> 8, which is equivalent to a single shift by 14
+        #if defined(__aarch64__)
+        uint16x4_t weight{vld1_u16(weights.data())};
+        uint32x4_t result{vmlal_u16(vmull_u16(vld1_u16(e0.data()), vsub_u16(vdup_n_u16(64), weight)), vld1_u16(e1.data()), weight)};
+        uint16x4_t narrowed{vshrn_n_u32(vaddq_u32(result, vdupq_n_u32(32)), 14)};
+        vst1_lane_u32(reinterpret_cast<uint32_t *>(output), vreinterpret_u32_u8(vmovn_u16(vcombine_u16(narrowed, narrowed))), 0);
+        #elif defined(__SSE4_1__)
+        __m128i weight{_mm_cvtepu16_epi32(_mm_loadl_epi64(reinterpret_cast<const __m128i *>(weights.data())))};
+        __m128i result{_mm_add_epi32(
+            _mm_mullo_epi32(_mm_cvtepu16_epi32(_mm_loadl_epi64(reinterpret_cast<const __m128i *>(e0.data()))), _mm_sub_epi32(_mm_set1_epi32(64), weight)),
+            _mm_mullo_epi32(_mm_cvtepu16_epi32(_mm_loadl_epi64(reinterpret_cast<const __m128i *>(e1.data()))), weight)
+        )};
+        result = _mm_srli_epi32(_mm_add_epi32(result, _mm_set1_epi32(32)), 14);
+        result = _mm_packus_epi32(result, result);
+        u32 packed{static_cast<u32>(_mm_cvtsi128_si32(_mm_packus_epi16(result, result)))};
+        std::memcpy(output, &packed, sizeof(packed));
+        #else
+        for (size_t channel{}; channel < 4; channel++)
+            output[channel] = static_cast<u8>((static_cast<u32>(e0[channel]) * (64 - weights[channel]) + static_cast<u32>(e1[channel]) * weights[channel] + 32) >> 14);
+        #endif
+    }
+
+    /**
+     * @brief Decodes a single ASTC block into a buffer of R8G8B8A8 texels with a pitch of MaxBlockDimension texels
+     */
+    void DecodeBlock(const u8 *src, u8 *texels, u32 blockWidth, u32 blockHeight, bool isSrgb) {
+        BlockBits bits;
+        std::memcpy(&bits, src, sizeof(bits));
+
+        auto fill{[&](const std::array<u8, 4> &color) {
+            for (u32 y{}; y < blockHeight; y++)
+                for (u32 x{}; x < blockWidth; x++)
+                    std::memcpy(texels + ((y * MaxBlockDimension + x) * R8g8b8a8Bpp), color.data(), color.size());
+        }};
+
+        u32 mode{bits.Read(0, 11)};
+        if ((mode & 0x1FF) == 0x1FC) {
+            // Void-extent blocks are a single constant color, HDR void-extent blocks aren't supported in LDR
+            if ((mode & 0x200) || bits.Read(10, 2) != 0b11)
+                return fill(ErrorColor);
+
+            u32 lowS{bits.Read(12, 13)}, highS{bits.Read(25, 13)}, lowT{bits.Read(38, 13)}, highT{bits.Read(51, 13)};
+            bool allOnes{lowS == 0x1FFF && highS == 0x1FFF && lowT == 0x1FFF && highT == 0x1FFF};
+            if (!allOnes && (lowS >= highS || lowT >= highT))
+                return fill(ErrorColor);
+
+            return fill({
+                static_cast<u8>(bits.Read(64, 16) >> 8),
+                static_cast<u8>(bits.Read(80, 16) >> 8),
+                static_cast<u8>(bits.Read(96, 16) >> 8),
+                static_cast<u8>(bits.Read(112, 16) >> 8),
+            });
+        }
+
+        const auto &blockMode{BlockModeTable[mode]};
+        if (blockMode.error || blockMode.gridWidth > blockWidth || blockMode.gridHeight > blockHeight)
+            return fill(ErrorColor);
+
+        u32 partitionCount{bits.Read(11, 2) + 1};
+        if (blockMode.dualPlane && partitionCount == 4)
+            return fill(ErrorColor);
+
+        // Determine the color endpoint modes of all partitions, these may be partially stored below the weights
+        std::array<u32, 4> endpointModes{};
+        size_t colorOffset, belowWeightsOffset{128U - blockMode.weightBits};
+        u32 partitionSeed{};
+        if (partitionCount == 1) {
+            endpointModes[0] = bits.Read(13, 4);
+            colorOffset = 17;
+        } else {
+            partitionSeed = bits.Read(13, 10);
+            colorOffset = 29;
+
+            u32 encodedModes{bits.Read(23, 6)};
+            u32 baseClass{encodedModes & 0b11};
+            if (baseClass == 0) {
+                for (u32 partition{}; partition < partitionCount; partition++)
+                    endpointModes[partition] = encodedModes >> 2;
+            } else {
+                size_t extraBits{3 * partitionCount - 4};
+                belowWeightsOffset -= extraBits;
+                encodedModes |= bits.Read(belowWeightsOffset, extraBits) << 6;
+
+                encodedModes >>= 2;
+                u32 classSelectors{encodedModes & ((1U << partitionCount) - 1)};
+                u32 modeSelectors{encodedModes >> partitionCount};
+                for (u32 partition{}; partition < partitionCount; partition++) {
+                    u32 endpointClass{baseClass - 1 + ((classSelectors >> partition) & 1)};
+                    endpointModes[partition] = (endpointClass << 2) | ((modeSelectors >> (partition * 2)) & 0b11);
+                }
+            }
+        }
+
+        u32 planeChannel{std::numeric_limits<u32>::max()};
+        if (blockMode.dualPlane) {
+            belowWeightsOffset -= 2;
+            planeChannel = bits.Read(belowWeightsOffset, 2);
+        }
+
+        if (belowWeightsOffset <= colorOffset)
+            return fill(ErrorColor);
+        size_t colorBits{belowWeightsOffset - colorOffset};
+
+        size_t colorValueCount{};
+        for (u32 partition{}; partition < partitionCount; partition++)
+            colorValueCount += ((endpointModes[partition] >> 2) + 1) * 2;
+        if (colorValueCount > MaxColorValueCount)
+            return fill(ErrorColor);
+
+        // The color endpoints use the largest range which fits in the bits that remain after all other fields
+        size_t colorRange{ColorRangeLevels.size()};
+        while (colorRange > 0 && IntegerEncoding::ForLevels(ColorRangeLevels[colorRange - 1]).GetBitLength(colorValueCount) > colorBits)
+            colorRange--;
+        if (colorRange == 0)
+            return fill(ErrorColor);
+        colorRange--;
+
+        std::array<u8, MaxColorValueCount> colorValues;
+        DecodeIntegerSequence(bits.Extract(colorOffset, colorBits), IntegerEncoding::ForLevels(ColorRangeLevels[colorRange]), colorValueCount, colorValues.data());
+        for (size_t index{}; index < colorValueCount; index++)
+            colorValues[index] = ColorUnquantizationTable[colorRange][colorValues[index]];
+
+        std::array<std::array<std::array<u16, 4>, 2>, 4> endpoints; //!< The endpoints of all partitions expanded to 16-bit
+        const u8 *partitionValues{colorValues.data()};
+        for (u32 partition{}; partition < partitionCount; partition++) {
+            Color e0, e1;
+            if (!DecodeEndpoints(endpointModes[partition], partitionValues, e0, e1))
+                return fill(ErrorColor);
+            partitionValues += ((endpointModes[partition] >> 2) + 1) * 2;
+
+            for (size_t channel{}; channel < 4; channel++) {
+                // sRGB endpoints are expanded with a fixed low byte while linear endpoints are replicated into it
+                endpoints[partition][0][channel] = static_cast<u16>(isSrgb ? ((e0[channel] << 8) | 0x80) : (e0[channel] * 257));
+                endpoints[partition][1][channel] = static_cast<u16>(isSrgb ? ((e1[channel] << 8) | 0x80) : (e1[channel] * 257));
+            }
+        }
+
+        // Weights are stored in reverse starting from the most significant bit of the block
+        size_t planeCount{blockMode.dualPlane ? 2U : 1U};
+        size_t gridWeightCount{static_cast<size_t>(blockMode.gridWidth) * blockMode.gridHeight};
+        std::array<u8, 2 * (MaxWeightCount + MaxBlockDimension + 1)> gridWeights{}; //!< The unquantized weights of the grid, padded to allow for reading past the last row during infill
+        DecodeIntegerSequence(bits.Reverse().Extract(0, blockMode.weightBits), IntegerEncoding::ForLevels(WeightRangeLevels[blockMode.weightRange]), gridWeightCount * planeCount, gridWeights.data());
+        for (size_t index{}; index < gridWeightCount * planeCount; index++)
+            gridWeights[index] = WeightUnquantizationTable[blockMode.weightRange][gridWeights[index]];
+
+        u32 scaleS{(1024 + blockWidth / 2) / (blockWidth - 1)}, scaleT{(1024 + blockHeight / 2) / (blockHeight - 1)};
+        bool smallBlock{blockWidth * blockHeight < 31};
+        for (u32 y{}; y < blockHeight; y++) {
+            u32 gt{((scaleT * y) * (blockMode.gridHeight - 1) + 32) >> 6};
+            u32 jt{gt >> 4}, ft{gt & 0xF};
+            for (u32 x{}; x < blockWidth; x++) {
+                // Bilinearly infill the weight of the texel from the weight grid
+                u32 gs{((scaleS * x) * (blockMode.gridWidth - 1) + 32) >> 6};
+                u32 js{gs >> 4}, fs{gs & 0xF};
+                u32 w11{((fs * ft) + 8) >> 4}, w10{ft - w11}, w01{fs - w11}, w00{16 - fs - ft + w11};
+                size_t v0{js + jt * blockMode.gridWidth};
+
+                std::array<u16, 4> weights;
+                for (size_t plane{}; plane < planeCount; plane++) {
+                    auto weight{[&](size_t index) -> u32 { return gridWeights[index * planeCount + plane]; }};
+                    u32 value{(weight(v0) * w00 + weight(v0 + 1) * w01 + weight(v0 + blockMode.gridWidth) * w10 + weight(v0 + blockMode.gridWidth + 1) * w11 + 8) >> 4};
+                    if (plane == 0)
+                        weights.fill(static_cast<u16>(value));
+                    else
+                        weights[planeChannel] = static_cast<u16>(value);
+                }
+
+                u8 partition{partitionCount > 1 ? SelectPartition(partitionSeed, x, y, partitionCount, smallBlock) : u8{}};
+                Interpolate(endpoints[partition][0], endpoints[partition][1], weights, texels + ((y * MaxBlockDimension + x) * R8g8b8a8Bpp));
+            }
+        }
+    }
+
+    void Decode(const u8 *src, u8 *dst, size_t width, size_t height, size_t blockWidth, size_t blockHeight, bool isSrgb, size_t blockRowOffset, size_t blockRowCount) {
+        std::array<u8, MaxBlockDimension * MaxBlockDimension * R8g8b8a8Bpp> texels;
+        size_t pitch{width * R8g8b8a8Bpp};
+        size_t blockRows{util::DivideCeil(height, blockHeight)};
+        if (blockRowOffset >= blockRows)
+            return;
+
+        size_t blockRowEnd{blockRowOffset + std::min(blockRowCount, blockRows - blockRowOffset)};
+        src += blockRowOffset * util::DivideCeil(width, blockWidth) * BlockSize;
+        dst += blockRowOffset * blockHeight * pitch;
+        for (size_t y{blockRowOffset * blockHeight}; y < blockRowEnd * blockHeight; y += blockHeight, dst += blockHeight * pitch) {
+            size_t rows{std::min(blockHeight, height - y)};
+            u8 *dstBlock{dst};
+            for (size_t x{}; x < width; x += blockWidth, src += BlockSize, dstBlock += blockWidth * R8g8b8a8Bpp) {
+                DecodeBlock(src, texels.data(), static_cast<u32>(blockWidth), static_cast<u32>(blockHeight), isSrgb);
+
+                // Blocks on the right and bottom edges may extend past the image, only the texels inside of it are written
+                size_t rowBytes{std::min(blockWidth, width - x) * R8g8b8a8Bpp};
+                for (size_t row{}; row < rows; row++)
+                    std::memcpy(dstBlock + (row * pitch), texels.data() + (row * MaxBlockDimension * R8g8b8a8Bpp), rowBytes);
+            }
+        }
+    }
+}
@@ -0,0 +1,20 @@
+// SPDX-License-Identifier: MPL-2.0
+// Copyright © 2022 Skyline Team and Contributors (https://github.com/skyline-emu/)
+
+#pragma once
+
+#include <common.h>
+
+namespace skyline::gpu::texture::astc {
+    /**
+     * @brief Decodes an ASTC LDR encoded 2D image to R8G8B8A8
+     * @param blockWidth The width of an ASTC block in texels, this must be one of the block footprints supported by the format (4-12)
+     * @param blockHeight The height of an ASTC block in texels, this must be one of the block footprints supported by the format (4-12)
+     * @param isSrgb If the image is sRGB encoded, this affects the expansion of endpoints prior to interpolation
+     * @param blockRowOffset The index of the first row of blocks to decode, `src` and `dst` always point to the start of the entire image
+     * @param blockRowCount The amount of rows of blocks to decode, this is clamped to the image
+     * @note Blocks which are invalid or use HDR endpoint modes are decoded to the error color (magenta) as mandated for LDR decoders
+     * @note Rows of blocks are independent of each other, as such disjoint ranges of the same image can be decoded concurrently
+     */
+    void Decode(const u8 *src, u8 *dst, size_t width, size_t height, size_t blockWidth, size_t blockHeight, bool isSrgb, size_t blockRowOffset = 0, size_t blockRowCount = std::numeric_limits<size_t>::max());
+}
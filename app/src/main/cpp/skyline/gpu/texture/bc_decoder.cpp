@@ -8,6 +8,11 @@
 
 #include <fmt/printf.h>
 #include <common.h>
+#if defined(__aarch64__)
+#include <arm_neon.h>
+#elif defined(__SSSE3__)
+#include <tmmintrin.h>
+#endif
 
 #ifdef NDEBUG
 #define ASSERT(condition)
@@ -26,20 +31,27 @@ namespace {
     constexpr int BlockWidth = 4;
     constexpr int BlockHeight = 4;
 
+    /**
+     * @brief A table of byte shuffles which expand a row of four 2-bit BC1 indices into the byte offsets of the corresponding entries in a palette of four R8G8B8A8 colors
+     */
+    constexpr auto ColorRowShuffles{[]() {
+        std::array<std::array<uint8_t, 16>, 256> shuffles{};
+        for (size_t row{}; row < shuffles.size(); row++)
+            for (size_t texel{}; texel < 4; texel++)
+                for (size_t byte{}; byte < 4; byte++)
+                    shuffles[row][(texel * 4) + byte] = static_cast<uint8_t>((((row >> (texel * 2)) & 0x3) * 4) + byte);
+        return shuffles;
+    }()};
+
+    /**
+     * @brief A byte shuffle which moves four packed alpha values into the alpha channel of four R8G8B8A8 texels, out of range indices zero the other channels
+     */
+    constexpr std::array<uint8_t, 16> AlphaRowShuffle{0x80, 0x80, 0x80, 0, 0x80, 0x80, 0x80, 1, 0x80, 0x80, 0x80, 2, 0x80, 0x80, 0x80, 3};
+
     struct BC_color {
         void decode(uint8_t *dst, size_t x, size_t y, size_t dstW, size_t dstH, size_t dstPitch, size_t dstBpp, bool hasAlphaChannel, bool hasSeparateAlpha) const {
             Color c[4];
-            c[0].extract565(c0);
-            c[1].extract565(c1);
-            if (hasSeparateAlpha || (c0 > c1)) {
-                c[2] = ((c[0] * 2) + c[1]) / 3;
-                c[3] = ((c[1] * 2) + c[0]) / 3;
-            } else {
-                c[2] = (c[0] + c[1]) >> 1;
-                if (hasAlphaChannel) {
-                    c[3].clearAlpha();
-                }
-            }
+            palette(c, hasAlphaChannel, hasSeparateAlpha);
 
             for (int j = 0; j < BlockHeight && (y + j) < dstH; j++) {
                 size_t dstOffset = j * dstPitch;
@@ -50,6 +62,51 @@ namespace {
             }
         }
 
+        /**
+         * @brief Decodes a block which lies entirely inside the image to R8G8B8A8, this avoids per-texel bounds checks and expands an entire row of indices with a single byte shuffle
+         * @param alphaRows The alpha of every row of texels with a byte per texel, this must be supplied when hasSeparateAlpha is set and is ignored otherwise
+         */
+        void decodeFull(uint8_t *dst, size_t dstPitch, bool hasAlphaChannel, bool hasSeparateAlpha, const uint32_t *alphaRows = nullptr) const {
+            Color c[4];
+            palette(c, hasAlphaChannel, hasSeparateAlpha);
+
+            alignas(16) uint32_t packed[4];
+            for (int i = 0; i < 4; i++) {
+                // The alpha of the palette is replaced by the separate alpha, it's cleared here so it can be merged in with an OR
+                packed[i] = hasSeparateAlpha ? (c[i].pack8888() & 0x00FFFFFF) : c[i].pack8888();
+            }
+
+            #if defined(__aarch64__)
+            uint8x16_t paletteVector = vld1q_u8(reinterpret_cast<const uint8_t *>(packed));
+            uint8x16_t alphaShuffle = vld1q_u8(AlphaRowShuffle.data());
+            for (int j = 0; j < BlockHeight; j++, dst += dstPitch) {
+                uint8x16_t row = vqtbl1q_u8(paletteVector, vld1q_u8(ColorRowShuffles[(idx >> (j * 8)) & 0xFF].data()));
+                if (hasSeparateAlpha)
+                    row = vorrq_u8(row, vqtbl1q_u8(vreinterpretq_u8_u32(vdupq_n_u32(alphaRows[j])), alphaShuffle));
+                vst1q_u8(dst, row);
+            }
+            #elif defined(__SSSE3__)
+            __m128i paletteVector = _mm_load_si128(reinterpret_cast<const __m128i *>(packed));
+            __m128i alphaShuffle = _mm_loadu_si128(reinterpret_cast<const __m128i *>(AlphaRowShuffle.data()));
+            for (int j = 0; j < BlockHeight; j++, dst += dstPitch) {
+                __m128i row = _mm_shuffle_epi8(paletteVector, _mm_loadu_si128(reinterpret_cast<const __m128i *>(ColorRowShuffles[(idx >> (j * 8)) & 0xFF].data())));
+                if (hasSeparateAlpha)
+                    row = _mm_or_si128(row, _mm_shuffle_epi8(_mm_set1_epi32(static_cast<int>(alphaRows[j])), alphaShuffle));
+                _mm_storeu_si128(reinterpret_cast<__m128i *>(dst), row);
+            }
+            #else
+            for (int j = 0; j < BlockHeight; j++, dst += dstPitch) {
+                uint32_t row[4];
+                for (int i = 0; i < BlockWidth; i++) {
+                    row[i] = packed[(idx >> ((j * 8) + (i * 2))) & 0x3];
+                    if (hasSeparateAlpha)
+                        row[i] |= ((alphaRows[j] >> (i * 8)) & 0xFF) << 24;
+                }
+                std::memcpy(dst, row, sizeof(row));
+            }
+            #endif
+        }
+
       private:
         struct Color {
             Color() {
@@ -112,6 +169,20 @@ namespace {
             return (idx & (0x3 << offset)) >> offset;
         }
 
+        void palette(Color (&c)[4], bool hasAlphaChannel, bool hasSeparateAlpha) const {
+            c[0].extract565(c0);
+            c[1].extract565(c1);
+            if (hasSeparateAlpha || (c0 > c1)) {
+                c[2] = ((c[0] * 2) + c[1]) / 3;
+                c[3] = ((c[1] * 2) + c[0]) / 3;
+            } else {
+                c[2] = (c[0] + c[1]) >> 1;
+                if (hasAlphaChannel) {
+                    c[3].clearAlpha();
+                }
+            }
+        }
+
         unsigned short c0;
         unsigned short c1;
         unsigned int idx;
@@ -121,7 +192,30 @@ namespace {
     struct BC_channel {
         void decode(uint8_t *dst, size_t x, size_t y, size_t dstW, size_t dstH, size_t dstPitch, size_t dstBpp, size_t channel, bool isSigned) const {
             int c[8] = {0};
+            palette(c, isSigned);
+
+            for (size_t j = 0; j < BlockHeight && (y + j) < dstH; j++) {
+                for (size_t i = 0; i < BlockWidth && (x + i) < dstW; i++) {
+                    dst[channel + (i * dstBpp) + (j * dstPitch)] = static_cast<uint8_t>(c[getIdx((j * BlockHeight) + i)]);
+                }
+            }
+        }
+
+        /**
+         * @brief Decodes all texels of the block in row-major order, this is used for blocks which lie entirely inside the image
+         */
+        void values(uint8_t (&out)[16], bool isSigned) const {
+            int c[8] = {0};
+            palette(c, isSigned);
 
+            uint64_t indices = data >> 16;
+            for (int i = 0; i < BlockWidth * BlockHeight; i++, indices >>= 3) {
+                out[i] = static_cast<uint8_t>(c[indices & 0x7]);
+            }
+        }
+
+      private:
+        void palette(int (&c)[8], bool isSigned) const {
             if (isSigned) {
                 c[0] = static_cast<signed char>(data & 0xFF);
                 c[1] = static_cast<signed char>((data & 0xFF00) >> 8);
@@ -141,15 +235,8 @@ namespace {
                 c[6] = isSigned ? -128 : 0;
                 c[7] = isSigned ? 127 : 255;
             }
-
-            for (size_t j = 0; j < BlockHeight && (y + j) < dstH; j++) {
-                for (size_t i = 0; i < BlockWidth && (x + i) < dstW; i++) {
-                    dst[channel + (i * dstBpp) + (j * dstPitch)] = static_cast<uint8_t>(c[getIdx((j * BlockHeight) + i)]);
-                }
-            }
         }
 
-      private:
         uint8_t getIdx(int i) const {
             int offset = i * 3 + 16;
             return static_cast<uint8_t>((data & (0x7ull << offset)) >> offset);
@@ -170,6 +257,15 @@ namespace {
             }
         }
 
+        /**
+         * @return The alpha of a row of texels in the block with a byte per texel
+         */
+        uint32_t getRow(int j) const {
+            uint32_t nibbles = (data >> (j * 16)) & 0xFFFF;
+            uint32_t row = (nibbles & 0xF) | ((nibbles & 0xF0) << 4) | ((nibbles & 0xF00) << 8) | ((nibbles & 0xF000) << 12);
+            return row | (row << 4);
+        }
+
       private:
         uint8_t getAlpha(int i) const {
             int offset = i << 2;
@@ -489,7 +585,7 @@ namespace {
         };
 
 // Interpolates between two endpoints, then does a final unquantization step
-        Color interpolate(RGBf e0, RGBf e1, const IndexInfo &index, bool isSigned) {
+        Color interpolate(const RGBf &e0, const RGBf &e1, const IndexInfo &index, bool isSigned) {
             static constexpr uint32_t weights3[] = {0, 9, 18, 27, 37, 46, 55, 64};
             static constexpr uint32_t weights4[] = {0, 4, 9, 13, 17, 21, 26, 30,
                                                     34, 38, 43, 47, 51, 55, 60, 64};
@@ -808,122 +904,130 @@ namespace {
             uint64_t low64;
             uint64_t high64;
 
-            void decode(uint8_t *dst, size_t dstX, size_t dstY, size_t dstWidth, size_t dstHeight, size_t dstPitch, size_t dstBpp, bool isSigned) const {
-                uint8_t mode = 0;
-                Data data(low64, high64);
-                ASSERT(dstBpp == sizeof(Color));
+            /**
+             * @return The index of the block description for the mode of this block, -1 for illegal or reserved modes
+             */
+            int blockIndex() const {
+                // Modes 0 and 1 are encoded with 2 bits while all other modes are encoded with 5 bits
+                return modeToIndex(static_cast<uint8_t>((low64 & 0x2) == 0 ? (low64 & 0x3) : (low64 & 0x1F)));
+            }
 
-                if ((data.low64 & 0x2) == 0) {
-                    mode = data.consumeBits(1, 0);
-                } else {
-                    mode = data.consumeBits(4, 0);
+            /**
+             * @brief Reads a single field of a block description, the description is a compile-time constant so no dispatching on the field type is done at runtime
+             */
+            template<int BlockIndex, int DescIndex>
+            static void readField(Data &data, RGBf (&e)[4], int &partition) {
+                constexpr BlockDesc desc = blockDescs[BlockIndex][DescIndex];
+                if constexpr (desc.type == Partition) {
+                    partition |= data.consumeBits(desc.MSB, desc.LSB);
+                } else if constexpr (desc.type == EP0 || desc.type == EP1 || desc.type == EP2 || desc.type == EP3) {
+                    e[desc.type].channel[desc.channel] |= data.consumeBits(desc.MSB, desc.LSB);
                 }
+            }
+
+            template<int BlockIndex, size_t... DescIndices>
+            static void readFields(Data &data, RGBf (&e)[4], int &partition, std::index_sequence<DescIndices...>) {
+                // The first description is always the mode which has already been consumed
+                (readField<BlockIndex, DescIndices + 1>(data, e, partition), ...);
+            }
+
+            /**
+             * @brief Decodes a block with the mode at BlockIndex, the block description is a compile-time constant so reading the fields of the block is unrolled
+             */
+            template<int BlockIndex>
+            void decode(uint8_t *dst, size_t dstX, size_t dstY, size_t dstWidth, size_t dstHeight, size_t dstPitch, size_t dstBpp, bool isSigned) const {
+                ASSERT(dstBpp == sizeof(Color));
 
-                int blockIndex = modeToIndex(mode);
                 // Handle illegal or reserved mode
-                if (blockIndex == -1) {
+                if constexpr (BlockIndex < 0) {
                     for (int y = 0; y < 4 && y + dstY < dstHeight; y++) {
                         for (int x = 0; x < 4 && x + dstX < dstWidth; x++) {
                             auto out = reinterpret_cast<Color *>(dst + sizeof(Color) * x + dstPitch * y);
                             out->rgba = {0, 0, 0};
                         }
                     }
-                    return;
-                }
-                const BlockDesc *blockDesc = blockDescs[blockIndex];
-
-                RGBf e[4];
-                e[0].isSigned = e[1].isSigned = e[2].isSigned = e[3].isSigned = isSigned;
-
-                int partition = 0;
-                ModeDesc modeDesc;
-                for (int index = 0; blockDesc[index].type != End; index++) {
-                    const BlockDesc desc = blockDesc[index];
-
-                    switch (desc.type) {
-                        case Mode:
-                            modeDesc = desc.modeDesc;
-                            ASSERT(modeDesc.number == mode);
-
-                            e[0].size[0] = e[0].size[1] = e[0].size[2] = modeDesc.endpointBits;
-                            for (int i = 0; i < RGBfChannels; i++) {
-                                if (modeDesc.hasDelta) {
-                                    e[1].size[i] = e[2].size[i] = e[3].size[i] = modeDesc.deltaBits.channel[i];
-                                } else {
-                                    e[1].size[i] = e[2].size[i] = e[3].size[i] = modeDesc.endpointBits;
-                                }
-                            }
-                            break;
-                        case Partition:
-                            partition |= data.consumeBits(desc.MSB, desc.LSB);
-                            break;
-                        case EP0:
-                        case EP1:
-                        case EP2:
-                        case EP3:
-                            e[desc.type].channel[desc.channel] |= data.consumeBits(desc.MSB, desc.LSB);
-                            break;
-                        default:
-                            ASSERT_MSG(false, "Unexpected enum value: %d", (int) desc.type);
-                            return;
+                } else {
+                    constexpr ModeDesc modeDesc = blockDescs[BlockIndex][0].modeDesc;
+
+                    Data data(low64, high64);
+                    data.consumeBits(BlockIndex < 2 ? 1 : 4, 0);
+
+                    RGBf e[4];
+                    e[0].isSigned = e[1].isSigned = e[2].isSigned = e[3].isSigned = isSigned;
+
+                    e[0].size[0] = e[0].size[1] = e[0].size[2] = modeDesc.endpointBits;
+                    for (int i = 0; i < RGBfChannels; i++) {
+                        if (modeDesc.hasDelta) {
+                            e[1].size[i] = e[2].size[i] = e[3].size[i] = modeDesc.deltaBits.channel[i];
+                        } else {
+                            e[1].size[i] = e[2].size[i] = e[3].size[i] = modeDesc.endpointBits;
+                        }
                     }
-                }
 
-                // Sign extension
-                if (isSigned) {
-                    for (int ep = 0; ep < modeDesc.partitionCount * 2; ep++) {
-                        e[ep].extendSign();
+                    int partition = 0;
+                    readFields<BlockIndex>(data, e, partition, std::make_index_sequence<MaxBlockDescIndex - 1>{});
+
+                    // Sign extension
+                    if (isSigned) {
+                        for (int ep = 0; ep < modeDesc.partitionCount * 2; ep++) {
+                            e[ep].extendSign();
+                        }
+                    } else if (modeDesc.hasDelta) {
+                        // Don't sign-extend the base endpoint in an unsigned format.
+                        for (int ep = 1; ep < modeDesc.partitionCount * 2; ep++) {
+                            e[ep].extendSign();
+                        }
                     }
-                } else if (modeDesc.hasDelta) {
-                    // Don't sign-extend the base endpoint in an unsigned format.
-                    for (int ep = 1; ep < modeDesc.partitionCount * 2; ep++) {
-                        e[ep].extendSign();
+
+                    // Turn the deltas into endpoints
+                    if (modeDesc.hasDelta) {
+                        for (int ep = 1; ep < modeDesc.partitionCount * 2; ep++) {
+                            e[ep].resolveDelta(e[0]);
+                        }
                     }
-                }
 
-                // Turn the deltas into endpoints
-                if (modeDesc.hasDelta) {
-                    for (int ep = 1; ep < modeDesc.partitionCount * 2; ep++) {
-                        e[ep].resolveDelta(e[0]);
+                    for (int ep = 0; ep < modeDesc.partitionCount * 2; ep++) {
+                        e[ep].unquantize();
                     }
-                }
 
-                for (int ep = 0; ep < modeDesc.partitionCount * 2; ep++) {
-                    e[ep].unquantize();
-                }
+                    // All header fields span at least 65 bits, as such the remaining index bits are entirely within the low 64 bits
+                    uint64_t indices = data.low64;
+
+                    // Get the indices, calculate final colors, and output
+                    for (int y = 0; y < 4; y++) {
+                        for (int x = 0; x < 4; x++) {
+                            int pixelNum = x + y * 4;
+                            IndexInfo idx;
+                            bool isAnchor = false;
+                            int firstEndpoint = 0;
+                            // Bc6H can have either 1 or 2 petitions depending on the mode.
+                            // The number of petitions affects the number of indices with implicit
+                            // leading 0 bits and the number of bits per index.
+                            if constexpr (modeDesc.partitionCount == 1) {
+                                idx.numBits = 4;
+                                // There's an implicit leading 0 bit for the first idx
+                                isAnchor = (pixelNum == 0);
+                            } else {
+                                idx.numBits = 3;
+                                // There are 2 indices with implicit leading 0-bits.
+                                isAnchor = ((pixelNum == 0) || (pixelNum == AnchorTable2[partition]));
+                                firstEndpoint = PartitionTable2[partition][pixelNum] * 2;
+                            }
 
-                // Get the indices, calculate final colors, and output
-                for (int y = 0; y < 4; y++) {
-                    for (int x = 0; x < 4; x++) {
-                        int pixelNum = x + y * 4;
-                        IndexInfo idx;
-                        bool isAnchor = false;
-                        int firstEndpoint = 0;
-                        // Bc6H can have either 1 or 2 petitions depending on the mode.
-                        // The number of petitions affects the number of indices with implicit
-                        // leading 0 bits and the number of bits per index.
-                        if (modeDesc.partitionCount == 1) {
-                            idx.numBits = 4;
-                            // There's an implicit leading 0 bit for the first idx
-                            isAnchor = (pixelNum == 0);
-                        } else {
-                            idx.numBits = 3;
-                            // There are 2 indices with implicit leading 0-bits.
-                            isAnchor = ((pixelNum == 0) || (pixelNum == AnchorTable2[partition]));
-                            firstEndpoint = PartitionTable2[partition][pixelNum] * 2;
-                        }
+                            int indexBits = idx.numBits - isAnchor;
+                            idx.value = indices & ((1u << indexBits) - 1);
+                            indices >>= indexBits;
 
-                        idx.value = data.consumeBits(idx.numBits - isAnchor - 1, 0);
+                            // Don't exit the loop early, we need to consume these index bits regardless if
+                            // we actually output them or not.
+                            if ((y + dstY >= dstHeight) || (x + dstX >= dstWidth)) {
+                                continue;
+                            }
 
-                        // Don't exit the loop early, we need to consume these index bits regardless if
-                        // we actually output them or not.
-                        if ((y + dstY >= dstHeight) || (x + dstX >= dstWidth)) {
-                            continue;
+                            Color color = interpolate(e[firstEndpoint], e[firstEndpoint + 1], idx, isSigned);
+                            auto out = reinterpret_cast<Color *>(dst + dstBpp * x + dstPitch * y);
+                            *out = color;
                         }
-
-                        Color color = interpolate(e[firstEndpoint], e[firstEndpoint + 1], idx, isSigned);
-                        auto out = reinterpret_cast<Color *>(dst + dstBpp * x + dstPitch * y);
-                        *out = color;
                     }
                 }
             }
@@ -1250,32 +1354,11 @@ namespace {
                 return ((low >> bf.offset) | (high << (64 - bf.offset))) & mask;
             }
 
-            const Mode &mode() const {
-                if ((low & 0b00000001) != 0) {
-                    return Modes[0];
-                }
-                if ((low & 0b00000010) != 0) {
-                    return Modes[1];
-                }
-                if ((low & 0b00000100) != 0) {
-                    return Modes[2];
-                }
-                if ((low & 0b00001000) != 0) {
-                    return Modes[3];
-                }
-                if ((low & 0b00010000) != 0) {
-                    return Modes[4];
-                }
-                if ((low & 0b00100000) != 0) {
-                    return Modes[5];
-                }
-                if ((low & 0b01000000) != 0) {
-                    return Modes[6];
-                }
-                if ((low & 0b10000000) != 0) {
-                    return Modes[7];
-                }
-                return Modes[8];  // Invalid mode
+            /**
+             * @return The index of the mode of this block in the mode table, this is the position of the lowest set bit with all bits clear being an invalid mode
+             */
+            int modeIndex() const {
+                return std::countr_zero(static_cast<unsigned int>(low & 0xFF) | 0x100u);
             }
 
             struct IndexInfo {
@@ -1296,10 +1379,14 @@ namespace {
                 return (uint8_t) (((64 - weights[index.value]) * uint16_t(e0) + weights[index.value] * uint16_t(e1) + 32) >> 6);
             }
 
+            /**
+             * @brief Decodes a block with the mode at ModeIndex, the mode is a compile-time constant so all bitfield offsets are folded
+             */
+            template<int ModeIndex>
             void decode(uint8_t *dst, size_t dstX, size_t dstY, size_t dstWidth, size_t dstHeight, size_t dstPitch) const {
-                auto const &mode = this->mode();
+                constexpr const Mode &mode = Modes[ModeIndex];
 
-                if (mode.IDX < 0)  // Invalid mode:
+                if constexpr (mode.IDX < 0)  // Invalid mode:
                 {
                     for (size_t y = 0; y < 4 && y + dstY < dstHeight; y++) {
                         for (size_t x = 0; x < 4 && x + dstX < dstWidth; x++) {
@@ -1368,26 +1455,49 @@ namespace {
                     }
                 }
 
-                int colorIndexBitOffset = 0;
-                int alphaIndexBitOffset = 0;
+                // Everything besides the indices is constant for the block, it's read once rather than for every texel
+                auto partitionIdx = Get(mode.Partition());
+                ASSERT(partitionIdx < MaxPartitions);
+                auto rotation = Get(mode.Rotation());
+
+                // ARB_texture_compression_bptc states:
+                // "The index value for interpolating color comes from the secondary
+                // index for the texel if the format has an index selection bit and its
+                // value is one and from the primary index otherwise.""
+                // "The alpha index comes from the secondary index if the block has a
+                // secondary index and the block either doesn't have an index selection
+                // bit or that bit is zero and the primary index otherwise."
+                auto indexSelection = Get(mode.IndexSelection());
+                ASSERT(indexSelection <= 1);
+                bool colorSecondary = indexSelection == 1;
+                bool alphaSecondary = (mode.IB2 != 0) && (indexSelection == 0);
+                int colorIndexBits = colorSecondary ? mode.IB2 : mode.IB;
+                int alphaIndexBits = alphaSecondary ? mode.IB2 : mode.IB;
+                int colorIndexBitOffset = colorSecondary ? mode.SecondaryIndex(0, 0).offset : mode.PrimaryIndex(0, 0).offset;
+                int alphaIndexBitOffset = alphaSecondary ? mode.SecondaryIndex(0, 0).offset : mode.PrimaryIndex(0, 0).offset;
+
+                int anchors[MaxSubsets];
+                for (int subsetIdx = 0; subsetIdx < MaxSubsets; subsetIdx++) {
+                    anchors[subsetIdx] = anchorIndex(mode, partitionIdx, subsetIdx);
+                }
+
                 for (int y = 0; y < 4; y++) {
                     for (int x = 0; x < 4; x++) {
                         auto texelIdx = y * 4 + x;
-                        auto partitionIdx = Get(mode.Partition());
-                        ASSERT(partitionIdx < MaxPartitions);
                         auto subsetIdx = subsetIndex(mode, partitionIdx, texelIdx);
                         ASSERT(subsetIdx < MaxSubsets);
                         auto const &subset = subsets[subsetIdx];
 
-                        auto anchorIdx = anchorIndex(mode, partitionIdx, subsetIdx);
-                        auto isAnchor = anchorIdx == texelIdx;
-                        auto colorIdx = colorIndex(mode, isAnchor, colorIndexBitOffset);
-                        auto alphaIdx = alphaIndex(mode, isAnchor, alphaIndexBitOffset);
+                        // The anchor texel of every subset has an implicit leading zero bit in its indices
+                        auto isAnchor = anchors[subsetIdx] == texelIdx;
+                        IndexInfo colorIdx{Get({colorIndexBitOffset, colorIndexBits - isAnchor}), colorIndexBits};
+                        IndexInfo alphaIdx{Get({alphaIndexBitOffset, alphaIndexBits - isAnchor}), alphaIndexBits};
+                        colorIndexBitOffset += colorIndexBits - isAnchor;
+                        alphaIndexBitOffset += alphaIndexBits - isAnchor;
 
                         if (y + dstY >= dstHeight || x + dstX >= dstWidth) {
                             // Don't be tempted to skip early at the loops:
-                            // The calls to colorIndex() and alphaIndex() adjust bit
-                            // offsets that need to be carefully tracked.
+                            // The bit offsets of the indices need to be carefully tracked.
                             continue;
                         }
 
@@ -1398,7 +1508,7 @@ namespace {
                         output.rgb.b = interpolate(subset[0].rgb.r, subset[1].rgb.r, colorIdx);
                         output.a = interpolate(subset[0].a, subset[1].a, alphaIdx);
 
-                        switch (Get(mode.Rotation())) {
+                        switch (rotation) {
                             default:
                                 break;
                             case 1:
@@ -1446,42 +1556,6 @@ namespace {
                 }
             }
 
-            IndexInfo colorIndex(const Mode &mode, bool isAnchor,
-                                 int &indexBitOffset) const {
-                // ARB_texture_compression_bptc states:
-                // "The index value for interpolating color comes from the secondary
-                // index for the texel if the format has an index selection bit and its
-                // value is one and from the primary index otherwise.""
-                auto idx = Get(mode.IndexSelection());
-                ASSERT(idx <= 1);
-                bool secondary = idx == 1;
-                auto numBits = secondary ? mode.IB2 : mode.IB;
-                auto numReadBits = numBits - (isAnchor ? 1 : 0);
-                auto index =
-                    Get(secondary ? mode.SecondaryIndex(indexBitOffset, numReadBits)
-                                  : mode.PrimaryIndex(indexBitOffset, numReadBits));
-                indexBitOffset += numReadBits;
-                return {index, numBits};
-            }
-
-            IndexInfo alphaIndex(const Mode &mode, bool isAnchor,
-                                 int &indexBitOffset) const {
-                // ARB_texture_compression_bptc states:
-                // "The alpha index comes from the secondary index if the block has a
-                // secondary index and the block either doesn't have an index selection
-                // bit or that bit is zero and the primary index otherwise."
-                auto idx = Get(mode.IndexSelection());
-                ASSERT(idx <= 1);
-                bool secondary = (mode.IB2 != 0) && (idx == 0);
-                auto numBits = secondary ? mode.IB2 : mode.IB;
-                auto numReadBits = numBits - (isAnchor ? 1 : 0);
-                auto index =
-                    Get(secondary ? mode.SecondaryIndex(indexBitOffset, numReadBits)
-                                  : mode.PrimaryIndex(indexBitOffset, numReadBits));
-                indexBitOffset += numReadBits;
-                return {index, numBits};
-            }
-
             // Assumes little-endian
             uint64_t low;
             uint64_t high;
@@ -1497,82 +1571,229 @@ namespace bcn {
     constexpr size_t R8g8b8a8Bpp{4}; //!< The amount of bytes per pixel in R8G8B8A8
     constexpr size_t R16g16b16a16Bpp{8}; //!< The amount of bytes per pixel in R16G16B16
 
-    void DecodeBc1(const uint8_t *src, uint8_t *dst, size_t width, size_t height, bool hasAlphaChannel) {
-        const auto *color{reinterpret_cast<const BC_color *>(src)};
+    /**
+     * @brief Calls the supplied function for every row of blocks in the range of block rows, the range is clamped to the image
+     * @param function A function taking a pointer to the first block in the row, a pointer to the output of the row and the Y coordinate of the row in texels
+     */
+    template<size_t BlockSize, typename Function>
+    void ForEachBlockRow(const uint8_t *src, uint8_t *dst, size_t width, size_t height, size_t dstBpp, size_t blockRowOffset, size_t blockRowCount, Function &&function) {
+        size_t blockRowSize{((width + BlockWidth - 1) / BlockWidth) * BlockSize}, blockRows{(height + BlockHeight - 1) / BlockHeight};
+        if (blockRowOffset >= blockRows)
+            return;
+
+        size_t pitch{dstBpp * width};
+        size_t blockRowEnd{blockRowOffset + std::min(blockRowCount, blockRows - blockRowOffset)};
+        for (size_t blockRow{blockRowOffset}; blockRow < blockRowEnd; blockRow++)
+            function(src + (blockRow * blockRowSize), dst + (blockRow * BlockHeight * pitch), blockRow * BlockHeight);
+    }
+
+    /**
+     * @return If the block at the supplied coordinates lies entirely inside the image
+     */
+    bool IsFullBlock(size_t x, size_t y, size_t width, size_t height) {
+        return x + BlockWidth <= width && y + BlockHeight <= height;
+    }
+
+    void DecodeBc1(const uint8_t *src, uint8_t *dst, size_t width, size_t height, bool hasAlphaChannel, size_t blockRowOffset, size_t blockRowCount) {
         size_t pitch{R8g8b8a8Bpp * width};
-        for (size_t y{}; y < height; y += BlockHeight, dst += BlockHeight * pitch) {
-            uint8_t *dstRow{dst};
-            for (size_t x{}; x < width; x += BlockWidth, ++color, dstRow += BlockWidth * R8g8b8a8Bpp)
-                [[clang::always_inline]] color->decode(dstRow, x, y, width, height, pitch, R8g8b8a8Bpp, hasAlphaChannel, false);
-        }
+        ForEachBlockRow<sizeof(BC_color)>(src, dst, width, height, R8g8b8a8Bpp, blockRowOffset, blockRowCount, [&](const uint8_t *blocks, uint8_t *dstRow, size_t y) {
+            const auto *color{reinterpret_cast<const BC_color *>(blocks)};
+            for (size_t x{}; x < width; x += BlockWidth, ++color, dstRow += BlockWidth * R8g8b8a8Bpp) {
+                if (IsFullBlock(x, y, width, height))
+                    [[clang::always_inline]] color->decodeFull(dstRow, pitch, hasAlphaChannel, false);
+                else
+                    color->decode(dstRow, x, y, width, height, pitch, R8g8b8a8Bpp, hasAlphaChannel, false);
+            }
+        });
     }
 
-    void DecodeBc2(const uint8_t *src, uint8_t *dst, size_t width, size_t height) {
-        const auto *alpha{reinterpret_cast<const BC_alpha *>(src)};
-        const auto *color{reinterpret_cast<const BC_color *>(src + 8)};
+    void DecodeBc2(const uint8_t *src, uint8_t *dst, size_t width, size_t height, size_t blockRowOffset, size_t blockRowCount) {
         size_t pitch{R8g8b8a8Bpp * width};
-        for (size_t y{}; y < height; y += BlockHeight, dst += BlockHeight * pitch) {
-            uint8_t *dstRow{dst};
+        ForEachBlockRow<sizeof(BC_alpha) + sizeof(BC_color)>(src, dst, width, height, R8g8b8a8Bpp, blockRowOffset, blockRowCount, [&](const uint8_t *blocks, uint8_t *dstRow, size_t y) {
+            const auto *alpha{reinterpret_cast<const BC_alpha *>(blocks)};
+            const auto *color{reinterpret_cast<const BC_color *>(blocks + 8)};
             for (size_t x{}; x < width; x += BlockWidth, alpha += 2, color += 2, dstRow += BlockWidth * R8g8b8a8Bpp) {
-                [[clang::always_inline]] color->decode(dstRow, x, y, width, height, pitch, R8g8b8a8Bpp, false, true);
-                [[clang::always_inline]] alpha->decode(dstRow, x, y, width, height, pitch, R8g8b8a8Bpp);
+                if (IsFullBlock(x, y, width, height)) {
+                    uint32_t alphaRows[BlockHeight];
+                    for (int j{}; j < BlockHeight; j++)
+                        alphaRows[j] = alpha->getRow(j);
+                    [[clang::always_inline]] color->decodeFull(dstRow, pitch, false, true, alphaRows);
+                } else {
+                    color->decode(dstRow, x, y, width, height, pitch, R8g8b8a8Bpp, false, true);
+                    alpha->decode(dstRow, x, y, width, height, pitch, R8g8b8a8Bpp);
+                }
             }
-        }
+        });
     }
 
-    void DecodeBc3(const uint8_t *src, uint8_t *dst, size_t width, size_t height) {
-        const auto *alpha{reinterpret_cast<const BC_channel *>(src)};
-        const auto *color{reinterpret_cast<const BC_color *>(src + 8)};
+    void DecodeBc3(const uint8_t *src, uint8_t *dst, size_t width, size_t height, size_t blockRowOffset, size_t blockRowCount) {
         size_t pitch{R8g8b8a8Bpp * width};
-        for (size_t y{}; y < height; y += BlockHeight, dst += BlockHeight * pitch) {
-            uint8_t *dstRow{dst};
+        ForEachBlockRow<sizeof(BC_channel) + sizeof(BC_color)>(src, dst, width, height, R8g8b8a8Bpp, blockRowOffset, blockRowCount, [&](const uint8_t *blocks, uint8_t *dstRow, size_t y) {
+            const auto *alpha{reinterpret_cast<const BC_channel *>(blocks)};
+            const auto *color{reinterpret_cast<const BC_color *>(blocks + 8)};
             for (size_t x{}; x < width; x += BlockWidth, alpha += 2, color += 2, dstRow += BlockWidth * R8g8b8a8Bpp) {
-                [[clang::always_inline]] color->decode(dstRow, x, y, width, height, pitch, R8g8b8a8Bpp, false, true);
-                [[clang::always_inline]] alpha->decode(dstRow, x, y, width, height, pitch, R8g8b8a8Bpp, 3, false);
+                if (IsFullBlock(x, y, width, height)) {
+                    uint8_t alphaValues[BlockWidth * BlockHeight];
+                    alpha->values(alphaValues, false);
+                    uint32_t alphaRows[BlockHeight];
+                    std::memcpy(alphaRows, alphaValues, sizeof(alphaRows));
+                    [[clang::always_inline]] color->decodeFull(dstRow, pitch, false, true, alphaRows);
+                } else {
+                    color->decode(dstRow, x, y, width, height, pitch, R8g8b8a8Bpp, false, true);
+                    alpha->decode(dstRow, x, y, width, height, pitch, R8g8b8a8Bpp, 3, false);
+                }
             }
-        }
+        });
     }
 
-    void DecodeBc4(const uint8_t *src, uint8_t *dst, size_t width, size_t height, bool isSigned) {
-        const auto *red{reinterpret_cast<const BC_channel *>(src)};
+    void DecodeBc4(const uint8_t *src, uint8_t *dst, size_t width, size_t height, bool isSigned, size_t blockRowOffset, size_t blockRowCount) {
         size_t pitch{R8Bpp * width};
-        for (size_t y{}; y < height; y += BlockHeight, dst += BlockHeight * pitch) {
-            uint8_t *dstRow{dst};
-            for (size_t x{}; x < width; x += BlockWidth, ++red, dstRow += BlockWidth * R8Bpp)
-                [[clang::always_inline]] red->decode(dstRow, x, y, width, height, pitch, R8Bpp, 0, isSigned);
-        }
+        ForEachBlockRow<sizeof(BC_channel)>(src, dst, width, height, R8Bpp, blockRowOffset, blockRowCount, [&](const uint8_t *blocks, uint8_t *dstRow, size_t y) {
+            const auto *red{reinterpret_cast<const BC_channel *>(blocks)};
+            for (size_t x{}; x < width; x += BlockWidth, ++red, dstRow += BlockWidth * R8Bpp) {
+                if (IsFullBlock(x, y, width, height)) {
+                    uint8_t values[BlockWidth * BlockHeight];
+                    red->values(values, isSigned);
+                    for (size_t j{}; j < BlockHeight; j++)
+                        std::memcpy(dstRow + (j * pitch), values + (j * BlockWidth), BlockWidth * R8Bpp);
+                } else {
+                    red->decode(dstRow, x, y, width, height, pitch, R8Bpp, 0, isSigned);
+                }
+            }
+        });
     }
 
-    void DecodeBc5(const uint8_t *src, uint8_t *dst, size_t width, size_t height, bool isSigned) {
-        const auto *red{reinterpret_cast<const BC_channel *>(src)};
-        const auto *green{reinterpret_cast<const BC_channel *>(src + 8)};
+    void DecodeBc5(const uint8_t *src, uint8_t *dst, size_t width, size_t height, bool isSigned, size_t blockRowOffset, size_t blockRowCount) {
         size_t pitch{R8g8Bpp * width};
-        for (size_t y{}; y < height; y += BlockHeight, dst += BlockHeight * pitch) {
-            uint8_t *dstRow{dst};
+        ForEachBlockRow<sizeof(BC_channel) * 2>(src, dst, width, height, R8g8Bpp, blockRowOffset, blockRowCount, [&](const uint8_t *blocks, uint8_t *dstRow, size_t y) {
+            const auto *red{reinterpret_cast<const BC_channel *>(blocks)};
+            const auto *green{reinterpret_cast<const BC_channel *>(blocks + 8)};
             for (size_t x{}; x < width; x += BlockWidth, red += 2, green += 2, dstRow += BlockWidth * R8g8Bpp) {
-                [[clang::always_inline]] red->decode(dstRow, x, y, width, height, pitch, R8g8Bpp, 0, isSigned);
-                [[clang::always_inline]] green->decode(dstRow, x, y, width, height, pitch, R8g8Bpp, 1, isSigned);
+                if (IsFullBlock(x, y, width, height)) {
+                    uint8_t redValues[BlockWidth * BlockHeight], greenValues[BlockWidth * BlockHeight];
+                    red->values(redValues, isSigned);
+                    green->values(greenValues, isSigned);
+
+                    #if defined(__aarch64__)
+                    uint8x16x2_t interleaved{vzipq_u8(vld1q_u8(redValues), vld1q_u8(greenValues))};
+                    for (size_t j{}; j < BlockHeight; j++)
+                        vst1_u8(dstRow + (j * pitch), j % 2 ? vget_high_u8(interleaved.val[j / 2]) : vget_low_u8(interleaved.val[j / 2]));
+                    #elif defined(__SSSE3__)
+                    __m128i redVector{_mm_loadu_si128(reinterpret_cast<const __m128i *>(redValues))}, greenVector{_mm_loadu_si128(reinterpret_cast<const __m128i *>(greenValues))};
+                    __m128i interleaved[2]{_mm_unpacklo_epi8(redVector, greenVector), _mm_unpackhi_epi8(redVector, greenVector)};
+                    for (size_t j{}; j < BlockHeight; j++)
+                        _mm_storel_epi64(reinterpret_cast<__m128i *>(dstRow + (j * pitch)), j % 2 ? _mm_srli_si128(interleaved[j / 2], 8) : interleaved[j / 2]);
+                    #else
+                    for (size_t j{}; j < BlockHeight; j++) {
+                        uint8_t row[BlockWidth * R8g8Bpp];
+                        for (size_t i{}; i < BlockWidth; i++) {
+                            row[i * R8g8Bpp] = redValues[(j * BlockWidth) + i];
+                            row[(i * R8g8Bpp) + 1] = greenValues[(j * BlockWidth) + i];
+                        }
+                        std::memcpy(dstRow + (j * pitch), row, sizeof(row));
+                    }
+                    #endif
+                } else {
+                    red->decode(dstRow, x, y, width, height, pitch, R8g8Bpp, 0, isSigned);
+                    green->decode(dstRow, x, y, width, height, pitch, R8g8Bpp, 1, isSigned);
+                }
             }
-        }
+        });
     }
 
-    void DecodeBc6(const uint8_t *src, uint8_t *dst, size_t width, size_t height, bool isSigned) {
-        const auto *block{reinterpret_cast<const BC6H::Block *>(src)};
+    void DecodeBc6(const uint8_t *src, uint8_t *dst, size_t width, size_t height, bool isSigned, size_t blockRowOffset, size_t blockRowCount) {
         size_t pitch{R16g16b16a16Bpp * width};
-        for (size_t y{}; y < height; y += BlockHeight, dst += BlockHeight * pitch) {
-            uint8_t *dstRow{dst};
-            for (size_t x{}; x < width; x += BlockWidth, ++block, dstRow += BlockWidth * R16g16b16a16Bpp)
-                [[clang::always_inline]] block->decode(dstRow, x, y, width, height, pitch, R16g16b16a16Bpp, isSigned);
-        }
+        ForEachBlockRow<sizeof(BC6H::Block)>(src, dst, width, height, R16g16b16a16Bpp, blockRowOffset, blockRowCount, [&](const uint8_t *blocks, uint8_t *dstRow, size_t y) {
+            const auto *block{reinterpret_cast<const BC6H::Block *>(blocks)};
+            for (size_t x{}; x < width; x += BlockWidth, ++block, dstRow += BlockWidth * R16g16b16a16Bpp) {
+                // Every mode has a decoder specialized for its block description, this moves all branching on the mode out of the decoder
+                switch (block->blockIndex()) {
+                    case 0:
+                        block->decode<0>(dstRow, x, y, width, height, pitch, R16g16b16a16Bpp, isSigned);
+                        break;
+                    case 1:
+                        block->decode<1>(dstRow, x, y, width, height, pitch, R16g16b16a16Bpp, isSigned);
+                        break;
+                    case 2:
+                        block->decode<2>(dstRow, x, y, width, height, pitch, R16g16b16a16Bpp, isSigned);
+                        break;
+                    case 3:
+                        block->decode<3>(dstRow, x, y, width, height, pitch, R16g16b16a16Bpp, isSigned);
+                        break;
+                    case 4:
+                        block->decode<4>(dstRow, x, y, width, height, pitch, R16g16b16a16Bpp, isSigned);
+                        break;
+                    case 5:
+                        block->decode<5>(dstRow, x, y, width, height, pitch, R16g16b16a16Bpp, isSigned);
+                        break;
+                    case 6:
+                        block->decode<6>(dstRow, x, y, width, height, pitch, R16g16b16a16Bpp, isSigned);
+                        break;
+                    case 7:
+                        block->decode<7>(dstRow, x, y, width, height, pitch, R16g16b16a16Bpp, isSigned);
+                        break;
+                    case 8:
+                        block->decode<8>(dstRow, x, y, width, height, pitch, R16g16b16a16Bpp, isSigned);
+                        break;
+                    case 9:
+                        block->decode<9>(dstRow, x, y, width, height, pitch, R16g16b16a16Bpp, isSigned);
+                        break;
+                    case 10:
+                        block->decode<10>(dstRow, x, y, width, height, pitch, R16g16b16a16Bpp, isSigned);
+                        break;
+                    case 11:
+                        block->decode<11>(dstRow, x, y, width, height, pitch, R16g16b16a16Bpp, isSigned);
+                        break;
+                    case 12:
+                        block->decode<12>(dstRow, x, y, width, height, pitch, R16g16b16a16Bpp, isSigned);
+                        break;
+                    case 13:
+                        block->decode<13>(dstRow, x, y, width, height, pitch, R16g16b16a16Bpp, isSigned);
+                        break;
+                    default:
+                        block->decode<-1>(dstRow, x, y, width, height, pitch, R16g16b16a16Bpp, isSigned);
+                        break;
+                }
+            }
+        });
     }
 
-    void DecodeBc7(const uint8_t *src, uint8_t *dst, size_t width, size_t height) {
-        const auto *block{reinterpret_cast<const BC7::Block *>(src)};
+    void DecodeBc7(const uint8_t *src, uint8_t *dst, size_t width, size_t height, size_t blockRowOffset, size_t blockRowCount) {
         size_t pitch{R8g8b8a8Bpp * width};
-        for (size_t y{}; y < height; y += BlockHeight, dst += BlockHeight * pitch) {
-            uint8_t *dstRow{dst};
-            for (size_t x{}; x < width; x += BlockWidth, ++block, dstRow += BlockWidth * R8g8b8a8Bpp)
-                [[clang::always_inline]] block->decode(dstRow, x, y, width, height, pitch);
-        }
+        ForEachBlockRow<sizeof(BC7::Block)>(src, dst, width, height, R8g8b8a8Bpp, blockRowOffset, blockRowCount, [&](const uint8_t *blocks, uint8_t *dstRow, size_t y) {
+            const auto *block{reinterpret_cast<const BC7::Block *>(blocks)};
+            for (size_t x{}; x < width; x += BlockWidth, ++block, dstRow += BlockWidth * R8g8b8a8Bpp) {
+                // Every mode has a decoder specialized for its bitfield layout, this moves all branching on the mode out of the decoder
+                switch (block->modeIndex()) {
+                    case 0:
+                        block->decode<0>(dstRow, x, y, width, height, pitch);
+                        break;
+                    case 1:
+                        block->decode<1>(dstRow, x, y, width, height, pitch);
+                        break;
+                    case 2:
+                        block->decode<2>(dstRow, x, y, width, height, pitch);
+                        break;
+                    case 3:
+                        block->decode<3>(dstRow, x, y, width, height, pitch);
+                        break;
+                    case 4:
+                        block->decode<4>(dstRow, x, y, width, height, pitch);
+                        break;
+                    case 5:
+                        block->decode<5>(dstRow, x, y, width, height, pitch);
+                        break;
+                    case 6:
+                        block->decode<6>(dstRow, x, y, width, height, pitch);
+                        break;
+                    case 7:
+                        block->decode<7>(dstRow, x, y, width, height, pitch);
+                        break;
+                    default:
+                        block->decode<8>(dstRow, x, y, width, height, pitch);
+                        break;
+                }
+            }
+        });
     }
 }
@@ -4,40 +4,47 @@
 #pragma once
 
 #include <cstdint>
+#include <limits>
 
+/**
+ * @note All decoders can be restricted to a range of block rows with `blockRowOffset` and `blockRowCount`, `src` and `dst` always point to the start of the entire image
+ * @note Rows of blocks are independent of each other, as such disjoint ranges of the same image can be decoded concurrently
+ */
 namespace bcn {
+    constexpr size_t AllBlockRows{std::numeric_limits<size_t>::max()}; //!< A block row count which decodes every row after the offset
+
     /**
      * @brief Decodes a BC1 encoded image to R8G8B8A8
      */
-    void DecodeBc1(const uint8_t *src, uint8_t *dst, size_t width, size_t height, bool hasAlphaChannel);
+    void DecodeBc1(const uint8_t *src, uint8_t *dst, size_t width, size_t height, bool hasAlphaChannel, size_t blockRowOffset = 0, size_t blockRowCount = AllBlockRows);
 
     /**
      * @brief Decodes a BC2 encoded image to R8G8B8A8
      */
-    void DecodeBc2(const uint8_t *src, uint8_t *dst, size_t width, size_t height);
+    void DecodeBc2(const uint8_t *src, uint8_t *dst, size_t width, size_t height, size_t blockRowOffset = 0, size_t blockRowCount = AllBlockRows);
 
     /**
      * @brief Decodes a BC3 encoded image to R8G8B8A8
      */
-    void DecodeBc3(const uint8_t *src, uint8_t *dst, size_t width, size_t height);
+    void DecodeBc3(const uint8_t *src, uint8_t *dst, size_t width, size_t height, size_t blockRowOffset = 0, size_t blockRowCount = AllBlockRows);
 
     /**
      * @brief Decodes a BC4 encoded image to R8
      */
-    void DecodeBc4(const uint8_t *src, uint8_t *dst, size_t width, size_t height, bool isSigned);
+    void DecodeBc4(const uint8_t *src, uint8_t *dst, size_t width, size_t height, bool isSigned, size_t blockRowOffset = 0, size_t blockRowCount = AllBlockRows);
 
     /**
      * @brief Decodes a BC5 encoded image to R8G8
      */
-    void DecodeBc5(const uint8_t *src, uint8_t *dst, size_t width, size_t height, bool isSigned);
+    void DecodeBc5(const uint8_t *src, uint8_t *dst, size_t width, size_t height, bool isSigned, size_t blockRowOffset = 0, size_t blockRowCount = AllBlockRows);
 
     /**
      * @brief Decodes a BC6 encoded image to R16G16B16A16
      */
-    void DecodeBc6(const uint8_t *src, uint8_t *dst, size_t width, size_t height, bool isSigned);
+    void DecodeBc6(const uint8_t *src, uint8_t *dst, size_t width, size_t height, bool isSigned, size_t blockRowOffset = 0, size_t blockRowCount = AllBlockRows);
 
     /**
      * @brief Decodes a BC7 encoded image to R8G8B8A8
      */
-    void DecodeBc7(const uint8_t *src, uint8_t *dst, size_t width, size_t height);
+    void DecodeBc7(const uint8_t *src, uint8_t *dst, size_t width, size_t height, size_t blockRowOffset = 0, size_t blockRowCount = AllBlockRows);
 }
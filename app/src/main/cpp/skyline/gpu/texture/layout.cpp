@@ -1,6 +1,11 @@
 // SPDX-License-Identifier: MPL-2.0
 // Copyright © 2022 Skyline Team and Contributors (https://github.com/skyline-emu/)
 
+#if defined(__aarch64__)
+#include <arm_neon.h>
+#elif defined(__AVX2__)
+#include <immintrin.h>
+#endif
 #include "layout.h"
 
 namespace skyline::gpu::texture {
@@ -17,6 +22,7 @@ namespace skyline::gpu::texture {
     constexpr size_t GobWidth{64}; //!< The width of a GOB in bytes
     constexpr size_t GobHeight{8}; //!< The height of a GOB in lines
     constexpr size_t SectorLinesInGob{(GobWidth / SectorWidth) * GobHeight}; //!< The number of lines of sectors inside a GOB
+    constexpr size_t GobSize{GobWidth * GobHeight}; //!< The size of a GOB in bytes
 
     size_t GetBlockLinearLayerSize(Dimensions dimensions, size_t formatBlockWidth, size_t formatBlockHeight, size_t formatBpb, size_t gobBlockHeight, size_t gobBlockDepth) {
         size_t robLineWidth{util::DivideCeil<size_t>(dimensions.width, formatBlockWidth)}; //!< The width of the ROB in terms of format blocks
@@ -95,6 +101,51 @@ namespace skyline::gpu::texture {
         return mipLevels;
     }
 
+    /**
+     * @brief Copies an entire GOB between blocklinear memory and a pitch-linear surface
+     * @note Every 64 bytes of a GOB are 4 sectors covering a 32x2 byte region in the order (0, 0), (0, 1), (16, 0), (16, 1), this is the same Morton order as the sector-granular copy but allows moving two sectors per line at once
+     */
+    template<bool BlockLinearToPitch>
+    __attribute__((always_inline)) inline void CopyGob(u8 *gob, u8 *pitchGob, size_t pitchWidthBytes) {
+        #pragma clang loop unroll(full)
+        for (size_t group{}; group < SectorLinesInGob / 4; group++, gob += SectorWidth * 4) {
+            u8 *line0{pitchGob + ((group & 0b11) * SectorHeight * pitchWidthBytes) + ((group & 0b100) << 3)};
+            u8 *line1{line0 + pitchWidthBytes};
+
+            #if defined(__aarch64__)
+            if constexpr (BlockLinearToPitch) {
+                uint8x16x4_t sectors{vld1q_u8_x4(gob)};
+                vst1q_u8(line0, sectors.val[0]);
+                vst1q_u8(line1, sectors.val[1]);
+                vst1q_u8(line0 + SectorWidth, sectors.val[2]);
+                vst1q_u8(line1 + SectorWidth, sectors.val[3]);
+            } else {
+                uint8x16x4_t sectors{{vld1q_u8(line0), vld1q_u8(line1), vld1q_u8(line0 + SectorWidth), vld1q_u8(line1 + SectorWidth)}};
+                vst1q_u8_x4(gob, sectors);
+            }
+            #elif defined(__AVX2__)
+            // Each line is two non-adjacent sectors, these are shuffled between 128-bit lanes to allow for 32-byte accesses on both sides
+            if constexpr (BlockLinearToPitch) {
+                __m256i sectors01{_mm256_loadu_si256(reinterpret_cast<__m256i *>(gob))}, sectors23{_mm256_loadu_si256(reinterpret_cast<__m256i *>(gob + SectorWidth * 2))};
+                _mm256_storeu_si256(reinterpret_cast<__m256i *>(line0), _mm256_permute2x128_si256(sectors01, sectors23, 0x20));
+                _mm256_storeu_si256(reinterpret_cast<__m256i *>(line1), _mm256_permute2x128_si256(sectors01, sectors23, 0x31));
+            } else {
+                __m256i lineData0{_mm256_loadu_si256(reinterpret_cast<__m256i *>(line0))}, lineData1{_mm256_loadu_si256(reinterpret_cast<__m256i *>(line1))};
+                _mm256_storeu_si256(reinterpret_cast<__m256i *>(gob), _mm256_permute2x128_si256(lineData0, lineData1, 0x20));
+                _mm256_storeu_si256(reinterpret_cast<__m256i *>(gob + SectorWidth * 2), _mm256_permute2x128_si256(lineData0, lineData1, 0x31));
+            }
+            #else
+            std::array<u8 *, 4> sectors{line0, line1, line0 + SectorWidth, line1 + SectorWidth};
+            for (size_t index{}; index < sectors.size(); index++) {
+                if constexpr (BlockLinearToPitch)
+                    std::memcpy(sectors[index], gob + (index * SectorWidth), SectorWidth);
+                else
+                    std::memcpy(gob + (index * SectorWidth), sectors[index], SectorWidth);
+            }
+            #endif
+        }
+    }
+
     /**
      * @brief Copies pixel data between a pitch-linear and blocklinear texture
      * @tparam BlockLinearToPitch Whether to copy from a blocklinear texture to a pitch-linear texture or a pitch-linear texture to a blocklinear texture
@@ -131,10 +182,20 @@ namespace skyline::gpu::texture {
         u8 *sector{blockLinear};
 
         auto deswizzleRob{[&](u8 *pitchRob, auto isLastRob, size_t depthSliceCount, size_t blockPaddingY = 0, size_t blockExtentY = 0) {
-            auto deswizzleBlock{[&](u8 *pitchBlock, auto copySector) __attribute__((always_inline)) {
+            auto deswizzleBlock{[&](u8 *pitchBlock, auto copySector, auto isFullWidth) __attribute__((always_inline)) {
                 for (size_t gobZ{}; gobZ < depthSliceCount; gobZ++) { // Every Block contains `depthSliceCount` slices, excluding padding
                     u8 *pitchGob{pitchBlock};
                     for (size_t gobY{}; gobY < blockHeight; gobY++) { // Every Block contains `blockHeight` Y-axis GOBs
+                        if constexpr (isFullWidth) {
+                            // GOBs which aren't cut off by the surface extent can be copied as a whole rather than sector-by-sector
+                            if (!isLastRob || gobY != blockHeight - 1 || blockExtentY == GobHeight) [[likely]] {
+                                CopyGob<BlockLinearToPitch>(sector, pitchGob, pitchWidthBytes);
+                                sector += GobSize;
+                                pitchGob += gobYOffset;
+                                continue;
+                            }
+                        }
+
                         #pragma clang loop unroll_count(SectorLinesInGob)
                         for (size_t index{}; index < SectorLinesInGob; index++) {
                             size_t xT{((index << 3) & 0b10000) | ((index << 1) & 0b100000)}; // Morton-Swizzle on the X-axis
@@ -170,7 +231,7 @@ namespace skyline::gpu::texture {
                     else
                         std::memcpy(sector, linearSector, SectorWidth);
                     sector += SectorWidth; // `sectorWidth` bytes are of sequential image data
-                });
+                }, std::true_type{});
 
                 pitchRob += GobWidth; // Increment the linear block to the next block (As Block Width = 1 GOB Width)
             }
@@ -186,7 +247,7 @@ namespace skyline::gpu::texture {
                             std::memcpy(sector, linearSector, copyAmount);
                     }
                     sector += SectorWidth;
-                });
+                }, std::false_type{});
         }};
 
         for (size_t currMob{}; currMob < depthMobCount; ++currMob, pitch += gobZOffset * gobBlockDepth) {
@@ -231,22 +292,6 @@ namespace skyline::gpu::texture {
         originX = util::DivideCeil<u32>(originX, static_cast<u32>(formatBlockWidth));
         size_t originXBytes{originX * formatBpb};
 
-        if (formatBpb != 12) [[likely]] {
-            size_t startingBlockXBytes{util::AlignUp(originXBytes, GobWidth) - originXBytes};
-            while (formatBpb != 16) {
-                if (util::IsAligned(pitchTextureWidthBytes - startingBlockXBytes, formatBpb << 1)
-                && util::IsAligned(startingBlockXBytes, formatBpb << 1)) {
-                    pitchTextureWidth /= 2;
-                    formatBpb <<= 1;
-                } else {
-                    break;
-                }
-            }
-        } else {
-            formatBpb = 4;
-            pitchTextureWidth *= 3;
-        }
-
         size_t pitchTextureHeight{util::DivideCeil<size_t>(pitchDimensions.height, formatBlockHeight)};
         size_t robHeight{gobBlockHeight * GobHeight};
 
@@ -263,71 +308,49 @@ namespace skyline::gpu::texture {
 
         u8 *pitchOffset{pitch};
 
-        auto copyTexture{[&]<typename FORMATBPB>() __attribute__((always_inline)) {
-            for (size_t currMob{}; currMob < depthMobCount; ++currMob, blockLinear += robSize * robPerMob) {
-                size_t sliceCount{(currMob + 1) == depthMobCount ? lastMobSliceCount : gobBlockDepth};
-                u64 sliceOffset{};
-                for (size_t slice{}; slice < sliceCount; ++slice, sliceOffset += (GobHeight * GobWidth * gobBlockHeight)) {
-                    u64 robOffset{util::AlignDown(originY, robHeight) * blockLinearTextureWidthAlignedBytes * gobBlockDepth};
-                    for (size_t line{}; line < pitchTextureHeight; ++line, pitchOffset += pitchBytes) {
-                        // XYZ Offset in entire ROBs
-                        if (line && !((originY + line) & (robHeight - 1))) [[unlikely]]
-                            robOffset += robSize;
-                        // Y Offset in entire GOBs in current block
-                        size_t GobYOffset{util::AlignDown((originY + line) & (robHeight - 1), GobHeight) * GobWidth};
-                        // Y Offset inside current GOB
-                        GobYOffset += (((originY + line) & 0x6) << 5) + (((originY + line) & 0x1) << 4);
-
-                        u8 *deSwizzledOffset{pitchOffset};
-                        u8 *swizzledYZOffset{blockLinear + robOffset + GobYOffset + sliceOffset};
-                        u8 *swizzledOffset{};
-
-                        size_t xBytes{originXBytes};
-                        size_t GobXOffset{};
-
-                        size_t blockOffset{util::AlignDown(xBytes, GobWidth) * robHeight * gobBlockDepth};
-
-                        for (size_t pixel{}; pixel < pitchTextureWidth; ++pixel, deSwizzledOffset += formatBpb, xBytes += formatBpb) {
-                            // XYZ Offset in entire blocks in current ROB
-                            if (pixel && !(xBytes & 0x3F)) [[unlikely]]
-                                blockOffset += blockSize;
-
-                            // X Offset inside current GOB
-                            GobXOffset = ((xBytes & 0x20) << 3) + (xBytes & 0xF) + ((xBytes & 0x10) << 1);
-
-                            swizzledOffset = swizzledYZOffset + blockOffset + GobXOffset;
-
-                            if constexpr (BlockLinearToPitch)
-                                *reinterpret_cast<FORMATBPB *>(deSwizzledOffset) = *reinterpret_cast<FORMATBPB *>(swizzledOffset);
-                            else
-                                *reinterpret_cast<FORMATBPB *>(swizzledOffset) = *reinterpret_cast<FORMATBPB *>(deSwizzledOffset);
+        auto copySector{[](u8 *swizzled, u8 *deswizzled, size_t size) __attribute__((always_inline)) {
+            if constexpr (BlockLinearToPitch)
+                std::memcpy(deswizzled, swizzled, size);
+            else
+                std::memcpy(swizzled, deswizzled, size);
+        }};
+
+        for (size_t currMob{}; currMob < depthMobCount; ++currMob, blockLinear += robSize * robPerMob) {
+            size_t sliceCount{(currMob + 1) == depthMobCount ? lastMobSliceCount : gobBlockDepth};
+            u64 sliceOffset{};
+            for (size_t slice{}; slice < sliceCount; ++slice, sliceOffset += (GobHeight * GobWidth * gobBlockHeight)) {
+                u64 robOffset{util::AlignDown(originY, robHeight) * blockLinearTextureWidthAlignedBytes * gobBlockDepth};
+                for (size_t line{}; line < pitchTextureHeight; ++line, pitchOffset += pitchBytes) {
+                    // XYZ Offset in entire ROBs
+                    if (line && !((originY + line) & (robHeight - 1))) [[unlikely]]
+                        robOffset += robSize;
+                    // Y Offset in entire GOBs in current block
+                    size_t GobYOffset{util::AlignDown((originY + line) & (robHeight - 1), GobHeight) * GobWidth};
+                    // Y Offset inside current GOB
+                    GobYOffset += (((originY + line) & 0x6) << 5) + (((originY + line) & 0x1) << 4);
+
+                    u8 *deSwizzledOffset{pitchOffset};
+                    u8 *swizzledYZOffset{blockLinear + robOffset + GobYOffset + sliceOffset};
+
+                    // A line is copied in runs of bytes which are contiguous in both layouts, these are at most a sector wide regardless of the format's bpb
+                    size_t xBytes{originXBytes}, xBytesEnd{originXBytes + pitchTextureWidthBytes};
+                    while (xBytes < xBytesEnd) {
+                        // XYZ Offset in entire blocks in current ROB + X Offset inside current GOB
+                        u8 *swizzledOffset{swizzledYZOffset + ((xBytes / GobWidth) * blockSize) + ((xBytes & 0x20) << 3) + (xBytes & 0xF) + ((xBytes & 0x10) << 1)};
+
+                        if (util::IsAligned(xBytes, SectorWidth) && xBytesEnd - xBytes >= SectorWidth) [[likely]] {
+                            copySector(swizzledOffset, deSwizzledOffset, SectorWidth);
+                            xBytes += SectorWidth;
+                            deSwizzledOffset += SectorWidth;
+                        } else {
+                            size_t runBytes{std::min(util::AlignDown(xBytes, SectorWidth) + SectorWidth, xBytesEnd) - xBytes};
+                            copySector(swizzledOffset, deSwizzledOffset, runBytes);
+                            xBytes += runBytes;
+                            deSwizzledOffset += runBytes;
                         }
                     }
                 }
             }
-        }};
-
-        switch (formatBpb) {
-            case 1: {
-                copyTexture.template operator()<u8>();
-                break;
-            }
-            case 2: {
-                copyTexture.template operator()<u16>();
-                break;
-            }
-            case 4: {
-                copyTexture.template operator()<u32>();
-                break;
-            }
-            case 8: {
-                copyTexture.template operator()<u64>();
-                break;
-            }
-            case 16: {
-                copyTexture.template operator()<u128>();
-                break;
-            }
         }
     }
 
@@ -340,6 +363,36 @@ namespace skyline::gpu::texture {
         );
     }
 
+    size_t GetBlockLinearRobCount(Dimensions dimensions, size_t formatBlockHeight, size_t gobBlockHeight) {
+        return util::DivideCeil<size_t>(util::DivideCeil<size_t>(dimensions.height, formatBlockHeight), GobHeight * gobBlockHeight);
+    }
+
+    void CopyBlockLinearRobsToLinear(Dimensions dimensions,
+                                     size_t formatBlockWidth, size_t formatBlockHeight, size_t formatBpb,
+                                     size_t gobBlockHeight, size_t gobBlockDepth,
+                                     u8 *blockLinear, u8 *linear,
+                                     size_t robOffset, size_t robCount) {
+        if (dimensions.depth != 1)
+            throw exception("Copying ROBs of a surface with a depth of {} is not supported", dimensions.depth);
+
+        size_t robHeight{GobHeight * gobBlockHeight};
+        size_t surfaceHeightLines{util::DivideCeil<size_t>(dimensions.height, formatBlockHeight)};
+        size_t robWidthUnalignedBytes{util::DivideCeil<size_t>(dimensions.width, formatBlockWidth) * formatBpb};
+        size_t robSize{util::AlignUp(robWidthUnalignedBytes, GobWidth) * robHeight * gobBlockDepth}; //!< The size of a ROB in blocklinear memory, a single slice is still padded to the full depth of a block
+
+        size_t startLine{robOffset * robHeight};
+        if (startLine >= surfaceHeightLines)
+            return;
+        size_t lineCount{std::min(robCount * robHeight, surfaceHeightLines - startLine)};
+
+        CopyBlockLinearInternal<true>(
+            Dimensions{dimensions.width, static_cast<u32>(lineCount * formatBlockHeight), 1},
+            formatBlockWidth, formatBlockHeight, formatBpb, 0,
+            gobBlockHeight, gobBlockDepth,
+            blockLinear + (robOffset * robSize), linear + (startLine * robWidthUnalignedBytes)
+        );
+    }
+
     void CopyBlockLinearToPitch(Dimensions dimensions,
                                 size_t formatBlockWidth, size_t formatBlockHeight, size_t formatBpb, u32 pitchAmount,
                                 size_t gobBlockHeight, size_t gobBlockDepth,
@@ -40,6 +40,21 @@ namespace skyline::gpu::texture {
                                  size_t gobBlockHeight, size_t gobBlockDepth,
                                  u8 *blockLinear, u8 *linear);
 
+    /**
+     * @return The amount of ROBs (Rows of Blocks) in a slice of the specified block-linear surface including any padding ROB
+     */
+    size_t GetBlockLinearRobCount(Dimensions dimensions, size_t formatBlockHeight, size_t gobBlockHeight);
+
+    /**
+     * @brief Copies a range of ROBs from a single-slice blocklinear texture to the corresponding lines of a linear output buffer
+     * @note This allows for deswizzling a surface in independent bands as no two ROBs share any bytes in either layout
+     */
+    void CopyBlockLinearRobsToLinear(Dimensions dimensions,
+                                     size_t formatBlockWidth, size_t formatBlockHeight, size_t formatBpb,
+                                     size_t gobBlockHeight, size_t gobBlockDepth,
+                                     u8 *blockLinear, u8 *linear,
+                                     size_t robOffset, size_t robCount);
+
     /**
      * @brief Copies the contents of a blocklinear texture to a pitch texture
      */
@@ -3,13 +3,13 @@
 
 #include <gpu.h>
 #include <kernel/memory.h>
-#include <kernel/types/KProcess.h>
 #include <common/trace.h>
 #include <common/settings.h>
 #include "texture.h"
 #include "layout.h"
 #include "adreno_aliasing.h"
 #include "bc_decoder.h"
+#include "astc_decoder.h"
 #include "format.h"
 
 namespace skyline::gpu {
@@ -129,7 +129,7 @@ namespace skyline::gpu {
             u8 *alignedData{util::AlignDown(mapping.data(), constant::PageSize)};
             size_t alignedSize{static_cast<size_t>(util::AlignUp(mapping.data() + mapping.size(), constant::PageSize) - alignedData)};
 
-            alignedMirror = gpu.state.process->memory.CreateMirror(span<u8>{alignedData, alignedSize});
+            alignedMirror = gpu.state.guestMemory->CreateMirror(span<u8>{alignedData, alignedSize});
             mirror = alignedMirror.subspan(static_cast<size_t>(mapping.data() - alignedData), mapping.size());
         } else {
             std::vector<span<u8>> alignedMappings;
@@ -149,13 +149,13 @@ namespace skyline::gpu {
             totalSize += backMapping.size();
             alignedMappings.emplace_back(backMapping.data(), util::AlignUp(backMapping.size(), constant::PageSize));
 
-            alignedMirror = gpu.state.process->memory.CreateMirrors(alignedMappings);
+            alignedMirror = gpu.state.guestMemory->CreateMirrors(alignedMappings);
             mirror = alignedMirror.subspan(static_cast<size_t>(frontMapping.data() - alignedData), totalSize);
         }
 
         // We can't just capture `this` in the lambda since the lambda could exceed the lifetime of the buffer
         std::weak_ptr<Texture> weakThis{weak_from_this()};
-        trapHandle = gpu.state.nce->CreateTrap(mappings, [weakThis] {
+        trapHandle = gpu.state.traps->CreateTrap(mappings, [weakThis] {
             auto texture{weakThis.lock()};
             if (!texture)
                 return;
@@ -242,7 +242,7 @@ namespace skyline::gpu {
         });
     }
 
-    std::shared_ptr<memory::StagingBuffer> Texture::SynchronizeHostImpl() {
+    std::shared_ptr<memory::StagingBuffer> Texture::SynchronizeHostImpl(GpuDeswizzle &gpuDeswizzle) {
         if (guest->dimensions != dimensions)
             throw exception("Guest and host dimensions being different is not supported currently");
 
@@ -254,7 +254,7 @@ namespace skyline::gpu {
         auto stagingBuffer{[&]() -> std::shared_ptr<memory::StagingBuffer> {
             if (tiling == vk::ImageTiling::eOptimal || !std::holds_alternative<memory::Image>(backing)) {
                 // We need a staging buffer for all optimal copies (since we aren't aware of the host optimal layout) and linear textures which we cannot map on the CPU since we do not have access to their backing VkDeviceMemory
-                auto stagingBuffer{gpu.memory.AllocateStagingBuffer(surfaceSize)};
+                auto stagingBuffer{gpu.memory.AllocateStagingBuffer(surfaceSize, format->bpb)};
                 bufferData = stagingBuffer->data();
                 return stagingBuffer;
             } else if (tiling == vk::ImageTiling::eLinear) {
@@ -278,16 +278,109 @@ namespace skyline::gpu {
             deswizzleOutput = bufferData;
         }
 
+        // Textures above a size threshold are split into independent jobs for every layer, mip level and band of rows which are run on the GPU worker pool, smaller textures are processed serially as the overhead of dispatching jobs outweighs any gains
+        bool parallelize{surfaceSize >= ParallelSyncThreshold};
+        std::vector<std::function<void()>> jobs;
+        auto runJobs{[&]() {
+            if (!parallelize || jobs.size() == 1) {
+                for (auto &job : jobs)
+                    job();
+            } else {
+                TRACE_EVENT("gpu", "Texture::SynchronizeHostImpl::RunJobs", "jobs", jobs.size());
+
+                std::atomic<u64> jobTimeNs{};
+                auto startTimeNs{util::GetTimeNs()};
+
+                std::vector<std::future<void>> futures;
+                futures.reserve(jobs.size());
+                for (auto &job : jobs)
+                    futures.emplace_back(gpu.workerPool.submit([&job, &jobTimeNs]() {
+                        auto jobStartTimeNs{util::GetTimeNs()};
+                        job();
+                        jobTimeNs.fetch_add(util::GetTimeNs() - jobStartTimeNs, std::memory_order_relaxed);
+                    }));
+
+                // All jobs must be complete before any exceptions are rethrown as they reference state on this stack frame
+                for (auto &future : futures)
+                    future.wait();
+                for (auto &future : futures)
+                    future.get();
+
+                // The difference between the combined time of all jobs and the wall-clock time is the time saved by running them in parallel
+                auto wallTimeNs{util::GetTimeNs() - startTimeNs};
+                TRACE_EVENT_INSTANT("gpu", "Texture::SynchronizeHostImpl::Parallelism", "jobs", jobs.size(), "jobTimeNs", jobTimeNs.load(), "wallTimeNs", wallTimeNs, "savedTimeNs", static_cast<i64>(jobTimeNs.load()) - static_cast<i64>(wallTimeNs));
+            }
+
+            jobs.clear();
+        }};
+
+        // Large block-linear textures are deswizzled on the GPU from a copy of the guest data, this avoids doing anything on the CPU other than a linear copy
+        bool gpuDeswizzleEnabled{stagingBuffer && guest->format == format && guest->format->bpb != 12 && surfaceSize >= GpuDeswizzleThreshold};
+
+        auto deswizzleBlockLinear{[&](texture::Dimensions levelDimensions, size_t gobBlockHeight, size_t gobBlockDepth, u8 *input, u8 *output) {
+            if (gpuDeswizzleEnabled) {
+                auto widthBytes{static_cast<u32>(util::DivideCeil<size_t>(levelDimensions.width, guest->format->blockWidth) * guest->format->bpb)};
+                auto heightLines{static_cast<u32>(util::DivideCeil<size_t>(levelDimensions.height, guest->format->blockHeight))};
+                BlockLinearHelperShader::CopyLayout layout{
+                    .blockLinearOffset = static_cast<vk::DeviceSize>(input - mirror.data()),
+                    .pitchOffset = static_cast<vk::DeviceSize>(output - bufferData),
+                    .widthBytes = widthBytes,
+                    .height = heightLines,
+                    .depth = levelDimensions.depth,
+                    .pitch = widthBytes,
+                    .blockLinearWidthBytes = widthBytes,
+                    .blockLinearHeight = heightLines,
+                    .gobBlockHeight = static_cast<u32>(gobBlockHeight),
+                    .gobBlockDepth = static_cast<u32>(gobBlockDepth),
+                };
+
+                if (BlockLinearHelperShader::CanCopy(gpu, layout, mirror.size(), surfaceSize)) {
+                    gpuDeswizzle.copies.push_back(layout);
+                    return;
+                }
+            }
+
+            size_t robCount{texture::GetBlockLinearRobCount(levelDimensions, guest->format->blockHeight, gobBlockHeight)};
+            size_t robLinearSize{std::max<size_t>(guest->format->GetSize(levelDimensions) / robCount, 1)}; //!< An approximation of the size of a single ROB in linear memory, this is only used for sizing bands
+            size_t robsPerBand{std::max<size_t>(ParallelSyncBandSize / robLinearSize, 1)};
+            if (!parallelize || levelDimensions.depth != 1 || robCount <= robsPerBand) {
+                jobs.emplace_back([=, this]() {
+                    texture::CopyBlockLinearToLinear(
+                        levelDimensions,
+                        guest->format->blockWidth, guest->format->blockHeight, guest->format->bpb,
+                        gobBlockHeight, gobBlockDepth,
+                        input, output
+                    );
+                });
+                return;
+            }
+
+            for (size_t rob{}; rob < robCount; rob += robsPerBand)
+                jobs.emplace_back([=, this]() {
+                    texture::CopyBlockLinearRobsToLinear(
+                        levelDimensions,
+                        guest->format->blockWidth, guest->format->blockHeight, guest->format->bpb,
+                        gobBlockHeight, gobBlockDepth,
+                        input, output,
+                        rob, robsPerBand
+                    );
+                });
+        }};
+
         auto guestLayerStride{guest->GetLayerStride()};
         if (levelCount == 1) {
             auto outputLayer{deswizzleOutput};
             for (size_t layer{}; layer < layerCount; layer++) {
                 if (guest->tileConfig.mode == texture::TileMode::Block)
-                    texture::CopyBlockLinearToLinear(*guest, pointer, outputLayer);
+                    deswizzleBlockLinear(guest->dimensions, guest->tileConfig.blockHeight, guest->tileConfig.blockDepth, pointer, outputLayer);
                 else if (guest->tileConfig.mode == texture::TileMode::Pitch)
-                    texture::CopyPitchLinearToLinear(*guest, pointer, outputLayer);
+                    jobs.emplace_back([this, pointer, outputLayer]() {
+                        texture::CopyPitchLinearToLinear(*guest, pointer, outputLayer);
+                    });
                 else if (guest->tileConfig.mode == texture::TileMode::Linear)
-                    std::memcpy(outputLayer, pointer, surfaceSize);
+                    jobs.emplace_back([this, pointer, outputLayer]() {
+                        std::memcpy(outputLayer, pointer, surfaceSize);
+                    });
                 pointer += guestLayerStride;
                 outputLayer += deswizzledLayerStride;
             }
@@ -296,12 +389,7 @@ namespace skyline::gpu {
             for (size_t layer{}; layer < layerCount; layer++) {
                 auto inputLevel{pointer}, outputLevel{deswizzleOutput};
                 for (const auto &level : mipLayouts) {
-                    texture::CopyBlockLinearToLinear(
-                        level.dimensions,
-                        guest->format->blockWidth, guest->format->blockHeight, guest->format->bpb,
-                        level.blockHeight, level.blockDepth,
-                        inputLevel, outputLevel + (layer * level.linearSize) // Offset into the current layer relative to the start of the current mip level
-                    );
+                    deswizzleBlockLinear(level.dimensions, level.blockHeight, level.blockDepth, inputLevel, outputLevel + (layer * level.linearSize)); // Offset into the current layer relative to the start of the current mip level
 
                     inputLevel += level.blockLinearSize; // Skip over the current mip level as we've deswizzled it
                     outputLevel += layerCount * level.linearSize; // We need to offset the output buffer by the size of the previous mip level
@@ -313,68 +401,121 @@ namespace skyline::gpu {
             throw exception("Mipmapped textures with tiling mode '{}' aren't supported", static_cast<int>(tiling));
         }
 
+        if (!gpuDeswizzle.copies.empty()) {
+            gpuDeswizzle.input = gpu.memory.AllocateStagingBuffer(mirror.size());
+            jobs.emplace_back([this, input = gpuDeswizzle.input->data()]() {
+                std::memcpy(input, mirror.data(), mirror.size());
+            });
+        }
+
+        runJobs();
+
         if (!deswizzleBuffer.empty()) {
-            for (const auto &level : mipLayouts) {
-                size_t levelHeight{level.dimensions.height * layerCount}; //!< The height of an image representing all layers in the entire level
-                switch (guest->format->vkFormat) {
+            auto decode{[guestFormat = guest->format](u8 *input, u8 *output, size_t width, size_t height, size_t blockRowOffset, size_t blockRowCount) {
+                switch (guestFormat->vkFormat) {
                     case vk::Format::eBc1RgbaUnormBlock:
                     case vk::Format::eBc1RgbaSrgbBlock:
-                        bcn::DecodeBc1(deswizzleOutput, bufferData, level.dimensions.width, levelHeight, true);
+                        bcn::DecodeBc1(input, output, width, height, true, blockRowOffset, blockRowCount);
                         break;
 
                     case vk::Format::eBc2UnormBlock:
                     case vk::Format::eBc2SrgbBlock:
-                        bcn::DecodeBc2(deswizzleOutput, bufferData, level.dimensions.width, levelHeight);
+                        bcn::DecodeBc2(input, output, width, height, blockRowOffset, blockRowCount);
                         break;
 
                     case vk::Format::eBc3UnormBlock:
                     case vk::Format::eBc3SrgbBlock:
-                        bcn::DecodeBc3(deswizzleOutput, bufferData, level.dimensions.width, levelHeight);
+                        bcn::DecodeBc3(input, output, width, height, blockRowOffset, blockRowCount);
                         break;
 
                     case vk::Format::eBc4UnormBlock:
-                        bcn::DecodeBc4(deswizzleOutput, bufferData, level.dimensions.width, levelHeight, false);
+                        bcn::DecodeBc4(input, output, width, height, false, blockRowOffset, blockRowCount);
                         break;
                     case vk::Format::eBc4SnormBlock:
-                        bcn::DecodeBc4(deswizzleOutput, bufferData, level.dimensions.width, levelHeight, true);
+                        bcn::DecodeBc4(input, output, width, height, true, blockRowOffset, blockRowCount);
                         break;
 
                     case vk::Format::eBc5UnormBlock:
-                        bcn::DecodeBc5(deswizzleOutput, bufferData, level.dimensions.width, levelHeight, false);
+                        bcn::DecodeBc5(input, output, width, height, false, blockRowOffset, blockRowCount);
                         break;
                     case vk::Format::eBc5SnormBlock:
-                        bcn::DecodeBc5(deswizzleOutput, bufferData, level.dimensions.width, levelHeight, true);
+                        bcn::DecodeBc5(input, output, width, height, true, blockRowOffset, blockRowCount);
                         break;
 
                     case vk::Format::eBc6HUfloatBlock:
-                        bcn::DecodeBc6(deswizzleOutput, bufferData, level.dimensions.width, levelHeight, false);
+                        bcn::DecodeBc6(input, output, width, height, false, blockRowOffset, blockRowCount);
                         break;
                     case vk::Format::eBc6HSfloatBlock:
-                        bcn::DecodeBc6(deswizzleOutput, bufferData, level.dimensions.width, levelHeight, true);
+                        bcn::DecodeBc6(input, output, width, height, true, blockRowOffset, blockRowCount);
                         break;
 
                     case vk::Format::eBc7UnormBlock:
                     case vk::Format::eBc7SrgbBlock:
-                        bcn::DecodeBc7(deswizzleOutput, bufferData, level.dimensions.width, levelHeight);
+                        bcn::DecodeBc7(input, output, width, height, blockRowOffset, blockRowCount);
                         break;
 
                     default:
-                        throw exception("Unsupported guest format '{}'", vk::to_string(guest->format->vkFormat));
+                        if (guestFormat->IsAstc()) {
+                            texture::astc::Decode(input, output, width, height, guestFormat->blockWidth, guestFormat->blockHeight, guestFormat->IsAstcSrgb(), blockRowOffset, blockRowCount);
+                            break;
+                        }
+
+                        throw exception("Unsupported guest format '{}'", vk::to_string(guestFormat->vkFormat));
+                }
+            }};
+
+            // ASTC decoding is expensive enough that it's worth caching the decoded layers on disk, layers which are found in the cache skip decoding entirely
+            bool useDecodedTextureCache{gpu.decodedTextureCache && guest->format->IsAstc()};
+            std::vector<std::pair<u64, span<u8>>> decodedTextureCacheMisses;
+
+            for (const auto &level : mipLayouts) {
+                // Every slice of every layer is encoded with its own block rows, so they're decoded separately as the last block row of each may be partial
+                size_t blockRowCount{util::DivideCeil<size_t>(level.dimensions.height, guest->format->blockHeight)};
+                size_t blockRowOutputSize{format->GetSize(level.dimensions.width, guest->format->blockHeight)};
+                size_t bandBlockRows{parallelize ? std::max<size_t>(ParallelSyncBandSize / blockRowOutputSize, 1) : blockRowCount};
+
+                for (size_t layer{}; layer < layerCount; layer++) {
+                    u8 *layerInput{deswizzleOutput + layer * level.linearSize}, *layerOutput{bufferData + layer * level.targetLinearSize};
+
+                    bool isCached{};
+                    if (useDecodedTextureCache) {
+                        span<u8> encoded{layerInput, level.linearSize}, decoded{layerOutput, level.targetLinearSize};
+                        auto key{cache::DecodedTextureCache::GetKey(encoded, guest->format->vkFormat, level.dimensions.width, level.dimensions.height)};
+                        isCached = gpu.decodedTextureCache->Load(key, decoded);
+                        if (!isCached)
+                            decodedTextureCacheMisses.emplace_back(key, decoded);
+                    }
+
+                    if (isCached)
+                        continue;
+
+                    // Every slice of the layer is split into bands of block rows, every band is decoded independently as a compressed block is never shared between bands
+                    size_t sliceSize{level.linearSize / level.dimensions.depth}, targetSliceSize{level.targetLinearSize / level.dimensions.depth};
+                    for (size_t slice{}; slice < level.dimensions.depth; slice++)
+                        for (size_t blockRow{}; blockRow < blockRowCount; blockRow += bandBlockRows)
+                            jobs.emplace_back([=, width = level.dimensions.width, height = level.dimensions.height]() {
+                                decode(layerInput + slice * sliceSize, layerOutput + slice * targetSliceSize, width, height, blockRow, bandBlockRows);
+                            });
                 }
 
                 deswizzleOutput += level.linearSize * layerCount;
                 bufferData += level.targetLinearSize * layerCount;
             }
+
+            runJobs();
+
+            for (auto [key, decoded] : decodedTextureCacheMisses)
+                gpu.decodedTextureCache->Store(key, decoded);
         }
 
         return stagingBuffer;
     }
 
-    boost::container::small_vector<vk::BufferImageCopy, 10> Texture::GetBufferImageCopies() {
+    boost::container::small_vector<vk::BufferImageCopy, 10> Texture::GetBufferImageCopies(vk::DeviceSize baseOffset) {
         boost::container::small_vector<vk::BufferImageCopy, 10> bufferImageCopies;
 
         auto pushBufferImageCopyWithAspect{[&](vk::ImageAspectFlagBits aspect) {
-            vk::DeviceSize bufferOffset{};
+            vk::DeviceSize bufferOffset{baseOffset};
             u32 mipLevel{};
             for (auto &level : mipLayouts) {
                 bufferImageCopies.emplace_back(
@@ -420,10 +561,20 @@ namespace skyline::gpu {
                 },
             });
 
-        auto bufferImageCopies{GetBufferImageCopies()};
+        auto bufferImageCopies{GetBufferImageCopies(stagingBuffer->offset)};
         commandBuffer.copyBufferToImage(stagingBuffer->vkBuffer, image, layout, vk::ArrayProxy(static_cast<u32>(bufferImageCopies.size()), bufferImageCopies.data()));
     }
 
+    void Texture::RecordGpuDeswizzle(const vk::raii::CommandBuffer &commandBuffer, const std::shared_ptr<memory::StagingBuffer> &stagingBuffer, GpuDeswizzle &gpuDeswizzle) {
+        if (gpuDeswizzle.copies.empty())
+            return;
+
+        gpuDeswizzle.descriptorSet = gpu.helperShaders.blockLinearHelperShader.Copy(gpu, commandBuffer,
+                                                                                   BufferBinding{gpuDeswizzle.input->vkBuffer, gpuDeswizzle.input->offset, gpuDeswizzle.input->size()},
+                                                                                   BufferBinding{stagingBuffer->vkBuffer, stagingBuffer->offset, stagingBuffer->size()},
+                                                                                   gpuDeswizzle.copies, true);
+    }
+
     void Texture::CopyIntoStagingBuffer(const vk::raii::CommandBuffer &commandBuffer, const std::shared_ptr<memory::StagingBuffer> &stagingBuffer) {
         auto image{GetBacking()};
         commandBuffer.pipelineBarrier(vk::PipelineStageFlagBits::eBottomOfPipe, vk::PipelineStageFlagBits::eTransfer, {}, {}, {}, vk::ImageMemoryBarrier{
@@ -441,7 +592,7 @@ namespace skyline::gpu {
             },
         });
 
-        auto bufferImageCopies{GetBufferImageCopies()};
+        auto bufferImageCopies{GetBufferImageCopies(stagingBuffer->offset)};
         commandBuffer.copyImageToBuffer(image, layout, stagingBuffer->vkBuffer, vk::ArrayProxy(static_cast<u32>(bufferImageCopies.size()), bufferImageCopies.data()));
 
         commandBuffer.pipelineBarrier(vk::PipelineStageFlagBits::eTransfer, vk::PipelineStageFlagBits::eHost, {}, {}, vk::BufferMemoryBarrier{
@@ -450,7 +601,7 @@ namespace skyline::gpu {
             .srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
             .dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
             .buffer = stagingBuffer->vkBuffer,
-            .offset = 0,
+            .offset = stagingBuffer->offset,
             .size = stagingBuffer->size(),
         }, {});
     }
@@ -497,7 +648,7 @@ namespace skyline::gpu {
     void Texture::FreeGuest() {
         // Avoid freeing memory if the backing format doesn't match, as otherwise texture data would be lost on the guest side, also avoid if fast readback is active
         if (*gpu.state.settings->freeGuestTextureMemory && guest->format == format && !(accumulatedGuestWaitTime > SkipReadbackHackWaitTimeThreshold && *gpu.state.settings->enableFastGpuReadbackHack)) {
-            gpu.state.process->memory.FreeMemory(mirror);
+            gpu.state.guestMemory->FreeMemory(mirror);
             memoryFreed = true;
         }
     }
@@ -516,6 +667,9 @@ namespace skyline::gpu {
           sampleCount(sampleCount) {}
 
     texture::Format ConvertHostCompatibleFormat(texture::Format format, const TraitManager &traits) {
+        if (format->IsAstc())
+            return traits.supportsAstcLdr ? format : (format->IsAstcSrgb() ? format::R8G8B8A8Srgb : format::R8G8B8A8Unorm);
+
         auto bcnSupport{traits.bcnSupport};
         if (bcnSupport.all())
             return format;
@@ -633,7 +787,7 @@ namespace skyline::gpu {
     Texture::~Texture() {
         SynchronizeGuest(true);
         if (trapHandle)
-            gpu.state.nce->DeleteTrap(*trapHandle);
+            gpu.state.traps->DeleteTrap(*trapHandle);
         if (alignedMirror.valid())
             munmap(alignedMirror.data(), alignedMirror.size());
     }
@@ -745,7 +899,7 @@ namespace skyline::gpu {
             if (gpuDirty && dirtyState == DirtyState::Clean) {
                 // If a texture is Clean then we can just transition it to being GPU dirty and retrap it
                 dirtyState = DirtyState::GpuDirty;
-                gpu.state.nce->TrapRegions(*trapHandle, false);
+                gpu.state.traps->TrapRegions(*trapHandle, false);
                 FreeGuest();
                 return;
             } else if (dirtyState != DirtyState::CpuDirty) {
@@ -753,19 +907,21 @@ namespace skyline::gpu {
             }
 
             dirtyState = gpuDirty ? DirtyState::GpuDirty : DirtyState::Clean;
-            gpu.state.nce->TrapRegions(*trapHandle, !gpuDirty); // Trap any future CPU reads (optionally) + writes to this texture
+            gpu.state.traps->TrapRegions(*trapHandle, !gpuDirty); // Trap any future CPU reads (optionally) + writes to this texture
         }
 
         // From this point on Clean -> CPU dirty state transitions can occur, GPU dirty -> * transitions will always require the full lock to be held and thus won't occur
 
-        auto stagingBuffer{SynchronizeHostImpl()};
+        GpuDeswizzle gpuDeswizzle;
+        auto stagingBuffer{SynchronizeHostImpl(gpuDeswizzle)};
         if (stagingBuffer) {
             if (cycle)
                 cycle->WaitSubmit();
             auto lCycle{gpu.scheduler.Submit([&](vk::raii::CommandBuffer &commandBuffer) {
+                RecordGpuDeswizzle(commandBuffer, stagingBuffer, gpuDeswizzle);
                 CopyFromStagingBuffer(commandBuffer, stagingBuffer);
             })};
-            lCycle->AttachObjects(stagingBuffer, shared_from_this());
+            lCycle->AttachObjects(stagingBuffer, shared_from_this(), gpuDeswizzle.input, gpuDeswizzle.descriptorSet);
             lCycle->ChainCycle(cycle);
             cycle = lCycle;
         }
@@ -791,7 +947,7 @@ namespace skyline::gpu {
             std::scoped_lock lock{stateMutex};
             if (gpuDirty && dirtyState == DirtyState::Clean) {
                 dirtyState = DirtyState::GpuDirty;
-                gpu.state.nce->TrapRegions(*trapHandle, false);
+                gpu.state.traps->TrapRegions(*trapHandle, false);
                 FreeGuest();
                 return;
             } else if (dirtyState != DirtyState::CpuDirty) {
@@ -799,13 +955,15 @@ namespace skyline::gpu {
             }
 
             dirtyState = gpuDirty ? DirtyState::GpuDirty : DirtyState::Clean;
-            gpu.state.nce->TrapRegions(*trapHandle, !gpuDirty); // Trap any future CPU reads (optionally) + writes to this texture
+            gpu.state.traps->TrapRegions(*trapHandle, !gpuDirty); // Trap any future CPU reads (optionally) + writes to this texture
         }
 
-        auto stagingBuffer{SynchronizeHostImpl()};
+        GpuDeswizzle gpuDeswizzle;
+        auto stagingBuffer{SynchronizeHostImpl(gpuDeswizzle)};
         if (stagingBuffer) {
+            RecordGpuDeswizzle(commandBuffer, stagingBuffer, gpuDeswizzle);
             CopyFromStagingBuffer(commandBuffer, stagingBuffer);
-            pCycle->AttachObjects(stagingBuffer, shared_from_this());
+            pCycle->AttachObjects(stagingBuffer, shared_from_this(), gpuDeswizzle.input, gpuDeswizzle.descriptorSet);
             pCycle->ChainCycle(cycle);
             cycle = pCycle;
         }
@@ -829,7 +987,7 @@ namespace skyline::gpu {
             if (cpuDirty && dirtyState == DirtyState::Clean) {
                 dirtyState = DirtyState::CpuDirty;
                 if (!skipTrap)
-                    gpu.state.nce->DeleteTrap(*trapHandle);
+                    gpu.state.traps->DeleteTrap(*trapHandle);
                 return;
             } else if (dirtyState != DirtyState::GpuDirty) {
                 return;
@@ -847,16 +1005,16 @@ namespace skyline::gpu {
         WaitOnBacking();
 
         if (tiling == vk::ImageTiling::eOptimal || !std::holds_alternative<memory::Image>(backing)) {
-            if (!downloadStagingBuffer)
-                downloadStagingBuffer = gpu.memory.AllocateStagingBuffer(surfaceSize);
+            // The staging buffer is released as soon as the copy to the guest is done so its region in the staging ring can be recycled
+            auto stagingBuffer{gpu.memory.AllocateStagingBuffer(surfaceSize, format->bpb)};
 
             WaitOnFence();
             auto lCycle{gpu.scheduler.Submit([&](vk::raii::CommandBuffer &commandBuffer) {
-                CopyIntoStagingBuffer(commandBuffer, downloadStagingBuffer);
+                CopyIntoStagingBuffer(commandBuffer, stagingBuffer);
             })};
             lCycle->Wait(); // We block till the copy is complete
 
-            CopyToGuest(downloadStagingBuffer->data());
+            CopyToGuest(stagingBuffer->data());
         } else if (tiling == vk::ImageTiling::eLinear) {
             // We can optimize linear texture sync on a UMA by mapping the texture onto the CPU and copying directly from it rather than using a staging buffer
             WaitOnFence();
@@ -867,9 +1025,9 @@ namespace skyline::gpu {
 
         if (!skipTrap)
             if (cpuDirty)
-                gpu.state.nce->DeleteTrap(*trapHandle);
+                gpu.state.traps->DeleteTrap(*trapHandle);
             else
-                gpu.state.nce->TrapRegions(*trapHandle, true); // Trap any future CPU writes to this texture
+                gpu.state.traps->TrapRegions(*trapHandle, true); // Trap any future CPU writes to this texture
     }
 
     std::shared_ptr<TextureView> Texture::GetView(vk::ImageViewType type, vk::ImageSubresourceRange range, texture::Format pFormat, vk::ComponentMapping mapping) {
@@ -7,10 +7,11 @@
 #include <range/v3/algorithm.hpp>
 #include <common/spin_lock.h>
 #include <common/lockable_shared_ptr.h>
-#include <nce.h>
+#include <nce/trap_manager.h>
 #include <gpu/tag_allocator.h>
 #include <gpu/memory_manager.h>
 #include <gpu/usage_tracker.h>
+#include <gpu/shaders/helper_shaders.h>
 
 namespace skyline::gpu {
     namespace texture {
@@ -83,6 +84,17 @@ namespace skyline::gpu {
                 return (blockHeight != 1) || (blockWidth != 1);
             }
 
+            constexpr bool IsAstc() const {
+                return vkFormat >= vk::Format::eAstc4x4UnormBlock && vkFormat <= vk::Format::eAstc12x12SrgbBlock;
+            }
+
+            /**
+             * @return If the format is an sRGB ASTC format, the ASTC formats alternate between UNORM and sRGB variants of every block footprint
+             */
+            constexpr bool IsAstcSrgb() const {
+                return IsAstc() && ((static_cast<u32>(vkFormat) - static_cast<u32>(vk::Format::eAstc4x4UnormBlock)) & 1);
+            }
+
             /**
              * @param width The width of the texture in pixels
              * @param height The height of the texture in pixels
@@ -375,6 +387,10 @@ namespace skyline::gpu {
      */
     class Texture : public std::enable_shared_from_this<Texture> {
       private:
+        static constexpr size_t ParallelSyncThreshold{0x100000}; //!< The minimum size of a texture in bytes for guest -> host synchronization to be split into jobs on the GPU worker pool
+        static constexpr size_t ParallelSyncBandSize{0x40000}; //!< The approximate amount of bytes written by a single job during parallel guest -> host synchronization
+        static constexpr size_t GpuDeswizzleThreshold{0x40000}; //!< The minimum size of a texture in bytes for block-linear guest -> host synchronization to be deswizzled on the GPU rather than on the CPU
+
         GPU &gpu;
         RecursiveSpinLock mutex; //!< Synchronizes any mutations to the texture or its backing
         std::atomic<ContextTag> tag{}; //!< The tag associated with the last lock call
@@ -384,7 +400,7 @@ namespace skyline::gpu {
 
         span<u8> mirror{}; //!< A contiguous mirror of all the guest mappings to allow linear access on the CPU
         span<u8> alignedMirror{}; //!< The mirror mapping aligned to page size to reflect the full mapping
-        std::optional<nce::NCE::TrapHandle> trapHandle{}; //!< The handle of the traps for the guest mappings
+        std::optional<nce::TrapManager::TrapHandle> trapHandle{}; //!< The handle of the traps for the guest mappings
         enum class DirtyState {
             Clean, //!< The CPU mappings are in sync with the GPU texture
             CpuDirty, //!< The CPU mappings have been modified but the GPU texture is not up to date
@@ -408,8 +424,6 @@ namespace skyline::gpu {
 
         std::vector<TextureViewStorage> views;
 
-        std::shared_ptr<memory::StagingBuffer> downloadStagingBuffer{};
-
         u32 lastRenderPassIndex{}; //!< The index of the last render pass that used this texture
         texture::RenderPassUsage lastRenderPassUsage{texture::RenderPassUsage::None}; //!< The type of usage in the last render pass
         bool everUsedAsRt{}; //!< If this texture has ever been used as a rendertarget
@@ -424,11 +438,26 @@ namespace skyline::gpu {
          */
         void SetupGuestMappings();
 
+        /**
+         * @brief Block-linear guest data that's deswizzled into the staging buffer on the GPU during guest -> host synchronization
+         */
+        struct GpuDeswizzle {
+            std::shared_ptr<memory::StagingBuffer> input; //!< A copy of the guest texture's block-linear data
+            std::vector<BlockLinearHelperShader::CopyLayout> copies; //!< The copies from the input into the staging buffer, these are relative to the start of both buffers
+            std::shared_ptr<DescriptorAllocator::ActiveDescriptorSet> descriptorSet; //!< The descriptor set used by the copies, this is set once they're recorded
+        };
+
         /**
          * @brief An implementation function for guest -> host texture synchronization, it allocates and copies data into a staging buffer or directly into a linear host texture
+         * @param gpuDeswizzle Any block-linear data that's deswizzled on the GPU rather than copied into the staging buffer, this must be recorded with RecordGpuDeswizzle prior to copying from the staging buffer
          * @return If a staging buffer was required for the texture sync, it's returned filled with guest texture data and must be copied to the host texture by the callee
          */
-        std::shared_ptr<memory::StagingBuffer> SynchronizeHostImpl();
+        std::shared_ptr<memory::StagingBuffer> SynchronizeHostImpl(GpuDeswizzle &gpuDeswizzle);
+
+        /**
+         * @brief Records any GPU deswizzling from SynchronizeHostImpl into the supplied command buffer, the input and descriptor set of the deswizzle must be attached to the fence cycle of the command buffer
+         */
+        void RecordGpuDeswizzle(const vk::raii::CommandBuffer &commandBuffer, const std::shared_ptr<memory::StagingBuffer> &stagingBuffer, GpuDeswizzle &gpuDeswizzle);
 
         /**
          * @brief Records commands for copying data from a staging buffer to the texture's backing into the supplied command buffer
@@ -454,9 +483,10 @@ namespace skyline::gpu {
         void FreeGuest();
 
         /**
+         * @param baseOffset The offset of the texture's data in the buffer, this is the offset of the staging buffer in its backing
          * @return A vector of all the buffer image copies that need to be done for every aspect of every level of every layer of the texture
          */
-        boost::container::small_vector<vk::BufferImageCopy, 10> GetBufferImageCopies();
+        boost::container::small_vector<vk::BufferImageCopy, 10> GetBufferImageCopies(vk::DeviceSize baseOffset);
 
         static constexpr size_t FrequentlyLockedThreshold{2}; //!< Threshold for the number of times a texture can be locked (not from context locks, only normal) before it should be considered frequently locked
         size_t accumulatedCpuLockCounter{};
@@ -139,11 +139,15 @@ namespace skyline::gpu {
         texture->TransitionLayout(vk::ImageLayout::eGeneral);
         auto it{texture->guest->mappings.begin()};
         textures.emplace(mappingEnd, TextureMapping{texture, it, guestMapping});
+        maxMappingSize = std::max(maxMappingSize, guestMapping.size());
         while ((++it) != texture->guest->mappings.end()) {
             guestMapping = *it;
-            auto mapping{std::upper_bound(textures.begin(), textures.end(), guestMapping)};
+            auto mapping{std::upper_bound(textures.begin(), textures.end(), guestMapping, [](const span<u8> &value, const TextureMapping &element) {
+                return value.end() < element.end();
+            })};
             // TODO: Delete overlapping textures that aren't in texture pool
             textures.emplace(mapping, TextureMapping{texture, it, guestMapping});
+            maxMappingSize = std::max(maxMappingSize, guestMapping.size());
         }
 
         return texture->GetView(guestTexture.viewType, vk::ImageSubresourceRange{
@@ -154,4 +158,20 @@ namespace skyline::gpu {
             .layerCount = guestTexture.GetViewLayerCount(),
         }, guestTexture.format, guestTexture.swizzle);
     }
+
+    bool TextureManager::HasOverlap(span<u8> mapping) const {
+        // Only mappings ending after the start of the supplied mapping can overlap it, these are searched until one ends far enough past its end that it can't start within it
+        u8 *mappingStart{mapping.data()}, *mappingEnd{mapping.data() + mapping.size()};
+        for (auto it{std::upper_bound(textures.begin(), textures.end(), mappingStart, [](u8 *address, const TextureMapping &element) {
+            return address < element.data() + element.size();
+        })}; it != textures.end(); it++) {
+            if (it->data() < mappingEnd)
+                return true;
+
+            if (static_cast<size_t>(it->data() + it->size() - mappingEnd) >= maxMappingSize)
+                break;
+        }
+
+        return false;
+    }
 }
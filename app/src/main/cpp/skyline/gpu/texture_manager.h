@@ -26,7 +26,8 @@ namespace skyline::gpu {
         };
 
         GPU &gpu;
-        std::vector<TextureMapping> textures; //!< A sorted vector of all texture mappings
+        std::vector<TextureMapping> textures; //!< A vector of all texture mappings sorted by their end address
+        size_t maxMappingSize{}; //!< The size of the largest mapping in `textures`, this bounds how far past the end of a range an overlapping mapping can end
 
       public:
         TextureManager(GPU &gpu);
@@ -36,5 +37,11 @@ namespace skyline::gpu {
          * @note The texture manager **must** be locked prior to calling this
          */
         std::shared_ptr<TextureView> FindOrCreate(const GuestTexture &guestTexture, ContextTag tag = {});
+
+        /**
+         * @return If any texture has a mapping which overlaps with the supplied mapping
+         * @note The texture manager **must** be locked prior to calling this
+         */
+        bool HasOverlap(span<u8> mapping) const;
     };
 }
@@ -0,0 +1,157 @@
+// SPDX-License-Identifier: MPL-2.0
+// Copyright © 2022 Skyline Team and Contributors (https://github.com/skyline-emu/)
+
+#include "memory.h"
+
+namespace skyline::kernel {
+    /**
+     * @return The index of the chunk containing the supplied address in a sorted array of chunks, this is always in bounds even if the array is being concurrently modified
+     * @note This is a branchless binary search as the branches of a regular binary search are unpredictable for random lookups
+     */
+    static size_t FindChunkIndex(const ChunkEntry *entries, size_t count, u8 *addr) {
+        const ChunkEntry *chunk{entries};
+        while (count > 1) {
+            size_t half{count / 2};
+            chunk = (chunk[half].base <= addr) ? chunk + half : chunk;
+            count -= half;
+        }
+        return static_cast<size_t>(chunk - entries);
+    }
+
+    void ChunkMap::Reset(span<u8> addressSpace) {
+        // Insert a placeholder element at the end of the array to make sure there's always a chunk following the last chunk in the address space
+        constexpr size_t InitialChunkCapacity{0x400};
+        chunkArrays.clear();
+        auto &array{chunkArrays.emplace_back(std::make_unique<ChunkArray>(InitialChunkCapacity))};
+        array->entries[0] = {addressSpace.data(), {
+            .state = memory::states::Unmapped,
+            .size = addressSpace.size(),
+        }};
+        array->entries[1] = {reinterpret_cast<u8 *>(UINT64_MAX), {
+            .state = memory::states::Reserved,
+        }};
+        array->count.store(2, std::memory_order_relaxed);
+        chunks.store(array.get(), std::memory_order_release);
+    }
+
+    span<ChunkEntry> ChunkMap::GetChunks() const {
+        auto array{chunks.load(std::memory_order_relaxed)};
+        return span<ChunkEntry>{array->entries.get(), array->count.load(std::memory_order_relaxed)};
+    }
+
+    size_t ChunkMap::GetIndex(u8 *addr) const {
+        auto array{chunks.load(std::memory_order_relaxed)};
+        return FindChunkIndex(array->entries.get(), array->count.load(std::memory_order_relaxed), addr);
+    }
+
+    void ChunkMap::Replace(size_t first, size_t last, span<const ChunkEntry> replacement) {
+        auto array{chunks.load(std::memory_order_relaxed)};
+        auto entries{array->entries.get()};
+        size_t count{array->count.load(std::memory_order_relaxed)};
+        size_t newCount{count - (last - first) + replacement.size()};
+
+        if (newCount > array->capacity) [[unlikely]] {
+            // The chunks are written into a new array which is only published after it's complete, readers of the old array don't need to retry as it isn't modified
+            auto &newArray{chunkArrays.emplace_back(std::make_unique<ChunkArray>(array->capacity * 2))};
+            auto newEntries{newArray->entries.get()};
+            std::copy(entries, entries + first, newEntries);
+            std::copy(replacement.begin(), replacement.end(), newEntries + first);
+            std::copy(entries + last, entries + count, newEntries + first + replacement.size());
+            newArray->count.store(newCount, std::memory_order_relaxed);
+            chunks.store(newArray.get(), std::memory_order_release);
+            return;
+        }
+
+        chunkSequence.fetch_add(1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+
+        std::memmove(entries + first + replacement.size(), entries + last, (count - last) * sizeof(ChunkEntry));
+        std::copy(replacement.begin(), replacement.end(), entries + first);
+        array->count.store(newCount, std::memory_order_relaxed);
+
+        chunkSequence.fetch_add(1, std::memory_order_release);
+    }
+
+    bool ChunkMap::Map(const std::pair<u8 *, ChunkDescriptor> &newDesc) {
+        if (!newDesc.second.size) [[unlikely]]
+            return false;
+
+        auto entries{chunks.load(std::memory_order_relaxed)->entries.get()};
+        u8 *newEnd{newDesc.first + newDesc.second.size};
+
+        // The range of chunks overlapping the new chunk
+        size_t first{GetIndex(newDesc.first)}, last{GetIndex(newEnd - 1)};
+        ChunkEntry firstChunk{entries[first]}, lastChunk{entries[last]};
+
+        // We're mapping strictly inside a single chunk with the same attributes, no editing necessary
+        if (first == last && firstChunk.base < newDesc.first && lastChunk.End() > newEnd && firstChunk.descriptor.IsCompatible(newDesc.second)) [[unlikely]]
+            return false;
+
+        bool isUnmapping{newDesc.second.state == memory::states::Unmapped};
+        bool needsReprotection{false};
+        for (size_t index{first}; index <= last; index++)
+            if ((entries[index].descriptor.state == memory::states::Unmapped) != isUnmapping)
+                needsReprotection = true;
+
+        // The new chunk, alongside any remainders of the overlapped chunks and any neighbours it's merged with, replaces all overlapped chunks in a single operation
+        std::array<ChunkEntry, 3> replacement;
+        size_t replacementCount{}, replaceFirst{first}, replaceLast{last + 1};
+
+        if (firstChunk.base < newDesc.first) {
+            firstChunk.descriptor.size = static_cast<size_t>(newDesc.first - firstChunk.base);
+            replacement[replacementCount++] = firstChunk;
+        } else if (first && entries[first - 1].descriptor.IsCompatible(newDesc.second)) {
+            replacement[replacementCount++] = entries[--replaceFirst];
+        }
+
+        bool isMerged{replacementCount && replacement[replacementCount - 1].descriptor.IsCompatible(newDesc.second)};
+        if (isMerged)
+            replacement[replacementCount - 1].descriptor.size += newDesc.second.size;
+        else
+            replacement[replacementCount++] = ChunkEntry{newDesc.first, newDesc.second};
+
+        std::optional<ChunkEntry> nextChunk;
+        if (lastChunk.End() > newEnd) {
+            lastChunk.descriptor.size = static_cast<size_t>(lastChunk.End() - newEnd);
+            lastChunk.base = newEnd;
+            nextChunk = lastChunk;
+        } else if (entries[last + 1].base == newEnd && entries[last + 1].descriptor.IsCompatible(newDesc.second)) {
+            nextChunk = entries[replaceLast++];
+        }
+
+        if (nextChunk) {
+            auto &current{replacement[replacementCount - 1]};
+            if (nextChunk->descriptor.IsCompatible(newDesc.second)) {
+                // If the new chunk wasn't merged into the preceding chunk then it takes on the descriptor of the following chunk
+                size_t size{current.descriptor.size + nextChunk->descriptor.size};
+                if (!isMerged)
+                    current.descriptor = nextChunk->descriptor;
+                current.descriptor.size = size;
+            } else {
+                replacement[replacementCount++] = *nextChunk;
+            }
+        }
+
+        Replace(replaceFirst, replaceLast, span<const ChunkEntry>{replacement.data(), replacementCount});
+        return needsReprotection;
+    }
+
+    ChunkEntry ChunkMap::Find(u8 *addr) const {
+        // The chunk is read optimistically and the read is retried if a writer modified the array concurrently, any torn reads are discarded
+        while (true) {
+            u32 sequence{chunkSequence.load(std::memory_order_acquire)};
+            if (sequence & 1) [[unlikely]] {
+                std::this_thread::yield();
+                continue;
+            }
+
+            auto array{chunks.load(std::memory_order_acquire)};
+            size_t count{array->count.load(std::memory_order_relaxed)};
+            auto chunk{array->entries[FindChunkIndex(array->entries.get(), count, addr)]};
+
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (chunkSequence.load(std::memory_order_relaxed) == sequence) [[likely]]
+                return chunk;
+        }
+    }
+}
@@ -18,138 +18,23 @@ namespace skyline::kernel {
     }
 
     void MemoryManager::MapInternal(const std::pair<u8 *, ChunkDescriptor> &newDesc) {
-        // The chunk that contains / precedes the new chunk base address
-        auto firstChunkBase{chunks.lower_bound(newDesc.first)};
-        if (newDesc.first <= firstChunkBase->first)
-            --firstChunkBase;
-
-        // The chunk that contains / follows the end address of the new chunk
-        auto lastChunkBase{chunks.lower_bound(newDesc.first + newDesc.second.size)};
-        if ((newDesc.first + newDesc.second.size) < lastChunkBase->first)
-            --lastChunkBase;
-
-        ChunkDescriptor firstChunk{firstChunkBase->second};
-        ChunkDescriptor lastChunk{lastChunkBase->second};
-
-        bool needsReprotection{false};
-        bool isUnmapping{newDesc.second.state == memory::states::Unmapped};
-
-        // We cut a hole in a single chunk
-        if (firstChunkBase->first == lastChunkBase->first) {
-            if (firstChunk.IsCompatible(newDesc.second)) [[unlikely]]
-                // No editing necessary
-                return;
-
-            if ((firstChunk.state == memory::states::Unmapped) != isUnmapping)
-                needsReprotection = true;
-
-            // We reduce the size of the first half
-            firstChunk.size = static_cast<size_t>(newDesc.first - firstChunkBase->first);
-            chunks[firstChunkBase->first] = firstChunk;
-
-            // We create the chunk's second half
-            lastChunk.size = static_cast<size_t>((lastChunkBase->first + lastChunk.size) - (newDesc.first + newDesc.second.size));
-            chunks.insert({newDesc.first + newDesc.second.size, lastChunk});
-
-            // Insert new chunk in between
-            chunks.insert(newDesc);
-        } else {
-            // If there are descriptors between first and last chunk, delete them
-            if ((firstChunkBase->first + firstChunk.size) != lastChunkBase->first) {
-                auto tempChunkBase{std::next(firstChunkBase)};
-
-                while (tempChunkBase->first != lastChunkBase->first) {
-                    auto tmp{tempChunkBase++};
-                    if ((tmp->second.state == memory::states::Unmapped) != isUnmapping)
-                        needsReprotection = true;
-                }
-                chunks.erase(std::next(firstChunkBase), lastChunkBase);
-            }
-
-            bool shouldInsert{true};
-
-            // We check if the new chunk and the first chunk is mergable
-            if (firstChunk.IsCompatible(newDesc.second)) {
-                shouldInsert = false;
-
-                firstChunk.size = static_cast<size_t>((newDesc.first + newDesc.second.size) - firstChunkBase->first);
-                chunks[firstChunkBase->first] = firstChunk;
-            } else if ((firstChunkBase->first + firstChunk.size) != newDesc.first) { // If it's not mergable check if it needs resizing
-                firstChunk.size = static_cast<size_t>(newDesc.first - firstChunkBase->first);
-
-                chunks[firstChunkBase->first] = firstChunk;
-
-                if ((firstChunk.state == memory::states::Unmapped) != isUnmapping)
-                    needsReprotection = true;
-            }
-
-            // We check if the new chunk and the last chunk is mergable
-            if (lastChunk.IsCompatible(newDesc.second)) {
-                u8 *oldBase{lastChunkBase->first};
-                chunks.erase(lastChunkBase);
-
-                if (shouldInsert) {
-                    shouldInsert = false;
-
-                    lastChunk.size = static_cast<size_t>((lastChunk.size + oldBase) - (newDesc.first));
-
-                    chunks[newDesc.first] = lastChunk;
-                } else {
-                    firstChunk.size = static_cast<size_t>((lastChunk.size + oldBase) - firstChunkBase->first);
-                    chunks[firstChunkBase->first] = firstChunk;
-                }
-            } else if ((newDesc.first + newDesc.second.size) != lastChunkBase->first) { // If it's not mergable check if it needs resizing
-                lastChunk.size = static_cast<size_t>((lastChunk.size + lastChunkBase->first) - (newDesc.first + newDesc.second.size));
-
-                chunks.erase(lastChunkBase);
-                chunks[newDesc.first + newDesc.second.size] = lastChunk;
-
-                if ((lastChunk.state == memory::states::Unmapped) != isUnmapping)
-                    needsReprotection = true;
-            }
-
-            // Insert if not merged
-            if (shouldInsert)
-                chunks.insert(newDesc);
-        }
-
-        if (needsReprotection)
+        if (chunks.Map(newDesc)) {
+            bool isUnmapping{newDesc.second.state == memory::states::Unmapped};
             if (mprotect(newDesc.first, newDesc.second.size, !isUnmapping ? PROT_READ | PROT_WRITE | PROT_EXEC : PROT_NONE)) [[unlikely]]
                 Logger::Warn("Reprotection failed: {}", strerror(errno));
+        }
     }
 
     void MemoryManager::ForeachChunkInRange(span<u8> memory, auto editCallback) {
-        auto chunkBase{chunks.lower_bound(memory.data())};
-        if (memory.data() < chunkBase->first)
-            --chunkBase;
-
-        size_t sizeLeft{memory.size()};
-
-        if (chunkBase->first < memory.data()) [[unlikely]] {
-            size_t chunkSize{std::min<size_t>(chunkBase->second.size - (static_cast<size_t>(memory.data() - chunkBase->first)), memory.size())};
-
-            std::pair<u8 *, ChunkDescriptor> temp{memory.data(), chunkBase->second};
-            temp.second.size = chunkSize;
+        // Chunks are looked up by address on every iteration as the callback may modify the chunk array
+        u8 *address{memory.data()}, *end{memory.end().base()};
+        while (address < end) {
+            auto chunk{chunks.GetChunks()[chunks.GetIndex(address)]};
+            std::pair<u8 *, ChunkDescriptor> temp{address, chunk.descriptor};
+            temp.second.size = static_cast<size_t>(std::min(chunk.End(), end) - address);
+
+            address += temp.second.size;
             editCallback(temp);
-
-            ++chunkBase;
-            sizeLeft -= chunkSize;
-        }
-
-        while (sizeLeft) {
-            if (sizeLeft < chunkBase->second.size) {
-                std::pair<u8 *, ChunkDescriptor> temp(*chunkBase);
-                temp.second.size = sizeLeft;
-                editCallback(temp);
-                break;
-            } else [[likely]] {
-                std::pair<u8 *, ChunkDescriptor> temp(*chunkBase);
-
-                editCallback(temp);
-
-                sizeLeft = sizeLeft - chunkBase->second.size;
-                ++chunkBase;
-            }
         }
     }
 
@@ -234,13 +119,7 @@ namespace skyline::kernel {
             }
         }
 
-        // Insert a placeholder element at the end of the map to make sure upper_bound/lower_bound never triggers std::map::end() which is broken
-        chunks = {{addressSpace.data(),{
-            .size = addressSpace.size(),
-            .state = memory::states::Unmapped,
-        }}, {reinterpret_cast<u8 *>(UINT64_MAX), {
-            .state = memory::states::Reserved,
-        }}};
+        chunks.Reset(addressSpace);
     }
 
     void MemoryManager::InitializeRegions(span<u8> codeRegion) {
@@ -373,16 +252,11 @@ namespace skyline::kernel {
     }
 
     std::optional<std::pair<u8 *, ChunkDescriptor>> MemoryManager::GetChunk(u8 *addr) {
-        std::shared_lock lock{mutex};
-
         if (!addressSpace.contains(addr)) [[unlikely]]
             return std::nullopt;
 
-        auto chunkBase{chunks.lower_bound(addr)};
-        if (addr < chunkBase->first)
-            --chunkBase;
-
-        return std::make_optional(*chunkBase);
+        auto chunk{chunks.Find(addr)};
+        return std::make_optional<std::pair<u8 *, ChunkDescriptor>>(chunk.base, chunk.descriptor);
     }
 
     __attribute__((always_inline)) void MemoryManager::MapCodeMemory(span<u8> memory, memory::Permission permission) {
@@ -524,20 +398,21 @@ namespace skyline::kernel {
     void MemoryManager::SvcUnmapMemory(span<u8> source, span<u8> destination) {
         std::unique_lock lock{mutex};
 
-        auto dstChunk = chunks.lower_bound(destination.data());
-        if (destination.data() < dstChunk->first)
-            --dstChunk;
-        while (dstChunk->second.state.value == memory::states::Unmapped)
-            ++dstChunk;
+        auto entries{chunks.GetChunks()};
+        size_t dstIndex{chunks.GetIndex(destination.data())};
+        while (entries[dstIndex].descriptor.state.value == memory::states::Unmapped)
+            ++dstIndex;
 
-        if ((destination.data() + destination.size()) > dstChunk->first) [[likely]] {
-            ForeachChunkInRange(span<u8>{source.data() + (dstChunk->first - destination.data()), dstChunk->second.size}, [&](std::pair<u8 *, ChunkDescriptor> &desc) __attribute__((always_inline)) {
-                desc.second.permission = dstChunk->second.permission;
+        // The destination chunk is copied as the chunk array is modified while remapping the source
+        auto dstChunk{entries[dstIndex]};
+        if ((destination.data() + destination.size()) > dstChunk.base) [[likely]] {
+            ForeachChunkInRange(span<u8>{source.data() + (dstChunk.base - destination.data()), dstChunk.descriptor.size}, [&](std::pair<u8 *, ChunkDescriptor> &desc) __attribute__((always_inline)) {
+                desc.second.permission = dstChunk.descriptor.permission;
                 desc.second.attributes.isBorrowed = false;
                 MapInternal(desc);
             });
 
-            std::memcpy(source.data() + (dstChunk->first - destination.data()), dstChunk->first, dstChunk->second.size);
+            std::memcpy(source.data() + (dstChunk.base - destination.data()), dstChunk.base, dstChunk.descriptor.size);
         }
     }
 
@@ -556,11 +431,12 @@ namespace skyline::kernel {
         std::shared_lock lock{mutex};
         size_t size{};
 
-        auto currChunk = chunks.lower_bound(heap.data());
+        auto entries{chunks.GetChunks()};
+        auto currChunk{std::lower_bound(entries.begin(), entries.end(), heap.data(), [](const ChunkEntry &chunk, u8 *addr) { return chunk.base < addr; })};
 
-        while (currChunk->first < heap.end().base()) {
-            if (currChunk->second.state == memory::states::Heap)
-                size += currChunk->second.size;
+        while (currChunk->base < heap.end().base()) {
+            if (currChunk->descriptor.state == memory::states::Heap)
+                size += currChunk->descriptor.size;
             ++currChunk;
         }
 
@@ -570,6 +446,6 @@ namespace skyline::kernel {
     size_t MemoryManager::GetSystemResourceUsage() {
         std::shared_lock lock{mutex};
         constexpr size_t KMemoryBlockSize{0x40};
-        return std::min(static_cast<size_t>(state.process->npdm.meta.systemResourceSize), util::AlignUp(chunks.size() * KMemoryBlockSize, constant::PageSize));
+        return std::min(static_cast<size_t>(state.process->npdm.meta.systemResourceSize), util::AlignUp(chunks.GetChunks().size() * KMemoryBlockSize, constant::PageSize));
     }
 }
@@ -6,7 +6,6 @@
 #include <sys/mman.h>
 #include <common.h>
 #include <common/file_descriptor.h>
-#include <map>
 
 namespace skyline {
     namespace kernel::type {
@@ -32,9 +31,9 @@ namespace skyline {
              */
             constexpr Permission(bool read, bool write, bool execute) : r{read}, w{write}, x{execute} {}
 
-            inline bool operator==(const Permission &rhs) const { return r == rhs.r && w == rhs.w && x == rhs.x; }
+            constexpr bool operator==(const Permission &rhs) const { return r == rhs.r && w == rhs.w && x == rhs.x; }
 
-            inline bool operator!=(const Permission &rhs) const { return !operator==(rhs); }
+            constexpr bool operator!=(const Permission &rhs) const { return !operator==(rhs); }
 
             /**
              * @return The value of the permission struct in Linux format
@@ -219,13 +218,81 @@ namespace skyline {
             }
         };
 
+        /**
+         * @brief A chunk descriptor alongside its base address, this is trivially copyable so it can be copied out by lock-free readers
+         */
+        struct ChunkEntry {
+            u8 *base;
+            ChunkDescriptor descriptor;
+
+            constexpr u8 *End() const {
+                return base + descriptor.size;
+            }
+        };
+
+        /**
+         * @brief A map of contiguous chunks covering the entire address space, these are stored in a flat array sorted by their base address
+         * @note The map is modified by a single writer at a time while it can be read concurrently without any locking through Find()
+         */
+        class ChunkMap {
+          private:
+            struct ChunkArray {
+                std::unique_ptr<ChunkEntry[]> entries;
+                size_t capacity;
+                std::atomic<size_t> count{};
+
+                ChunkArray(size_t capacity) : entries{std::make_unique<ChunkEntry[]>(capacity)}, capacity{capacity} {}
+            };
+
+            std::vector<std::unique_ptr<ChunkArray>> chunkArrays; //!< All chunk arrays that were allocated, arrays replaced by a larger one are retained as lock-free readers may still be accessing them
+            std::atomic<ChunkArray *> chunks{}; //!< The array that currently holds all chunks, this is the last array in `chunkArrays`
+            std::atomic<u32> chunkSequence{}; //!< A sequence counter which is odd while the chunk array is being modified in-place, this allows Find to read chunks without locking
+
+            /**
+             * @brief Replaces the chunks in the range [first, last) with the supplied chunks
+             */
+            void Replace(size_t first, size_t last, span<const ChunkEntry> replacement);
+
+          public:
+            /**
+             * @brief Resets the map to a single unmapped chunk covering the supplied address space
+             * @note This must not be called while there are any concurrent readers
+             */
+            void Reset(span<u8> addressSpace);
+
+            /**
+             * @return All chunks in the map followed by a reserved placeholder chunk at the end of the address space
+             * @note This must only be used by the writer and is invalidated by any modification of the map
+             */
+            span<ChunkEntry> GetChunks() const;
+
+            /**
+             * @return The index of the chunk containing the supplied address in GetChunks()
+             * @note This must only be used by the writer
+             */
+            size_t GetIndex(u8 *addr) const;
+
+            /**
+             * @brief Inserts a chunk into the map, splitting any chunks it partially overlaps and merging it with any compatible neighbours
+             * @return If the mapped range was changed between unmapped and mapped and needs to be reprotected accordingly
+             */
+            bool Map(const std::pair<u8 *, ChunkDescriptor> &newDesc);
+
+            /**
+             * @return The chunk containing the supplied address, the address must be inside the address space of the map
+             * @note This doesn't lock and never blocks on the writer, it retries if the chunks were modified while reading
+             */
+            ChunkEntry Find(u8 *addr) const;
+        };
+
         /**
          * @brief MemoryManager allocates and keeps track of guest virtual memory and its related attributes
          */
         class MemoryManager {
           private:
             const DeviceState &state;
-            std::map<u8 *, ChunkDescriptor> chunks;
+
+            ChunkMap chunks; //!< The chunks of the guest address space, this is modified while holding the VMM mutex exclusively
 
             std::vector<std::shared_ptr<type::KMemory>> memRefs;
 
@@ -293,6 +360,7 @@ namespace skyline {
 
             /**
              * @brief Gets the highest chunk's descriptor that contains this address
+             * @note This doesn't lock the VMM mutex and never blocks on writers, it retries if the chunks were modified while reading
              */
             std::optional<std::pair<u8 *, ChunkDescriptor>> GetChunk(u8 *addr);
 
@@ -0,0 +1,139 @@
+// SPDX-License-Identifier: MPL-2.0
+// Copyright © 2022 Skyline Team and Contributors (https://github.com/skyline-emu/)
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <bit>
+#include <common/base.h>
+
+namespace skyline::kernel {
+    /**
+     * @brief A queue of threads which are running or to be run on a core
+     * @note The queue consists of a dedicated slot for the thread at the front (which is running or will run next) followed by an intrusive FIFO list of threads for every priority level, an occupancy bitmap of the lists allows finding the highest priority thread in constant time
+     * @note All members other than the atomics must only be accessed while holding the core's mutex, the atomics can be read without it to get an approximate view of the core's load
+     * @tparam ThreadType The type of the threads in the queue, this must have the intrusive `runQueue*` members, `priority` and `averageTimeslice` of KThread
+     */
+    template<typename ThreadType>
+    struct RunQueue {
+        static constexpr size_t PriorityLevelCount{64}; //!< The amount of distinct thread priority levels, all valid priorities are below this
+
+        struct PriorityList {
+            ThreadType *head{};
+            ThreadType *tail{};
+        };
+
+        std::atomic<ThreadType *> front{}; //!< The thread at the front of the queue, this is nullptr if the queue is empty
+        std::array<PriorityList, PriorityLevelCount> priorityLists{}; //!< The lists of threads after the front of the queue for each priority level
+        std::atomic<u64> priorityMask{}; //!< A bitmap of which priority lists are non-empty, the lowest set bit corresponds to the highest priority thread after the front
+        std::array<std::atomic<u64>, PriorityLevelCount> priorityTimeslices{}; //!< The sum of the estimated timeslices of all threads in each priority list
+
+        /**
+         * @return If the supplied thread is anywhere in this queue
+         */
+        bool Contains(const ThreadType *thread) const {
+            return front.load(std::memory_order_relaxed) == thread || thread->runQueuePriority != -1;
+        }
+
+        /**
+         * @brief Inserts a thread after the front of the queue, after all threads with the same or a higher priority
+         */
+        void PushBack(ThreadType *thread) {
+            auto priority{static_cast<u8>(thread->priority.load())};
+            auto &list{priorityLists.at(priority)};
+
+            thread->runQueuePriority = static_cast<i8>(priority);
+            thread->runQueuePrev = list.tail;
+            thread->runQueueNext = nullptr;
+            if (list.tail)
+                list.tail->runQueueNext = thread;
+            else
+                list.head = thread;
+            list.tail = thread;
+
+            thread->runQueueTimeslice = thread->averageTimeslice ? thread->averageTimeslice : 1;
+            // The atomics are only ever written while holding the core mutex, so they don't require atomic read-modify-write operations
+            priorityTimeslices[priority].store(priorityTimeslices[priority].load(std::memory_order_relaxed) + thread->runQueueTimeslice, std::memory_order_relaxed);
+            priorityMask.store(priorityMask.load(std::memory_order_relaxed) | (1ULL << priority), std::memory_order_relaxed);
+        }
+
+        /**
+         * @brief Inserts a thread after the front of the queue, before all threads with the same or a lower priority
+         */
+        void PushFront(ThreadType *thread) {
+            auto priority{static_cast<u8>(thread->priority.load())};
+            auto &list{priorityLists.at(priority)};
+
+            thread->runQueuePriority = static_cast<i8>(priority);
+            thread->runQueuePrev = nullptr;
+            thread->runQueueNext = list.head;
+            if (list.head)
+                list.head->runQueuePrev = thread;
+            else
+                list.tail = thread;
+            list.head = thread;
+
+            thread->runQueueTimeslice = thread->averageTimeslice ? thread->averageTimeslice : 1;
+            priorityTimeslices[priority].store(priorityTimeslices[priority].load(std::memory_order_relaxed) + thread->runQueueTimeslice, std::memory_order_relaxed);
+            priorityMask.store(priorityMask.load(std::memory_order_relaxed) | (1ULL << priority), std::memory_order_relaxed);
+        }
+
+        /**
+         * @brief Removes a thread from its priority list, this must not be called on the thread at the front of the queue
+         */
+        void Unlink(ThreadType *thread) {
+            auto priority{static_cast<u8>(thread->runQueuePriority)};
+            auto &list{priorityLists[priority]};
+
+            if (thread->runQueuePrev)
+                thread->runQueuePrev->runQueueNext = thread->runQueueNext;
+            else
+                list.head = thread->runQueueNext;
+            if (thread->runQueueNext)
+                thread->runQueueNext->runQueuePrev = thread->runQueuePrev;
+            else
+                list.tail = thread->runQueuePrev;
+
+            if (!list.head)
+                priorityMask.store(priorityMask.load(std::memory_order_relaxed) & ~(1ULL << priority), std::memory_order_relaxed);
+            priorityTimeslices[priority].store(priorityTimeslices[priority].load(std::memory_order_relaxed) - thread->runQueueTimeslice, std::memory_order_relaxed);
+
+            thread->runQueuePriority = -1;
+            thread->runQueuePrev = nullptr;
+            thread->runQueueNext = nullptr;
+        }
+
+        /**
+         * @return The thread after the front of the queue which would be at the front if the current front was removed, this is nullptr if there's no such thread
+         */
+        ThreadType *PeekNext() const {
+            u64 mask{priorityMask.load(std::memory_order_relaxed)};
+            return mask ? priorityLists[static_cast<size_t>(std::countr_zero(mask))].head : nullptr;
+        }
+
+        /**
+         * @brief Moves the thread after the front of the queue to the front, the current front must have already been removed or relinked
+         */
+        void AdvanceFront() {
+            auto next{PeekNext()};
+            if (next)
+                Unlink(next);
+            front.store(next, std::memory_order_relaxed);
+        }
+
+        /**
+         * @brief Removes a thread from the queue regardless of its position
+         * @return If the thread was at the front of the queue, the front is replaced by the next thread in that case
+         */
+        bool Erase(ThreadType *thread) {
+            if (front.load(std::memory_order_relaxed) == thread) {
+                AdvanceFront();
+                return true;
+            }
+
+            Unlink(thread);
+            return false;
+        }
+    };
+}
@@ -33,36 +33,32 @@ namespace skyline::kernel {
     Scheduler::CoreContext &Scheduler::GetOptimalCoreForThread(const std::shared_ptr<type::KThread> &thread) {
         auto *currentCore{&cores.at(thread->coreId)};
 
-        if (!currentCore->queue.empty() && thread->affinityMask.count() != 1) {
+        if (currentCore->front.load(std::memory_order_relaxed) && thread->affinityMask.count() != 1) {
             // Select core where the current thread will be scheduled the earliest based off average timeslice durations for resident threads
             // There's a preference for the current core as migration isn't free
+            // The core state is read without locking any cores, this may result in a slightly outdated view of the cores but that's acceptable for load balancing
             size_t minTimeslice{};
             CoreContext *optimalCore{};
             for (auto &candidateCore : cores) {
                 if (thread->affinityMask.test(candidateCore.id)) {
                     u64 timeslice{};
 
-                    if (!candidateCore.queue.empty()) {
-                        std::scoped_lock coreLock{candidateCore.mutex};
-
-                        auto threadIterator{candidateCore.queue.cbegin()};
-                        if (threadIterator != candidateCore.queue.cend()) {
-                            const auto &runningThread{*threadIterator};
-                            timeslice += [&]() {
-                                if (runningThread->averageTimeslice)
-                                    return std::min(runningThread->averageTimeslice - (util::GetTimeTicks() - runningThread->timesliceStart), 1UL);
-                                else if (runningThread->timesliceStart)
-                                    return util::GetTimeTicks() - runningThread->timesliceStart;
-                                else
-                                    return 1UL;
-                            }();
-
-                            while (++threadIterator != candidateCore.queue.cend()) {
-                                const auto &residentThread{*threadIterator};
-                                if (residentThread->priority <= thread->priority)
-                                    timeslice += residentThread->averageTimeslice ? residentThread->averageTimeslice : 1UL;
-                            }
-                        }
+                    if (auto runningThread{candidateCore.front.load(std::memory_order_relaxed)}) {
+                        // Threads are never destroyed while they're owned by the process so this is safe to access even if the thread was removed from the core in the meantime
+                        u64 averageTimeslice{__atomic_load_n(&runningThread->averageTimeslice, __ATOMIC_RELAXED)}, timesliceStart{__atomic_load_n(&runningThread->timesliceStart, __ATOMIC_RELAXED)};
+                        timeslice += [&]() {
+                            if (averageTimeslice)
+                                return std::min(averageTimeslice - (util::GetTimeTicks() - timesliceStart), 1UL);
+                            else if (timesliceStart)
+                                return util::GetTimeTicks() - timesliceStart;
+                            else
+                                return 1UL;
+                        }();
+
+                        // Sum the timeslices of all priority levels that will be scheduled prior to or alongside the thread
+                        u64 mask{candidateCore.priorityMask.load(std::memory_order_relaxed) & (std::numeric_limits<u64>::max() >> (std::numeric_limits<u64>::digits - 1 - thread->priority))};
+                        for (; mask; mask &= mask - 1)
+                            timeslice += candidateCore.priorityTimeslices[static_cast<size_t>(std::countr_zero(mask))].load(std::memory_order_relaxed);
                     }
 
                     if (!optimalCore || timeslice < minTimeslice || (timeslice == minTimeslice && &candidateCore == currentCore)) {
@@ -85,8 +81,8 @@ namespace skyline::kernel {
         return *currentCore;
     }
 
-    void Scheduler::YieldThread(const std::shared_ptr<type::KThread> &thread) {
-        if (state.thread != thread) {
+    void Scheduler::YieldThread(type::KThread *thread) {
+        if (state.thread.get() != thread) {
             // If another thread is being yielded, we need to send it an OS signal to yield
             if (!thread->pendingYield) {
                 // We only want to yield the thread if it hasn't already been sent a signal to yield in the past
@@ -113,46 +109,42 @@ namespace skyline::kernel {
         }
 
         #ifndef NDEBUG
-        // Scan the queue for the same thread to prevent double insertion
-        for (auto &residentThread : core.queue) {
-            if (residentThread == thread) {
-                Logger::Error("T{} already exists in C{}", thread->id, core.id);
-                Logger::EmulationContext.Flush();
-            }
+        // Check the queue for the same thread to prevent double insertion
+        if (core.Contains(thread.get())) {
+            Logger::Error("T{} already exists in C{}", thread->id, core.id);
+            Logger::EmulationContext.Flush();
         }
         #endif
 
-        auto nextThread{std::upper_bound(core.queue.begin(), core.queue.end(), thread->priority.load(), type::KThread::IsHigherPriority)};
-        if (nextThread == core.queue.begin()) {
-            if (nextThread != core.queue.end()) {
+        auto front{core.front.load(std::memory_order_relaxed)};
+        if (!front || thread->priority < front->priority) {
+            if (front) {
                 // If the inserted thread has a higher priority than the currently running thread (and the queue isn't empty)
                 // We can yield the thread which is currently scheduled on the core by sending it a signal
                 // It is optimized to avoid waiting for the thread to yield on receiving the signal which serializes the entire pipeline
-                auto front{core.queue.front()};
                 front->forceYield = true;
-                core.queue.splice(std::upper_bound(core.queue.begin(), core.queue.end(), front->priority.load(), type::KThread::IsHigherPriority), core.queue, core.queue.begin());
-                core.queue.push_front(thread);
+                core.PushBack(front);
+                core.front.store(thread.get(), std::memory_order_relaxed);
 
                 YieldThread(front);
             } else {
-                core.queue.push_front(thread);
+                core.front.store(thread.get(), std::memory_order_relaxed);
             }
             if (thread != state.thread)
                 thread->scheduleCondition.notify(); // We only want to trigger the conditional variable if the current thread isn't inserting itself
         } else {
-            core.queue.insert(nextThread, thread);
+            core.PushBack(thread.get());
         }
     }
 
     void Scheduler::MigrateToCore(const std::shared_ptr<type::KThread> &thread, CoreContext *&currentCore, CoreContext *targetCore, std::unique_lock<SpinLock> &lock) {
         // We need to check if the thread was in its resident core's queue
         // If it was, we need to remove it from the queue
-        auto it{std::find(currentCore->queue.begin(), currentCore->queue.end(), thread)};
-        bool wasInserted{it != currentCore->queue.end()};
+        bool wasInserted{currentCore->Contains(thread.get())};
         if (wasInserted) {
-            it = currentCore->queue.erase(it);
-            if (it == currentCore->queue.begin() && it != currentCore->queue.end())
-                (*it)->scheduleCondition.notify();
+            if (currentCore->Erase(thread.get()))
+                if (auto front{currentCore->front.load(std::memory_order_relaxed)})
+                    front->scheduleCondition.notify();
         }
         lock.unlock();
 
@@ -178,7 +170,7 @@ namespace skyline::kernel {
                 if (!thread->affinityMask.test(thread->coreId)) // We need to retest in case the thread was migrated while the core was unlocked
                     MigrateToCore(thread, core, &cores.at(thread->idealCore), lock);
             }
-            return !core->queue.empty() && core->queue.front() == thread;
+            return core->front.load(std::memory_order_relaxed) == thread.get();
         }};
 
         TRACE_EVENT("scheduler", "WaitSchedule");
@@ -216,7 +208,7 @@ namespace skyline::kernel {
                 std::scoped_lock migrationLock{thread->coreMigrationMutex};
                 MigrateToCore(thread, core, &cores.at(thread->idealCore), lock);
             }
-            return !core->queue.empty() && core->queue.front() == thread;
+            return core->front.load(std::memory_order_relaxed) == thread.get();
         })) {
             if (thread->priority == core->preemptionPriority)
                 thread->ArmPreemptionTimer(PreemptiveTimeslice);
@@ -235,14 +227,15 @@ namespace skyline::kernel {
 
         std::unique_lock lock(core.mutex);
 
-        if (core.queue.front() == thread) {
+        if (core.front.load(std::memory_order_relaxed) == thread.get()) {
             // If this thread is at the front of the thread queue then we need to rotate the thread
             // In the case where this thread was forcefully yielded, we don't need to do this as it's done by the thread which yielded to this thread
-            // Splice the linked element from the beginning of the queue to where its priority is present
-            core.queue.splice(std::upper_bound(core.queue.begin(), core.queue.end(), thread->priority.load(), type::KThread::IsHigherPriority), core.queue, core.queue.begin());
+            // Move the thread from the front of the queue to the back of the list for its priority, the highest priority thread is then moved to the front
+            core.PushBack(thread.get());
+            core.AdvanceFront();
 
-            auto &front{core.queue.front()};
-            if (front != thread)
+            auto front{core.front.load(std::memory_order_relaxed)};
+            if (front != thread.get())
                 front->scheduleCondition.notify(); // If we aren't at the front of the queue, only then should we wake the thread at the front up
         } else if (!thread->forceYield) {
             throw exception("T{} called Rotate while not being in C{}'s queue", thread->id, thread->coreId);
@@ -262,16 +255,14 @@ namespace skyline::kernel {
             std::unique_lock lock(core.mutex);
 
             if (!thread->isPaused) {
-                auto it{std::find(core.queue.begin(), core.queue.end(), thread)};
-                if (it != core.queue.end()) {
-                    it = core.queue.erase(it);
-                    if (it == core.queue.begin()) {
+                if (core.Contains(thread.get())) {
+                    if (core.Erase(thread.get())) {
                         // We need to update the averageTimeslice accordingly, if we've been unscheduled by this
                         if (thread->timesliceStart)
                             thread->averageTimeslice = (thread->averageTimeslice / 4) + (3 * (util::GetTimeTicks() - thread->timesliceStart / 4));
 
-                        if (it != core.queue.end())
-                            (*it)->scheduleCondition.notify(); // We need to wake the thread at the front of the queue, if we were at the front previously
+                        if (auto front{core.front.load(std::memory_order_relaxed)})
+                            front->scheduleCondition.notify(); // We need to wake the thread at the front of the queue, if we were at the front previously
                     }
                 } else {
                     Logger::Warn("T{} was not in C{}'s queue", thread->id, thread->coreId);
@@ -292,13 +283,14 @@ namespace skyline::kernel {
         auto *core{&cores.at(thread->coreId)};
         std::unique_lock coreLock(core->mutex);
 
-        auto currentIt{std::find(core->queue.begin(), core->queue.end(), thread)}, nextIt{std::next(currentIt)};
-        if (currentIt == core->queue.end()) {
+        auto front{core->front.load(std::memory_order_relaxed)};
+        if (!core->Contains(thread.get())) {
             return;
-        } else if (currentIt == core->queue.begin()) {
+        } else if (front == thread.get()) {
             // Alternatively, if it's currently running then we'd just want to yield if there's a higher priority thread to run instead
-            if (nextIt != core->queue.end() && (*nextIt)->priority < thread->priority) {
-                YieldThread(thread);
+            auto next{core->PeekNext()};
+            if (next && next->priority < thread->priority) {
+                YieldThread(thread.get());
             } else if (!thread->isPreempted && thread->priority == core->preemptionPriority) {
                 // If the thread needs to be preempted due to its new priority then arm its preemption timer
                 thread->ArmPreemptionTimer(PreemptiveTimeslice);
@@ -306,16 +298,35 @@ namespace skyline::kernel {
                 // If the thread no longer needs to be preempted due to its new priority then disarm its preemption timer
                 thread->DisarmPreemptionTimer();
             }
-        } else if (thread->priority < (*std::prev(currentIt))->priority || (nextIt != core->queue.end() && thread->priority > (*nextIt)->priority)) {
-            // If the thread is in the queue and it's position is affected by the priority change then need to remove and re-insert the thread
-            core->queue.erase(currentIt);
-
-            auto targetIt{std::upper_bound(core->queue.begin(), core->queue.end(), thread->priority.load(), type::KThread::IsHigherPriority)};
-            if (targetIt == core->queue.begin() && targetIt != core->queue.end()) {
-                core->queue.insert(std::next(core->queue.begin()), thread);
-                YieldThread(core->queue.front());
+        } else if (thread->priority != thread->runQueuePriority) {
+            // The thread keeps its position in the queue if it's still ordered with respect to its neighbours at its new priority, this requires it to be at the edge of its old priority list facing the new priority with no threads at any priority in-between
+            i8 oldPriority{thread->runQueuePriority}, newPriority{thread->priority};
+            u64 mask{core->priorityMask.load(std::memory_order_relaxed)};
+            bool keepPosition;
+            if (newPriority > oldPriority) {
+                u64 betweenMask{((1ULL << newPriority) - 1) & ~((2ULL << oldPriority) - 1)};
+                keepPosition = !thread->runQueueNext && !(mask & betweenMask);
+            } else {
+                u64 betweenMask{((1ULL << oldPriority) - 1) & ~((2ULL << newPriority) - 1)};
+                // The thread before this one is the front of the queue if there are no threads with the same or a higher priority in the lists
+                bool previousOrdered{(mask & ((2ULL << newPriority) - 1)) || front->priority <= newPriority};
+                keepPosition = !thread->runQueuePrev && !(mask & betweenMask) && previousOrdered;
+            }
+
+            core->Unlink(thread.get());
+
+            if (keepPosition) {
+                // Relinking the thread at the edge of its new priority list facing its old position doesn't change its position in the queue
+                if (newPriority > oldPriority)
+                    core->PushFront(thread.get());
+                else
+                    core->PushBack(thread.get());
+            } else if (thread->priority < front->priority) {
+                // If the thread has a higher priority than the running thread then it should be the next thread to run and the running thread should yield
+                core->PushFront(thread.get());
+                YieldThread(front);
             } else {
-                core->queue.insert(targetIt, thread);
+                core->PushBack(thread.get());
             }
         }
     }
@@ -323,7 +334,7 @@ namespace skyline::kernel {
     void Scheduler::UpdateCore(const std::shared_ptr<type::KThread> &thread) {
         auto *core{&cores.at(thread->coreId)};
         std::scoped_lock coreLock{core->mutex};
-        if (core->queue.front() == thread)
+        if (core->front.load(std::memory_order_relaxed) == thread.get())
             thread->SendSignal(YieldSignal);
         else
             thread->scheduleCondition.notify();
@@ -337,7 +348,7 @@ namespace skyline::kernel {
         auto originalCoreId{thread->coreId};
         thread->coreId = constant::ParkedCoreId;
         for (auto &core : cores)
-            if (originalCoreId != core.id && thread->affinityMask.test(core.id) && (core.queue.empty() || core.queue.front()->priority > thread->priority))
+            if (auto front{core.front.load(std::memory_order_relaxed)}; originalCoreId != core.id && thread->affinityMask.test(core.id) && (!front || front->priority > thread->priority))
                 thread->coreId = core.id;
 
         if (thread->coreId == constant::ParkedCoreId) {
@@ -355,8 +366,9 @@ namespace skyline::kernel {
             auto &thread{state.thread};
             auto &core{cores.at(thread->coreId)};
             std::unique_lock coreLock(core.mutex);
-            auto nextThread{core.queue.size() > 1 ? *std::next(core.queue.begin()) : nullptr};
-            nextThread = nextThread->priority == thread->priority ? nextThread : nullptr; // If the next thread doesn't have the same priority then it won't be scheduled next
+            auto nextThread{core.PeekNext()};
+            if (nextThread && nextThread->priority != thread->priority)
+                nextThread = nullptr; // If the next thread doesn't have the same priority then it won't be scheduled next
             auto parkedThread{parkedQueue.front()};
 
             // We need to be conservative about waking up a parked thread, it should only be done if its priority is higher than the current thread
@@ -375,17 +387,15 @@ namespace skyline::kernel {
 
         thread->isPaused = true;
 
-        auto it{std::find(core->queue.begin(), core->queue.end(), thread)};
-        if (it != core->queue.end()) {
+        if (core->Contains(thread.get())) {
             thread->insertThreadOnResume = true; // If we're handling removing the thread then we need to be responsible for inserting it back inside ResumeThread
 
-            it = core->queue.erase(it);
-            if (it == core->queue.begin() && it != core->queue.end())
-                (*it)->scheduleCondition.notify();
+            if (core->Erase(thread.get())) {
+                if (auto front{core->front.load(std::memory_order_relaxed)})
+                    front->scheduleCondition.notify();
 
-            if (it == core->queue.begin()) {
                 // We need to send a yield signal to the thread if it's currently running
-                YieldThread(thread);
+                YieldThread(thread.get());
                 thread->forceYield = true;
             }
         } else {
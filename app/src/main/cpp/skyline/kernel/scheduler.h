@@ -5,6 +5,7 @@
 
 #include "common/spin_lock.h"
 #include <common.h>
+#include "run_queue.h"
 #include <condition_variable>
 
 namespace skyline {
@@ -44,11 +45,13 @@ namespace skyline {
           private:
             const DeviceState &state;
 
-            struct CoreContext {
+            /**
+             * @brief The state of a single core including a queue of threads which are running or to be run on it
+             */
+            struct CoreContext : RunQueue<type::KThread> {
                 u8 id;
                 i8 preemptionPriority; //!< The priority at which this core becomes preemptive as opposed to cooperative
                 SpinLock mutex; //!< Synchronizes all operations on the queue
-                std::list<std::shared_ptr<type::KThread>> queue; //!< A queue of threads which are running or to be run on this core
 
                 CoreContext(u8 id, i8 preemptionPriority);
             };
@@ -68,7 +71,7 @@ namespace skyline {
             /**
              * @brief Trigger a thread to yield via a signal or on SVC exit if it is the current thread
              */
-            void YieldThread(const std::shared_ptr<type::KThread> &thread);
+            void YieldThread(type::KThread *thread);
 
           public:
             static constexpr std::chrono::milliseconds PreemptiveTimeslice{10}; //!< The duration of time a preemptive thread can run before yielding
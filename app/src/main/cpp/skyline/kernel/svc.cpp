@@ -656,10 +656,8 @@ namespace skyline::kernel::svc {
     }
 
     void WaitSynchronization(const DeviceState &state) {
-        constexpr u8 MaxSyncHandles{0x40}; // The total amount of handles that can be passed to WaitSynchronization
-
         u32 numHandles{state.ctx->gpr.w2};
-        if (numHandles > MaxSyncHandles) {
+        if (numHandles > type::MaxSyncWaitObjects) {
             state.ctx->gpr.w0 = result::OutOfRange;
             return;
         }
@@ -698,16 +696,16 @@ namespace skyline::kernel::svc {
 
         TRACE_EVENT_FMT("kernel", waitHandles.size() == 1 ? "WaitSynchronization 0x{:X}" : "WaitSynchronizationMultiple 0x{:X}", waitHandles[0]);
 
-        std::unique_lock lock(type::KSyncObject::syncObjectMutex);
-        if (state.thread->cancelSync) {
-            state.thread->cancelSync = false;
+        auto &thread{state.thread};
+        if (thread->cancelSync.exchange(false)) {
             state.ctx->gpr.w0 = result::Cancelled;
             return;
         }
 
+        // Fast path: if any object is already signalled then we can return without taking any locks
         u32 index{};
         for (const auto &object : objectTable) {
-            if (object->signalled) {
+            if (object->signalled.load()) {
                 Logger::Debug("Signalled 0x{:X}", waitHandles[index]);
                 state.ctx->gpr.w0 = Result{};
                 state.ctx->gpr.w1 = index;
@@ -722,62 +720,96 @@ namespace skyline::kernel::svc {
             return;
         }
 
-        auto priority{state.thread->priority.load()};
-        for (const auto &object : objectTable)
-            object->syncObjectWaiters.insert(std::upper_bound(object->syncObjectWaiters.begin(), object->syncObjectWaiters.end(), priority, type::KThread::IsHigherPriority), state.thread);
+        // Register as a waiter on all objects, each object is locked individually so there's no lock ordering to follow between them
+        auto removeWaiters{[&](u32 count) {
+            for (u32 i{}; i < count; i++)
+                objectTable[i]->RemoveWaiter(thread->syncWaiterNodes[i]);
+        }};
+
+        for (index = 0; index < objectTable.size(); index++) {
+            auto &node{thread->syncWaiterNodes[index]};
+            node.thread = thread.get();
+            if (objectTable[index]->AddWaiter(node)) {
+                // The object was signalled after the fast path, we don't need to wait at all
+                removeWaiters(index);
+                Logger::Debug("Signalled 0x{:X}", waitHandles[index]);
+                state.ctx->gpr.w0 = Result{};
+                state.ctx->gpr.w1 = index;
+                return;
+            }
+        }
 
-        state.thread->isCancellable = true;
-        state.thread->wakeObject = nullptr;
         state.scheduler->RemoveThread();
 
-        lock.unlock();
-        if (timeout > 0)
-            state.scheduler->TimedWaitSchedule(std::chrono::nanoseconds(timeout));
-        else
-            state.scheduler->WaitSchedule(false);
-        lock.lock();
+        bool cancelled{};
+        {
+            std::scoped_lock lock{thread->syncWaitMutex};
+            cancelled = thread->cancelSync.exchange(false);
+            if (!cancelled) {
+                thread->isCancellable = true;
+                thread->wakeObject = nullptr;
+            }
+        }
 
-        state.thread->isCancellable = false;
-        auto wakeObject{state.thread->wakeObject};
+        if (cancelled) {
+            removeWaiters(static_cast<u32>(objectTable.size()));
+            Logger::Debug("Wait has been cancelled");
+            state.ctx->gpr.w0 = result::Cancelled;
+            state.scheduler->InsertThread(thread);
+            state.scheduler->WaitSchedule();
+            return;
+        }
 
-        u32 wakeIndex{};
-        index = 0;
+        // Any object signalled between registering as a waiter and becoming cancellable wouldn't have woken us, so we need to wake ourselves for those
         for (const auto &object : objectTable) {
-            if (object.get() == wakeObject)
-                wakeIndex = index;
+            if (object->signalled.load()) {
+                std::scoped_lock lock{thread->syncWaitMutex};
+                if (thread->isCancellable) {
+                    thread->isCancellable = false;
+                    thread->wakeObject = object.get();
+                    state.scheduler->InsertThread(thread);
+                }
+                break;
+            }
+        }
 
-            auto it{std::find(object->syncObjectWaiters.begin(), object->syncObjectWaiters.end(), state.thread)};
-            if (it != object->syncObjectWaiters.end())
-                object->syncObjectWaiters.erase(it);
-            else
-                throw exception("svcWaitSynchronization: An object (0x{:X}) has been removed from the syncObjectWaiters queue incorrectly", waitHandles[index]);
+        if (timeout > 0)
+            state.scheduler->TimedWaitSchedule(std::chrono::nanoseconds(timeout));
+        else
+            state.scheduler->WaitSchedule(false);
 
-            index++;
+        type::KSyncObject *wakeObject;
+        {
+            std::scoped_lock lock{thread->syncWaitMutex};
+            thread->isCancellable = false;
+            wakeObject = thread->wakeObject;
+            cancelled = !wakeObject && thread->cancelSync.exchange(false);
         }
 
+        removeWaiters(static_cast<u32>(objectTable.size()));
+
         if (wakeObject) {
+            u32 wakeIndex{static_cast<u32>(std::distance(objectTable.begin(), std::find_if(objectTable.begin(), objectTable.end(), [&](const auto &object) { return object.get() == wakeObject; })))};
             Logger::Debug("Signalled 0x{:X}", waitHandles[wakeIndex]);
             state.ctx->gpr.w0 = Result{};
             state.ctx->gpr.w1 = wakeIndex;
-        } else if (state.thread->cancelSync) {
-            state.thread->cancelSync = false;
+        } else if (cancelled) {
             Logger::Debug("Wait has been cancelled");
             state.ctx->gpr.w0 = result::Cancelled;
         } else {
             Logger::Debug("Wait has timed out");
             state.ctx->gpr.w0 = result::TimedOut;
-            lock.unlock();
-            state.scheduler->InsertThread(state.thread);
+            state.scheduler->InsertThread(thread);
             state.scheduler->WaitSchedule();
         }
     }
 
     void CancelSynchronization(const DeviceState &state) {
         try {
-            std::unique_lock lock(type::KSyncObject::syncObjectMutex);
             auto thread{state.process->GetHandle<type::KThread>(state.ctx->gpr.w0)};
             Logger::Debug("Cancelling Synchronization {}", thread->id);
-            thread->cancelSync = true;
+            std::scoped_lock lock{thread->syncWaitMutex};
+            thread->cancelSync.store(true);
             if (thread->isCancellable) {
                 thread->isCancellable = false;
                 state.scheduler->InsertThread(thread);
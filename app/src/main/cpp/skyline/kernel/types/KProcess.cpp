@@ -123,6 +123,68 @@ namespace skyline::kernel::type {
         handles.clear();
     }
 
+    void KProcess::SyncWaiterBucket::Insert(KThread *thread, void *key) {
+        thread->syncWaitKey = key;
+
+        i8 priority{thread->priority.load()};
+        KThread *prev{}, *next{head};
+        while (next && next->priority <= priority) {
+            prev = next;
+            next = next->syncWaitNext;
+        }
+
+        thread->syncWaitPrev = prev;
+        thread->syncWaitNext = next;
+        if (prev)
+            prev->syncWaitNext = thread;
+        else
+            head = thread;
+        if (next)
+            next->syncWaitPrev = thread;
+    }
+
+    void KProcess::SyncWaiterBucket::Remove(KThread *thread) {
+        if (thread->syncWaitPrev)
+            thread->syncWaitPrev->syncWaitNext = thread->syncWaitNext;
+        else
+            head = thread->syncWaitNext;
+        if (thread->syncWaitNext)
+            thread->syncWaitNext->syncWaitPrev = thread->syncWaitPrev;
+
+        thread->syncWaitKey = nullptr;
+        thread->syncWaitPrev = nullptr;
+        thread->syncWaitNext = nullptr;
+    }
+
+    KThread *KProcess::SyncWaiterBucket::FindHighestPriority(void *key) {
+        KThread *highest{};
+        for (auto thread{head}; thread; thread = thread->syncWaitNext)
+            if (thread->syncWaitKey == key && (!highest || thread->priority < highest->priority))
+                highest = thread;
+        return highest;
+    }
+
+    i32 KProcess::SyncWaiterBucket::CountWaiters(void *key) {
+        i32 count{};
+        for (auto thread{head}; thread; thread = thread->syncWaitNext)
+            if (thread->syncWaitKey == key)
+                count++;
+        return count;
+    }
+
+    bool KProcess::SyncWaiterBucket::IsLastWaiter(KThread *thread) {
+        for (auto next{thread->syncWaitNext}; next; next = next->syncWaitNext)
+            if (next->syncWaitKey == thread->syncWaitKey)
+                return false;
+        return true;
+    }
+
+    KProcess::SyncWaiterBucket &KProcess::GetSyncWaiterBucket(void *key) {
+        // Keys are always word-aligned so the low bits are discarded, the rest is scrambled with a multiplicative hash so adjacent keys end up in different buckets
+        auto value{static_cast<u64>(reinterpret_cast<uintptr_t>(key) >> 2)};
+        return syncWaiterBuckets[(value * 0x9E3779B97F4A7C15ULL) >> (64 - std::countr_zero(SyncWaiterBucketCount))];
+    }
+
     constexpr u32 HandleWaitersBit{1UL << 30}; //!< A bit which denotes if a mutex psuedo-handle has waiters or not
 
     Result KProcess::MutexLock(const std::shared_ptr<KThread> &thread, u32 *mutex, KHandle ownerHandle, KHandle tag, bool failOnOutdated) {
@@ -243,10 +305,10 @@ namespace skyline::kernel::type {
             state.thread->waitResult = {};
         }
 
+        auto &bucket{GetSyncWaiterBucket(key)};
         {
-            std::scoped_lock lock{syncWaiterMutex};
-            auto queue{syncWaiters.equal_range(key)};
-            syncWaiters.insert(std::upper_bound(queue.first, queue.second, state.thread->priority.load(), [](const i8 priority, const SyncWaiters::value_type &it) { return it.second->priority > priority; }), {key, state.thread});
+            std::scoped_lock lock{bucket.mutex};
+            bucket.Insert(state.thread.get(), key);
 
             __atomic_store_n(key, true, __ATOMIC_SEQ_CST); // We need to notify any userspace threads that there are waiters on this conditional variable by writing back a boolean flag denoting it
 
@@ -258,11 +320,9 @@ namespace skyline::kernel::type {
             bool inQueue{true};
             {
                 // Attempt to remove ourselves from the queue so we cannot be signalled
-                std::unique_lock syncLock{syncWaiterMutex};
-                auto queue{syncWaiters.equal_range(key)};
-                auto iterator{std::find(queue.first, queue.second, SyncWaiters::value_type{key, state.thread})};
-                if (iterator != queue.second)
-                    syncWaiters.erase(iterator);
+                std::scoped_lock syncLock{bucket.mutex};
+                if (state.thread->syncWaitKey == key)
+                    bucket.Remove(state.thread.get());
                 else
                     inQueue = false;
             }
@@ -335,28 +395,27 @@ namespace skyline::kernel::type {
     void KProcess::ConditionVariableSignal(u32 *key, i32 amount) {
         TRACE_EVENT_FMT("kernel", "ConditionVariableSignal 0x{:X}", key);
 
+        auto &bucket{GetSyncWaiterBucket(key)};
         i32 waiterCount{amount};
         while (amount <= 0 || waiterCount) {
             std::shared_ptr<type::KThread> thread;
             void *conditionVariable{};
             {
                 // Try to find a thread to signal
-                std::scoped_lock lock{syncWaiterMutex};
-                auto queue{syncWaiters.equal_range(key)};
+                std::scoped_lock lock{bucket.mutex};
 
-                if (queue.first != queue.second) {
+                if (auto waiter{bucket.FindHighestPriority(key)}) {
                     // If threads are waiting on us still then we need to remove the highest priority thread from the queue
-                    auto it{std::min_element(queue.first, queue.second, [](const SyncWaiters::value_type &lhs, const SyncWaiters::value_type &rhs) { return lhs.second->priority < rhs.second->priority; })};
-                    thread = it->second;
+                    thread = waiter->shared_from_this();
                     conditionVariable = thread->waitConditionVariable;
                     #ifndef NDEBUG
                     if (conditionVariable != key)
                         Logger::Warn("Condition variable mismatch: 0x{:X} != 0x{:X}", conditionVariable, key);
                     #endif
 
-                    syncWaiters.erase(it);
+                    bucket.Remove(waiter);
                     waiterCount--;
-                } else if (queue.first == queue.second) {
+                } else {
                     // If we didn't find a thread then we need to clear the boolean flag denoting that there are no more threads waiting on this conditional variable
                     __atomic_store_n(key, false, __ATOMIC_SEQ_CST);
                     break;
@@ -407,8 +466,9 @@ namespace skyline::kernel::type {
     Result KProcess::WaitForAddress(u32 *address, u32 value, i64 timeout, ArbitrationType type) {
         TRACE_EVENT_FMT("kernel", "WaitForAddress 0x{:X}", address);
 
+        auto &bucket{GetSyncWaiterBucket(address)};
         {
-            std::scoped_lock lock{syncWaiterMutex};
+            std::scoped_lock lock{bucket.mutex};
 
             u32 userValue{__atomic_load_n(address, __ATOMIC_SEQ_CST)};
             switch (type) {
@@ -434,8 +494,7 @@ namespace skyline::kernel::type {
             if (timeout == 0) [[unlikely]]
                 return result::TimedOut;
 
-            auto queue{syncWaiters.equal_range(address)};
-            syncWaiters.insert(std::upper_bound(queue.first, queue.second, state.thread->priority.load(), [](const i8 priority, const SyncWaiters::value_type &it) { return it.second->priority > priority; }), {address, state.thread});
+            bucket.Insert(state.thread.get(), address);
 
             state.scheduler->RemoveThread();
         }
@@ -443,13 +502,12 @@ namespace skyline::kernel::type {
         if (timeout > 0 && !state.scheduler->TimedWaitSchedule(std::chrono::nanoseconds(timeout))) {
             bool shouldWait{false};
             {
-                std::scoped_lock lock{syncWaiterMutex};
-                auto queue{syncWaiters.equal_range(address)};
-                auto iterator{std::find(queue.first, queue.second, SyncWaiters::value_type{address, state.thread})};
-                if (iterator != queue.second) {
-                    if (syncWaiters.erase(iterator) == queue.second)
+                std::scoped_lock lock{bucket.mutex};
+                if (state.thread->syncWaitKey == address) {
+                    if (bucket.IsLastWaiter(state.thread.get()))
                         // We need to update the boolean flag denoting that there are no more threads waiting on this address
                         __atomic_store_n(address, false, __ATOMIC_SEQ_CST);
+                    bucket.Remove(state.thread.get());
                 } else {
                     // If we didn't find the thread in the queue then it must have been signalled already and we should just wait
                     shouldWait = true;
@@ -475,22 +533,22 @@ namespace skyline::kernel::type {
     Result KProcess::SignalToAddress(u32 *address, u32 value, i32 amount, SignalType type) {
         TRACE_EVENT_FMT("kernel", "SignalToAddress 0x{:X}", address);
 
-        std::scoped_lock lock{syncWaiterMutex};
-        auto queue{syncWaiters.equal_range(address)};
+        auto &bucket{GetSyncWaiterBucket(address)};
+        std::scoped_lock lock{bucket.mutex};
 
         if (type != SignalType::Signal) {
             u32 newValue{value};
             if (type == SignalType::SignalAndIncrementIfEqual) {
                 newValue++;
             } else if (type == SignalType::SignalAndModifyBasedOnWaitingThreadCountIfEqual) {
+                i32 waiterCount{bucket.CountWaiters(address)};
                 if (amount <= 0) {
-                    if (queue.first != queue.second)
+                    if (waiterCount)
                         newValue -= 2;
                     else
                         newValue++;
                 } else {
-                    if (queue.first != queue.second) {
-                        i32 waiterCount{static_cast<i32>(std::distance(queue.first, queue.second))};
+                    if (waiterCount) {
                         if (waiterCount < amount)
                             newValue--;
                     } else {
@@ -503,20 +561,12 @@ namespace skyline::kernel::type {
                 return result::InvalidState;
         }
 
+        // While threads should generally be inserted in priority order, they may not always be due to the way the kernel handles priority updates
+        // As a result, we need to look up the highest priority thread for every wake to ensure that we wake up the highest priority threads first
         i32 waiterCount{amount};
-        boost::container::small_vector<SyncWaiters::iterator, 10> orderedThreads;
-        for (auto it{queue.first}; it != queue.second; it++) {
-            // While threads should generally be inserted in priority order, they may not always be due to the way the kernel handles priority updates
-            // As a result, we need to create a second list of threads ordered by priority to ensure that we wake up the highest priority threads first
-            auto thread{it->second};
-            orderedThreads.insert(std::upper_bound(orderedThreads.begin(), orderedThreads.end(), thread->priority.load(), [](const i8 priority, const SyncWaiters::iterator &it) { return it->second->priority > priority; }), it);
-        }
-
-        for (auto &it : orderedThreads) {
-            auto thread{it->second};
-
-            syncWaiters.erase(it);
-            state.scheduler->InsertThread(thread);
+        while (auto thread{bucket.FindHighestPriority(address)}) {
+            bucket.Remove(thread);
+            state.scheduler->InsertThread(thread->shared_from_this());
 
             if (--waiterCount == 0 && amount > 0)
                 break;
@@ -30,9 +30,43 @@ namespace skyline {
             std::atomic_bool alreadyKilled{}; //!< If the process has already been killed prior so there's no need to redundantly kill it again
             std::vector<std::shared_ptr<KThread>> threads;
 
-            using SyncWaiters = std::multimap<void *, std::shared_ptr<KThread>>;
-            std::mutex syncWaiterMutex; //!< Synchronizes all mutations to the map to prevent races
-            SyncWaiters syncWaiters; //!< All threads waiting on process-wide synchronization primitives (Atomic keys + Address Arbiter)
+            /**
+             * @brief A bucket of all threads waiting on process-wide synchronization primitives (Atomic keys + Address Arbiter) with keys that hash to it
+             * @note Waiting threads are linked into an intrusive list using their sync waiter members, threads are sorted by their priority at the time of insertion
+             * @note The bucket is aligned to a cache line to avoid false sharing between the mutexes of adjacent buckets
+             */
+            struct alignas(64) SyncWaiterBucket {
+                std::mutex mutex; //!< Synchronizes all mutations of the list and the sync waiter members of threads in it
+                KThread *head{};
+
+                /**
+                 * @brief Inserts a thread into the list after all threads with the same or a higher priority
+                 */
+                void Insert(KThread *thread, void *key);
+
+                void Remove(KThread *thread);
+
+                /**
+                 * @return The highest priority thread waiting on the supplied key or nullptr if there are none
+                 * @note Threads may not be in priority order as their priority can change while waiting, so this doesn't just return the first waiter
+                 */
+                KThread *FindHighestPriority(void *key);
+
+                /**
+                 * @return The amount of threads waiting on the supplied key
+                 */
+                i32 CountWaiters(void *key);
+
+                /**
+                 * @return If there are no threads waiting on the same key as the supplied thread after it in the list
+                 */
+                bool IsLastWaiter(KThread *thread);
+            };
+
+            static constexpr size_t SyncWaiterBucketCount{64}; //!< The amount of buckets sync waiters are spread over, this must be a power of two
+            std::array<SyncWaiterBucket, SyncWaiterBucketCount> syncWaiterBuckets;
+
+            SyncWaiterBucket &GetSyncWaiterBucket(void *key);
 
             /**
             * @brief The status of a single TLS page (A page is 4096 bytes on ARMv8)
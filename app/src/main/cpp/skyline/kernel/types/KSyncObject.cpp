@@ -6,23 +6,9 @@
 
 namespace skyline::kernel::type {
     void KSyncObject::Signal() {
-        std::scoped_lock lock{syncObjectMutex};
-        signalled = true;
-        for (auto &waiter : syncObjectWaiters) {
-            if (waiter->isCancellable) {
-                waiter->isCancellable = false;
-                waiter->wakeObject = this;
-                state.scheduler->InsertThread(waiter);
-            }
-        }
-    }
-
-    bool KSyncObject::ResetSignal() {
-        std::scoped_lock lock{syncObjectMutex};
-        if (signalled) [[likely]] {
-            signalled = false;
-            return true;
-        }
-        return false;
+        SyncWaiterList::Signal([this](KThread *waiter) {
+            waiter->wakeObject = this;
+            state.scheduler->InsertThread(waiter->shared_from_this());
+        });
     }
 }
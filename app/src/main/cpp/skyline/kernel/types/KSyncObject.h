@@ -6,32 +6,123 @@
 #include "KObject.h"
 
 namespace skyline::kernel::type {
+    constexpr size_t MaxSyncWaitObjects{0x40}; //!< The maximum amount of objects a thread can wait on at once in svcWaitSynchronization
+
+    /**
+     * @brief An intrusive node which links a thread into the waiter list of a single synchronization object
+     * @note Every thread has a preallocated node for each object it can wait on at once, so waiting doesn't require any allocations
+     */
+    template<typename ThreadType>
+    struct SyncWaiterNode {
+        ThreadType *thread{}; //!< The thread which is waiting on the object
+        SyncWaiterNode *prev{}, *next{}; //!< The neighbours of this node in the waiter list of the object, these are protected by the mutex of the object
+    };
+
+    using KSyncWaiterNode = SyncWaiterNode<KThread>;
+
+    /**
+     * @brief The signal of a synchronization object along with the list of threads waiting on it
+     * @note This is separate from KSyncObject so that it doesn't depend on the rest of the kernel, waking a thread is left to the caller of Signal()
+     * @note The lock ordering is object mutex -> thread `syncWaitMutex` -> scheduler locks, a thread waiting on multiple objects only ever holds a single object mutex at a time
+     * @tparam ThreadType The type of the waiting threads, this must have the `priority`, `syncWaitMutex` and `isCancellable` members of KThread
+     */
+    template<typename ThreadType>
+    class SyncWaiterList {
+      private:
+        std::mutex syncObjectMutex; //!< Synchronizes signalling this object with the waiter list
+        SyncWaiterNode<ThreadType> *waiterHead{}; //!< The head of an intrusive list of waiter nodes sorted by the priority of their threads
+
+      public:
+        std::atomic<bool> signalled; //!< If the current object is signalled (An object stays signalled till the signal has been explicitly reset), this can be read without locking
+
+        SyncWaiterList(bool presignalled) : signalled{presignalled} {}
+
+        /**
+         * @brief Flips the 'signalled' flag and wakes up any waiters which can still be woken up
+         * @param wake A function which is called with each thread that should be woken up, this is called while holding the `syncWaitMutex` of the thread after it has been made uncancellable
+         */
+        template<typename WakeFunction>
+        void Signal(WakeFunction &&wake) {
+            std::scoped_lock lock{syncObjectMutex};
+            signalled.store(true);
+            for (auto node{waiterHead}; node; node = node->next) {
+                auto waiter{node->thread};
+                std::scoped_lock waiterLock{waiter->syncWaitMutex};
+                if (waiter->isCancellable) {
+                    waiter->isCancellable = false;
+                    wake(waiter);
+                }
+            }
+        }
+
+        /**
+         * @brief Resets the object to an unsignalled state
+         * @return If the signal was reset or not
+         */
+        bool ResetSignal() {
+            // Resetting is done under the lock so it can't interleave with a concurrent Signal() waking the waiters
+            std::scoped_lock lock{syncObjectMutex};
+            return signalled.exchange(false);
+        }
+
+        /**
+         * @brief Inserts the supplied node into the waiter list in the order of the priority of its thread
+         * @return If the object was already signalled, the node isn't inserted in this case
+         */
+        bool AddWaiter(SyncWaiterNode<ThreadType> &node) {
+            std::scoped_lock lock{syncObjectMutex};
+            if (signalled.load())
+                return true;
+
+            auto priority{node.thread->priority.load()};
+            SyncWaiterNode<ThreadType> *prev{}, *next{waiterHead};
+            while (next && next->thread->priority.load() <= priority) {
+                prev = next;
+                next = next->next;
+            }
+
+            node.prev = prev;
+            node.next = next;
+            if (prev)
+                prev->next = &node;
+            else
+                waiterHead = &node;
+            if (next)
+                next->prev = &node;
+            return false;
+        }
+
+        /**
+         * @brief Removes the supplied node from the waiter list
+         */
+        void RemoveWaiter(SyncWaiterNode<ThreadType> &node) {
+            std::scoped_lock lock{syncObjectMutex};
+            if (node.prev)
+                node.prev->next = node.next;
+            else
+                waiterHead = node.next;
+            if (node.next)
+                node.next->prev = node.prev;
+            node.prev = node.next = nullptr;
+        }
+    };
+
     /**
      * @brief KSyncObject is an abstract class which holds everything necessary for an object to be synchronizable
      * @note This abstraction is roughly equivalent to KSynchronizationObject on HOS
      */
-    class KSyncObject : public KObject {
+    class KSyncObject : public KObject, public SyncWaiterList<KThread> {
       public:
-        inline static std::mutex syncObjectMutex; //!< A global lock used for locking all signalling to avoid races
-        std::list<std::shared_ptr<KThread>> syncObjectWaiters; //!< A list of threads waiting on this object to be signalled
-        bool signalled; //!< If the current object is signalled (An object stays signalled till the signal has been explicitly reset)
-
         /**
          * @param presignalled If this object should be signalled initially or not
          */
-        KSyncObject(const DeviceState &state, skyline::kernel::type::KType type, bool presignalled = false) : KObject(state, type), signalled(presignalled) {};
+        KSyncObject(const DeviceState &state, skyline::kernel::type::KType type, bool presignalled = false) : KObject(state, type), SyncWaiterList(presignalled) {};
 
         /**
          * @brief Wakes up any waiters on this object and flips the 'signalled' flag
          */
         void Signal();
 
-        /**
-         * @brief Resets the object to an unsignalled state
-         * @return If the signal was reset or not
-         */
-        bool ResetSignal();
-
         virtual ~KSyncObject() = default;
     };
 }
@@ -58,6 +58,10 @@ namespace skyline {
             u64 timesliceStart{}; //!< A timestamp in host CNTVCT ticks of when the thread's current timeslice started
             u64 averageTimeslice{}; //!< A weighted average of the timeslice duration for this thread
 
+            KThread *runQueuePrev{}, *runQueueNext{}; //!< The neighbours of this thread in the priority list of its resident core's scheduler queue
+            i8 runQueuePriority{-1}; //!< The priority level of the scheduler priority list this thread is in or -1 if it isn't in one, this is tracked separately as the priority of the thread can change while it's in a list
+            u64 runQueueTimeslice{}; //!< The estimated timeslice this thread contributes to its scheduler priority list
+
             bool isPreempted{}; //!< If the preemption timer has been armed and will fire
             bool pendingYield{}; //!< If the thread has been yielded and hasn't been acted upon it yet
             bool forceYield{}; //!< If the thread has been forcefully yielded by another thread
@@ -71,9 +75,14 @@ namespace skyline {
             bool waitSignalled{}; //!< If the conditional variable has been signalled already
             Result waitResult; //!< The result of the wait operation
 
+            void *syncWaitKey{}; //!< The key of the process-wide synchronization primitive this thread is waiting on, this is nullptr if the thread isn't in any KProcess sync waiter bucket
+            KThread *syncWaitPrev{}, *syncWaitNext{}; //!< The neighbours of this thread in its sync waiter bucket, these are protected by the mutex of the bucket
+
+            std::mutex syncWaitMutex; //!< Synchronizes waking this thread from svcWaitSynchronization, this protects `isCancellable` and `wakeObject`
             bool isCancellable{false}; //!< If the thread is currently in a position where it's cancellable
-            bool cancelSync{false}; //!< Whether to cancel the SvcWaitSynchronization call this thread currently is in/the next one it joins
+            std::atomic<bool> cancelSync{false}; //!< Whether to cancel the SvcWaitSynchronization call this thread currently is in/the next one it joins, this is only set while holding `syncWaitMutex`
             type::KSyncObject *wakeObject{}; //!< A pointer to the synchronization object responsible for waking this thread up
+            std::array<KSyncWaiterNode, MaxSyncWaitObjects> syncWaiterNodes{}; //!< The nodes linking this thread into the waiter lists of the objects it's waiting on in svcWaitSynchronization
 
             bool isPaused{false}; //!< If the thread is currently paused and not runnable
             bool insertThreadOnResume{false}; //!< If the thread should be inserted into the scheduler when it resumes (used for pausing threads during sleep/sync)
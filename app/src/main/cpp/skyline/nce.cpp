@@ -194,50 +194,6 @@ namespace skyline::nce {
         }
     }
 
-    static NCE *staticNce{nullptr}; //!< A static instance of NCE for use in the signal handler
-
-    void NCE::HostSignalHandler(int signal, siginfo *info, ucontext *ctx) {
-        if (signal == SIGSEGV) {
-            if (staticNce && staticNce->TrapHandler(reinterpret_cast<u8 *>(info->si_addr), true))
-                return;
-
-            bool runningUnderDebugger{[]() {
-                static std::ifstream status("/proc/self/status");
-                status.seekg(0);
-
-                constexpr std::string_view TracerPidTag{"TracerPid:"};
-                for (std::string line; std::getline(status, line);) {
-                    if (line.starts_with(TracerPidTag)) {
-                        line = line.substr(TracerPidTag.size());
-
-                        for (char character : line)
-                            if (std::isspace(character))
-                                continue;
-                            else
-                                return character != '0';
-
-                        return false;
-                    }
-                }
-
-                return false;
-            }()};
-
-            if (runningUnderDebugger) {
-                /* Variables for debugger, these are meant to be read and utilized by the debugger to break in user code with all registers intact */
-                void *pc{reinterpret_cast<void *>(ctx->uc_mcontext.pc)}; // Use 'p pc' to get the value of this and 'breakpoint set -t current -a ${value of pc}' to break in user code
-                bool shouldReturn{true}; // Set this to false to throw an exception instead of returning
-
-                raise(SIGTRAP); // Notify the debugger if we've got a SIGSEGV as the debugger doesn't catch them by default as they might be hooked
-
-                if (shouldReturn)
-                    return;
-            }
-        }
-
-        signal::ExceptionalSignalHandler(signal, info, ctx); // Delegate throwing a host exception to the exceptional signal handler
-    }
-
     void *NceTlsRestorer() {
         ThreadContext *threadCtx;
         asm volatile("MRS %x0, TPIDR_EL0":"=r"(threadCtx));
@@ -249,11 +205,15 @@ namespace skyline::nce {
 
     NCE::NCE(const DeviceState &state) : state(state) {
         signal::SetTlsRestorer(&NceTlsRestorer);
-        staticNce = this;
+        hostTrapManager = this;
     }
 
     NCE::~NCE() {
-        staticNce = nullptr;
+        if (userfaultfdThread.joinable()) {
+            userfaultfd.Exit();
+            userfaultfdThread.join();
+        }
+        hostTrapManager = nullptr;
     }
 
     constexpr size_t TrampolineSize{18}; // Size of the main SVC trampoline function in u32 units
@@ -612,151 +572,269 @@ namespace skyline::nce {
         }
     }
 
-    NCE::CallbackEntry::CallbackEntry(TrapProtection protection, LockCallback lockCallback, TrapCallback readCallback, TrapCallback writeCallback) : protection{protection}, lockCallback{std::move(lockCallback)}, readCallback{std::move(readCallback)}, writeCallback{std::move(writeCallback)} {}
+    NCE::TrapGroup::TrapGroup(span<span<u8>> regions, LockCallback lockCallback, TrapCallback readCallback, TrapCallback writeCallback) : lockCallback{std::move(lockCallback)}, readCallback{std::move(readCallback)}, writeCallback{std::move(writeCallback)} {
+        intervals.reserve(regions.size());
+        for (const auto &region : regions)
+            intervals.emplace_back(util::AlignDown(region.data(), constant::PageSize), util::AlignUp(region.end().base(), constant::PageSize));
+    }
 
-    void NCE::ReprotectIntervals(const std::vector<TrapMap::Interval> &intervals, TrapProtection protection) {
-        TRACE_EVENT("host", "NCE::ReprotectIntervals");
+    void NCE::TrapGroupSet::lock() {
+        for (auto group : groups)
+            group->mutex.lock();
+    }
 
-        auto reprotectIntervalsWithFunction = [&intervals](auto getProtection) {
-            for (auto region : intervals) {
-                region = region.Align(constant::PageSize);
-                mprotect(region.start, region.Size(), getProtection(region));
-            }
-        };
-
-        // We need to determine the lowest protection possible for the given interval
-        if (protection == TrapProtection::None) {
-            reprotectIntervalsWithFunction([&](auto region) {
-                auto entries{trapMap.GetRange(region)};
-
-                TrapProtection lowestProtection{TrapProtection::None};
-                for (const auto &entry : entries) {
-                    auto entryProtection{entry.get().protection};
-                    if (entryProtection > lowestProtection) {
-                        lowestProtection = entryProtection;
-                        if (entryProtection == TrapProtection::ReadWrite)
-                            return PROT_NONE;
-                    }
-                }
+    void NCE::TrapGroupSet::unlock() {
+        for (auto group{groups.rbegin()}; group != groups.rend(); group++)
+            (*group)->mutex.unlock();
+    }
 
-                switch (lowestProtection) {
-                    case TrapProtection::None:
-                        return PROT_READ | PROT_WRITE | PROT_EXEC;
-                    case TrapProtection::WriteOnly:
-                        return PROT_READ | PROT_EXEC;
-                    case TrapProtection::ReadWrite:
-                        return PROT_NONE;
-                }
-            });
-        } else if (protection == TrapProtection::WriteOnly) {
-            reprotectIntervalsWithFunction([&](auto region) {
-                auto entries{trapMap.GetRange(region)};
-                for (const auto &entry : entries)
-                    if (entry.get().protection == TrapProtection::ReadWrite)
-                        return PROT_NONE;
+    void NCE::InitializeTrapBackend() {
+        trapBackendInitialized = true;
+
+        // The entire address space is registered upfront as registering a range splits the VMAs at its boundaries
+        auto &memory{state.process->memory};
+        std::array<span<u8>, 2> regions{memory.codeBase36Bit, memory.base};
+        if (!userfaultfd.Initialize(regions))
+            return;
 
+        trapBackend = TrapBackend::UserfaultfdWriteProtect;
+        userfaultfdThread = std::thread(&NCE::UserfaultfdThread, this);
+        Logger::Info("Using userfaultfd write-protection for trapping guest memory");
+    }
+
+    void NCE::UserfaultfdThread() {
+        if (int result{pthread_setname_np(pthread_self(), "Sky-Userfaultfd")})
+            Logger::Warn("Failed to set the thread name: {}", strerror(result));
+
+        signal::SetSignalHandler({SIGSEGV}, HostSignalHandler); // Callbacks may access trapped memory
+
+        userfaultfd.Run([this](u8 *page) {
+            if (!TrapHandler(page, true, true))
+                // The page isn't trapped anymore but the faulting thread still needs to be woken up
+                userfaultfd.WriteProtect(span<u8>{page, constant::PageSize}, false);
+        });
+    }
+
+    void NCE::ProtectPages(span<u8> pages, TrapProtection protection) {
+        if (trapBackend == TrapBackend::UserfaultfdWriteProtect) {
+            // Write-protection is applied before the pages are made writable and cleared after so writes can't be missed, mprotect returns early without splitting any VMAs when the protection doesn't change which is the common case here
+            if (protection == TrapProtection::WriteOnly)
+                userfaultfd.WriteProtect(pages, true);
+            mprotect(pages.data(), pages.size(), protection == TrapProtection::ReadWrite ? PROT_NONE : PROT_READ | PROT_WRITE | PROT_EXEC);
+            if (protection == TrapProtection::None)
+                userfaultfd.WriteProtect(pages, false);
+        } else {
+            mprotect(pages.data(), pages.size(), GetHostProtection(protection));
+        }
+    }
+
+    int NCE::GetHostProtection(TrapProtection protection) {
+        switch (protection) {
+            case TrapProtection::None:
+                return PROT_READ | PROT_WRITE | PROT_EXEC;
+            case TrapProtection::WriteOnly:
                 return PROT_READ | PROT_EXEC;
+            case TrapProtection::ReadWrite:
+                return PROT_NONE;
+        }
+    }
+
+    NCE::TrapProtection NCE::GetProtection(const TrapGroupSet &set) {
+        TrapProtection highestProtection{TrapProtection::None};
+        for (auto group : set.groups)
+            highestProtection = std::max(highestProtection, group->protection);
+        return highestProtection;
+    }
+
+    /**
+     * @brief Calls the supplied callback with every run of consecutive pages in the interval that point to the same trap group set in the table
+     */
+    template<typename TableType>
+    static void ForEachTrapRun(const TableType &table, span<u8> interval, auto callback) {
+        u8 *runStart{interval.data()}, *end{interval.end().base()};
+        while (runStart < end) {
+            auto set{table[runStart]};
+            u8 *runEnd{runStart + constant::PageSize};
+            while (runEnd < end && table[runEnd] == set)
+                runEnd += constant::PageSize;
+
+            callback(span<u8>{runStart, runEnd}, set);
+            runStart = runEnd;
+        }
+    }
+
+    void NCE::UpdateTrapTable(TrapGroup &group, bool insert) {
+        for (auto interval : group.intervals) {
+            ForEachTrapRun(trapTable, interval, [&](span<u8> run, TrapGroupSet *set) {
+                std::vector<TrapGroup *> groups{set ? set->groups : std::vector<TrapGroup *>{}};
+                auto position{std::lower_bound(groups.begin(), groups.end(), &group)};
+                if (insert == (position != groups.end() && *position == &group))
+                    return; // Intervals of the same group may cover the same page, it only needs to be added or removed once
+
+                if (insert)
+                    groups.insert(position, &group);
+                else
+                    groups.erase(position);
+
+                size_t pageCount{run.size() / constant::PageSize};
+                if (set && (set->pageCount -= pageCount) == 0)
+                    trapGroupSets.erase(trapGroupSets.find(set->groups));
+
+                TrapGroupSet *newSet{};
+                if (!groups.empty()) {
+                    auto &entry{trapGroupSets[groups]};
+                    if (!entry)
+                        entry = std::make_unique<TrapGroupSet>(TrapGroupSet{.groups = groups});
+                    entry->pageCount += pageCount;
+                    newSet = entry.get();
+                }
+
+                trapTable.Set(run.data(), run.end().base(), newSet);
             });
-        } else if (protection == TrapProtection::ReadWrite) {
-            reprotectIntervalsWithFunction([&](auto region) {
-                return PROT_NONE; // No checks are needed as this is already the highest level of protection
-            });
         }
     }
 
-    bool NCE::TrapHandler(u8 *address, bool write) {
+    void NCE::ReprotectGroup(TrapGroup &group, TrapProtection protection) {
+        TRACE_EVENT("host", "NCE::ReprotectGroup");
+
+        {
+            std::scoped_lock lock{group.mutex};
+            group.protection = protection;
+
+            // Pages which are only covered by this group don't depend on the protection of any other groups
+            for (auto interval : group.intervals)
+                ForEachTrapRun(trapTable, interval, [&](span<u8> run, TrapGroupSet *set) {
+                    if (set->groups.size() == 1)
+                        ProtectPages(run, protection);
+                });
+        }
+
+        // Pages which are shared with other groups are reprotected while holding the locks of all groups covering them
+        for (auto interval : group.intervals)
+            ForEachTrapRun(trapTable, interval, [&](span<u8> run, TrapGroupSet *set) {
+                if (set->groups.size() > 1) {
+                    std::scoped_lock lock{*set};
+                    ProtectPages(run, GetProtection(*set));
+                }
+            });
+    }
+
+    bool NCE::TrapHandler(u8 *address, bool write, bool deferBlocking) {
         TRACE_EVENT("host", "NCE::TrapHandler");
+        auto startTime{util::GetTimeNs()};
 
         LockCallback lockCallback{};
         while (true) {
             if (lockCallback) {
-                // We want to avoid a deadlock of holding trapMutex while locking the resource inside a callback while another thread holding the resource's mutex waits on trapMutex, we solve this by quitting the loop if a callback would be blocking and attempt to lock the resource externally
+                // We want to avoid a deadlock of holding the group locks while locking the resource inside a callback while another thread holding the resource's mutex waits on a group lock, we solve this by quitting the loop if a callback would be blocking and attempt to lock the resource externally
                 lockCallback();
                 lockCallback = {};
             }
 
-            std::scoped_lock lock(trapMutex);
+            std::shared_lock tableLock{trapTableMutex};
 
-            // Retrieve any callbacks for the page that was faulted
-            auto[entries, intervals]{trapMap.GetAlignedRecursiveRange<constant::PageSize>(address)};
-            if (entries.empty())
+            // Retrieve the groups covering the page that was faulted
+            auto set{trapTable[address]};
+            if (!set)
                 return false; // There's no callbacks associated with this page
 
-            // Do callbacks for every entry in the intervals
+            std::scoped_lock groupLock{*set};
+
+            // Do callbacks for every group covering the page
+            auto deferToSignal{[&] {
+                // The faulted page is made read-only and its write-protection is cleared which wakes the faulting thread, it'll fault again with a SIGSEGV and handle the trap itself
+                // Any protection changes made after this will restore the page to using write-protection
+                u8 *page{util::AlignDown(address, constant::PageSize)};
+                mprotect(page, constant::PageSize, PROT_READ | PROT_EXEC);
+                userfaultfd.WriteProtect(span<u8>{page, constant::PageSize}, false);
+            }};
+
             if (write) {
-                for (auto entryRef : entries) {
-                    auto &entry{entryRef.get()};
-                    if (entry.protection == TrapProtection::None)
-                        // We don't need to do the callback if the entry doesn't require any protection already
+                for (auto group : set->groups) {
+                    if (group->protection == TrapProtection::None)
+                        // We don't need to do the callback if the group doesn't require any protection already
                         continue;
 
-                    if (!entry.writeCallback()) {
-                        lockCallback = entry.lockCallback;
+                    if (!group->writeCallback()) {
+                        lockCallback = group->lockCallback;
                         break;
                     }
-                    entry.protection = TrapProtection::None; // We don't need to protect this entry anymore
+                    group->protection = TrapProtection::None; // We don't need to protect this group anymore
                 }
-                if (lockCallback)
+                if (lockCallback) {
+                    if (deferBlocking) {
+                        deferToSignal();
+                        return true;
+                    }
                     continue; // We need to retry the loop because a callback was blocking
+                }
             } else {
-                bool allNone{true}; // If all entries require no protection, we can protect to allow all accesses
-                for (auto entryRef : entries) {
-                    auto &entry{entryRef.get()};
-                    if (entry.protection < TrapProtection::ReadWrite) {
-                        // We don't need to do the callback if the entry can already handle read accesses
-                        allNone = allNone && entry.protection == TrapProtection::None;
+                for (auto group : set->groups) {
+                    if (group->protection < TrapProtection::ReadWrite)
+                        // We don't need to do the callback if the group can already handle read accesses
                         continue;
-                    }
 
-                    if (!entry.readCallback()) {
-                        lockCallback = entry.lockCallback;
+                    if (!group->readCallback()) {
+                        lockCallback = group->lockCallback;
                         break;
                     }
-                    entry.protection = TrapProtection::WriteOnly; // We only need to trap writes to this entry
+                    group->protection = TrapProtection::WriteOnly; // We only need to trap writes to this group
                 }
                 if (lockCallback)
                     continue; // We need to retry the loop because a callback was blocking
-                write = allNone;
             }
 
-            int permission{PROT_READ | (write ? PROT_WRITE : 0) | PROT_EXEC};
-            for (const auto &interval : intervals)
-                // Reprotect the interval to the lowest protection level that the callbacks performed allow
-                mprotect(interval.start, interval.Size(), permission);
+            // Reprotect all pages covered by the groups on the faulted page to the lowest protection level that the callbacks performed allow, this avoids faulting on every page of a group separately
+            // Pages shared with any groups that aren't locked are left as-is, they'll be reprotected when they're faulted on or when the group is reprotected
+            for (auto group : set->groups) {
+                for (auto interval : group->intervals) {
+                    ForEachTrapRun(trapTable, interval, [&](span<u8> run, TrapGroupSet *runSet) {
+                        if (runSet == set)
+                            ProtectPages(run, GetProtection(*set));
+                        else if (runSet->groups.size() == 1)
+                            ProtectPages(run, group->protection);
+                    });
+                }
+            }
 
+            TRACE_COUNTER("host", "NCE Trap Faults", trapFaultCount.fetch_add(1, std::memory_order_relaxed) + 1);
+            TRACE_COUNTER("host", "NCE Trap Handler Latency", util::GetTimeNs() - startTime);
             return true;
         }
     }
 
-    constexpr NCE::TrapHandle::TrapHandle(const TrapMap::GroupHandle &handle) : TrapMap::GroupHandle(handle) {}
+    bool NCE::HandleHostFault(u8 *address) {
+        return TrapHandler(address, true);
+    }
 
     NCE::TrapHandle NCE::CreateTrap(span<span<u8>> regions, const LockCallback &lockCallback, const TrapCallback &readCallback, const TrapCallback &writeCallback) {
         TRACE_EVENT("host", "NCE::CreateTrap");
-        std::scoped_lock lock{trapMutex};
-        TrapHandle handle{trapMap.Insert(regions, CallbackEntry{TrapProtection::None, lockCallback, readCallback, writeCallback})};
-        return handle;
+        std::scoped_lock lock{trapTableMutex};
+        if (!trapBackendInitialized)
+            InitializeTrapBackend();
+
+        auto group{std::make_unique<TrapGroup>(regions, lockCallback, readCallback, writeCallback)};
+        UpdateTrapTable(*group, true);
+        return TrapHandle{trapGroups.emplace(group.get(), std::move(group)).first->first};
     }
 
     void NCE::TrapRegions(TrapHandle handle, bool writeOnly) {
         TRACE_EVENT("host", "NCE::TrapRegions");
-        std::scoped_lock lock{trapMutex};
-        auto protection{writeOnly ? TrapProtection::WriteOnly : TrapProtection::ReadWrite};
-        handle->value.protection = protection;
-        ReprotectIntervals(handle->intervals, protection);
+        std::shared_lock lock{trapTableMutex};
+        ReprotectGroup(GetGroup(handle), writeOnly ? TrapProtection::WriteOnly : TrapProtection::ReadWrite);
     }
 
     void NCE::RemoveTrap(TrapHandle handle) {
         TRACE_EVENT("host", "NCE::RemoveTrap");
-        std::scoped_lock lock{trapMutex};
-        handle->value.protection = TrapProtection::None;
-        ReprotectIntervals(handle->intervals, TrapProtection::None);
+        std::shared_lock lock{trapTableMutex};
+        ReprotectGroup(GetGroup(handle), TrapProtection::None);
     }
 
     void NCE::DeleteTrap(TrapHandle handle) {
         TRACE_EVENT("host", "NCE::DeleteTrap");
-        std::scoped_lock lock{trapMutex};
-        handle->value.protection = TrapProtection::None;
-        ReprotectIntervals(handle->intervals, TrapProtection::None);
-        trapMap.Remove(handle);
+        std::scoped_lock lock{trapTableMutex};
+        ReprotectGroup(GetGroup(handle), TrapProtection::None);
+        UpdateTrapTable(GetGroup(handle), false);
+        trapGroups.erase(static_cast<TrapGroup *>(handle.group));
     }
 }
@@ -7,13 +7,17 @@
 #include <linux/elf.h>
 #include "common.h"
 #include "hle/symbol_hooks.h"
-#include "common/interval_map.h"
+#include "common/segment_table.h"
+#include "common/spin_lock.h"
+#include "common/file_descriptor.h"
+#include "nce/userfaultfd.h"
+#include "nce/trap_manager.h"
 
 namespace skyline::nce {
     /**
      * @brief The NCE (Native Code Execution) class is responsible for managing state relevant to the layer between the host and guest
      */
-    class NCE {
+    class NCE : public TrapManager {
       private:
         const DeviceState &state;
 
@@ -28,27 +32,98 @@ namespace skyline::nce {
             ReadWrite = 2, //!< Both read and write protection are required
         };
 
-        using TrapCallback = std::function<bool()>;
-        using LockCallback = std::function<void()>;
-
-        struct CallbackEntry {
-            TrapProtection protection; //!< The least restrictive protection that this callback needs to have
+        /**
+         * @brief A group of trapped regions which share the same callbacks
+         */
+        struct TrapGroup {
+            std::mutex mutex; //!< Synchronizes the protection of the group and the host protection of any pages covered by it, the locks of multiple groups must be acquired in the order of their addresses
+            TrapProtection protection{TrapProtection::None}; //!< The least restrictive protection that the callbacks of this group need to have
             LockCallback lockCallback;
             TrapCallback readCallback, writeCallback;
+            std::vector<span<u8>> intervals; //!< The page-aligned regions of memory covered by this group
+
+            TrapGroup(span<span<u8>> regions, LockCallback lockCallback, TrapCallback readCallback, TrapCallback writeCallback);
+        };
+
+        /**
+         * @brief A unique set of trap groups that cover a page, pages with the same groups share the same set
+         */
+        struct TrapGroupSet {
+            std::vector<TrapGroup *> groups; //!< The groups covering the page sorted by their addresses, this is the order their locks must be acquired in
+            size_t pageCount{}; //!< The amount of pages in the trap table which point to this set
+
+            void lock();
+
+            void unlock();
+        };
+
+        std::unordered_map<TrapGroup *, std::unique_ptr<TrapGroup>> trapGroups; //!< All trap groups that have been created, the groups are heap allocated as they must have stable addresses
+        std::map<std::vector<TrapGroup *>, std::unique_ptr<TrapGroupSet>> trapGroupSets; //!< All sets of trap groups that are referenced by the trap table
+        SegmentTable<TrapGroupSet *, constant::AddressSpaceSize, constant::PageSizeBits, 21> trapTable; //!< A page table which maps every trapped page to the set of trap groups covering it
+        SharedSpinLock trapTableMutex; //!< Synchronizes the trap table and the trap group sets, it's locked in shared mode by the trap handler and when reprotecting groups while creating and deleting groups requires exclusive access
+
+        std::atomic<u64> trapFaultCount{}; //!< The total amount of faults that have been handled by the trap handler, this is exposed as a trace counter
 
-            CallbackEntry(TrapProtection protection, LockCallback lockCallback, TrapCallback readCallback, TrapCallback writeCallback);
+        /**
+         * @brief The mechanism used by the kernel to notify us of accesses to trapped pages
+         */
+        enum class TrapBackend {
+            Mprotect, //!< All accesses are trapped by changing the protection of pages and handling the resulting SIGSEGV on the accessing thread
+            UserfaultfdWriteProtect, //!< Writes are trapped by write-protecting pages with userfaultfd and handled on a dedicated thread, this avoids splitting VMAs and a signal round trip for write-only traps while read traps still use mprotect
         };
 
-        std::mutex trapMutex; //!< Synchronizes the accesses to the trap map
-        using TrapMap = IntervalMap<u8*, CallbackEntry>;
-        TrapMap trapMap; //!< A map of all intervals and corresponding callbacks that have been registered
+        TrapBackend trapBackend{TrapBackend::Mprotect}; //!< The backend used for trapping, this is selected on the first trap creation as it requires the guest address space to be initialized
+        bool trapBackendInitialized{}; //!< If the trap backend has been selected, this is protected by the trap table mutex
+        nce::Userfaultfd userfaultfd; //!< The userfaultfd that the guest address space is registered with for write-protection
+        std::thread userfaultfdThread; //!< A thread that handles write-protection faults delivered by the userfaultfd
 
         /**
-         * @brief Reprotects the intervals to the least restrictive protection given the supplied protection
+         * @brief Selects the trap backend, the userfaultfd backend is used if the kernel supports write-protecting shared memory while the mprotect backend is used as a fallback
+         * @note The trap table mutex must be locked exclusively
          */
-        void ReprotectIntervals(const std::vector<TrapMap::Interval>& intervals, TrapProtection protection);
+        void InitializeTrapBackend();
 
-        bool TrapHandler(u8* address, bool write);
+        void UserfaultfdThread();
+
+        /**
+         * @brief Applies the supplied protection to the host pages using the trap backend
+         */
+        void ProtectPages(span<u8> pages, TrapProtection protection);
+
+        /**
+         * @return The host protection for pages covered by a group with the supplied protection when using the mprotect backend
+         */
+        static int GetHostProtection(TrapProtection protection);
+
+        /**
+         * @return The most restrictive protection of all groups in the supplied set, all groups in the set must be locked
+         */
+        static TrapProtection GetProtection(const TrapGroupSet &set);
+
+        /**
+         * @brief Adds or removes a group from the sets of all pages that it covers in the trap table
+         * @note The trap table mutex must be locked exclusively
+         */
+        void UpdateTrapTable(TrapGroup &group, bool insert);
+
+        /**
+         * @brief Sets the protection of a group and reprotects all pages covered by it to the least restrictive protection possible given all groups covering them
+         * @note The trap table mutex must be locked in shared mode
+         */
+        void ReprotectGroup(TrapGroup &group, TrapProtection protection);
+
+        /**
+         * @brief Does the callbacks of all groups covering the page and reprotects the pages covered by them
+         * @param deferBlocking If a callback would block, hand the page over to the mprotect backend so the access faults again with a SIGSEGV on the accessing thread rather than blocking the calling thread, this is used by the userfaultfd thread as it must not wait on a resource that could be held by a thread that's blocked on a fault
+         * @return If the page was trapped
+         */
+        bool TrapHandler(u8* address, bool write, bool deferBlocking = false);
+
+        bool HandleHostFault(u8 *address) override;
+
+        static TrapGroup &GetGroup(TrapHandle handle) {
+            return *static_cast<TrapGroup *>(handle.group);
+        }
 
         static void SvcHandler(u16 svcId, ThreadContext *ctx);
 
@@ -87,18 +162,12 @@ namespace skyline::nce {
          */
         static void SignalHandler(int signal, siginfo *info, ucontext *ctx, void **tls);
 
-        /**
-         * @brief Handles signals for any host threads which may access NCE trapped memory
-         * @note Any untrapped SIGSEGVs will emit SIGTRAP when a debugger is attached rather than throwing an exception
-         */
-        static void HostSignalHandler(int signal, siginfo *info, ucontext *ctx);
-
         /**
          * @note There should only be one instance of NCE concurrently
          */
         NCE(const DeviceState &state);
 
-        ~NCE();
+        ~NCE() override;
 
         struct PatchData {
             size_t size; //!< Size of the .patch section
@@ -124,40 +193,12 @@ namespace skyline::nce {
 
         void WriteHookSection(span<HookedSymbolEntry> entries, span<u32> hookSection);
 
-        /**
-         * @brief An opaque handle to a group of trapped region
-         */
-        class TrapHandle : private TrapMap::GroupHandle {
-            constexpr TrapHandle(const TrapMap::GroupHandle &handle);
-
-            friend NCE;
-        };
-
-        /**
-         * @brief Creates a region of guest memory that can be trapped with a callback for when an access to it has been made
-         * @param lockCallback A callback to lock the resource that is being trapped, it must block until the resource is locked but unlock it prior to returning
-         * @param readCallback A callback for read accesses to the trapped region, it must not block and return a boolean if it would block
-         * @param writeCallback A callback for write accesses to the trapped region, it must not block and return a boolean if it would block
-         * @note The handle **must** be deleted using DeleteTrap before the NCE instance is destroyed
-         * @note It is UB to supply a region of host memory rather than guest memory
-         * @note This doesn't trap the region in itself, any trapping must be done via TrapRegions(...)
-         */
-        TrapHandle CreateTrap(span<span<u8>> regions, const LockCallback& lockCallback, const TrapCallback& readCallback, const TrapCallback& writeCallback);
+        TrapHandle CreateTrap(span<span<u8>> regions, const LockCallback &lockCallback, const TrapCallback &readCallback, const TrapCallback &writeCallback) override;
 
-        /**
-         * @brief Re-traps a region of memory after protections were removed
-         * @param writeOnly If the trap is optimally for write-only accesses, this is not guarenteed
-         */
-        void TrapRegions(TrapHandle handle, bool writeOnly);
+        void TrapRegions(TrapHandle handle, bool writeOnly) override;
 
-        /**
-         * @brief Removes protections from a region of memory
-         */
-        void RemoveTrap(TrapHandle handle);
+        void RemoveTrap(TrapHandle handle) override;
 
-        /**
-         * @brief Deletes a trap handle and removes the protection from the region
-         */
-        void DeleteTrap(TrapHandle handle);
+        void DeleteTrap(TrapHandle handle) override;
     };
 }
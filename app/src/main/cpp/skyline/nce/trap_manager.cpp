@@ -0,0 +1,50 @@
+// SPDX-License-Identifier: MPL-2.0
+// Copyright © 2022 Skyline Team and Contributors (https://github.com/skyline-emu/)
+
+#include <fstream>
+#include <common/signal.h>
+#include "trap_manager.h"
+
+namespace skyline::nce {
+    void TrapManager::HostSignalHandler(int signal, siginfo *info, ucontext *ctx) {
+        if (signal == SIGSEGV) {
+            if (hostTrapManager && hostTrapManager->HandleHostFault(reinterpret_cast<u8 *>(info->si_addr)))
+                return;
+
+            bool runningUnderDebugger{[]() {
+                static std::ifstream status("/proc/self/status");
+                status.seekg(0);
+
+                constexpr std::string_view TracerPidTag{"TracerPid:"};
+                for (std::string line; std::getline(status, line);) {
+                    if (line.starts_with(TracerPidTag)) {
+                        line = line.substr(TracerPidTag.size());
+
+                        for (char character : line)
+                            if (std::isspace(character))
+                                continue;
+                            else
+                                return character != '0';
+
+                        return false;
+                    }
+                }
+
+                return false;
+            }()};
+
+            if (runningUnderDebugger) {
+                /* Variables for debugger, these are meant to be read and utilized by the debugger to break in user code with all registers intact */
+                void *pc{reinterpret_cast<void *>(ctx->uc_mcontext.pc)}; // Use 'p pc' to get the value of this and 'breakpoint set -t current -a ${value of pc}' to break in user code
+                bool shouldReturn{true}; // Set this to false to throw an exception instead of returning
+
+                raise(SIGTRAP); // Notify the debugger if we've got a SIGSEGV as the debugger doesn't catch them by default as they might be hooked
+
+                if (shouldReturn)
+                    return;
+            }
+        }
+
+        signal::ExceptionalSignalHandler(signal, info, ctx); // Delegate throwing a host exception to the exceptional signal handler
+    }
+}
@@ -0,0 +1,70 @@
+// SPDX-License-Identifier: MPL-2.0
+// Copyright © 2022 Skyline Team and Contributors (https://github.com/skyline-emu/)
+
+#pragma once
+
+#include <common.h>
+
+namespace skyline::nce {
+    /**
+     * @brief An interface for trapping host accesses to guest memory, this is used by GPU resources that are backed by guest memory to synchronize their host copies
+     * @note NCE implements this by protecting the guest pages, the GPU doesn't depend on NCE directly so it can be used without any guest code executing
+     */
+    class TrapManager {
+      protected:
+        static inline TrapManager *hostTrapManager{}; //!< The trap manager that handles host faults on trapped memory in HostSignalHandler, there should only be one at a time
+
+        /**
+         * @brief Handles a write fault from a host thread on a page that might be trapped
+         * @return If the page was trapped and the faulting access can be retried
+         */
+        virtual bool HandleHostFault(u8 *address) = 0;
+
+      public:
+        using TrapCallback = std::function<bool()>;
+        using LockCallback = std::function<void()>;
+
+        /**
+         * @brief An opaque handle to a group of trapped regions
+         */
+        struct TrapHandle {
+            void *group; //!< The implementation-defined group of trapped regions
+        };
+
+        virtual ~TrapManager() = default;
+
+        /**
+         * @brief Handles signals for any host threads which may access trapped memory
+         * @note Any untrapped SIGSEGVs will emit SIGTRAP when a debugger is attached rather than throwing an exception
+         */
+        static void HostSignalHandler(int signal, siginfo *info, ucontext *ctx);
+
+        /**
+         * @brief Creates a region of guest memory that can be trapped with a callback for when an access to it has been made
+         * @param lockCallback A callback to lock the resource that is being trapped, it must block until the resource is locked but unlock it prior to returning
+         * @param readCallback A callback for read accesses to the trapped region, it must not block and return a boolean if it would block
+         * @param writeCallback A callback for write accesses to the trapped region, it must not block and return a boolean if it would block
+         * @note The handle **must** be deleted using DeleteTrap before the trap manager is destroyed
+         * @note It is UB to supply a region of host memory rather than guest memory
+         * @note The callbacks may be called on a dedicated thread, they must not write to trapped guest memory directly and should write to a mirror instead
+         * @note This doesn't trap the region in itself, any trapping must be done via TrapRegions(...)
+         */
+        virtual TrapHandle CreateTrap(span<span<u8>> regions, const LockCallback &lockCallback, const TrapCallback &readCallback, const TrapCallback &writeCallback) = 0;
+
+        /**
+         * @brief Re-traps a region of memory after protections were removed
+         * @param writeOnly If the trap is optimally for write-only accesses, this is not guarenteed
+         */
+        virtual void TrapRegions(TrapHandle handle, bool writeOnly) = 0;
+
+        /**
+         * @brief Removes protections from a region of memory
+         */
+        virtual void RemoveTrap(TrapHandle handle) = 0;
+
+        /**
+         * @brief Deletes a trap handle and removes the protection from the region
+         */
+        virtual void DeleteTrap(TrapHandle handle) = 0;
+    };
+}
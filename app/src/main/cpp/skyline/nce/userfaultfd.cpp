@@ -0,0 +1,113 @@
+// SPDX-License-Identifier: MPL-2.0
+// Copyright © 2022 Skyline Team and Contributors (https://github.com/skyline-emu/)
+
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <linux/userfaultfd.h>
+#include "userfaultfd.h"
+
+#ifndef UFFD_FEATURE_WP_HUGETLBFS_SHMEM
+#define UFFD_FEATURE_WP_HUGETLBFS_SHMEM (1 << 12) // Write-protection of shared memory was added in Linux 5.19 which is newer than the NDK's kernel headers
+#endif
+
+namespace skyline::nce {
+    bool Userfaultfd::Initialize(span<const span<u8>> regions) {
+        // Kernel-mode faults are not required as the kernel writing to trapped memory would already fail with the mprotect backend
+        userfaultfd = static_cast<int>(syscall(__NR_userfaultfd, O_CLOEXEC | O_NONBLOCK | UFFD_USER_MODE_ONLY));
+        if (userfaultfd == -1) {
+            Logger::Info("Using mprotect for trapping guest memory as userfaultfd is unavailable: {}", strerror(errno));
+            return false;
+        }
+
+        // Guest memory is shared memory, write-protecting it requires Linux 5.19 or newer
+        constexpr u64 RequiredFeatures{UFFD_FEATURE_PAGEFAULT_FLAG_WP | UFFD_FEATURE_WP_HUGETLBFS_SHMEM};
+        uffdio_api api{
+            .api = UFFD_API,
+            .features = RequiredFeatures,
+        };
+        if (ioctl(userfaultfd, UFFDIO_API, &api) == -1 || (api.features & RequiredFeatures) != RequiredFeatures) {
+            Logger::Info("Using mprotect for trapping guest memory as userfaultfd doesn't support write-protecting shared memory");
+            userfaultfd = -1;
+            return false;
+        }
+
+        for (auto region : regions) {
+            if (!region.valid() || region.empty())
+                continue;
+
+            uffdio_register registration{
+                .range = {
+                    .start = reinterpret_cast<u64>(region.data()),
+                    .len = region.size(),
+                },
+                .mode = UFFDIO_REGISTER_MODE_WP,
+            };
+            if (ioctl(userfaultfd, UFFDIO_REGISTER, &registration) == -1 || !(registration.ioctls & (1ULL << _UFFDIO_WRITEPROTECT))) {
+                Logger::Warn("Using mprotect for trapping guest memory as registering it with userfaultfd failed: {}", strerror(errno));
+                userfaultfd = -1; // Closing the userfaultfd unregisters any ranges that were registered prior
+                return false;
+            }
+        }
+
+        exitEvent = eventfd(0, EFD_CLOEXEC);
+        if (exitEvent == -1)
+            throw exception("Failed to create the userfaultfd exit eventfd: {}", strerror(errno));
+
+        return true;
+    }
+
+    void Userfaultfd::Run(const FaultHandler &handler) {
+        std::array<pollfd, 2> pollFds{
+            pollfd{.fd = userfaultfd, .events = POLLIN},
+            pollfd{.fd = exitEvent, .events = POLLIN},
+        };
+        std::array<uffd_msg, 16> messages;
+        while (true) {
+            if (poll(pollFds.data(), pollFds.size(), -1) == -1) {
+                if (errno == EINTR)
+                    continue;
+                Logger::Error("Failed to poll the userfaultfd: {}", strerror(errno));
+                return;
+            }
+
+            if (pollFds[1].revents) {
+                eventfd_t value;
+                eventfd_read(exitEvent, &value); // The event is reset so Run() can be called again
+                return;
+            }
+
+            auto result{read(userfaultfd, messages.data(), sizeof(messages))};
+            if (result == -1) {
+                if (errno == EAGAIN || errno == EINTR)
+                    continue; // The fault may have been resolved by another thread clearing the write-protection
+                Logger::Error("Failed to read from the userfaultfd: {}", strerror(errno));
+                return;
+            }
+
+            for (const auto &message : span{messages}.first(static_cast<size_t>(result) / sizeof(uffd_msg))) {
+                if (message.event != UFFD_EVENT_PAGEFAULT || !(message.arg.pagefault.flags & UFFD_PAGEFAULT_FLAG_WP))
+                    continue;
+
+                handler(util::AlignDown(reinterpret_cast<u8 *>(message.arg.pagefault.address), constant::PageSize));
+            }
+        }
+    }
+
+    void Userfaultfd::Exit() {
+        eventfd_write(exitEvent, 1);
+    }
+
+    void Userfaultfd::WriteProtect(span<u8> pages, bool protect) {
+        uffdio_writeprotect writeProtect{
+            .range = {
+                .start = reinterpret_cast<u64>(pages.data()),
+                .len = pages.size(),
+            },
+            .mode = protect ? UFFDIO_WRITEPROTECT_MODE_WP : 0,
+        };
+        while (ioctl(userfaultfd, UFFDIO_WRITEPROTECT, &writeProtect) == -1 && errno == EAGAIN); // EAGAIN is returned if the address space is being concurrently modified
+    }
+}
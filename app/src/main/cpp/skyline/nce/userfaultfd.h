@@ -0,0 +1,47 @@
+// SPDX-License-Identifier: MPL-2.0
+// Copyright © 2022 Skyline Team and Contributors (https://github.com/skyline-emu/)
+
+#pragma once
+
+#include <functional>
+#include <common.h>
+#include <common/file_descriptor.h>
+
+namespace skyline::nce {
+    /**
+     * @brief A userfaultfd which write-protects pages of registered memory and delivers writes to them as faults to a handler
+     * @note The faulting thread is blocked in the kernel until the write-protection of the page is cleared
+     */
+    class Userfaultfd {
+      private:
+        FileDescriptor userfaultfd;
+        FileDescriptor exitEvent; //!< An eventfd that's signalled to make Run() return
+
+      public:
+        using FaultHandler = std::function<void(u8 *page)>;
+
+        /**
+         * @brief Creates the userfaultfd and registers the supplied regions with it for write-protection
+         * @return If write-protection is supported for all regions, the userfaultfd must not be used otherwise
+         * @note The regions should be registered upfront in their entirety as registering a range splits the VMAs at its boundaries
+         */
+        bool Initialize(span<const span<u8>> regions);
+
+        /**
+         * @brief Handles write-protection faults on the calling thread until Exit() is called
+         * @param handler A function which is called with the page of every write-protection fault, it must clear the write-protection of the page to wake the faulting thread
+         */
+        void Run(const FaultHandler &handler);
+
+        /**
+         * @brief Makes Run() return on the thread that it's running on
+         * @note If Run() isn't running, the next call to it returns immediately
+         */
+        void Exit();
+
+        /**
+         * @brief Sets or clears write-protection for the supplied pages, clearing it wakes any threads that faulted on them
+         */
+        void WriteProtect(span<u8> pages, bool protect);
+    };
+}
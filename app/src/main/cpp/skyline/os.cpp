@@ -55,6 +55,7 @@ namespace skyline::kernel {
 
         auto &process{state.process};
         process = std::make_shared<kernel::type::KProcess>(state);
+        state.guestMemory = &process->memory;
 
         auto entry{state.loader->LoadProcessData(process, state)};
         auto &nacp{state.loader->nacp};
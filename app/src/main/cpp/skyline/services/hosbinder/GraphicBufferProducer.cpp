@@ -389,7 +389,7 @@ namespace skyline::service::hosbinder {
 
         width = defaultWidth;
         height = defaultHeight;
-        transformHint = state.gpu->presentation.GetTransformHint();
+        transformHint = state.gpu->presentation->GetTransformHint();
         pendingBufferCount = GetPendingBufferCount();
 
         Logger::Debug("#{} - {}Timestamp: {}, Crop: ({}-{})x({}-{}), Scale Mode: {}, Transform: {} [Sticky: {}], Swap Interval: {}, Is Async: {}", slot, isAutoTimestamp ? "Auto " : "", timestamp, crop.left, crop.right, crop.top, crop.bottom, ToString(scalingMode), ToString(transform), ToString(stickyTransform), swapInterval, async);
@@ -398,7 +398,7 @@ namespace skyline::service::hosbinder {
         lock.unlock();
 
         std::weak_ptr<GraphicBufferProducer> weakThis{shared_from_this()};
-        state.gpu->presentation.Present(buffer.texture, isAutoTimestamp ? 0 : timestamp, swapInterval, crop, scalingMode, transform, fence, [weakThis, &buffer] {
+        state.gpu->presentation->Present(buffer.texture, isAutoTimestamp ? 0 : timestamp, swapInterval, crop, scalingMode, transform, fence, [weakThis, &buffer] {
             if (auto gbp{weakThis.lock()}) {
                 std::scoped_lock lock{gbp->mutex};
                 buffer.state = BufferState::Free;
@@ -503,7 +503,7 @@ namespace skyline::service::hosbinder {
         connectedApi = api;
         width = defaultWidth;
         height = defaultHeight;
-        transformHint = state.gpu->presentation.GetTransformHint();
+        transformHint = state.gpu->presentation->GetTransformHint();
         pendingBufferCount = GetPendingBufferCount();
 
         Logger::Debug("API: {}, Producer Controlled By App: {}, Default Dimensions: {}x{}, Transform Hint: {}, Pending Buffer Count: {}", ToString(api), producerControlledByApp, width, height, ToString(transformHint), pendingBufferCount);
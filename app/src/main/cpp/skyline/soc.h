@@ -6,6 +6,9 @@
 #include "soc/smmu.h"
 #include "soc/host1x.h"
 #include "soc/gm20b/gpfifo.h"
+#ifdef GPFIFO_TRACE
+#include "soc/gm20b/gpfifo_trace.h"
+#endif
 
 namespace skyline::soc {
     /**
@@ -16,7 +19,12 @@ namespace skyline::soc {
       public:
         SMMU smmu;
         host1x::Host1x host1x;
+        #ifdef GPFIFO_TRACE
+        gm20b::GpfifoTraceWriter gpfifoTrace; //!< Records all GPFIFO submissions to a trace file for offline analysis of the GPU front-end
 
+        SOC(const DeviceState &state) : host1x(state), gpfifoTrace(state) {}
+        #else
         SOC(const DeviceState &state) : host1x(state) {}
+        #endif
     };
 }
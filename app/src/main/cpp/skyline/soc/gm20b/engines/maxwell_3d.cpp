@@ -108,7 +108,7 @@ namespace skyline::soc::gm20b::engine::maxwell3d {
           syncpoints{state.soc->host1x.syncpoints},
           i2m{state, channelCtx},
           dirtyManager{registers},
-          interconnect{*state.gpu, channelCtx, *state.nce, state.process->memory, dirtyManager, MakeEngineRegisters(registers)},
+          interconnect{*state.gpu, channelCtx, *state.traps, *state.guestMemory, dirtyManager, MakeEngineRegisters(registers)},
           channelCtx{channelCtx} {
         channelCtx.executor.AddFlushCallback([this]() { FlushEngineState(); });
         InitializeRegisters();
@@ -544,6 +544,13 @@ namespace skyline::soc::gm20b::engine::maxwell3d {
             interconnect.Draw(topology, *registers.streamOutputEnable, true, indexBufferCount, indexBufferFirst, instanceCount, globalBaseVertexIndex, globalBaseInstanceIndex);
     }
 
+    void Maxwell3D::DrawIndirect(u32 drawTopology, span<u8> indirectBuffer, u32 count, u32 stride) {
+        FlushEngineState();
+        auto topology{static_cast<type::DrawTopology>(drawTopology)};
+        if (CheckRenderEnable())
+            interconnect.DrawIndirect(topology, *registers.streamOutputEnable, false, indirectBuffer, count, stride);
+    }
+
     void Maxwell3D::DrawIndexedIndirect(u32 drawTopology, span<u8> indirectBuffer, u32 count, u32 stride) {
         FlushEngineState();
         auto topology{static_cast<type::DrawTopology>(drawTopology)};
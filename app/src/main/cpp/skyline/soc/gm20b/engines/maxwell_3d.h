@@ -488,6 +488,8 @@ namespace skyline::soc::gm20b::engine::maxwell3d {
 
         void DrawIndexedInstanced(u32 drawTopology, u32 indexBufferCount, u32 instanceCount, u32 globalBaseVertexIndex, u32 indexBufferFirst, u32 globalBaseInstanceIndex) override;
 
+        void DrawIndirect(u32 drawTopology, span<u8> indirectBuffer, u32 count, u32 stride) override;
+
         void DrawIndexedIndirect(u32 drawTopology, span<u8> indirectBuffer, u32 count, u32 stride) override;
     };
 }
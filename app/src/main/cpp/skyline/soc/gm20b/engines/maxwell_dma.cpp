@@ -43,6 +43,9 @@ namespace skyline::soc::gm20b::engine {
                 return;
             }
 
+            if (registers.launchDma->srcMemoryLayout == Registers::LaunchDma::MemoryLayout::BlockLinear && registers.launchDma->dstMemoryLayout == Registers::LaunchDma::MemoryLayout::Pitch && CopyBlockLinearToPitchOnGpu())
+                return;
+
             channelCtx.executor.Submit();
 
             if (registers.launchDma->srcMemoryLayout == registers.launchDma->dstMemoryLayout) [[unlikely]] {
@@ -190,6 +193,39 @@ namespace skyline::soc::gm20b::engine {
             copyFunc(srcMappings.front().data(), dstMappings.front().data());
     }
 
+    bool MaxwellDma::CopyBlockLinearToPitchOnGpu() {
+        if (registers.srcSurface->blockSize.Width() != 1) [[unlikely]]
+            return false;
+
+        gpu::texture::Dimensions srcDimensions{registers.srcSurface->width, registers.srcSurface->height, registers.srcSurface->depth};
+        size_t srcLayerStride{gpu::texture::GetBlockLinearLayerSize(srcDimensions, 1, 1, 1, registers.srcSurface->blockSize.Height(), registers.srcSurface->blockSize.Depth())};
+        size_t dstSize{*registers.pitchOut * *registers.lineCount * registers.srcSurface->depth};
+
+        auto srcMappings{channelCtx.asCtx->gmmu.TranslateRange(*registers.offsetIn, srcLayerStride)};
+        auto dstMappings{channelCtx.asCtx->gmmu.TranslateRange(*registers.offsetOut, dstSize)};
+        if (srcMappings.size() != 1 || dstMappings.size() != 1)
+            return false;
+
+        // The block-linear layout is always derived from the source surface, this is equivalent to both of the CPU paths for any copies that they handle correctly
+        gpu::BlockLinearHelperShader::CopyLayout layout{
+            .widthBytes = *registers.lineLengthIn,
+            .height = *registers.lineCount,
+            .depth = registers.srcSurface->depth,
+            .pitch = *registers.pitchOut,
+            .blockLinearWidthBytes = registers.srcSurface->width,
+            .blockLinearHeight = registers.srcSurface->height,
+            .gobBlockHeight = registers.srcSurface->blockSize.Height(),
+            .gobBlockDepth = registers.srcSurface->blockSize.Depth(),
+            .originXBytes = registers.srcSurface->origin.x,
+            .originY = registers.srcSurface->origin.y,
+        };
+        if (!interconnect.CopyBlockLinearToPitch(dstMappings.front(), srcMappings.front(), layout))
+            return false;
+
+        Logger::Debug("{}x{}x{}@0x{:X} -> {}x{}x{}@0x{:X} (GPU)", srcDimensions.width, srcDimensions.height, srcDimensions.depth, u64{*registers.offsetIn}, layout.widthBytes, layout.height, layout.depth, u64{*registers.offsetOut});
+        return true;
+    }
+
     void MaxwellDma::CopyPitchToBlockLinear() {
         if (registers.dstSurface->blockSize.Width() != 1) [[unlikely]] {
             Logger::Error("Blocklinear surfaces with a non-one block width are unsupported on the Tegra X1: {}", registers.srcSurface->blockSize.Width());
@@ -35,6 +35,12 @@ namespace skyline::soc::gm20b::engine {
 
         void CopyBlockLinearToPitch();
 
+        /**
+         * @brief Does a block-linear to pitch copy on the GPU with the block-linear helper shader, this avoids submitting the executor prior to the copy
+         * @return If the copy was done, if it couldn't be done on the GPU it must be done on the CPU with CopyBlockLinearToPitch instead
+         */
+        bool CopyBlockLinearToPitchOnGpu();
+
         void CopyPitchToBlockLinear();
 
         void LaunchDma();
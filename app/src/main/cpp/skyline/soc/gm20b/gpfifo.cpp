@@ -87,9 +87,18 @@ namespace skyline::soc::gm20b {
         gpfifoEngine(state.soc->host1x.syncpoints, channelCtx),
         channelCtx(channelCtx),
         gpEntries(numEntries),
-        thread(std::thread(&ChannelGpfifo::Run, this)) {}
+        thread(std::thread(&ChannelGpfifo::Run, this)) {
+        #ifdef GPFIFO_TRACE
+        traceChannelId = state.soc->gpfifoTrace.RegisterChannel(channelCtx, numEntries);
+        #endif
+    }
 
     void ChannelGpfifo::SendFull(u32 method, GpfifoArgument argument, SubchannelId subChannel, bool lastCall) {
+        #ifdef GPFIFO_PROFILING
+        if (method < engine::GPFIFO::RegisterCount || method >= engine::EngineMethodsEnd)
+            frameProfile.engines[static_cast<u8>(subChannel)].methodCount++; // Engine methods are counted by SendPure
+        #endif
+
         if (method < engine::GPFIFO::RegisterCount) {
             gpfifoEngine.CallMethod(method, *argument);
         } else if (method < engine::EngineMethodsEnd) { [[likely]]
@@ -116,6 +125,10 @@ namespace skyline::soc::gm20b {
     }
 
     void ChannelGpfifo::SendPure(u32 method, u32 argument, SubchannelId subChannel) {
+        #ifdef GPFIFO_PROFILING
+        frameProfile.engines[static_cast<u8>(subChannel)].methodCount++;
+        #endif
+
         if (subChannel == SubchannelId::ThreeD) [[likely]] {
             channelCtx.maxwell3D.CallMethod(method, argument);
             return;
@@ -143,6 +156,10 @@ namespace skyline::soc::gm20b {
     }
 
     void ChannelGpfifo::SendPureBatchNonInc(u32 method, span<u32> arguments, SubchannelId subChannel) {
+        #ifdef GPFIFO_PROFILING
+        frameProfile.engines[static_cast<u8>(subChannel)].methodCount += arguments.size();
+        #endif
+
         switch (subChannel) {
             case SubchannelId::ThreeD:
                 channelCtx.maxwell3D.CallMethodBatchNonInc(method, arguments);
@@ -235,9 +252,19 @@ namespace skyline::soc::gm20b {
         }};
 
         // We've a method from a previous GpEntry that needs resuming
-        if (resumeState.remaining)
+        if (resumeState.remaining) {
+            #ifdef GPFIFO_PROFILING
+            auto startTime{util::GetTimeNs()};
+            auto subChannel{resumeState.subChannel};
+            #endif
+
             resumeSplitMethod();
 
+            #ifdef GPFIFO_PROFILING
+            frameProfile.engines[static_cast<u8>(subChannel)].timeNs += static_cast<u64>(util::GetTimeNs() - startTime);
+            #endif
+        }
+
         // Process more methods if the entries are still not all used up after handling resuming
         for (; entry != pushBuffer.end(); entry++) {
             if (entry >= pushBuffer.end()) [[unlikely]]
@@ -356,12 +383,20 @@ namespace skyline::soc::gm20b {
                 }
             }};
 
+            #ifdef GPFIFO_PROFILING
+            auto startTime{util::GetTimeNs()};
+            #endif
+
             bool hitEnd{[&]() {
                 if (methodHeader.methodSubChannel != SubchannelId::ThreeD) [[unlikely]]
                     channelCtx.maxwell3D.FlushEngineState(); // Flush the 3D engine state when doing any calls to other engines
                 return processMethod();
             }()};
 
+            #ifdef GPFIFO_PROFILING
+            frameProfile.engines[static_cast<u8>(methodHeader.methodSubChannel)].timeNs += static_cast<u64>(util::GetTimeNs() - startTime);
+            #endif
+
             if (hitEnd)
                 break;
         }
@@ -373,7 +408,7 @@ namespace skyline::soc::gm20b {
 
         try {
             signal::SetSignalHandler({SIGINT, SIGILL, SIGTRAP, SIGBUS, SIGFPE}, signal::ExceptionalSignalHandler);
-            signal::SetSignalHandler({SIGSEGV}, nce::NCE::HostSignalHandler); // We may access NCE trapped memory
+            signal::SetSignalHandler({SIGSEGV}, nce::TrapManager::HostSignalHandler); // We may access NCE trapped memory
 
             bool channelLocked{};
 
@@ -385,7 +420,15 @@ namespace skyline::soc::gm20b {
                     channelLocked = true;
                 }
 
+                #ifdef GPFIFO_PROFILING
+                UpdateFrameProfile(); // This is done prior to processing the entry so it's accounted to the frame it was submitted for
+                #endif
+
                 Process(gpEntry);
+
+                #ifdef GPFIFO_PROFILING
+                frameProfile.gpEntryCount++;
+                #endif
             }, [this, &channelLocked]() {
                 // If we run out of GpEntries to process ensure we submit any remaining GPU work before waiting for more to arrive
                 Logger::Debug("Finished processing pushbuffer batch");
@@ -400,26 +443,91 @@ namespace skyline::soc::gm20b {
                 Logger::Error("{}\nStack Trace:{}", e.what(), state.loader->GetStackTrace(e.frames));
                 Logger::EmulationContext.Flush();
                 signal::BlockSignal({SIGINT});
-                state.process->Kill(false);
+                if (state.process)
+                    state.process->Kill(false);
+                else
+                    std::rethrow_exception(std::current_exception());
             }
         } catch (const exception &e) {
             Logger::ErrorNoPrefix("{}\nStack Trace:{}", e.what(), state.loader->GetStackTrace(e.frames));
             Logger::EmulationContext.Flush();
             signal::BlockSignal({SIGINT});
-            state.process->Kill(false);
+            if (state.process)
+                state.process->Kill(false);
+            else
+                std::rethrow_exception(std::current_exception());
         } catch (const std::exception &e) {
             Logger::Error(e.what());
             Logger::EmulationContext.Flush();
             signal::BlockSignal({SIGINT});
-            state.process->Kill(false);
+            if (state.process)
+                state.process->Kill(false);
+            else
+                std::rethrow_exception(std::current_exception());
         }
     }
 
+    #ifdef GPFIFO_PROFILING
+    static constexpr std::array<const char *, 8> SubchannelNames{"3D", "Compute", "Inline2Mem", "2D", "Copy", "Software0", "Software1", "Software2"}; //!< The names of the engines on each subchannel, indexed by SubchannelId
+
+    /**
+     * @return A breakdown of the time spent and methods called for every engine that was used
+     */
+    template<typename EngineProfiles>
+    static std::string FormatEngineProfiles(const EngineProfiles &engines) {
+        std::string output;
+        for (size_t i{}; i < engines.size(); i++)
+            if (engines[i].methodCount)
+                fmt::format_to(std::back_inserter(output), ", {}: {} methods ({}us)", SubchannelNames[i], engines[i].methodCount, engines[i].timeNs / constant::NsInMicrosecond);
+        return output;
+    }
+
+    void ChannelGpfifo::UpdateFrameProfile() {
+        size_t frameId{state.gpu->presentation->GetNextFrameId()};
+        if (frameId == profileFrameId)
+            return;
+
+        frameProfile.submitCount = channelCtx.channelSequenceNumber - profileSequenceNumber;
+        u64 timeNs{};
+        for (const auto &engine : frameProfile.engines)
+            timeNs += engine.timeNs;
+
+        if (frameProfileCallback)
+            frameProfileCallback(profileFrameId, frameProfile);
+        else
+            Logger::Info("GPFIFO frame {}: {} GpEntries, {} submits, {}us{}", profileFrameId, frameProfile.gpEntryCount, frameProfile.submitCount, timeNs / constant::NsInMicrosecond, FormatEngineProfiles(frameProfile.engines));
+
+        for (size_t i{}; i < frameProfile.engines.size(); i++) {
+            totalProfile.engines[i].methodCount += frameProfile.engines[i].methodCount;
+            totalProfile.engines[i].timeNs += frameProfile.engines[i].timeNs;
+        }
+        totalProfile.gpEntryCount += frameProfile.gpEntryCount;
+        totalProfile.submitCount += frameProfile.submitCount;
+        totalProfile.frameCount++;
+
+        frameProfile = {};
+        profileFrameId = frameId;
+        profileSequenceNumber = channelCtx.channelSequenceNumber;
+    }
+
+    void ChannelGpfifo::SetFrameProfileCallback(FrameProfileCallback callback) {
+        frameProfileCallback = std::move(callback);
+    }
+    #endif
+
     void ChannelGpfifo::Push(span<GpEntry> entries) {
+        #ifdef GPFIFO_TRACE
+        state.soc->gpfifoTrace.Submit(traceChannelId, channelCtx, entries);
+        #endif
+
         gpEntries.Append(entries);
     }
 
     void ChannelGpfifo::Push(GpEntry entry) {
+        #ifdef GPFIFO_TRACE
+        state.soc->gpfifoTrace.Submit(traceChannelId, channelCtx, span(entry));
+        #endif
+
         gpEntries.Push(entry);
     }
 
@@ -428,5 +536,10 @@ namespace skyline::soc::gm20b {
             pthread_kill(thread.native_handle(), SIGINT);
             thread.join();
         }
+
+        #ifdef GPFIFO_PROFILING
+        if (totalProfile.frameCount)
+            Logger::Info("GPFIFO profile for {} frames: {} GpEntries, {} submits{}", totalProfile.frameCount, totalProfile.gpEntryCount, totalProfile.submitCount, FormatEngineProfiles(totalProfile.engines));
+        #endif
     }
 }
@@ -131,6 +131,46 @@ namespace skyline::soc::gm20b {
 
         std::thread thread; //!< The thread that manages processing of pushbuffers
 
+        #ifdef GPFIFO_TRACE
+        u32 traceChannelId{}; //!< The ID of this channel in the GPFIFO trace
+        #endif
+
+        #ifdef GPFIFO_PROFILING
+      public:
+        /**
+         * @brief Front-end statistics for a single engine
+         */
+        struct EngineProfile {
+            u64 methodCount{}; //!< The amount of method calls made to the engine, including GPFIFO and macro methods
+            u64 timeNs{}; //!< The CPU time spent processing methods directed at the engine, this includes any macros and work recorded by the engine
+        };
+
+        /**
+         * @brief Front-end statistics accumulated over one or more frames
+         */
+        struct FrontEndProfile {
+            std::array<EngineProfile, 8> engines{}; //!< The statistics of every engine indexed by SubchannelId
+            u64 gpEntryCount{};
+            u64 submitCount{}; //!< The amount of times the command executor was submitted
+            u64 frameCount{};
+        };
+
+        using FrameProfileCallback = std::function<void(size_t frameId, const FrontEndProfile &profile)>;
+
+      private:
+        FrameProfileCallback frameProfileCallback; //!< Receives the statistics of every frame instead of them being logged if set
+
+        FrontEndProfile frameProfile; //!< The statistics of the frame currently being processed
+        FrontEndProfile totalProfile; //!< The statistics of all prior frames, this is logged on destruction
+        size_t profileFrameId{1}; //!< The ID of the frame that the statistics in frameProfile are being accumulated for, this is the ID of the next frame to be presented when accumulation started
+        size_t profileSequenceNumber{}; //!< The sequence number of the channel when the statistics in frameProfile started being accumulated
+
+        /**
+         * @brief Reports and resets the statistics of the current frame if a new frame has been presented since they started being accumulated
+         */
+        void UpdateFrameProfile();
+        #endif
+
         /**
          * @brief Sends a method call to the appropriate subchannel and handles macro and GPFIFO methods
          */
@@ -173,5 +213,13 @@ namespace skyline::soc::gm20b {
          * @brief Pushes a single entry to the FIFO, these commands will be executed on calls to 'Process'
          */
         void Push(GpEntry entries);
+
+        #ifdef GPFIFO_PROFILING
+        /**
+         * @brief Sets a callback which is called on the GPFIFO thread with the statistics of every frame rather than logging them
+         * @note This must be called prior to any entries being pushed
+         */
+        void SetFrameProfileCallback(FrameProfileCallback callback);
+        #endif
     };
 }
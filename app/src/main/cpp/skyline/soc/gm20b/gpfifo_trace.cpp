@@ -0,0 +1,153 @@
+// SPDX-License-Identifier: MPL-2.0
+// Copyright © 2022 Skyline Team and Contributors (https://github.com/skyline-emu/)
+
+#include <filesystem>
+#include <lz4.h>
+#include <os.h>
+#include "channel.h"
+#include "gpfifo_trace.h"
+
+namespace skyline::soc::gm20b {
+    GpfifoTraceWriter::GpfifoTraceWriter(const DeviceState &state) : state{state} {}
+
+    bool GpfifoTraceWriter::EnsureStreamOpen() {
+        if (!streamOpened) {
+            streamOpened = true;
+
+            auto path{fmt::format("{}gpu/traces/{}.sgft", state.os->publicAppFilesPath, util::GetTimeNs())};
+            std::filesystem::create_directories(std::filesystem::path{path}.parent_path());
+            stream.open(path, std::ios::binary | std::ios::trunc);
+
+            trace::Header header{};
+            stream.write(reinterpret_cast<const char *>(&header), sizeof(header));
+
+            if (stream.fail())
+                Logger::Warn("Failed to open the GPFIFO trace file, no GPFIFO submissions will be recorded");
+            else
+                Logger::Info("Recording GPFIFO trace to {}", path);
+        }
+
+        return stream.good();
+    }
+
+    void GpfifoTraceWriter::WriteMemory(u32 addressSpaceId, u64 iova, span<const u8> contents) {
+        compressionBuffer.resize(static_cast<size_t>(LZ4_compressBound(static_cast<int>(contents.size()))));
+        auto compressedSize{LZ4_compress_default(reinterpret_cast<const char *>(contents.data()), compressionBuffer.data(), static_cast<int>(contents.size()), static_cast<int>(compressionBuffer.size()))};
+        if (compressedSize <= 0)
+            throw exception("Failed to compress GPFIFO trace memory: 0x{:X} (0x{:X} bytes)", iova, contents.size());
+
+        WriteRecord(trace::RecordType::Memory, trace::MemoryRecord{
+            .addressSpaceId = addressSpaceId,
+            .compressedSize = static_cast<u32>(compressedSize),
+            .iova = iova,
+            .size = contents.size(),
+        }, span(compressionBuffer.data(), static_cast<size_t>(compressedSize)).cast<const u8>());
+    }
+
+    void GpfifoTraceWriter::WriteSnapshot() {
+        TRACE_EVENT("gpu", "GpfifoTraceWriter::WriteSnapshot");
+
+        for (auto it{addressSpaces.begin()}; it != addressSpaces.end();) {
+            auto &addressSpace{it->second};
+            auto asCtx{addressSpace.asCtx.lock()};
+            if (!asCtx) {
+                it = addressSpaces.erase(it);
+                continue;
+            }
+
+            auto mappings{asCtx->gmmu.GetMappings()};
+
+            std::vector<trace::Mapping> traceMappings;
+            traceMappings.reserve(mappings.size());
+            for (const auto &[iova, memory] : mappings)
+                traceMappings.push_back({iova, memory.size()});
+
+            if (traceMappings.size() != addressSpace.mappings.size() || !std::equal(traceMappings.begin(), traceMappings.end(), addressSpace.mappings.begin(), [](const auto &a, const auto &b) { return a.iova == b.iova && a.size == b.size; })) {
+                WriteRecord(trace::RecordType::Mappings, trace::MappingsRecord{addressSpace.id, static_cast<u32>(traceMappings.size())}, span(traceMappings).cast<const u8>());
+                addressSpace.mappings = std::move(traceMappings);
+            }
+
+            // Chunks are aligned in the IOVA space and split at mapping boundaries, chunks that are no longer mapped are dropped so they're rewritten if they're ever mapped again
+            std::map<u64, u64> chunkHashes;
+            for (const auto &[iova, memory] : mappings) {
+                for (u64 chunkIova{iova}, end{iova + memory.size()}; chunkIova < end;) {
+                    u64 chunkEnd{std::min(util::AlignDown(chunkIova, ChunkSize) + ChunkSize, end)};
+                    auto chunk{memory.subspan(chunkIova - iova, chunkEnd - chunkIova)};
+
+                    u64 hash{XXH64(chunk.data(), chunk.size(), 0)};
+                    auto previous{addressSpace.chunkHashes.find(chunkIova)};
+                    if (previous == addressSpace.chunkHashes.end() || previous->second != hash)
+                        WriteMemory(addressSpace.id, chunkIova, chunk);
+
+                    chunkHashes.emplace_hint(chunkHashes.end(), chunkIova, hash);
+                    chunkIova = chunkEnd;
+                }
+            }
+            addressSpace.chunkHashes = std::move(chunkHashes);
+
+            it++;
+        }
+    }
+
+    GpfifoTraceWriter::AddressSpaceTrace &GpfifoTraceWriter::GetAddressSpace(const std::shared_ptr<AddressSpaceContext> &asCtx) {
+        auto &addressSpace{addressSpaces[asCtx.get()]};
+        if (addressSpace.asCtx.lock() != asCtx) {
+            addressSpace = AddressSpaceTrace{.id = nextAddressSpaceId++, .asCtx = asCtx};
+            snapshotPending = true; // The new address space requires a full snapshot prior to any submissions which use it
+        }
+        return addressSpace;
+    }
+
+    u32 GpfifoTraceWriter::RegisterChannel(ChannelContext &channelCtx, size_t numEntries) {
+        std::scoped_lock lock{mutex};
+        u32 channelId{nextChannelId++};
+        if (!EnsureStreamOpen())
+            return channelId;
+
+        WriteRecord(trace::RecordType::Channel, trace::ChannelRecord{
+            .channelId = channelId,
+            .addressSpaceId = GetAddressSpace(channelCtx.asCtx).id,
+            .numEntries = static_cast<u32>(numEntries),
+        });
+        return channelId;
+    }
+
+    void GpfifoTraceWriter::Submit(u32 channelId, ChannelContext &channelCtx, span<const GpEntry> entries) {
+        TRACE_EVENT("gpu", "GpfifoTraceWriter::Submit");
+
+        std::scoped_lock lock{mutex};
+        if (!EnsureStreamOpen())
+            return;
+
+        auto &addressSpace{GetAddressSpace(channelCtx.asCtx)};
+        if (snapshotPending) {
+            WriteSnapshot();
+            snapshotPending = false;
+        }
+
+        for (const auto &entry : entries) {
+            if (!entry.size)
+                continue; // Control entries have no pushbuffer
+
+            u64 size{entry.size * sizeof(u32)};
+            readBuffer.resize(size);
+            channelCtx.asCtx->gmmu.Read(readBuffer.data(), entry.Address(), size);
+            WriteMemory(addressSpace.id, entry.Address(), readBuffer);
+
+            // The snapshot of any chunks overlapping the pushbuffer no longer reflects the replayed memory, they're dropped so they're rewritten by the next snapshot
+            addressSpace.chunkHashes.erase(addressSpace.chunkHashes.lower_bound(util::AlignDown(entry.Address(), ChunkSize)), addressSpace.chunkHashes.lower_bound(entry.Address() + size));
+        }
+
+        WriteRecord(trace::RecordType::Submit, trace::SubmitRecord{channelId, static_cast<u32>(entries.size())}, entries.cast<const u8>());
+    }
+
+    void GpfifoTraceWriter::Frame(u64 frameId, i64 timestamp) {
+        std::scoped_lock lock{mutex};
+        if (!EnsureStreamOpen())
+            return;
+
+        WriteRecord(trace::RecordType::Frame, trace::FrameRecord{frameId, timestamp});
+        stream.flush();
+        snapshotPending = true;
+    }
+}
@@ -0,0 +1,152 @@
+// SPDX-License-Identifier: MPL-2.0
+// Copyright © 2022 Skyline Team and Contributors (https://github.com/skyline-emu/)
+
+#pragma once
+
+#include <fstream>
+#include <map>
+#include <unordered_map>
+#include "gmmu.h"
+#include "gpfifo.h"
+
+namespace skyline::soc::gm20b {
+    struct ChannelContext;
+
+    /**
+     * @brief The format of GPFIFO trace files, these contain all GpEntries submitted to any channel alongside the GMMU-mapped memory they reference so the GPU front-end can be replayed deterministically
+     * @note A trace file consists of a header followed by a sequence of records, every record is a RecordHeader followed by a record-specific structure and its payload
+     * @note Records must be applied in order during replay, memory records always precede the submit records that depend on them
+     */
+    namespace trace {
+        struct Header {
+            static constexpr u32 Magic{util::MakeMagic<u32>("SGFT")}; //!< The magic value used to identify a GPFIFO trace file
+            static constexpr u32 Version{1}; //!< The version of the file format, MUST be incremented for any format changes
+
+            u32 magic{Magic};
+            u32 version{Version};
+        };
+
+        enum class RecordType : u32 {
+            Channel, //!< A channel was created, this is followed by a ChannelRecord
+            Mappings, //!< The set of mappings in an address space changed, this is followed by a MappingsRecord
+            Memory, //!< The contents of a region of an address space, this is followed by a MemoryRecord
+            Submit, //!< GpEntries were pushed to a channel, this is followed by a SubmitRecord
+            Frame, //!< A frame was presented, this is followed by a FrameRecord
+        };
+
+        struct RecordHeader {
+            RecordType type;
+            u32 size; //!< The size of the record following this header in bytes, including its payload
+        };
+
+        struct ChannelRecord {
+            u32 channelId;
+            u32 addressSpaceId; //!< The ID of the address space the channel is bound to, address spaces may be shared between channels
+            u32 numEntries; //!< The amount of GpEntries the channel's FIFO was allocated with
+        };
+
+        /**
+         * @note This is followed by `count` Mapping structures, all prior mappings of the address space are replaced by these
+         */
+        struct MappingsRecord {
+            u32 addressSpaceId;
+            u32 count;
+        };
+
+        struct Mapping {
+            u64 iova;
+            u64 size;
+        };
+
+        /**
+         * @note This is followed by `compressedSize` bytes of LZ4-compressed memory contents
+         */
+        struct MemoryRecord {
+            u32 addressSpaceId;
+            u32 compressedSize;
+            u64 iova;
+            u64 size; //!< The size of the decompressed memory contents in bytes
+        };
+
+        /**
+         * @note This is followed by `count` GpEntry structures
+         */
+        struct SubmitRecord {
+            u32 channelId;
+            u32 count;
+        };
+
+        struct FrameRecord {
+            u64 frameId; //!< The ID of the frame as returned by PresentationEngine::Present
+            i64 timestamp; //!< The host time at which the frame was presented in nanoseconds
+        };
+    }
+
+    /**
+     * @brief Records all GPFIFO submissions alongside the guest memory they reference into a trace file
+     * @note Pushbuffer contents are captured exactly at submission time, all other mapped memory is captured at the first submission after every presented frame and only chunks that changed since the prior capture are written
+     * @note All methods are thread-safe
+     */
+    class GpfifoTraceWriter {
+      private:
+        static constexpr u64 ChunkSize{0x10000}; //!< The granularity at which memory is hashed and written in snapshots, this must be a power of two
+
+        struct AddressSpaceTrace {
+            u32 id;
+            std::weak_ptr<AddressSpaceContext> asCtx; //!< Used to detect address spaces being destroyed and their context being reallocated at the same address
+            std::vector<trace::Mapping> mappings; //!< The mappings of the address space as of the last snapshot
+            std::map<u64, u64> chunkHashes; //!< A map of the IOVAs of chunks to the XXH64 hash of their contents as of the last snapshot
+        };
+
+        const DeviceState &state;
+        std::mutex mutex;
+        std::ofstream stream;
+        bool streamOpened{}; //!< If opening the stream was attempted, the stream is opened lazily as the OS paths aren't known prior to the first submission
+        u32 nextChannelId{}, nextAddressSpaceId{};
+        std::unordered_map<AddressSpaceContext *, AddressSpaceTrace> addressSpaces;
+        bool snapshotPending{true}; //!< If a memory snapshot should be written prior to the next submission
+        std::vector<u8> readBuffer; //!< A reusable buffer for reading pushbuffers from the GMMU
+        std::vector<char> compressionBuffer; //!< A reusable buffer for LZ4-compressed memory contents
+
+        /**
+         * @return If the stream is ready to be written to, this opens the stream on the first call
+         */
+        bool EnsureStreamOpen();
+
+        template<typename T>
+        void WriteRecord(trace::RecordType type, const T &record, span<const u8> payload = {}) {
+            trace::RecordHeader header{type, static_cast<u32>(sizeof(T) + payload.size())};
+            stream.write(reinterpret_cast<const char *>(&header), sizeof(header));
+            stream.write(reinterpret_cast<const char *>(&record), sizeof(T));
+            if (!payload.empty())
+                stream.write(reinterpret_cast<const char *>(payload.data()), static_cast<std::streamsize>(payload.size()));
+        }
+
+        void WriteMemory(u32 addressSpaceId, u64 iova, span<const u8> contents);
+
+        /**
+         * @brief Writes the mappings of all address spaces and the contents of any chunks that changed since the last snapshot
+         */
+        void WriteSnapshot();
+
+        AddressSpaceTrace &GetAddressSpace(const std::shared_ptr<AddressSpaceContext> &asCtx);
+
+      public:
+        GpfifoTraceWriter(const DeviceState &state);
+
+        /**
+         * @return A unique ID for the channel which must be passed to all future calls to Submit for it
+         */
+        u32 RegisterChannel(ChannelContext &channelCtx, size_t numEntries);
+
+        /**
+         * @brief Records the pushbuffers of the supplied entries and the entries themselves, this must be called prior to the entries being pushed to the channel's FIFO
+         */
+        void Submit(u32 channelId, ChannelContext &channelCtx, span<const GpEntry> entries);
+
+        /**
+         * @brief Records a frame boundary and schedules a memory snapshot prior to the next submission
+         */
+        void Frame(u64 frameId, i64 timestamp);
+    };
+}
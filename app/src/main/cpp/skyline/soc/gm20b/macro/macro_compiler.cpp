@@ -0,0 +1,421 @@
+// SPDX-License-Identifier: MPL-2.0
+// Copyright © 2022 Skyline Team and Contributors (https://github.com/skyline-emu/)
+
+#include "soc/gm20b/engines/engine.h"
+#include "macro_compiler.h"
+
+namespace skyline::soc::gm20b::engine {
+    /**
+     * @brief The instruction handlers for every combination of operation and assignment operation, these mirror the semantics of MacroInterpreter exactly
+     */
+    struct CompiledMacro::Handlers {
+        using AssignmentOperation = Opcode::AssignmentOperation;
+        using AluOperation = Opcode::AluOperation;
+
+        static void Send(ExecutionContext &ctx, u32 argument) {
+            ctx.engine->CallMethodFromMacro(ctx.methodAddress.address, argument);
+            ctx.methodAddress.address += ctx.methodAddress.increment;
+        }
+
+        template<AssignmentOperation Operation>
+        static void Assign(ExecutionContext &ctx, u8 reg, u32 result) {
+            if constexpr (Operation == AssignmentOperation::IgnoreAndFetch) {
+                ctx.registers[reg] = *ctx.argument++;
+            } else if constexpr (Operation == AssignmentOperation::Move) {
+                ctx.registers[reg] = result;
+            } else if constexpr (Operation == AssignmentOperation::MoveAndSetMethod) {
+                ctx.registers[reg] = result;
+                ctx.methodAddress.raw = result;
+            } else if constexpr (Operation == AssignmentOperation::FetchAndSend) {
+                ctx.registers[reg] = *ctx.argument++;
+                Send(ctx, result);
+            } else if constexpr (Operation == AssignmentOperation::MoveAndSend) {
+                ctx.registers[reg] = result;
+                Send(ctx, result);
+            } else if constexpr (Operation == AssignmentOperation::FetchAndSetMethod) {
+                ctx.registers[reg] = *ctx.argument++;
+                ctx.methodAddress.raw = result;
+            } else if constexpr (Operation == AssignmentOperation::MoveAndSetMethodThenFetchAndSend) {
+                ctx.registers[reg] = result;
+                ctx.methodAddress.raw = result;
+                Send(ctx, *ctx.argument++);
+            } else if constexpr (Operation == AssignmentOperation::MoveAndSetMethodThenSendHigh) {
+                ctx.registers[reg] = result;
+                ctx.methodAddress.raw = result;
+                Send(ctx, ctx.methodAddress.increment);
+            }
+        }
+
+        template<AluOperation Operation>
+        struct AluRegister {
+            static u32 Alu(ExecutionContext &ctx, u32 srcA, u32 srcB) {
+                if constexpr (Operation == AluOperation::Add) {
+                    u64 result{static_cast<u64>(srcA) + srcB};
+                    ctx.carryFlag = result >> 32;
+                    return static_cast<u32>(result);
+                } else if constexpr (Operation == AluOperation::AddWithCarry) {
+                    u64 result{static_cast<u64>(srcA) + srcB + ctx.carryFlag};
+                    ctx.carryFlag = result >> 32;
+                    return static_cast<u32>(result);
+                } else if constexpr (Operation == AluOperation::Subtract) {
+                    u64 result{static_cast<u64>(srcA) - srcB};
+                    ctx.carryFlag = result & 0xFFFFFFFF;
+                    return static_cast<u32>(result);
+                } else if constexpr (Operation == AluOperation::SubtractWithBorrow) {
+                    u64 result{static_cast<u64>(srcA) - srcB - !ctx.carryFlag};
+                    ctx.carryFlag = result & 0xFFFFFFFF;
+                    return static_cast<u32>(result);
+                } else if constexpr (Operation == AluOperation::BitwiseXor) {
+                    return srcA ^ srcB;
+                } else if constexpr (Operation == AluOperation::BitwiseOr) {
+                    return srcA | srcB;
+                } else if constexpr (Operation == AluOperation::BitwiseAnd) {
+                    return srcA & srcB;
+                } else if constexpr (Operation == AluOperation::BitwiseAndNot) {
+                    return srcA & ~srcB;
+                } else if constexpr (Operation == AluOperation::BitwiseNand) {
+                    return ~(srcA & srcB);
+                }
+            }
+
+            template<AssignmentOperation Assignment>
+            static void Execute(const Instruction &instruction, ExecutionContext &ctx) {
+                Assign<Assignment>(ctx, instruction.dest, Alu(ctx, ctx.registers[instruction.srcA], ctx.registers[instruction.srcB]));
+            }
+        };
+
+        struct AddImmediate {
+            template<AssignmentOperation Assignment>
+            static void Execute(const Instruction &instruction, ExecutionContext &ctx) {
+                Assign<Assignment>(ctx, instruction.dest, static_cast<u32>(static_cast<i32>(ctx.registers[instruction.srcA]) + instruction.immediate));
+            }
+        };
+
+        struct BitfieldReplace {
+            template<AssignmentOperation Assignment>
+            static void Execute(const Instruction &instruction, ExecutionContext &ctx) {
+                u32 src{(ctx.registers[instruction.srcB] >> instruction.srcBit) & instruction.mask};
+                u32 dest{ctx.registers[instruction.srcA] & ~(instruction.mask << instruction.destBit)};
+                Assign<Assignment>(ctx, instruction.dest, dest | (src << instruction.destBit));
+            }
+        };
+
+        struct BitfieldExtractShiftLeftImmediate {
+            template<AssignmentOperation Assignment>
+            static void Execute(const Instruction &instruction, ExecutionContext &ctx) {
+                u32 src{ctx.registers[instruction.srcB]};
+                u32 dest{ctx.registers[instruction.srcA]};
+                Assign<Assignment>(ctx, instruction.dest, ((src >> dest) & instruction.mask) << instruction.destBit);
+            }
+        };
+
+        struct BitfieldExtractShiftLeftRegister {
+            template<AssignmentOperation Assignment>
+            static void Execute(const Instruction &instruction, ExecutionContext &ctx) {
+                u32 src{ctx.registers[instruction.srcB]};
+                u32 dest{ctx.registers[instruction.srcA]};
+                Assign<Assignment>(ctx, instruction.dest, ((src >> instruction.srcBit) & instruction.mask) << dest);
+            }
+        };
+
+        struct ReadImmediate {
+            template<AssignmentOperation Assignment>
+            static void Execute(const Instruction &instruction, ExecutionContext &ctx) {
+                u32 result{ctx.engine->ReadMethodFromMacro(static_cast<u32>(static_cast<i32>(ctx.registers[instruction.srcA]) + instruction.immediate))};
+                Assign<Assignment>(ctx, instruction.dest, result);
+            }
+        };
+
+        /**
+         * @return The handler for the supplied operation specialised for the supplied assignment operation
+         */
+        template<typename Operation>
+        static Handler Select(AssignmentOperation assignment) {
+            switch (assignment) {
+                case AssignmentOperation::IgnoreAndFetch:
+                    return &Operation::template Execute<AssignmentOperation::IgnoreAndFetch>;
+                case AssignmentOperation::Move:
+                    return &Operation::template Execute<AssignmentOperation::Move>;
+                case AssignmentOperation::MoveAndSetMethod:
+                    return &Operation::template Execute<AssignmentOperation::MoveAndSetMethod>;
+                case AssignmentOperation::FetchAndSend:
+                    return &Operation::template Execute<AssignmentOperation::FetchAndSend>;
+                case AssignmentOperation::MoveAndSend:
+                    return &Operation::template Execute<AssignmentOperation::MoveAndSend>;
+                case AssignmentOperation::FetchAndSetMethod:
+                    return &Operation::template Execute<AssignmentOperation::FetchAndSetMethod>;
+                case AssignmentOperation::MoveAndSetMethodThenFetchAndSend:
+                    return &Operation::template Execute<AssignmentOperation::MoveAndSetMethodThenFetchAndSend>;
+                case AssignmentOperation::MoveAndSetMethodThenSendHigh:
+                    return &Operation::template Execute<AssignmentOperation::MoveAndSetMethodThenSendHigh>;
+            }
+
+            return nullptr;
+        }
+
+        /**
+         * @return The handler for the supplied ALU operation or nullptr if the operation is invalid
+         */
+        static Handler SelectAlu(AluOperation operation, AssignmentOperation assignment) {
+            switch (operation) {
+                case AluOperation::Add:
+                    return Select<AluRegister<AluOperation::Add>>(assignment);
+                case AluOperation::AddWithCarry:
+                    return Select<AluRegister<AluOperation::AddWithCarry>>(assignment);
+                case AluOperation::Subtract:
+                    return Select<AluRegister<AluOperation::Subtract>>(assignment);
+                case AluOperation::SubtractWithBorrow:
+                    return Select<AluRegister<AluOperation::SubtractWithBorrow>>(assignment);
+                case AluOperation::BitwiseXor:
+                    return Select<AluRegister<AluOperation::BitwiseXor>>(assignment);
+                case AluOperation::BitwiseOr:
+                    return Select<AluRegister<AluOperation::BitwiseOr>>(assignment);
+                case AluOperation::BitwiseAnd:
+                    return Select<AluRegister<AluOperation::BitwiseAnd>>(assignment);
+                case AluOperation::BitwiseAndNot:
+                    return Select<AluRegister<AluOperation::BitwiseAndNot>>(assignment);
+                case AluOperation::BitwiseNand:
+                    return Select<AluRegister<AluOperation::BitwiseNand>>(assignment);
+                default:
+                    return nullptr;
+            }
+        }
+    };
+
+    void CompiledMacro::ThrowInvalid(const Instruction &instruction) {
+        if (instruction.operation == OutOfBoundsOperation)
+            throw exception("MME execution went outside of macro memory");
+        else if (instruction.operation == static_cast<u8>(Opcode::Operation::AluRegister))
+            throw exception("Unknown MME ALU operation encountered");
+        else
+            throw exception("Unknown MME opcode encountered: 0x{:X}", instruction.operation);
+    }
+
+    __attribute__((always_inline)) void CompiledMacro::ExecuteDelaySlot(const Instruction &instruction, ExecutionContext &ctx) {
+        if (instruction.flow == Flow::Branch) [[unlikely]]
+            throw exception("Cannot branch while inside a delay slot");
+        else if (!instruction.handler) [[unlikely]]
+            ThrowInvalid(instruction);
+
+        instruction.handler(instruction, ctx);
+    }
+
+    bool CompiledMacro::Matches(span<u32> macroCode, size_t offset) const {
+        i64 start{static_cast<i64>(offset) + codeOffset};
+        if (start < 0 || start + static_cast<i64>(code.size()) > static_cast<i64>(macroCode.size()))
+            return false;
+
+        // If the translation runs off the end of macro memory then the code must end at the same place for it to be valid
+        bool overruns{instructions.size() - 1 > code.size()};
+        if (overruns && start + static_cast<i64>(code.size()) != static_cast<i64>(macroCode.size()))
+            return false;
+
+        return std::equal(code.begin(), code.end(), macroCode.begin() + start);
+    }
+
+    void CompiledMacro::Execute(span<u32> args, MacroEngineBase *targetEngine) const {
+        ExecutionContext ctx{
+            .engine = targetEngine,
+            .argument = args.data(),
+        };
+
+        // The first argument is stored in register 1
+        ctx.registers[1] = *ctx.argument++;
+
+        const Instruction *instruction{&instructions[entry]};
+        while (true) {
+            switch (instruction->flow) {
+                case Flow::Next:
+                    instruction->handler(*instruction, ctx);
+                    instruction++;
+                    break;
+
+                case Flow::Exit:
+                    instruction->handler(*instruction, ctx);
+                    ExecuteDelaySlot(*(instruction + 1), ctx);
+                    return;
+
+                case Flow::Branch:
+                    if ((ctx.registers[instruction->srcA] == 0) == instruction->branchOnZero) {
+                        if (!instruction->noDelay)
+                            ExecuteDelaySlot(*(instruction + 1), ctx);
+
+                        instruction = &instructions[instruction->target];
+                    } else if (instruction->exit) {
+                        // Exit has a delay slot
+                        ExecuteDelaySlot(*(instruction + 1), ctx);
+                        return;
+                    } else {
+                        instruction++;
+                    }
+                    break;
+
+                case Flow::Invalid:
+                    ThrowInvalid(*instruction);
+            }
+        }
+    }
+
+    CompiledMacro::Instruction MacroCompiler::Decode(MacroInterpreter::Opcode opcode) {
+        using Opcode = MacroInterpreter::Opcode;
+        using Flow = CompiledMacro::Flow;
+        using Handlers = CompiledMacro::Handlers;
+
+        CompiledMacro::Instruction instruction{
+            .flow = opcode.exit ? Flow::Exit : Flow::Next,
+            .operation = static_cast<u8>(opcode.operation),
+            .dest = opcode.dest ? opcode.dest : CompiledMacro::SinkRegister, // Register 0 should always be zero so redirect writes to it
+            .srcA = opcode.srcA,
+            .srcB = opcode.srcB,
+            .srcBit = opcode.bitfield.srcBit,
+            .destBit = opcode.bitfield.destBit,
+            .branchOnZero = opcode.branchCondition == Opcode::BranchCondition::Zero,
+            .noDelay = opcode.noDelay,
+            .exit = static_cast<bool>(opcode.exit),
+            .mask = opcode.bitfield.GetMask(),
+            .immediate = opcode.immediate,
+        };
+
+        switch (opcode.operation) {
+            case Opcode::Operation::AluRegister:
+                instruction.handler = Handlers::SelectAlu(opcode.aluOperation, opcode.assignmentOperation);
+                break;
+
+            case Opcode::Operation::AddImmediate:
+                instruction.handler = Handlers::Select<Handlers::AddImmediate>(opcode.assignmentOperation);
+                break;
+
+            case Opcode::Operation::BitfieldReplace:
+                instruction.handler = Handlers::Select<Handlers::BitfieldReplace>(opcode.assignmentOperation);
+                break;
+
+            case Opcode::Operation::BitfieldExtractShiftLeftImmediate:
+                instruction.handler = Handlers::Select<Handlers::BitfieldExtractShiftLeftImmediate>(opcode.assignmentOperation);
+                break;
+
+            case Opcode::Operation::BitfieldExtractShiftLeftRegister:
+                instruction.handler = Handlers::Select<Handlers::BitfieldExtractShiftLeftRegister>(opcode.assignmentOperation);
+                break;
+
+            case Opcode::Operation::ReadImmediate:
+                instruction.handler = Handlers::Select<Handlers::ReadImmediate>(opcode.assignmentOperation);
+                break;
+
+            case Opcode::Operation::Branch:
+                instruction.flow = Flow::Branch;
+                break;
+
+            default:
+                break;
+        }
+
+        if (instruction.flow != Flow::Branch && !instruction.handler)
+            instruction.flow = Flow::Invalid;
+
+        return instruction;
+    }
+
+    void MacroCompiler::EvictUnused() {
+        std::erase_if(cache, [](auto &entry) {
+            std::erase_if(entry.second, [](const std::weak_ptr<CompiledMacro> &translation) { return translation.expired(); });
+            return entry.second.empty();
+        });
+    }
+
+    std::shared_ptr<CompiledMacro> MacroCompiler::Compile(span<u32> macroCode, size_t offset) {
+        using Opcode = MacroInterpreter::Opcode;
+
+        // Walk all control flow paths from the entry point to determine the extent of the macro
+        enum class Visit : u8 {
+            None,
+            DelaySlot, //!< Only reached as the delay slot of an exit, control flow doesn't continue past it
+            Followed, //!< Reached by regular control flow
+        };
+
+        std::vector<Visit> visited(macroCode.size());
+        std::vector<size_t> pending;
+        size_t begin{offset}, end{offset + 1}; // Note: 'end' may be one past the end of macro memory if execution can run off of it
+
+        auto visit{[&](size_t pc, bool follow) {
+            begin = std::min(begin, pc);
+            end = std::max(end, pc + 1);
+
+            if (pc >= macroCode.size() || visited[pc] == Visit::Followed || (!follow && visited[pc] == Visit::DelaySlot))
+                return;
+
+            visited[pc] = follow ? Visit::Followed : Visit::DelaySlot;
+            if (follow)
+                pending.push_back(pc);
+        }};
+
+        visit(offset, true);
+        while (!pending.empty()) {
+            size_t pc{pending.back()};
+            pending.pop_back();
+
+            Opcode opcode{.raw = macroCode[pc]};
+            auto instruction{Decode(opcode)};
+            switch (instruction.flow) {
+                case CompiledMacro::Flow::Next:
+                    visit(pc + 1, true);
+                    break;
+
+                case CompiledMacro::Flow::Exit:
+                    visit(pc + 1, false);
+                    break;
+
+                case CompiledMacro::Flow::Branch: {
+                    i64 target{static_cast<i64>(pc) + opcode.immediate};
+                    if (target >= 0 && target < static_cast<i64>(macroCode.size()))
+                        visit(static_cast<size_t>(target), true);
+
+                    visit(pc + 1, !opcode.exit);
+                    break;
+                }
+
+                case CompiledMacro::Flow::Invalid:
+                    break;
+            }
+        }
+
+        auto codeEnd{std::min(end, macroCode.size())};
+        auto code{macroCode.subspan(begin, codeEnd - begin)};
+        u32 hash{XXH32(code.data(), code.size_bytes(), 0)};
+        u32 entry{static_cast<u32>(offset - begin + 1)};
+
+        if (auto it{cache.find(hash)}; it != cache.end()) {
+            for (const auto &weakTranslation : it->second)
+                if (auto translation{weakTranslation.lock()})
+                    if (translation->entry == entry && translation->instructions.size() == end - begin + 1 && std::equal(code.begin(), code.end(), translation->code.begin(), translation->code.end()))
+                        return translation;
+        }
+
+        // Macros being replaced by uploads leave behind translations that no positions reference anymore, these are evicted prior to inserting a new translation so the cache only holds live translations
+        EvictUnused();
+
+        auto translation{std::make_shared<CompiledMacro>()};
+        translation->entry = entry;
+        translation->code.assign(code.begin(), code.end());
+        translation->codeOffset = static_cast<i64>(begin) - static_cast<i64>(offset);
+        translation->hash = hash;
+
+        // Index 0 is a guard which branches that target outside of macro memory are redirected to
+        translation->instructions.resize(end - begin + 1);
+        for (size_t pc{begin}; pc < codeEnd; pc++) {
+            Opcode opcode{.raw = macroCode[pc]};
+            auto &instruction{translation->instructions[pc - begin + 1]};
+            instruction = Decode(opcode);
+
+            if (instruction.flow == CompiledMacro::Flow::Branch) {
+                i64 target{static_cast<i64>(pc) + opcode.immediate};
+                if (target >= static_cast<i64>(begin) && target < static_cast<i64>(end))
+                    instruction.target = static_cast<u32>(target - static_cast<i64>(begin) + 1);
+                else
+                    instruction.target = 0;
+            }
+        }
+
+        cache[hash].push_back(translation);
+        return translation;
+    }
+}
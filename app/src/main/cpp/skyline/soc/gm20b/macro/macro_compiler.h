@@ -0,0 +1,135 @@
+// SPDX-License-Identifier: MPL-2.0
+// Copyright © 2022 Skyline Team and Contributors (https://github.com/skyline-emu/)
+
+#pragma once
+
+#include <common.h>
+#include "macro_interpreter.h"
+
+namespace skyline::soc::gm20b::engine {
+    struct MacroEngineBase;
+
+    /**
+     * @brief A macro that has been translated into a flat array of pre-decoded instructions with their handlers resolved ahead of time, this avoids decoding and dispatching on the opcode bitfields for every executed instruction
+     * @note Branch targets are resolved relative to the entry point of the macro, as such a compiled macro is position-independent and can be shared by all macro positions holding identical code
+     */
+    class CompiledMacro {
+      private:
+        friend class MacroCompiler;
+
+        using Opcode = MacroInterpreter::Opcode;
+        using MethodAddress = MacroInterpreter::MethodAddress;
+
+        /**
+         * @brief The state of a single execution of a compiled macro
+         */
+        struct ExecutionContext {
+            MacroEngineBase *engine;
+            std::array<u32, 9> registers{}; //!< The general-purpose registers, the additional register at the end is a sink for writes to the zero register
+            const u32 *argument; //!< A pointer to the argument buffer for the program, it is read from sequentially
+            MethodAddress methodAddress{};
+            bool carryFlag{};
+        };
+
+        struct Instruction;
+        struct Handlers;
+
+        using Handler = void (*)(const Instruction &instruction, ExecutionContext &ctx);
+
+        /**
+         * @brief How control flow proceeds after an instruction has been executed
+         */
+        enum class Flow : u8 {
+            Next, //!< Execution continues at the following instruction
+            Exit, //!< The following instruction is executed as a delay slot after which execution stops
+            Branch, //!< A conditional branch to the target with an optional delay slot, if not taken this may exit like Flow::Exit
+            Invalid, //!< The instruction couldn't be decoded or lies outside macro memory, an exception is thrown when it is reached
+        };
+
+        static constexpr u8 SinkRegister{8}; //!< The register writes to the zero register are redirected to
+        static constexpr u8 OutOfBoundsOperation{0xFF}; //!< The value of `operation` for instructions that lie outside macro memory
+
+        /**
+         * @brief A single pre-decoded macro instruction with all fields extracted from the opcode
+         */
+        struct Instruction {
+            Handler handler{}; //!< Performs the operation and assignment of the instruction, this is nullptr for branches and invalid instructions
+            Flow flow{Flow::Invalid};
+            u8 operation{OutOfBoundsOperation}; //!< The raw operation of the opcode, used for error reporting
+            u8 dest{}; //!< The destination register, writes to register 0 are redirected to SinkRegister
+            u8 srcA{};
+            u8 srcB{};
+            u8 srcBit{};
+            u8 destBit{};
+            bool branchOnZero{}; //!< If the branch is taken when the source register is zero rather than when it's non-zero
+            bool noDelay{}; //!< If a taken branch skips its delay slot
+            bool exit{}; //!< If a branch that isn't taken should exit after its delay slot
+            u32 mask{}; //!< The precomputed mask for bitfield operations
+            i32 immediate{};
+            u32 target{}; //!< The index of the branch target in the instruction array
+        };
+
+        std::vector<Instruction> instructions; //!< All instructions in the reachable extent of the macro, index 0 is always an out-of-bounds guard
+        u32 entry{}; //!< The index of the entry point of the macro in the instruction array
+        std::vector<u32> code; //!< A copy of the in-bounds macro code this was compiled from, used to revalidate the translation against macro memory
+        i64 codeOffset{}; //!< The offset of the start of the code relative to the entry point of the macro
+        u32 hash{}; //!< The XXH32 hash of the code
+
+        /**
+         * @brief Executes an instruction that occupies a delay slot, delay slots cannot contain branches
+         */
+        static void ExecuteDelaySlot(const Instruction &instruction, ExecutionContext &ctx);
+
+        [[noreturn]] static void ThrowInvalid(const Instruction &instruction);
+
+      public:
+        /**
+         * @return The XXH32 hash of the macro code
+         */
+        u32 GetHash() const {
+            return hash;
+        }
+
+        /**
+         * @return The size of the macro code in words
+         */
+        size_t GetSize() const {
+            return code.size();
+        }
+
+        /**
+         * @return If this translation is still valid for the macro at the supplied offset in macro memory
+         */
+        bool Matches(span<u32> macroCode, size_t offset) const;
+
+        /**
+         * @brief Executes the macro with the given arguments targeting the specified engine
+         */
+        void Execute(span<u32> args, MacroEngineBase *targetEngine) const;
+    };
+
+    /**
+     * @brief The MacroCompiler class handles translating macros into CompiledMacro objects and caches the translations by the hash of their code
+     */
+    class MacroCompiler {
+      private:
+        std::unordered_map<u32, std::vector<std::weak_ptr<CompiledMacro>>> cache; //!< A map from the XXH32 hash of a macro's code to all translations with that hash, these are weak references as translations are owned by the macro positions using them
+
+        /**
+         * @brief Removes all translations which are no longer used by any macro position from the cache
+         */
+        void EvictUnused();
+
+        /**
+         * @brief Decodes a single opcode into a pre-decoded instruction, the branch target is resolved by the caller
+         */
+        static CompiledMacro::Instruction Decode(MacroInterpreter::Opcode opcode);
+
+      public:
+        /**
+         * @return A translation of the macro starting at the supplied offset in macro memory, this will be reused from the cache if the same code is still used by any macro position
+         * @note The cache doesn't keep translations alive, the caller is responsible for holding a reference to the translation for as long as it's used
+         */
+        std::shared_ptr<CompiledMacro> Compile(span<u32> macroCode, size_t offset);
+    };
+}
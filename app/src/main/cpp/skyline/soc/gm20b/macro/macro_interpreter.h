@@ -13,6 +13,9 @@ namespace skyline::soc::gm20b::engine {
      */
     class MacroInterpreter {
       private:
+        friend class CompiledMacro;
+        friend class MacroCompiler;
+
         #pragma pack(push, 1)
         union Opcode {
             u32 raw;
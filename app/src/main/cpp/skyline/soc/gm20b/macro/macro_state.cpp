@@ -5,6 +5,7 @@
 #include <range/v3/algorithm/any_of.hpp>
 #include <soc/gm20b/engines/maxwell/types.h>
 #include <soc/gm20b/engines/engine.h>
+#include <common/trace.h>
 #include "macro_state.h"
 
 namespace skyline::soc::gm20b {
@@ -23,8 +24,32 @@ namespace skyline::soc::gm20b {
         }
     }
 
+    /**
+     * @return If the arguments in the range [first, first + count) are all backed by contiguous pushbuffer memory, this is required to use them as an indirect buffer
+     */
+    static bool ArgsContiguous(span<GpfifoArgument> args, size_t first, size_t count) {
+        if (!count || args.size() < first + count || !args[first].argumentPtr)
+            return false;
+
+        for (size_t i{1}; i < count; i++)
+            if (args[first + i].argumentPtr != args[first].argumentPtr + i)
+                return false;
+
+        return true;
+    }
+
     namespace macro_hle {
         bool DrawInstanced(size_t offset, span<GpfifoArgument> args, engine::MacroEngineBase *targetEngine, const std::function<void(void)> &flushCallback) {
+            u32 topology{*args[0]};
+            bool topologyConversion{TopologyRequiresConversion(static_cast<engine::maxwell3d::type::DrawTopology>(topology))};
+
+            // The draw parameters in args[1..4] match the layout of VkDrawIndirectCommand so they can be consumed on the GPU directly rather than flushing
+            bool indirect{AnyArgsDirty(args.subspan(1, 4)) && !topologyConversion && ArgsContiguous(args, 1, 4)};
+            if (indirect) {
+                targetEngine->DrawIndirect(topology, span(args[1].argumentPtr, 4).cast<u8>(), 1, 0);
+                return true;
+            }
+
             if (AnyArgsDirty(args))
                 flushCallback();
 
@@ -36,13 +61,18 @@ namespace skyline::soc::gm20b {
 
         bool DrawInstancedIndexedIndirect(size_t offset, span<GpfifoArgument> args, engine::MacroEngineBase *targetEngine, const std::function<void(void)> &flushCallback) {
             u32 topology{*args[0]};
-            bool topologyConversion{TopologyRequiresConversion(static_cast<engine::maxwell3d::type::DrawTopology>(topology))};
-
-            // If the indirect topology isn't supported flush and fallback to a non indirect draw
-            if (topologyConversion && args[1].dirty)
+            // Indexed quads are converted on the GPU alongside the indirect parameters so they don't require a fallback, as long as the first index is known to be at a quad boundary
+            auto drawTopology{static_cast<engine::maxwell3d::type::DrawTopology>(topology)};
+            bool quads{drawTopology == engine::maxwell3d::type::DrawTopology::Quads};
+            bool topologyConversion{TopologyRequiresConversion(drawTopology) && !quads};
+            bool quadsUnaligned{quads && (args[3].dirty || *args[3] % 4 != 0)};
+
+            // If the indirect topology isn't supported or the parameters can't be used as an indirect buffer flush and fallback to a non indirect draw
+            bool indirectSupported{!topologyConversion && !quadsUnaligned && ArgsContiguous(args, 1, 5)};
+            if (!indirectSupported && (args[1].dirty || (quadsUnaligned && args[3].dirty)))
                 flushCallback();
 
-            if (topologyConversion || !args[1].dirty) {
+            if (!indirectSupported || !args[1].dirty) {
                 u32 instanceCount{targetEngine->ReadMethodFromMacro(0xD1B) & *args[2]};
                 targetEngine->DrawIndexedInstanced(topology, *args[1], instanceCount, *args[4], *args[3], *args[5]);
             } else {
@@ -78,18 +108,106 @@ namespace skyline::soc::gm20b {
         }
     }
 
+    #ifdef MACRO_DIFFERENTIAL_TESTING
+    /**
+     * @brief A proxy engine which records all methods called by a macro rather than executing them
+     * @note Reads of methods that have been written by the macro return the recorded value, all other reads are forwarded to the target engine
+     */
+    struct RecordingMacroEngine : public engine::MacroEngineBase {
+        engine::MacroEngineBase &target;
+        std::vector<std::pair<u32, u32>> calls; //!< All (method, argument) pairs in the order they were called
+        std::unordered_map<u32, u32> writes; //!< The last value written to each method
+
+        RecordingMacroEngine(engine::MacroEngineBase &target) : MacroEngineBase{target.macroState}, target{target} {}
+
+        void CallMethodFromMacro(u32 method, u32 argument) override {
+            calls.emplace_back(method, argument);
+            writes[method] = argument;
+        }
+
+        u32 ReadMethodFromMacro(u32 method) override {
+            auto it{writes.find(method)};
+            return it != writes.end() ? it->second : target.ReadMethodFromMacro(method);
+        }
+    };
+
+    /**
+     * @brief Executes a macro with both the interpreter and the compiled macro, logging any divergence in the emitted methods
+     * @note The methods emitted by the interpreter are treated as the reference and are the ones forwarded to the target engine
+     */
+    static void ExecuteDifferential(engine::MacroInterpreter &interpreter, const engine::CompiledMacro &compiledMacro, size_t offset, span<u32> args, engine::MacroEngineBase *targetEngine) {
+        RecordingMacroEngine interpreterEngine{*targetEngine}, compiledEngine{*targetEngine};
+        interpreter.Execute(offset, args, &interpreterEngine);
+
+        try {
+            compiledMacro.Execute(args, &compiledEngine);
+        } catch (const std::exception &e) {
+            Logger::Error("Compiled macro at 0x{:X} threw: {}", offset, e.what());
+        }
+
+        auto &expected{interpreterEngine.calls}, &actual{compiledEngine.calls};
+        auto mismatch{std::mismatch(expected.begin(), expected.end(), actual.begin(), actual.end())};
+        if (mismatch.first != expected.end() || mismatch.second != actual.end()) {
+            auto index{std::distance(expected.begin(), mismatch.first)};
+            Logger::Error("Compiled macro at 0x{:X} diverged from the interpreter at method call {} ({} calls expected, {} emitted)", offset, index, expected.size(), actual.size());
+            if (mismatch.first != expected.end() && mismatch.second != actual.end())
+                Logger::Error("Expected method 0x{:X} = 0x{:X}, emitted method 0x{:X} = 0x{:X}", mismatch.first->first, mismatch.first->second, mismatch.second->first, mismatch.second->second);
+        }
+
+        for (auto [method, argument] : expected)
+            targetEngine->CallMethodFromMacro(method, argument);
+    }
+    #endif
+
     void MacroState::Invalidate() {
         invalidatePending = true;
     }
 
+    #ifdef MACRO_PROFILING
+    MacroState::~MacroState() {
+        std::vector<const MacroProfile *> sortedProfiles;
+        sortedProfiles.reserve(macroProfiles.size());
+        for (const auto &[hash, profile] : macroProfiles)
+            sortedProfiles.push_back(&profile);
+
+        std::sort(sortedProfiles.begin(), sortedProfiles.end(), [](const auto *a, const auto *b) {
+            return a->executionTimeNs > b->executionTimeNs;
+        });
+
+        Logger::Info("Macro profile for {} unique macros:", sortedProfiles.size());
+        for (const auto *profile : sortedProfiles)
+            Logger::Info("Hash: 0x{:08X}, Size: 0x{:X}, Invocations: {}, HLE Hits: {}, HLE Misses: {}, Time: {}us", profile->hash, profile->size, profile->invocations, profile->hleHits, profile->invocations - profile->hleHits, profile->executionTimeNs / constant::NsInMicrosecond);
+    }
+    #endif
+
     void MacroState::Execute(u32 position, span<GpfifoArgument> args, engine::MacroEngineBase *targetEngine, const std::function<void(void)> &flushCallback) {
         size_t offset{macroPositions[position]};
 
         if (invalidatePending) {
             macroHleFunctions.fill({});
+            for (auto &entry : compiledMacros)
+                entry.valid = false;
             invalidatePending = false;
         }
 
+        auto &compiledEntry{compiledMacros[position]};
+        if (!compiledEntry.valid) {
+            // Most invalidations are caused by uploads of unrelated macros, so check if the existing translation is still valid before compiling
+            if (!compiledEntry.macro || !compiledEntry.macro->Matches(macroCode, offset)) {
+                compiledEntry.macro.reset(); // The stale translation is released first so it can be evicted from the compiler's cache if no other position uses it
+                compiledEntry.macro = macroCompiler.Compile(macroCode, offset);
+            }
+            compiledEntry.valid = true;
+        }
+
+        auto &compiledMacro{*compiledEntry.macro};
+        TRACE_EVENT("gpu", "Macro", "hash", compiledMacro.GetHash(), "size", compiledMacro.GetSize());
+
+        #ifdef MACRO_PROFILING
+        auto &profile{macroProfiles.try_emplace(compiledMacro.GetHash(), MacroProfile{compiledMacro.GetHash(), compiledMacro.GetSize()}).first->second};
+        auto startTime{util::GetTimeNs()};
+        #endif
+
         auto &hleEntry{macroHleFunctions[position]};
 
         if (!hleEntry.valid) {
@@ -97,14 +215,25 @@ namespace skyline::soc::gm20b {
             hleEntry.valid = true;
         }
 
-        if (macroHleFunctions[position].function && macroHleFunctions[position].function(offset, args, targetEngine, flushCallback))
-            return;
+        bool hleHit{hleEntry.function && hleEntry.function(offset, args, targetEngine, flushCallback)};
+        if (!hleHit) {
+            if (AnyArgsDirty(args))
+                flushCallback();
 
-        if (AnyArgsDirty(args))
-            flushCallback();
+            argumentStorage.resize(args.size());
+            std::transform(args.begin(), args.end(), argumentStorage.begin(), [](GpfifoArgument arg) { return *arg; });
+
+            #ifdef MACRO_DIFFERENTIAL_TESTING
+            ExecuteDifferential(macroInterpreter, compiledMacro, offset, argumentStorage, targetEngine);
+            #else
+            compiledMacro.Execute(argumentStorage, targetEngine);
+            #endif
+        }
 
-        argumentStorage.resize(args.size());
-        std::transform(args.begin(), args.end(), argumentStorage.begin(), [](GpfifoArgument arg) { return *arg; });
-        macroInterpreter.Execute(offset, argumentStorage, targetEngine);
+        #ifdef MACRO_PROFILING
+        profile.invocations++;
+        profile.hleHits += hleHit;
+        profile.executionTimeNs += static_cast<u64>(util::GetTimeNs() - startTime);
+        #endif
     }
 }
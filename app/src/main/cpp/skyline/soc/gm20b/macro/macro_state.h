@@ -5,6 +5,7 @@
 
 #include <common.h>
 #include "macro_interpreter.h"
+#include "macro_compiler.h"
 
 namespace skyline::soc::gm20b {
     /**
@@ -37,23 +38,49 @@ namespace skyline::soc::gm20b {
             bool valid;
         };
 
-        engine::MacroInterpreter macroInterpreter; //!< The macro interpreter for handling 3D/2D macros
+        struct CompiledMacroEntry {
+            std::shared_ptr<engine::CompiledMacro> macro;
+            bool valid;
+        };
+
+        engine::MacroInterpreter macroInterpreter; //!< The macro interpreter, this is only used as a reference for differential testing of compiled macros
+        engine::MacroCompiler macroCompiler; //!< The macro compiler for handling 3D/2D macros
         std::array<u32, 0x2000> macroCode{}; //!< Stores GPU macros, writes to it will wraparound on overflow
         std::array<size_t, 0x80> macroPositions{}; //!< The positions of each individual macro in macro code memory, there can be a maximum of 0x80 macros at any one time
-        std::array<MacroHleEntry, 0x80> macroHleFunctions{}; //!< The HLE functions for each macro position, used to optionally override the interpreter
-        std::vector<u32> argumentStorage; //!< Storage for the macro arguments during execution using the interpreter
+        std::array<MacroHleEntry, 0x80> macroHleFunctions{}; //!< The HLE functions for each macro position, used to optionally override the compiled macro
+        std::array<CompiledMacroEntry, 0x80> compiledMacros{}; //!< The compiled macros for each macro position, these are revalidated against macro code after an invalidation rather than being recompiled
+        std::vector<u32> argumentStorage; //!< Storage for the macro arguments during execution of compiled macros
 
         bool invalidatePending{};
 
+        #ifdef MACRO_PROFILING
+        /**
+         * @brief Execution statistics for a single unique macro
+         */
+        struct MacroProfile {
+            u32 hash; //!< The XXH32 hash of the macro code
+            size_t size; //!< The size of the macro code in words
+            u64 invocations{};
+            u64 hleHits{}; //!< The amount of invocations which were handled by a HLE function without falling back to the compiled macro
+            u64 executionTimeNs{}; //!< The total time spent executing the macro, including any HLE function
+        };
+
+        std::unordered_map<u32, MacroProfile> macroProfiles; //!< Profiles of all executed macros keyed by their hash, these are logged on destruction
+        #endif
+
         MacroState() : macroInterpreter{macroCode} {}
 
+        #ifdef MACRO_PROFILING
+        ~MacroState();
+        #endif
+
         /**
-         * @brief Invalidates the HLE function cache
+         * @brief Invalidates the HLE function and compiled macro caches
          */
         void Invalidate();
 
         /**
-         * @brief Executes a macro at a given position, this can either be a HLE function or the interpreter
+         * @brief Executes a macro at a given position, this can either be a HLE function or the compiled macro
          */
         void Execute(u32 position, span<GpfifoArgument> args, engine::MacroEngineBase *targetEngine, const std::function<void(void)> &flushCallback);
     };
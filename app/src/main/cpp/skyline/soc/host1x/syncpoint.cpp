@@ -2,9 +2,50 @@
 // Copyright © 2020 Skyline Team and Contributors (https://github.com/skyline-emu/)
 // Copyright © 2020 Ryujinx Team and Contributors (https://github.com/Ryujinx/)
 
+#include <linux/futex.h>
+#include <sys/syscall.h>
 #include "syncpoint.h"
 
 namespace skyline::soc::host1x {
+    u64 Syncpoint::InsertWaiter(u32 threshold, std::function<void()> callback) {
+        waiters.push_back(Waiter{threshold, nextWaiterId, std::move(callback)});
+        std::push_heap(waiters.begin(), waiters.end(), std::greater{});
+        nextThreshold.store(waiters.front().threshold);
+
+        // An increment that occurred prior to the store above might have missed this waiter, this is checked after the store so either that increment or we will see the waiter as signalled
+        if (value.load() >= threshold) {
+            EraseWaiter(std::find_if(waiters.begin(), waiters.end(), [&](const Waiter &waiter) { return waiter.id == nextWaiterId; }));
+            return 0;
+        }
+
+        return nextWaiterId++;
+    }
+
+    void Syncpoint::EraseWaiter(std::vector<Waiter>::iterator it) {
+        auto index{static_cast<size_t>(std::distance(waiters.begin(), it))};
+        if (index != waiters.size() - 1)
+            *it = std::move(waiters.back());
+        waiters.pop_back();
+
+        if (index < waiters.size()) {
+            // The replacement might belong above or below the erased waiter, it's sifted up and then down from the position it ends up at
+            std::push_heap(waiters.begin(), waiters.begin() + static_cast<ssize_t>(index) + 1, std::greater{});
+            while (true) {
+                size_t child{(index * 2) + 1};
+                if (child >= waiters.size())
+                    break;
+                if (child + 1 < waiters.size() && waiters[child] > waiters[child + 1])
+                    child++;
+                if (!(waiters[index] > waiters[child]))
+                    break;
+                std::swap(waiters[index], waiters[child]);
+                index = child;
+            }
+        }
+
+        nextThreshold.store(waiters.empty() ? std::numeric_limits<u32>::max() : waiters.front().threshold);
+    }
+
     Syncpoint::WaiterHandle Syncpoint::RegisterWaiter(u32 threshold, const std::function<void()> &callback) {
         if (value.load(std::memory_order_acquire) >= threshold) {
             // (Fast path) We don't need to wait on the mutex and can just get away with atomics
@@ -13,49 +54,45 @@ namespace skyline::soc::host1x {
         }
 
         std::scoped_lock lock(mutex);
-        if (value.load(std::memory_order_acquire) >= threshold) {
+        auto id{InsertWaiter(threshold, callback)};
+        if (!id)
             callback();
-            return {};
-        }
-
-        auto it{waiters.begin()};
-        while (it != waiters.end() && threshold >= it->threshold)
-            it++;
-        return waiters.emplace(it, threshold, callback);
+        return WaiterHandle{id};
     }
 
     void Syncpoint::DeregisterWaiter(WaiterHandle waiter) {
+        if (!waiter)
+            return;
+
         std::scoped_lock lock(mutex);
-        // We want to ensure the iterator still exists prior to erasing it
-        // Otherwise, if an invalid iterator was passed in then it could lead to UB
-        // It is important to avoid UB in that case since the deregister isn't called from a locked context
-        for (auto it{waiters.begin()}; it != waiters.end(); it++) {
-            if (it == waiter) {
-                waiters.erase(it);
-                return;
-            }
-        }
+        // The waiter might've already been signalled and removed, in which case the handle is simply stale
+        auto it{std::find_if(waiters.begin(), waiters.end(), [&](const Waiter &entry) { return entry.id == waiter.id; })};
+        if (it == waiters.end())
+            return;
+
+        EraseWaiter(it);
     }
 
     u32 Syncpoint::Increment() {
-        auto readValue{value.fetch_add(1, std::memory_order_acq_rel) + 1}; // We don't want to constantly do redundant atomic loads
+        auto readValue{value.fetch_add(1) + 1}; // We don't want to constantly do redundant atomic loads
+        if (readValue < nextThreshold.load())
+            return readValue; // (Fast path) No waiters have been reached by this increment
 
         std::scoped_lock lock(mutex);
-        bool signalCondition{};
-        auto it{waiters.begin()};
-        while (it != waiters.end() && readValue >= it->threshold) {
-            auto &waiter{*it};
+        bool wakeWaiters{};
+        while (!waiters.empty() && readValue >= waiters.front().threshold) {
+            std::pop_heap(waiters.begin(), waiters.end(), std::greater{});
+            auto &waiter{waiters.back()};
             if (waiter.callback)
                 waiter.callback();
             else
-                signalCondition = true;
-            it++;
+                wakeWaiters = true;
+            waiters.pop_back();
         }
+        nextThreshold.store(waiters.empty() ? std::numeric_limits<u32>::max() : waiters.front().threshold);
 
-        waiters.erase(waiters.begin(), it);
-
-        if (signalCondition)
-            incrementCondition.notify_all();
+        if (wakeWaiters)
+            syscall(__NR_futex, reinterpret_cast<u32 *>(&value), FUTEX_WAKE_PRIVATE, std::numeric_limits<i32>::max(), nullptr, nullptr, 0);
 
         return readValue;
     }
@@ -63,20 +100,42 @@ namespace skyline::soc::host1x {
     bool Syncpoint::Wait(u32 threshold, std::chrono::steady_clock::duration timeout) {
         if (value.load(std::memory_order_acquire) >= threshold)
             // (Fast Path) We don't need to wait on the mutex and can just get away with atomics
-            return {};
+            return true;
 
-        std::unique_lock lock(mutex);
-        auto it{waiters.begin()};
-        while (it != waiters.end() && threshold >= it->threshold)
-            it++;
-        waiters.emplace(it, threshold, nullptr);
+        WaiterHandle handle;
+        {
+            std::scoped_lock lock(mutex);
+            handle.id = InsertWaiter(threshold, nullptr);
+            if (!handle)
+                return true;
+        }
 
-        if (timeout == std::chrono::steady_clock::duration::max()) {
-            incrementCondition.wait(lock, [&] { return value.load(std::memory_order_relaxed) >= threshold; });
-            return true;
-        } else {
-            return incrementCondition.wait_for(lock, timeout, [&] { return value.load(std::memory_order_relaxed) >= threshold; });
+        bool infinite{timeout == std::chrono::steady_clock::duration::max()};
+        auto deadline{infinite ? std::chrono::steady_clock::time_point::max() : std::chrono::steady_clock::now() + timeout};
+        while (true) {
+            u32 current{value.load(std::memory_order_acquire)};
+            if (current >= threshold)
+                return true; // Our waiter is removed by the increment which reached the threshold
+
+            timespec *futexTimeout{};
+            timespec remainingTimespec;
+            if (!infinite) {
+                auto remaining{deadline - std::chrono::steady_clock::now()};
+                if (remaining <= std::chrono::steady_clock::duration::zero()) {
+                    DeregisterWaiter(handle);
+                    return value.load(std::memory_order_acquire) >= threshold;
+                }
+
+                auto remainingNs{std::chrono::duration_cast<std::chrono::nanoseconds>(remaining).count()};
+                remainingTimespec = {
+                    .tv_sec = static_cast<time_t>(remainingNs / constant::NsInSecond),
+                    .tv_nsec = static_cast<long>(remainingNs % constant::NsInSecond),
+                };
+                futexTimeout = &remainingTimespec;
+            }
+
+            // The futex only sleeps if the value is still the one we've observed, this ensures that increments after the load above aren't missed
+            syscall(__NR_futex, reinterpret_cast<u32 *>(&value), FUTEX_WAIT_PRIVATE, current, futexTimeout, nullptr, 0);
         }
     }
 }
-
@@ -11,31 +11,61 @@ namespace skyline::soc::host1x {
 
     /**
      * @brief The Syncpoint class represents a single syncpoint in the GPU which is used for GPU -> CPU synchronisation
+     * @note Increments only need to acquire the mutex when they reach the threshold of a waiter, blocking waits are done with a futex on the counter itself
      */
     class Syncpoint {
       private:
-        std::atomic<u32> value{}; //!< An atomically-incrementing counter at the core of a syncpoint
+        std::atomic<u32> value{}; //!< An atomically-incrementing counter at the core of a syncpoint, this is also used as the futex word for blocking waits
 
-        std::mutex mutex; //!< Synchronizes insertions and deletions of waiters alongside locking the increment condition
-        std::condition_variable incrementCondition; //!< Signalled on thresholds for waiters which are tied to Wait(...)
+        std::mutex mutex; //!< Synchronizes insertions and deletions of waiters
 
         struct Waiter {
             u32 threshold; //!< The syncpoint value to wait on to be reached
-            std::function<void()> callback; //!< The callback to do after the wait has ended, refers to cvar signal when nullptr
-
-            Waiter(u32 threshold, std::function<void()> callback) : threshold(threshold), callback(std::move(callback)) {}
+            u64 id; //!< A unique identifier for the waiter, this is used to break ties between waiters with the same threshold in order of registration
+            std::function<void()> callback; //!< The callback to do after the wait has ended, refers to a futex wake when nullptr
+
+            /**
+             * @brief The ordering of waiters in the heap, the waiter with the lowest threshold is at the top
+             */
+            bool operator>(const Waiter &other) const {
+                return threshold != other.threshold ? threshold > other.threshold : id > other.id;
+            }
         };
-        std::list<Waiter> waiters; //!< A linked list of all waiters, it's sorted in ascending order by threshold
+        std::vector<Waiter> waiters; //!< A min-heap of all waiters ordered by their threshold
+        u64 nextWaiterId{1}; //!< The ID of the next waiter, 0 is reserved for invalid handles
+        std::atomic<u32> nextThreshold{std::numeric_limits<u32>::max()}; //!< The lowest threshold of any waiter, increments that don't reach this don't need to acquire the mutex
+
+        /**
+         * @brief Inserts a waiter into the heap
+         * @return The ID of the waiter or 0 if the threshold has already been reached, in which case the waiter wasn't inserted
+         * @note The mutex must be locked
+         */
+        u64 InsertWaiter(u32 threshold, std::function<void()> callback);
+
+        /**
+         * @brief Removes a waiter from any position in the heap, this is done by replacing it with the last waiter and restoring the heap property around it rather than rebuilding the heap
+         * @note The mutex must be locked
+         */
+        void EraseWaiter(std::vector<Waiter>::iterator it);
 
       public:
         /**
          * @return The value of the syncpoint, retrieved in an atomically safe manner
          */
-        constexpr u32 Load() {
+        u32 Load() {
             return value.load(std::memory_order_acquire);
         }
 
-        using WaiterHandle = decltype(waiters)::iterator; //!< Aliasing an iterator to a Waiter as an opaque handle
+        /**
+         * @brief An opaque handle to a registered waiter, it's invalid if the waiter's threshold was already reached during registration
+         */
+        struct WaiterHandle {
+            u64 id{};
+
+            explicit operator bool() const {
+                return id != 0;
+            }
+        };
 
         /**
          * @brief Registers a new waiter with a callback that will be called when the syncpoint reaches the target threshold
@@ -45,7 +75,7 @@ namespace skyline::soc::host1x {
         WaiterHandle RegisterWaiter(u32 threshold, const std::function<void()> &callback);
 
         /**
-         * @note If the supplied handle is invalid then the function will do nothing
+         * @note If the supplied handle is invalid or the waiter has already been signalled then the function will do nothing
          */
         void DeregisterWaiter(WaiterHandle waiter);
 
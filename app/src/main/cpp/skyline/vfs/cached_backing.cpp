@@ -0,0 +1,196 @@
+// SPDX-License-Identifier: MPL-2.0
+// Copyright © 2022 Skyline Team and Contributors (https://github.com/skyline-emu/)
+
+#include <common/trace.h>
+#include "cached_backing.h"
+
+namespace skyline::vfs {
+    CachedBacking::CachedBacking(std::shared_ptr<Backing> pBacking, size_t memoryBudget, size_t blockSize) : Backing({true, false, false}, pBacking->size), backing(std::move(pBacking)), blockSize(blockSize), shardCapacity(std::max<size_t>(memoryBudget / blockSize / ShardCount, 1)) {
+        if (!std::has_single_bit(blockSize))
+            throw exception("CachedBacking block size must be a power of two: 0x{:X}", blockSize);
+
+        prefetchThread = std::thread(&CachedBacking::PrefetchThread, this);
+    }
+
+    CachedBacking::~CachedBacking() {
+        {
+            std::scoped_lock lock{prefetchMutex};
+            prefetchExit = true;
+        }
+        prefetchCondition.notify_all();
+        prefetchThread.join();
+    }
+
+    bool CachedBacking::IsCached(size_t index) {
+        auto &shard{GetShard(index)};
+        std::scoped_lock lock{shard.mutex};
+        return shard.lookup.contains(index);
+    }
+
+    bool CachedBacking::CopyFromCache(size_t index, span<u8> output, size_t blockOffset) {
+        auto &shard{GetShard(index)};
+        std::scoped_lock lock{shard.mutex};
+        auto it{shard.lookup.find(index)};
+        if (it == shard.lookup.end())
+            return false;
+
+        auto &block{*it->second};
+        if (blockOffset + output.size() > block.data.size())
+            return false; // The block was only partially read by the backing, treat it as a miss
+
+        shard.blocks.splice(shard.blocks.begin(), shard.blocks, it->second);
+        std::memcpy(output.data(), block.data.data() + blockOffset, output.size());
+        return true;
+    }
+
+    void CachedBacking::Insert(size_t index, span<u8> data) {
+        auto &shard{GetShard(index)};
+        std::scoped_lock lock{shard.mutex};
+        auto it{shard.lookup.find(index)};
+        if (it != shard.lookup.end()) {
+            // Another thread might've raced us to insert this block or the existing block might've been a short read, either way its contents are replaced
+            it->second->data.assign(data.begin(), data.end());
+            shard.blocks.splice(shard.blocks.begin(), shard.blocks, it->second);
+            return;
+        }
+
+        if (shard.blocks.size() >= shardCapacity) {
+            // Recycle the least recently used block to avoid a reallocation for the new block
+            auto last{std::prev(shard.blocks.end())};
+            shard.lookup.erase(last->index);
+            last->index = index;
+            last->data.assign(data.begin(), data.end());
+            shard.blocks.splice(shard.blocks.begin(), shard.blocks, last);
+        } else {
+            shard.blocks.emplace_front(CachedBlock{index, std::vector<u8>(data.begin(), data.end())});
+        }
+        shard.lookup.emplace(index, shard.blocks.begin());
+    }
+
+    size_t CachedBacking::FillBlocks(size_t firstIndex, size_t lastIndex, std::vector<u8> &buffer) {
+        size_t offset{firstIndex * blockSize};
+        size_t readSize{std::min((lastIndex - firstIndex + 1) * blockSize, size - offset)};
+        buffer.resize(readSize);
+
+        size_t read{backing->ReadUnchecked(buffer, offset)};
+        span<u8> data{buffer.data(), read};
+        for (size_t index{firstIndex}; !data.empty(); index++) {
+            auto blockData{data.first(std::min(blockSize, data.size()))};
+            Insert(index, blockData);
+            data = data.subspan(blockData.size());
+        }
+
+        return read;
+    }
+
+    void CachedBacking::PrefetchThread() {
+        if (int result{pthread_setname_np(pthread_self(), "Sky-Prefetch")})
+            Logger::Warn("Failed to set the thread name: {}", strerror(result));
+
+        std::vector<u8> buffer;
+        while (true) {
+            size_t firstIndex, lastIndex;
+            {
+                std::unique_lock lock{prefetchMutex};
+                prefetchCondition.wait(lock, [this] { return prefetchExit || prefetchStart != prefetchEnd; });
+                if (prefetchExit)
+                    return;
+
+                firstIndex = prefetchStart;
+                lastIndex = prefetchEnd - 1;
+                prefetchStart = prefetchEnd;
+            }
+
+            // Skip over any blocks that were already cached by the time we got to them
+            while (firstIndex <= lastIndex && IsCached(firstIndex))
+                firstIndex++;
+            while (lastIndex > firstIndex && IsCached(lastIndex))
+                lastIndex--;
+
+            if (firstIndex <= lastIndex) {
+                TRACE_EVENT("vfs", "CachedBacking::Prefetch", "firstBlock", firstIndex, "blockCount", lastIndex - firstIndex + 1);
+                FillBlocks(firstIndex, lastIndex, buffer);
+            }
+        }
+    }
+
+    void CachedBacking::QueuePrefetch(size_t firstIndex, size_t lastIndex) {
+        {
+            std::scoped_lock lock{prefetchMutex};
+            if (prefetchStart != prefetchEnd && firstIndex >= prefetchStart && firstIndex <= prefetchEnd) {
+                // Extend the pending range rather than replacing it when the reads are continuing the same stream
+                prefetchEnd = std::max(prefetchEnd, lastIndex + 1);
+            } else {
+                prefetchStart = firstIndex;
+                prefetchEnd = lastIndex + 1;
+            }
+        }
+        prefetchCondition.notify_one();
+    }
+
+    void CachedBacking::TraceCounters() {
+        u64 hits{hitCount.load(std::memory_order_relaxed)}, misses{missCount.load(std::memory_order_relaxed)};
+        TRACE_COUNTER("vfs", "CachedBacking Hit Rate", static_cast<double>(hits) / static_cast<double>(std::max<u64>(hits + misses, 1)));
+        TRACE_COUNTER("vfs", "CachedBacking Bytes Saved", bytesSaved.load(std::memory_order_relaxed));
+    }
+
+    size_t CachedBacking::ReadImpl(span<u8> output, size_t offset) {
+        if (offset >= size || output.empty())
+            return 0;
+        if (output.size() > size - offset)
+            output = output.first(size - offset);
+
+        // Detect sequential access and prefetch the blocks following this read
+        size_t readEnd{offset + output.size()};
+        bool isSequential{lastReadEnd.exchange(readEnd, std::memory_order_relaxed) == offset};
+
+        // Large reads are passed through directly as caching them would evict the entire working set for data that's unlikely to be reread
+        if (output.size() > (shardCapacity * ShardCount * blockSize) / 4)
+            return backing->ReadUnchecked(output, offset);
+
+        size_t firstIndex{offset / blockSize}, lastIndex{(readEnd - 1) / blockSize};
+        if (isSequential) {
+            if (sequentialReads.fetch_add(1, std::memory_order_relaxed) + 1 >= SequentialReadThreshold) {
+                size_t lastBlock{(size - 1) / blockSize};
+                if (lastIndex < lastBlock)
+                    QueuePrefetch(lastIndex + 1, std::min(lastIndex + PrefetchBlockCount, lastBlock));
+            }
+        } else {
+            sequentialReads.store(0, std::memory_order_relaxed);
+        }
+
+        std::vector<u8> buffer;
+        size_t index{firstIndex};
+        while (index <= lastIndex) {
+            size_t blockStart{index * blockSize};
+            size_t copyStart{std::max(offset, blockStart)}, copyEnd{std::min(readEnd, blockStart + blockSize)};
+            if (CopyFromCache(index, output.subspan(copyStart - offset, copyEnd - copyStart), copyStart - blockStart)) {
+                hitCount.fetch_add(1, std::memory_order_relaxed);
+                bytesSaved.fetch_add(copyEnd - copyStart, std::memory_order_relaxed);
+                index++;
+                continue;
+            }
+
+            // Coalesce all consecutive missing blocks into a single read from the backing
+            size_t missEnd{index};
+            while (missEnd < lastIndex && !IsCached(missEnd + 1))
+                missEnd++;
+
+            missCount.fetch_add(missEnd - index + 1, std::memory_order_relaxed);
+            size_t read{FillBlocks(index, missEnd, buffer)};
+
+            size_t runStart{index * blockSize};
+            size_t runCopyEnd{std::min(readEnd, runStart + read)};
+            if (runCopyEnd <= copyStart)
+                return copyStart - offset;
+            std::memcpy(output.data() + (copyStart - offset), buffer.data() + (copyStart - runStart), runCopyEnd - copyStart);
+            if (runCopyEnd < std::min(readEnd, (missEnd + 1) * blockSize))
+                return runCopyEnd - offset; // The backing returned less data than requested
+
+            index = missEnd + 1;
+        }
+
+        TraceCounters();
+        return output.size();
+    }
+}
@@ -0,0 +1,99 @@
+// SPDX-License-Identifier: MPL-2.0
+// Copyright © 2022 Skyline Team and Contributors (https://github.com/skyline-emu/)
+
+#pragma once
+
+#include <list>
+#include <unordered_map>
+#include <condition_variable>
+#include "backing.h"
+
+namespace skyline::vfs {
+    /**
+     * @brief A read-only backing that caches fixed-size blocks of another backing in memory, this avoids repeating the work of the underlying backing (such as file I/O and decryption) for data that is read multiple times
+     * @note Blocks are distributed over multiple independently locked LRU shards to avoid contention between concurrent readers
+     * @note Sequential reads are detected and the blocks following them are prefetched on a background thread
+     */
+    class CachedBacking : public Backing {
+      public:
+        static constexpr size_t DefaultBlockSize{0x4000}; //!< 16KiB blocks are a good fit for the read patterns of RomFS
+        static constexpr size_t DefaultMemoryBudget{32 * 1024 * 1024}; //!< The default maximum amount of memory used for cached blocks
+
+      private:
+        static constexpr size_t ShardCount{16};
+        static constexpr size_t SequentialReadThreshold{2}; //!< The amount of back-to-back sequential reads after which prefetching is triggered
+        static constexpr size_t PrefetchBlockCount{8}; //!< The amount of blocks that are prefetched past the end of a sequential read
+
+        struct CachedBlock {
+            size_t index;
+            std::vector<u8> data;
+        };
+
+        /**
+         * @brief A single LRU cache shard, blocks are assigned to shards based on their index so adjacent blocks are spread over all shards
+         */
+        struct Shard {
+            std::mutex mutex;
+            std::list<CachedBlock> blocks; //!< The blocks in this shard ordered from most to least recently used
+            std::unordered_map<size_t, std::list<CachedBlock>::iterator> lookup; //!< A map from a block index to its entry in the LRU list
+        };
+
+        std::shared_ptr<Backing> backing;
+        size_t blockSize;
+        size_t shardCapacity; //!< The maximum amount of blocks in a single shard
+        std::array<Shard, ShardCount> shards;
+
+        std::atomic<size_t> lastReadEnd{}; //!< The end offset of the last read, this is used to detect sequential access
+        std::atomic<size_t> sequentialReads{}; //!< The amount of back-to-back reads that started at the end of the prior read
+
+        std::thread prefetchThread;
+        std::mutex prefetchMutex; //!< Protects the prefetch state below
+        std::condition_variable prefetchCondition;
+        size_t prefetchStart{}, prefetchEnd{}; //!< The range of block indices that are pending a prefetch
+        bool prefetchExit{};
+
+        std::atomic<u64> hitCount{}, missCount{};
+        std::atomic<u64> bytesSaved{}; //!< The amount of bytes that were served from the cache rather than the underlying backing
+
+        Shard &GetShard(size_t index) {
+            return shards[index % ShardCount];
+        }
+
+        bool IsCached(size_t index);
+
+        /**
+         * @brief Copies a cached block into the output if present and marks it as most recently used
+         * @return If the block was present in the cache
+         */
+        bool CopyFromCache(size_t index, span<u8> output, size_t blockOffset);
+
+        /**
+         * @brief Inserts a block into the cache, evicting the least recently used block of its shard if it's full
+         */
+        void Insert(size_t index, span<u8> data);
+
+        /**
+         * @brief Reads the specified range of blocks from the underlying backing and inserts them into the cache
+         * @return The amount of bytes read from the backing
+         */
+        size_t FillBlocks(size_t firstIndex, size_t lastIndex, std::vector<u8> &buffer);
+
+        void PrefetchThread();
+
+        void QueuePrefetch(size_t firstIndex, size_t lastIndex);
+
+        void TraceCounters();
+
+      protected:
+        size_t ReadImpl(span<u8> output, size_t offset) override;
+
+      public:
+        /**
+         * @param memoryBudget The maximum amount of memory that should be used for cached blocks
+         * @param blockSize The granularity at which data is cached, this must be a power of two
+         */
+        CachedBacking(std::shared_ptr<Backing> backing, size_t memoryBudget = DefaultMemoryBudget, size_t blockSize = DefaultBlockSize);
+
+        ~CachedBacking();
+    };
+}
@@ -5,6 +5,7 @@
 #include <loader/loader.h>
 
 #include "ctr_encrypted_backing.h"
+#include "cached_backing.h"
 #include "region_backing.h"
 #include "partition_filesystem.h"
 #include "nca.h"
@@ -66,7 +67,10 @@ namespace skyline::vfs {
         size_t offset{static_cast<size_t>(entry.startOffset) * constant::MediaUnitSize + sectionHeader.integrityHashInfo.levels.back().offset};
         size_t size{sectionHeader.integrityHashInfo.levels.back().size};
 
+        // RomFS data is read frequently and in small chunks by the guest, caching it avoids repeatedly reading and decrypting the same data
         romFs = CreateBacking(sectionHeader, std::make_shared<RegionBacking>(backing, offset, size), offset);
+        if (romFs)
+            romFs = std::make_shared<CachedBacking>(std::move(romFs));
     }
 
     std::shared_ptr<Backing> NCA::CreateBacking(const NcaSectionHeader &sectionHeader, std::shared_ptr<Backing> rawBacking, size_t offset) {
@@ -38,6 +38,7 @@ data class NativeSettings(
     var forceMaxGpuClocks : Boolean,
     var freeGuestTextureMemory : Boolean,
     var disableShaderCache : Boolean,
+    var enableDecodedTextureCache : Boolean,
 
     // Hacks
     var enableFastGpuReadbackHack : Boolean,
@@ -65,6 +66,7 @@ data class NativeSettings(
         pref.forceMaxGpuClocks,
         pref.freeGuestTextureMemory,
         pref.disableShaderCache,
+        pref.enableDecodedTextureCache,
         pref.enableFastGpuReadbackHack,
         pref.enableFastReadbackWrites,
         pref.disableSubgroupShuffle,